@@ -0,0 +1,139 @@
+#include "SceneGenerator.h"
+#include<algorithm>
+#include<cmath>
+#include"Factories\ObjectFactory.h"
+#include"Scene\Scene.h"
+#include"DebugTools\Assert.h"
+
+namespace
+{
+	const AssetId models[] = { "Models/cube.obj", "Models/plane.obj" };	//*< Models objects are generated with, hashed once instead of for every object.
+	/**
+		Texture sets objects are generated with. Normal and depth maps are used only by pipelines which need them.
+	*/
+	const struct { AssetId texture; AssetId normalMap; AssetId depthMap; } textures[] = {
+		{ "Textures/bricks2.jpg", "Textures/bricks2N.jpg", "Textures/bricks2D.jpg" },
+		{ "Textures/dirt.JPG", "Textures/dirtN.JPG", "Textures/bricks2D.jpg" },
+		{ "Textures/bricks.JPG", "Textures/bricksN.JPG", "Textures/bricks2D.jpg" },
+		{ "Textures/cube.png", "Textures/bricks2N.jpg", "Textures/bricks2D.jpg" },
+		{ "Textures/box.png", "Textures/dirtN.JPG", "Textures/bricks2D.jpg" },
+		{ "Textures/chalet.jpg", "Textures/bricksN.JPG", "Textures/bricks2D.jpg" },
+		{ "Textures/texture.jpg", "Textures/bricks2N.jpg", "Textures/bricks2D.jpg" }
+	};
+	const uint32_t numModels = sizeof(models) / sizeof(models[0]);		//*< Number of available models.
+	const uint32_t numTextures = sizeof(textures) / sizeof(textures[0]);	//*< Number of available texture sets.
+	const float spacing = 0.4f;											//*< Distance between neighbouring root objects.
+	const float occluderDepth = -3.f;									//*< Distance of the occluding walls from the origin along z axis.
+	const float orbitRadius = 0.5f;										//*< Radius of the circle along which dynamic objects move.
+}
+
+SceneGenerator::SceneGenerator(const SceneParams & params) : params{ params }, random{ params.seed }
+{
+	ASSERT(params.pipelines.size() > 0)
+	ASSERT(params.hierarchyDepth > 0)
+	// objects that don't share a combination each get their own one, as long as there are enough assets on disk.
+	uint32_t unique = static_cast<uint32_t>(std::round((1.f - params.shareRatio) * params.numObjects));
+	numVariants = std::min(std::max(unique, 1u), numModels * numTextures);
+}
+
+void SceneGenerator::populate(Scene & scene)
+{
+	std::uniform_real_distribution<float> jitter{ -0.1f, 0.1f };
+	uint32_t numRoots = (params.numObjects + params.hierarchyDepth - 1) / params.hierarchyDepth;
+	uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(std::max(numRoots, 1u)))));
+	uint32_t index = 0;
+	// place roots in a grid in front of the camera and hang chains of children from them.
+	for (uint32_t i = 0; i < numRoots; i++)
+	{
+		glm::vec3 position{ (i % side - side / 2.f) * spacing + jitter(random), (i / side - side / 2.f) * spacing + jitter(random), -5.f + jitter(random) };
+		GameObject* root = createObject(index++, position, glm::vec3{ 0.125f, 0.125f, 0.125f });
+		GameObject* parent = root;
+		for (uint32_t depth = 1; depth < params.hierarchyDepth && index < params.numObjects; depth++)
+		{
+			// child transformations are relative to the parent.
+			GameObject* child = createObject(index++, glm::vec3{ 1.5f, 0.f, 0.f }, glm::vec3{ 0.75f, 0.75f, 0.75f });
+			parent->addChild(child);
+			parent = child;
+		}
+		// children are attached to the engine together with their root so the chain has to be complete before it is added.
+		scene.addItem(root);
+		if (i < params.numDynamic)
+		{
+			dynamic.push_back(root);
+		}
+	}
+	// walls cover every other slot of a row as wide as the grid, so roughly half of the objects end up hidden.
+	float extent = side * spacing;
+	for (uint32_t i = 0; i < params.numOccluders; i++)
+	{
+		float width = extent / (2 * params.numOccluders);
+		glm::vec3 position{ -extent / 2.f + (2 * i + 0.5f) * width, 0.f, occluderDepth };
+		ObjectCreate create{ position, glm::vec3{ width / 2.f, extent / 2.f, 0.05f }, 0.f, glm::vec3{ 0.f, 0.f, 1.f }, models[0], textures[0].texture, nullptr, nullptr, PipelineType::eNoLight, 0 };
+		GameObject* wall = ObjectFactory::createGameObjectRotation(create);
+		wall->setOccluder(true);
+		objects.push_back(wall);
+		scene.addItem(wall);
+	}
+	for (uint32_t i = 0; i < params.numBillboards; i++)
+	{
+		BillboardCreate billboard{ &scene, Axis::eY, glm::vec3{ jitter(random) * 20.f, jitter(random) * 10.f, -3.f + jitter(random) * 10.f }, glm::vec3{ 0.25f, 0.25f, 0.25f }, 0.f,
+									glm::vec3{ 0.f, 0.f, 1.f }, "Textures/no.png", PipelineType::eNoLight, 1 };
+		GameObject* go = ObjectFactory::createBillboard(billboard);
+		objects.push_back(go);
+		scene.addItem(go);
+	}
+}
+
+uint32_t SceneGenerator::getNumVariants() const
+{
+	return numVariants;
+}
+
+uint32_t SceneGenerator::getNumObjects() const
+{
+	return objects.size();
+}
+
+void SceneGenerator::animate(const double time)
+{
+	// move along a circle by the difference between its points at the previous and the current time.
+	double previous = elapsed;
+	elapsed += time;
+	for (size_t i = 0; i < dynamic.size(); i++)
+	{
+		float phase = static_cast<float>(i);
+		glm::vec3 from{ std::cos(previous + phase), std::sin(previous + phase), 0.f };
+		glm::vec3 to{ std::cos(elapsed + phase), std::sin(elapsed + phase), 0.f };
+		dynamic[i]->move((to - from) * orbitRadius);
+	}
+}
+
+SceneGenerator::~SceneGenerator()
+{
+	for (GameObject* go : objects)
+	{
+		delete go;
+	}
+	objects.clear();
+}
+
+GameObject * SceneGenerator::createObject(uint32_t index, const glm::vec3 & position, const glm::vec3 & scale)
+{
+	uint32_t variant = index % numVariants;
+	PipelineType pipeline = params.pipelines[index % params.pipelines.size()];
+	const auto& texture = textures[(variant / numModels) % numTextures];
+	AssetId normalMap;
+	AssetId depthMap;
+	if (pipeline == PipelineType::eBumpMap || pipeline == PipelineType::eParallax)
+	{
+		normalMap = texture.normalMap;
+	}
+	if (pipeline == PipelineType::eParallax)
+	{
+		depthMap = texture.depthMap;
+	}
+	ObjectCreate create{ position, scale, 0.f, glm::vec3{ 0.f, 0.f, 1.f }, models[variant % numModels], texture.texture, normalMap, depthMap, pipeline, 0 };
+	GameObject* go = ObjectFactory::createGameObjectRotation(create);
+	objects.push_back(go);
+	return go;
+}
\ No newline at end of file
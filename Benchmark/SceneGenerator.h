@@ -0,0 +1,79 @@
+#pragma once
+#include<vector>
+#include<random>
+#include"Core\PipelineType.h"
+#include"Graphics\GameObject.h"
+
+class Scene;
+
+/**
+	SceneParams structure.
+	Contains parameters which describe a generated scene.
+*/
+struct SceneParams
+{
+	uint32_t numObjects;					//*< Number of drawable objects, billboards excluded.
+	std::vector<PipelineType> pipelines;	//*< Pipelines assigned to objects in round robin order.
+	uint32_t hierarchyDepth;				//*< Length of parent-child chains objects are grouped into. 1 means that every object is a root.
+	float shareRatio;						//*< Ratio of objects that reuse already used model and texture combination. 0 makes every object as unique as available assets allow.
+	uint32_t numBillboards;					//*< Number of billboards facing the camera.
+	uint32_t seed;							//*< Seed used for object placement.
+	uint32_t numOccluders;					//*< Number of walls placed between the camera and the objects and used as occluders.
+	uint32_t numDynamic;					//*< Number of root objects moved every frame. The rest of the scene is static.
+};
+
+/**
+	SceneGenerator class.
+	Generates a synthetic scene out of given parameters using ObjectFactory. Owns all generated objects.
+*/
+class SceneGenerator
+{
+public:
+	/**
+		Constructor.
+		@param params parameters of the scene to generate.
+	*/
+	SceneGenerator(const SceneParams& params);
+	SceneGenerator(SceneGenerator& x) = delete;
+	SceneGenerator& operator=(SceneGenerator& x) = delete;
+	/**
+		Creates objects and adds them to the scene.
+		@param scene scene to which the objects are added.
+	*/
+	void populate(Scene& scene);
+	/**
+		Returns the number of distinct model and texture combinations used by generated objects.
+		@return number of distinct combinations.
+	*/
+	uint32_t getNumVariants() const;
+	/**
+		Returns the number of generated objects including billboards.
+		@return number of objects.
+	*/
+	uint32_t getNumObjects() const;
+	/**
+		Moves dynamic objects. Objects orbit around their starting position.
+		@param time time passed since the last call.
+	*/
+	void animate(const double time);
+	/**
+		Destructor. Deletes all generated objects.
+	*/
+	~SceneGenerator();
+private:
+	/**
+		Creates a single drawable object.
+		@param index index of the object in the scene.
+		@param position position of the object.
+		@param scale scale of the object.
+		@return pointer to the created object.
+	*/
+	GameObject* createObject(uint32_t index, const glm::vec3& position, const glm::vec3& scale);
+
+	SceneParams params;					//*< Parameters of the generated scene.
+	uint32_t numVariants;				//*< Number of distinct model and texture combinations in use.
+	std::mt19937 random;				//*< Random generator used for object placement.
+	std::vector<GameObject*> objects;	//*< Array of all generated objects.
+	std::vector<GameObject*> dynamic;	//*< Array of objects moved by animate.
+	double elapsed{ 0 };				//*< Time passed since the first call to animate.
+};
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include<iostream>
+#include<fstream>
+#include<sstream>
+#include<string>
+#include<cstring>
+#include<algorithm>
+#include<vector>
+#include"Djinn.h"
+#include"Factories\SceneFactory.h"
+#include"SceneGenerator.h"
+#include"DebugTools\GpuProfiler.h"
+#include"DebugTools\Profiler.h"
+#ifdef _WIN32
+#include<windows.h>
+#include<psapi.h>
+#endif
+
+namespace
+{
+	const double frameTime = 1.0 / 60.0;	//*< Fixed time step by which dynamic objects are animated every frame, so runs are reproducible.
+
+	/**
+		BenchmarkOptions structure.
+		Contains options parsed from the command line.
+	*/
+	struct BenchmarkOptions
+	{
+		SceneParams scene{ 1000, { PipelineType::ePhong, PipelineType::eToon, PipelineType::eNoLight, PipelineType::eBumpMap }, 1, 0.9f, 0, 1, 0, 0 };	//*< Parameters of the generated scene.
+		uint32_t frames{ 1000 };		//*< Number of measured frames.
+		uint32_t warmup{ 100 };			//*< Number of frames rendered before measuring.
+		uint32_t width{ 800 };			//*< Width of the render target.
+		uint32_t height{ 600 };			//*< Height of the render target.
+		bool headless{ true };			//*< Flag determining if rendering is done offscreen.
+		bool occlusion{ true };			//*< Flag determining if occlusion culling is performed.
+		bool streaming{ false };		//*< Flag determining if textures are streamed.
+		const char* output{ nullptr };	//*< File to which the report is written. Report is written to standard output if not set.
+		const char* pack{ nullptr };	//*< Asset pack from which assets are read.
+		const char* trace{ nullptr };	//*< File to which the CPU trace of the run is written.
+		double spike{ 0 };				//*< Frame time in milliseconds after which the CPU trace is written. 0 turns it off.
+	};
+
+	/**
+		Parses a comma separated list of pipeline names.
+		@param list list of pipeline names.
+		@return array of pipeline types.
+	*/
+	std::vector<PipelineType> parsePipelines(const std::string& list)
+	{
+		const std::pair<const char*, PipelineType> names[] = {
+			{ "nolight", PipelineType::eNoLight }, { "phong", PipelineType::ePhong }, { "toon", PipelineType::eToon },
+			{ "wireframe", PipelineType::eWireframe }, { "bumpmap", PipelineType::eBumpMap }, { "parallax", PipelineType::eParallax } };
+		std::vector<PipelineType> pipelines;
+		std::stringstream stream{ list };
+		std::string name;
+		while (std::getline(stream, name, ','))
+		{
+			auto it = std::find_if(std::begin(names), std::end(names), [&name](const std::pair<const char*, PipelineType>& x) { return name == x.first; });
+			if (it == std::end(names))
+			{
+				throw std::runtime_error("unknown pipeline " + name);
+			}
+			pipelines.push_back(it->second);
+		}
+		return pipelines;
+	}
+
+	/**
+		Parses command line arguments.
+		@param argc number of arguments.
+		@param argv array of arguments.
+		@return parsed options.
+	*/
+	BenchmarkOptions parseOptions(int argc, char** argv)
+	{
+		BenchmarkOptions options;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--windowed")
+			{
+				options.headless = false;
+				continue;
+			}
+			if (arg == "--no-occlusion")
+			{
+				options.occlusion = false;
+				continue;
+			}
+			if (arg == "--streaming")
+			{
+				options.streaming = true;
+				continue;
+			}
+			if (i + 1 >= argc)
+			{
+				throw std::runtime_error("missing value for " + arg);
+			}
+			const char* value = argv[++i];
+			if (arg == "--objects") options.scene.numObjects = std::stoul(value);
+			else if (arg == "--pipelines") options.scene.pipelines = parsePipelines(value);
+			else if (arg == "--depth") options.scene.hierarchyDepth = std::max(1ul, std::stoul(value));
+			else if (arg == "--share") options.scene.shareRatio = std::min(1.f, std::max(0.f, std::stof(value)));
+			else if (arg == "--billboards") options.scene.numBillboards = std::stoul(value);
+			else if (arg == "--seed") options.scene.seed = std::stoul(value);
+			else if (arg == "--occluders") options.scene.numOccluders = std::stoul(value);
+			else if (arg == "--dynamic") options.scene.numDynamic = std::stoul(value);
+			else if (arg == "--frames") options.frames = std::max(1ul, std::stoul(value));
+			else if (arg == "--warmup") options.warmup = std::stoul(value);
+			else if (arg == "--width") options.width = std::stoul(value);
+			else if (arg == "--height") options.height = std::stoul(value);
+			else if (arg == "--output") options.output = value;
+			else if (arg == "--pack") options.pack = value;
+			else if (arg == "--trace") options.trace = value;
+			else if (arg == "--spike") options.spike = std::stod(value);
+			else throw std::runtime_error("unknown option " + arg);
+		}
+		return options;
+	}
+
+	/**
+		Returns peak resident memory of the process.
+		@return peak memory in bytes, 0 if it couldn't be determined.
+	*/
+	size_t getPeakMemory()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return counters.PeakWorkingSetSize;
+		}
+#else
+		std::ifstream status{ "/proc/self/status" };
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.compare(0, 6, "VmHWM:") == 0)
+			{
+				return std::stoull(line.substr(6)) * 1024;
+			}
+		}
+#endif
+		return 0;
+	}
+
+	/**
+		Returns a percentile of sorted values.
+		@param sorted values sorted in ascending order.
+		@param percentile percentile between 0 and 100.
+		@return value at the given percentile.
+	*/
+	double percentile(const std::vector<double>& sorted, double percentile)
+	{
+		size_t index = static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+
+	/**
+		Writes statistics of a series of timings as a JSON object.
+		@param out stream to which to write.
+		@param values timings in milliseconds.
+	*/
+	void writeStats(std::ostream& out, std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		double sum = 0;
+		for (double v : values)
+		{
+			sum += v;
+		}
+		out << "{ \"mean\": " << sum / values.size() << ", \"min\": " << values.front() << ", \"p50\": " << percentile(values, 50)
+			<< ", \"p90\": " << percentile(values, 90) << ", \"p95\": " << percentile(values, 95) << ", \"p99\": " << percentile(values, 99)
+			<< ", \"max\": " << values.back() << " }";
+	}
+
+	/**
+		Writes statistics of a resource manager as a JSON object.
+		@param out stream to which to write.
+		@param stats statistics of the manager.
+	*/
+	void writeResources(std::ostream& out, const ResourceStats& stats)
+	{
+		out << "{ \"hits\": " << stats.hits << ", \"misses\": " << stats.misses << ", \"evictions\": " << stats.evictions
+			<< ", \"resident_bytes\": " << stats.residentBytes << " }";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		BenchmarkOptions options = parseOptions(argc, argv);
+		Djinn djinn;
+		// shaders are read during initialization, so the pack is mounted before it
+		if (options.pack != nullptr && !djinn.mountPack(options.pack))
+		{
+			throw std::runtime_error(std::string("failed to mount ") + options.pack);
+		}
+		djinn.initialize("Benchmark", options.width, options.height, options.headless);
+		djinn.setTextureStreaming(options.streaming);
+		size_t initMemory = getPeakMemory();
+		{
+			// the generator owns the objects, so it is declared first to destroy them after the scene releases them
+			SceneGenerator generator{ options.scene };
+			Scene scene = SceneFactory::createScene(SceneCreate{ 45.f, 0.1f, 50.f, glm::vec3{ 0.0, 0.0, 1.0 }, glm::vec3{ 0.0, 0.0, -1.0 } });
+			scene.addLight(glm::vec3{ 5.0, 0.0, 5.0 });
+			scene.setOcclusionCulling(options.occlusion);
+			generator.populate(scene);
+			djinn.setScene(&scene);
+			size_t sceneMemory = getPeakMemory();
+
+			for (uint32_t i = 0; i < options.warmup; i++)
+			{
+				generator.animate(frameTime);
+				djinn.runFrame();
+			}
+			if (options.trace != nullptr)
+			{
+				PROFILE_SPIKE_TRACE(options.spike, options.trace)
+			}
+			std::vector<double> total, update, record, submit, frustumCulled, occlusionCulled;
+			for (uint32_t i = 0; i < options.frames; i++)
+			{
+				generator.animate(frameTime);
+				FrameStats stats = djinn.runFrame();
+				total.push_back(stats.total);
+				update.push_back(stats.update);
+				record.push_back(stats.record);
+				submit.push_back(stats.submit);
+				frustumCulled.push_back(scene.getCullingStats().frustumCulled);
+				occlusionCulled.push_back(scene.getCullingStats().occlusionCulled);
+				PROFILE_FRAME(stats.total)
+			}
+			// with spike detection the trace contains the last spike instead of the end of the run.
+			if (options.trace != nullptr && options.spike == 0)
+			{
+				PROFILE_DUMP(options.trace)
+			}
+
+			std::ofstream file;
+			if (options.output != nullptr)
+			{
+				file.open(options.output);
+				if (!file.is_open())
+				{
+					throw std::runtime_error(std::string("failed to open ") + options.output);
+				}
+			}
+			std::ostream& out = options.output != nullptr ? file : std::cout;
+			out << "{\n";
+			out << "  \"scene\": { \"objects\": " << options.scene.numObjects << ", \"pipelines\": " << options.scene.pipelines.size()
+				<< ", \"depth\": " << options.scene.hierarchyDepth << ", \"share\": " << options.scene.shareRatio
+				<< ", \"variants\": " << generator.getNumVariants() << ", \"billboards\": " << options.scene.numBillboards
+				<< ", \"seed\": " << options.scene.seed << ", \"occluders\": " << options.scene.numOccluders
+				<< ", \"dynamic\": " << options.scene.numDynamic << " },\n";
+			out << "  \"frames\": " << options.frames << ",\n";
+			out << "  \"warmup\": " << options.warmup << ",\n";
+			out << "  \"headless\": " << (options.headless ? "true" : "false") << ",\n";
+			out << "  \"resolution\": [" << options.width << ", " << options.height << "],\n";
+			out << "  \"frame_ms\": "; writeStats(out, total); out << ",\n";
+			out << "  \"update_ms\": "; writeStats(out, update); out << ",\n";
+			out << "  \"record_ms\": "; writeStats(out, record); out << ",\n";
+			out << "  \"submit_ms\": "; writeStats(out, submit); out << ",\n";
+			const CullingStats& culling = scene.getCullingStats();
+			out << "  \"culling\": { \"occlusion\": " << (options.occlusion ? "true" : "false") << ", \"tested\": " << culling.tested
+				<< ", \"occluder_triangles\": " << culling.occluderTriangles << ", \"frustum_culled\": "; writeStats(out, frustumCulled);
+			out << ", \"occlusion_culled\": "; writeStats(out, occlusionCulled);
+			out << ", \"index_height\": " << scene.getSpatialIndexHeight() << ", \"triangles\": " << culling.triangles << ", \"lods\": [";
+			for (uint32_t i = 0; i < maxLodStats; i++)
+			{
+				out << (i == 0 ? "" : ", ") << culling.lods[i];
+			}
+			out << "] },\n";
+			MeshStats mesh = djinn.getMeshStats();
+			out << "  \"mesh\": { \"models\": " << mesh.models << ", \"cached\": " << mesh.cached << ", \"acmr_before\": " << mesh.getAcmrBefore()
+				<< ", \"acmr_after\": " << mesh.getAcmrAfter() << ", \"atvr_before\": " << mesh.getAtvrBefore() << ", \"atvr_after\": " << mesh.getAtvrAfter() << " },\n";
+			out << "  \"resources\": { \"textures\": "; writeResources(out, djinn.getTextureStats());
+			out << ", \"models\": "; writeResources(out, djinn.getModelStats()); out << " },\n";
+			out << "  \"gpu_ms\": {";
+			std::vector<GpuTiming> timings = djinn.getGpuTimings();
+			for (size_t i = 0; i < timings.size(); i++)
+			{
+				out << (i == 0 ? " " : ", ") << "\"" << timings[i].name << "\": { \"last\": " << timings[i].last << ", \"average\": " << timings[i].average << " }";
+			}
+			out << " },\n";
+			out << "  \"memory\": { \"after_init\": " << initMemory << ", \"after_scene\": " << sceneMemory << ", \"peak\": " << getPeakMemory() << " }\n";
+			out << "}" << std::endl;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include"vulkan\vulkan.hpp"
+#include<mutex>
 
 /**
 	Dynamic buffer class
@@ -51,6 +52,7 @@ private:
 	const vk::Device* device;						//*< Pointer to a logic device used to create a buffer.
 	const vk::CommandPool* pool;					//*< Pointer to a command pool.
 	const vk::Queue* queue;							//*< Pointer to a gpu queue.
+	std::mutex* queueMutex;							//*< Pointer to a mutex guarding the pool and the queue.
 	vk::Buffer uniformStagingBuffer;				//*< Handle of a buffer used for staging.
 	vk::DeviceMemory uniformStagingBufferMemory;	//*< Handle of a memory used for staging.
 	vk::Buffer uniformBuffer;						//*< Buffer's handle.
@@ -68,6 +70,7 @@ inline DynamicBuffer<T>::DynamicBuffer(DynamicBuffer && x)
 	device = x.device;
 	pool = x.pool;
 	queue = x.queue;
+	queueMutex = x.queueMutex;
 	uniformStagingBuffer = x.uniformStagingBuffer;
 	uniformStagingBufferMemory = x.uniformStagingBufferMemory;
 	uniformBuffer = x.uniformBuffer;
@@ -76,6 +79,7 @@ inline DynamicBuffer<T>::DynamicBuffer(DynamicBuffer && x)
 	x.device = nullptr;
 	x.pool = nullptr;
 	x.queue = nullptr;
+	x.queueMutex = nullptr;
 	x.uniformStagingBuffer = vk::Buffer();
 	x.uniformStagingBufferMemory = vk::DeviceMemory();
 	x.uniformBuffer = vk::Buffer();
@@ -91,6 +95,7 @@ inline DynamicBuffer<T>& DynamicBuffer<T>::operator=(DynamicBuffer && x)
 		device = x.device;
 		pool = x.pool;
 		queue = x.queue;
+		queueMutex = x.queueMutex;
 		uniformStagingBuffer = x.uniformStagingBuffer;
 		uniformStagingBufferMemory = x.uniformStagingBufferMemory;
 		uniformBuffer = x.uniformBuffer;
@@ -99,6 +104,7 @@ inline DynamicBuffer<T>& DynamicBuffer<T>::operator=(DynamicBuffer && x)
 		x.device = nullptr;
 		x.pool = nullptr;
 		x.queue = nullptr;
+		x.queueMutex = nullptr;
 		x.uniformStagingBuffer = vk::Buffer();
 		x.uniformStagingBufferMemory = vk::DeviceMemory();
 		x.uniformBuffer = vk::Buffer();
@@ -118,6 +124,7 @@ inline void DynamicBuffer<T>::updateBuffer(const T& newData)
 	device->unmapMemory(uniformStagingBufferMemory);
 
 	//allocate command buffer
+	std::lock_guard<std::mutex> lock{ *queueMutex };
 	vk::CommandBufferAllocateInfo allocInfo{ *pool, vk::CommandBufferLevel::ePrimary, 1 };
 	vk::CommandBuffer commandBuffer = device->allocateCommandBuffers(allocInfo)[0];
 	vk::CommandBufferBeginInfo beginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit };
@@ -0,0 +1,120 @@
+#include "GpuScene.h"
+
+GpuScene::GpuScene(GpuScene && x) : device{ x.device }, objectBuffer{ x.objectBuffer }, objectMemory{ x.objectMemory }, objects{ x.objects },
+									transformBuffer{ x.transformBuffer }, transformMemory{ x.transformMemory }, transforms{ x.transforms },
+									commandBuffer{ x.commandBuffer }, commandMemory{ x.commandMemory }, countBuffer{ x.countBuffer }, countMemory{ x.countMemory },
+									capacity{ x.capacity }, objectCount{ x.objectCount }, cameraBuffer{ x.cameraBuffer },
+									cullSet{ std::move(x.cullSet) }, drawSet{ std::move(x.drawSet) }, batches{ std::move(x.batches) }
+{
+	x.device = nullptr;
+	x.objectBuffer = vk::Buffer();
+	x.objectMemory = vk::DeviceMemory();
+	x.objects = nullptr;
+	x.transformBuffer = vk::Buffer();
+	x.transformMemory = vk::DeviceMemory();
+	x.transforms = nullptr;
+	x.commandBuffer = vk::Buffer();
+	x.commandMemory = vk::DeviceMemory();
+	x.countBuffer = vk::Buffer();
+	x.countMemory = vk::DeviceMemory();
+	x.capacity = 0;
+	x.objectCount = 0;
+	x.cameraBuffer = vk::Buffer();
+}
+
+GpuScene & GpuScene::operator=(GpuScene && x)
+{
+	if (this != &x)
+	{
+		clear();
+		device = x.device;
+		objectBuffer = x.objectBuffer;
+		objectMemory = x.objectMemory;
+		objects = x.objects;
+		transformBuffer = x.transformBuffer;
+		transformMemory = x.transformMemory;
+		transforms = x.transforms;
+		commandBuffer = x.commandBuffer;
+		commandMemory = x.commandMemory;
+		countBuffer = x.countBuffer;
+		countMemory = x.countMemory;
+		capacity = x.capacity;
+		objectCount = x.objectCount;
+		cameraBuffer = x.cameraBuffer;
+		cullSet = std::move(x.cullSet);
+		drawSet = std::move(x.drawSet);
+		batches = std::move(x.batches);
+
+		x.device = nullptr;
+		x.objectBuffer = vk::Buffer();
+		x.objectMemory = vk::DeviceMemory();
+		x.objects = nullptr;
+		x.transformBuffer = vk::Buffer();
+		x.transformMemory = vk::DeviceMemory();
+		x.transforms = nullptr;
+		x.commandBuffer = vk::Buffer();
+		x.commandMemory = vk::DeviceMemory();
+		x.countBuffer = vk::Buffer();
+		x.countMemory = vk::DeviceMemory();
+		x.capacity = 0;
+		x.objectCount = 0;
+		x.cameraBuffer = vk::Buffer();
+	}
+	return *this;
+}
+
+uint32_t GpuScene::getObjectCount() const
+{
+	return objectCount;
+}
+
+const std::vector<DrawBatch>& GpuScene::getBatches() const
+{
+	return batches;
+}
+
+GpuScene::~GpuScene()
+{
+	clear();
+}
+
+void GpuScene::clear()
+{
+	if (device == nullptr)
+	{
+		return;
+	}
+	if (objects != nullptr)
+	{
+		device->unmapMemory(objectMemory);
+		objects = nullptr;
+	}
+	if (transforms != nullptr)
+	{
+		device->unmapMemory(transformMemory);
+		transforms = nullptr;
+	}
+	vk::Buffer buffers[] = { objectBuffer, transformBuffer, commandBuffer, countBuffer };
+	vk::DeviceMemory memories[] = { objectMemory, transformMemory, commandMemory, countMemory };
+	for (int i = 0; i < 4; i++)
+	{
+		if (buffers[i])
+		{
+			device->destroyBuffer(buffers[i]);
+		}
+		if (memories[i])
+		{
+			device->freeMemory(memories[i]);
+		}
+	}
+	objectBuffer = vk::Buffer();
+	objectMemory = vk::DeviceMemory();
+	transformBuffer = vk::Buffer();
+	transformMemory = vk::DeviceMemory();
+	commandBuffer = vk::Buffer();
+	commandMemory = vk::DeviceMemory();
+	countBuffer = vk::Buffer();
+	countMemory = vk::DeviceMemory();
+	capacity = 0;
+	objectCount = 0;
+}
\ No newline at end of file
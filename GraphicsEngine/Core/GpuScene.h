@@ -0,0 +1,107 @@
+#pragma once
+#include<vulkan\vulkan.hpp>
+#include<glm\glm.hpp>
+#include<list>
+#include<memory>
+#include<vector>
+#include"DescriptorSet.h"
+#include"PipelineType.h"
+
+class GraphicsComponent;
+
+/**
+	Per object data read by the culling shader. Layout needs to match ObjectData in shaders/cull.comp.
+*/
+struct GpuObject
+{
+	/**
+		Flags describing how the object is culled.
+	*/
+	enum Flags
+	{
+		eHidden = 1,	//*< Object is not drawn.
+		eNoCull = 2		//*< Object is drawn without being tested against the frustum.
+	};
+	glm::vec4 bounds;		//*< Bounding sphere of the object's model in model space stored as (center, radius).
+	uint32_t firstIndex;	//*< First index of the object's mesh in the arena.
+	uint32_t indexCount;	//*< Number of indices of the object's mesh.
+	int32_t vertexOffset;	//*< Offset of the object's first vertex in the arena.
+	uint32_t batch;			//*< Index of the batch in which the object is drawn.
+	uint32_t batchFirst;	//*< Index of the first draw command of the batch.
+	uint32_t flags;			//*< Combination of Flags.
+	uint32_t padding[2];	//*< Padding to a multiple of 16 bytes.
+};
+
+/**
+	Consecutive components drawn with the same pipeline, material and mesh arena.
+	Indirect batches are drawn with a single indirect draw call while other batches draw component by component.
+*/
+struct DrawBatch
+{
+	PipelineType type;															//*< Pipeline used to draw the batch.
+	std::list<std::shared_ptr<GraphicsComponent>>::const_iterator begin;		//*< First component in the batch.
+	std::list<std::shared_ptr<GraphicsComponent>>::const_iterator end;			//*< Component after the last one in the batch.
+	uint32_t firstDraw;															//*< Index of the first draw command of the batch.
+	uint32_t drawCount;															//*< Number of components in the batch.
+	bool indirect;																//*< True if the batch is drawn with an indirect draw call.
+};
+
+/**
+	GPU side representation of a scene used for GPU culling and indirect drawing.
+	Holds per object data, transformations and draw commands for every component in the scene.
+*/
+class GpuScene
+{
+public:
+	/**
+		Constructor.
+	*/
+	GpuScene() {}
+	GpuScene(const GpuScene& x) = delete;
+	/**
+		Move constructor.
+	*/
+	GpuScene(GpuScene&& x);
+	GpuScene& operator=(const GpuScene& x) = delete;
+	/**
+		Move assignment operator.
+	*/
+	GpuScene& operator=(GpuScene&& x);
+	/**
+		Returns the number of objects uploaded for the last update.
+		@return number of objects.
+	*/
+	uint32_t getObjectCount() const;
+	/**
+		Returns the batches into which scene's components were split on the last update.
+		@return vector of batches.
+	*/
+	const std::vector<DrawBatch>& getBatches() const;
+	/**
+		Destructor.
+	*/
+	~GpuScene();
+	friend class VulkanEngine;
+private:
+	/**
+		Destroys all buffers.
+	*/
+	void clear();
+	const vk::Device* device{ nullptr };		//*< Pointer to a logic device used to create the buffers.
+	vk::Buffer objectBuffer;					//*< Buffer holding GpuObject for every object.
+	vk::DeviceMemory objectMemory;				//*< Memory bound to the object buffer.
+	GpuObject* objects{ nullptr };				//*< Persistently mapped object buffer.
+	vk::Buffer transformBuffer;					//*< Buffer holding model transformation of every object.
+	vk::DeviceMemory transformMemory;			//*< Memory bound to the transformation buffer.
+	glm::mat4* transforms{ nullptr };			//*< Persistently mapped transformation buffer.
+	vk::Buffer commandBuffer;					//*< Buffer holding indirect draw commands written by the culling shader.
+	vk::DeviceMemory commandMemory;				//*< Memory bound to the command buffer.
+	vk::Buffer countBuffer;						//*< Buffer holding number of visible objects of every batch.
+	vk::DeviceMemory countMemory;				//*< Memory bound to the count buffer.
+	uint32_t capacity{ 0 };						//*< Number of objects the buffers can hold.
+	uint32_t objectCount{ 0 };					//*< Number of objects written on the last update.
+	vk::Buffer cameraBuffer;					//*< Scene's projection-view uniform buffer out of which the culling shader extracts the frustum. Not owned.
+	DescriptorSet cullSet;						//*< Descriptor set used by the culling shader.
+	DescriptorSet drawSet;						//*< Descriptor set with object transformations used by indirect pipelines.
+	std::vector<DrawBatch> batches;				//*< Batches the scene is drawn with.
+};
\ No newline at end of file
@@ -3,12 +3,19 @@
 #include<vector>
 #include"GLFW\glfw3.h"
 #include<memory>
+#include"..\ResourceManagers\AssetId.h"
 
 class VTexture;
 class IndexBuffer;
 class VertexBuffer;
+class MeshArena;
+struct MeshRange;
 struct GlobalBuffers;
+struct GpuTiming;
+struct MeshStats;
+struct ResourceStats;
 class GraphicsComponent;
+class PipelineVariant;
 enum class PipelineType;
 enum class ModelType;
 
@@ -44,6 +51,32 @@ public:
 		@return IndexBuffer object created with given parameters.
 	*/
 	virtual IndexBuffer createIndexBuffer(const std::vector<uint32_t>& indices, bool useStaging = true) const = 0;
+	/**
+		Creates an index buffer with 16-bit indices.
+		@param indices vector of indices.
+		@param useStaging flag used to determine if we should try to enhance performane in creation of the buffer or not.
+		@return IndexBuffer object created with given parameters.
+	*/
+	virtual IndexBuffer createIndexBuffer(const std::vector<uint16_t>& indices, bool useStaging = true) const = 0;
+	/**
+		Creates an empty mesh arena. Arena stores vertices and indices of many meshes with the same vertex layout in shared buffers.
+		@param vertexStride size of a single vertex in bytes.
+		@param vertexCapacity number of vertices for which the space is initially reserved.
+		@param indexCapacity number of indices for which the space is initially reserved.
+		@param indexSize size of a single index in bytes, either 2 or 4.
+		@return created mesh arena.
+	*/
+	virtual MeshArena createMeshArena(uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t indexSize = sizeof(uint32_t)) const = 0;
+	/**
+		Uploads a mesh into the arena. Arena's buffers are grown if there is not enough space left in them.
+		@param arena arena in which to store the mesh.
+		@param vertices pointer to an array of vertices in the arena's vertex layout.
+		@param vertexCount number of vertices in the array.
+		@param indices pointer to an array of indices of the arena's index size, relative to the first vertex of the mesh.
+		@param indexCount number of indices in the array.
+		@return location of the mesh inside of the arena.
+	*/
+	virtual MeshRange allocateMesh(MeshArena& arena, const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount) const = 0;
 	/**
 		Creates a texture used by GPU.
 		@param pixels pointer to an array of pixels. Data needs to be in 4 channel format.
@@ -53,48 +86,109 @@ public:
 		@return VTexture object containing created texture stored in the GPU.
 	*/
 	virtual VTexture createTexture(unsigned char* pixels, unsigned int width, unsigned int height, bool useStaging = true) const = 0;
+	/**
+		Creates a texture with a chain of mip levels used by GPU.
+		@param levels pointer to 4 channel pixels of all mip levels, tightly packed one after another from the coarsest to the finest level.
+		@param width width of the finest level.
+		@param height height of the finest level.
+		@param mipLevels number of mip levels, each one half the size of the previous one and at least one pixel large.
+		@return VTexture object containing created texture stored in the GPU.
+	*/
+	virtual VTexture createMipmappedTexture(const unsigned char* levels, uint32_t width, uint32_t height, uint32_t mipLevels) const = 0;
 	/**
 		Returns a pointer to the window in which we draw scenes.
 		@return pointer to the currently used window.
 	*/
 	virtual GLFWwindow* getWindow() const = 0;
+	/**
+		Checks if the engine renders to offscreen images instead of a window.
+		@return true if engine is headless, false otherwise.
+	*/
+	virtual bool isHeadless() const = 0;
+	/**
+		Reads back the last rendered frame.
+		@return pixels of the frame in tightly packed 4 channel RGBA format, row by row starting from the top.
+	*/
+	virtual std::vector<unsigned char> readFrame() const = 0;
+	/**
+		Saves the last rendered frame to a PNG file.
+		@param filename name of the file in which to store the frame.
+	*/
+	virtual void saveFrame(const char* filename) const = 0;
+	/**
+		Returns rolling averages of GPU time spent in measured regions of a frame.
+		@return array of timings.
+	*/
+	virtual std::vector<GpuTiming> getGpuTimings() const = 0;
+	/**
+		Returns statistics of the vertex cache optimisation of loaded models.
+		@return mesh statistics.
+	*/
+	virtual MeshStats getMeshStats() const = 0;
+	/**
+		Returns statistics of the texture manager.
+		@return texture statistics.
+	*/
+	virtual ResourceStats getTextureStats() const = 0;
+	/**
+		Returns statistics of the model manager.
+		@return model statistics.
+	*/
+	virtual ResourceStats getModelStats() const = 0;
+	/**
+		Sets GPU memory budgets of loaded textures and models. Least recently used resources no component uses are released to stay within them.
+		@param textureBytes budget of textures in bytes.
+		@param modelBytes budget of models in bytes.
+	*/
+	virtual void setResourceBudgets(uint64_t textureBytes, uint64_t modelBytes) = 0;
+	/**
+		Sets whether textures loaded from now on are streamed, starting with their coarsest mip levels and loading finer ones as objects using them get closer.
+		@param streaming true to stream textures, false to load them whole.
+	*/
+	virtual void setTextureStreaming(bool streaming) = 0;
+	/**
+		Sets whether textures, models and shaders are reloaded when their files change. Changed files are re-imported in the background
+		and replace loaded resources between frames, so components using them keep working without being recreated.
+		@param enabled true to watch asset directories, false to stop watching them.
+	*/
+	virtual void setHotReload(bool enabled) = 0;
 	/**
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
 		Uniqueness of the id needs to be handeled externally, otherwise problems may arrise if there happen to be components with same ids.
-		@param model filename of the model used.
-		@param texFilename filename of the texture used.
+		@param model id or filename of the model used.
+		@param texFilename id or filename of the texture used.
 		@param pipeline enumerator which determines how we want to draw the object.
 		@param layer layer to which the object is assigned.
 		@param loadType type of the model we want to use.
 		@return shared pointer to the component created with given parameters.
 	*/
-	virtual std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const char * model, const char * texFilename, PipelineType pipeline, int layer, ModelType loadType) = 0;
+	virtual std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, PipelineType pipeline, int layer, ModelType loadType) = 0;
 	/**
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
 		Uniqueness of the id needs to be handeled externally, otherwise problems may arrise if there happen to be components with same ids.
-		@param model filename of the model used.
-		@param texFilename filename of the texture used.
-		@param normalMap filename of the normal map used.
+		@param model id or filename of the model used.
+		@param texFilename id or filename of the texture used.
+		@param normalMap id or filename of the normal map used.
 		@param pipeline enumerator which determines how we want to draw the object.
 		@param layer layer to which the object is assigned.
 		@return shared pointer to the component created with given parameters.
 	*/
-	virtual std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const char * model, const char * texFilename, const char* normalMap, PipelineType pipeline, int layer) = 0;
+	virtual std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, const AssetId& normalMap, PipelineType pipeline, int layer) = 0;
 	/**
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
 		Uniqueness of the id needs to be handeled externally, otherwise problems may arrise if there happen to be components with same ids.
-		@param model filename of the model used.
-		@param texFilename filename of the texture used.
-		@param normalMap filename of the normal map used.
-		@param depthMap filename of the depth map used.
+		@param model id or filename of the model used.
+		@param texFilename id or filename of the texture used.
+		@param normalMap id or filename of the normal map used.
+		@param depthMap id or filename of the depth map used.
 		@param pipeline enumerator which determines how we want to draw the object.
 		@param layer layer to which the object is assigned.
 		@return shared pointer to the component created with given parameters.
 	*/
-	virtual std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const char * model, const char * texFilename, const char* normalMap, const char* depthMap, PipelineType pipeline, int layer) = 0;
+	virtual std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, const AssetId& normalMap, const AssetId& depthMap, PipelineType pipeline, int layer) = 0;
 	/**
 		Signals the engine to update all internal data related to the given scene so it can be drawn.
 		Doesn't need to be called every frame, it can be called when a change occurs.
@@ -117,6 +211,12 @@ public:
 		@param id id of the scene we want to deregister.
 	*/
 	virtual void deRegisterScene(int id) = 0;
+	/**
+		Sets the variant of a pipeline used to draw a scene. All components of the scene drawn with the variant's pipeline type use the variant.
+		@param sceneId id of the scene.
+		@param variant variant of a pipeline type, a variant without constants restores the base pipeline.
+	*/
+	virtual void setPipelineVariant(int sceneId, const PipelineVariant& variant) = 0;
 	/**
 		Attaches an object to the scene.
 		@param sceneId id of the scene to which we want to attach the object.
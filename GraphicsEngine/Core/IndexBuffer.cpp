@@ -1,11 +1,12 @@
 #include"IndexBuffer.h"
 
-IndexBuffer::IndexBuffer(IndexBuffer && x) : StaticBuffer(std::move(x)), numIndices{ x.numIndices } {}
+IndexBuffer::IndexBuffer(IndexBuffer && x) : StaticBuffer(std::move(x)), numIndices{ x.numIndices }, indexType{ x.indexType } {}
 
 IndexBuffer & IndexBuffer::operator=(IndexBuffer&& x)
 {
 	StaticBuffer::operator=(std::move(x));
 	numIndices = x.numIndices;
+	indexType = x.indexType;
 	x.numIndices = 0;
 	return *this;
 }
@@ -15,7 +16,17 @@ uint32_t IndexBuffer::getIndicesCount() const
 	return numIndices;
 }
 
+vk::IndexType IndexBuffer::getIndexType() const
+{
+	return indexType;
+}
+
+uint32_t IndexBuffer::getIndexSize() const
+{
+	return indexType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
 void IndexBuffer::bind(const vk::CommandBuffer& buffer, const uint32_t bindingPoint) const
 {
-	buffer.bindIndexBuffer(this->buffer, 0, vk::IndexType::eUint32);
+	buffer.bindIndexBuffer(this->buffer, 0, indexType);
 }
\ No newline at end of file
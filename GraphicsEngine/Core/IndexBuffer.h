@@ -27,6 +27,16 @@ public:
 		@return  number of indices.
 	*/
 	uint32_t getIndicesCount() const;
+	/**
+		Returns the type of indices stored in the buffer.
+		@return index type.
+	*/
+	vk::IndexType getIndexType() const;
+	/**
+		Returns the size of a single index stored in the buffer.
+		@return size of an index in bytes.
+	*/
+	uint32_t getIndexSize() const;
 	/**
 		Binds a buffer to a binding point using commmand buffer.
 		@param buffer command buffer used to bind static buffer.
@@ -39,5 +49,6 @@ public:
 	~IndexBuffer() {}
 	friend class VulkanBase;
 protected:
-	uint32_t numIndices;	//*< Number of indices stored in the buffer.
+	uint32_t numIndices;								//*< Number of indices stored in the buffer.
+	vk::IndexType indexType{ vk::IndexType::eUint32 };	//*< Type of indices stored in the buffer.
 };
\ No newline at end of file
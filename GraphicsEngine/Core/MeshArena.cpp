@@ -0,0 +1,110 @@
+#include "MeshArena.h"
+#include<algorithm>
+
+MeshArena::MeshArena(MeshArena && x) : vertices{ std::move(x.vertices) }, indices{ std::move(x.indices) }, vertexStride{ x.vertexStride },
+										vertexCapacity{ x.vertexCapacity }, vertexCount{ x.vertexCount }, indexCapacity{ x.indexCapacity }, indexCount{ x.indexCount },
+										freeVertices{ std::move(x.freeVertices) }, freeIndices{ std::move(x.freeIndices) }
+{
+	x.vertexCapacity = 0;
+	x.vertexCount = 0;
+	x.indexCapacity = 0;
+	x.indexCount = 0;
+}
+
+MeshArena & MeshArena::operator=(MeshArena && x)
+{
+	if (this != &x)
+	{
+		vertices = std::move(x.vertices);
+		indices = std::move(x.indices);
+		vertexStride = x.vertexStride;
+		vertexCapacity = x.vertexCapacity;
+		vertexCount = x.vertexCount;
+		indexCapacity = x.indexCapacity;
+		indexCount = x.indexCount;
+		freeVertices = std::move(x.freeVertices);
+		freeIndices = std::move(x.freeIndices);
+
+		x.vertexCapacity = 0;
+		x.vertexCount = 0;
+		x.indexCapacity = 0;
+		x.indexCount = 0;
+	}
+	return *this;
+}
+
+void MeshArena::bind(const vk::CommandBuffer & buffer) const
+{
+	vertices.bind(buffer, 0);
+	indices.bind(buffer, 0);
+}
+
+uint32_t MeshArena::getVertexStride() const
+{
+	return vertexStride;
+}
+
+uint32_t MeshArena::getVertexCount() const
+{
+	return vertexCount;
+}
+
+uint32_t MeshArena::getIndexCount() const
+{
+	return indexCount;
+}
+
+uint32_t MeshArena::getIndexSize() const
+{
+	return indices.getIndexSize();
+}
+
+void MeshArena::free(const MeshRange & range)
+{
+	release(freeVertices, static_cast<uint32_t>(range.vertexOffset), range.vertexCount);
+	release(freeIndices, range.firstIndex, range.indexCount);
+}
+
+void MeshArena::release(FreeList & list, uint32_t first, uint32_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	FreeList::iterator it = std::lower_bound(list.begin(), list.end(), std::make_pair(first, 0u));
+	//merge with the following range, then with the preceding one.
+	if (it != list.end() && first + count == it->first)
+	{
+		count += it->second;
+		it = list.erase(it);
+	}
+	if (it != list.begin() && (it - 1)->first + (it - 1)->second == first)
+	{
+		(it - 1)->second += count;
+		return;
+	}
+	list.insert(it, std::make_pair(first, count));
+}
+
+bool MeshArena::take(FreeList & list, uint32_t count, uint32_t & first)
+{
+	if (count == 0)
+	{
+		return false;
+	}
+	for (FreeList::iterator it = list.begin(); it != list.end(); it++)
+	{
+		if (it->second >= count)
+		{
+			first = it->first;
+			it->first += count;
+			it->second -= count;
+			if (it->second == 0)
+			{
+				list.erase(it);
+			}
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
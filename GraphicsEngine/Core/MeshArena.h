@@ -0,0 +1,105 @@
+#pragma once
+#include"VertexBuffer.h"
+#include"IndexBuffer.h"
+#include<vector>
+#include<utility>
+
+/**
+	MeshRange structure.
+	Describes where a mesh is stored inside of a mesh arena.
+*/
+struct MeshRange
+{
+	uint32_t firstIndex;	//*< Index of the first index of the mesh in the arena's index buffer.
+	uint32_t indexCount;	//*< Number of indices of the mesh.
+	int32_t vertexOffset;	//*< Index of the first vertex of the mesh in the arena's vertex buffer. Added to each index when drawing.
+	uint32_t vertexCount;	//*< Number of vertices of the mesh.
+};
+
+/**
+	Mesh arena class.
+	Holds vertices and indices of many meshes with the same vertex layout in one shared vertex and index buffer,
+	so buffers are bound once for all of those meshes and each mesh is drawn with offsets into them.
+	Meshes are allocated linearly and the buffers grow when they run out of space. Space of freed meshes is reused by later meshes which fit into it.
+*/
+class MeshArena
+{
+public:
+	/**
+		Constructor.
+	*/
+	MeshArena() {}
+	MeshArena(MeshArena& x) = delete;
+	/**
+		Move constructor.
+	*/
+	MeshArena(MeshArena&& x);
+	MeshArena& operator=(MeshArena& x) = delete;
+	/**
+		Move assignment operator.
+	*/
+	MeshArena& operator=(MeshArena&& x);
+	/**
+		Binds arena's vertex buffer to binding point 0 and its index buffer.
+		@param buffer command buffer used to bind the arena.
+	*/
+	void bind(const vk::CommandBuffer& buffer) const;
+	/**
+		Returns the size of a single vertex stored in the arena.
+		@return size of a vertex in bytes.
+	*/
+	uint32_t getVertexStride() const;
+	/**
+		Returns the number of vertices stored in the arena.
+		@return number of vertices.
+	*/
+	uint32_t getVertexCount() const;
+	/**
+		Returns the number of indices stored in the arena.
+		@return number of indices.
+	*/
+	uint32_t getIndexCount() const;
+	/**
+		Returns the size of a single index stored in the arena.
+		@return size of an index in bytes.
+	*/
+	uint32_t getIndexSize() const;
+	/**
+		Marks the space of a mesh as unused, so it can be reused by meshes allocated later.
+		The mesh must not be drawn after this call, including by command buffers which were already recorded.
+		@param range location of the whole mesh inside of the arena, as returned when it was allocated.
+	*/
+	void free(const MeshRange& range);
+	/**
+		Destructor.
+	*/
+	~MeshArena() {}
+	friend class VulkanBase;
+private:
+	typedef std::vector<std::pair<uint32_t, uint32_t>> FreeList;
+	/**
+		Adds a range to a list of unused ranges, merging it with its neighbours.
+		@param list list of unused ranges sorted by their start.
+		@param first start of the added range.
+		@param count length of the added range.
+	*/
+	static void release(FreeList& list, uint32_t first, uint32_t count);
+	/**
+		Takes space from the first unused range which is large enough.
+		@param list list of unused ranges sorted by their start.
+		@param count length of the space needed.
+		@param first set to the start of the space taken.
+		@return true if the space was found, false otherwise.
+	*/
+	static bool take(FreeList& list, uint32_t count, uint32_t& first);
+
+	VertexBuffer vertices;			//*< Buffer holding vertices of all meshes.
+	IndexBuffer indices;			//*< Buffer holding indices of all meshes.
+	uint32_t vertexStride{ 0 };		//*< Size of a single vertex in bytes.
+	uint32_t vertexCapacity{ 0 };	//*< Number of vertices which fit in the vertex buffer.
+	uint32_t vertexCount{ 0 };		//*< Number of vertices stored in the vertex buffer.
+	uint32_t indexCapacity{ 0 };	//*< Number of indices which fit in the index buffer.
+	uint32_t indexCount{ 0 };		//*< Number of indices stored in the index buffer.
+	FreeList freeVertices;			//*< Unused ranges of the vertex buffer left by freed meshes, as their first vertex and number of vertices.
+	FreeList freeIndices;			//*< Unused ranges of the index buffer left by freed meshes, as their first index and number of indices.
+};
\ No newline at end of file
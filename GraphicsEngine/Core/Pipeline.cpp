@@ -1,16 +1,17 @@
 #include "Pipeline.h"
 #include "..\DebugTools\Assert.h"
 
-PipelineLayout::PipelineLayout() : device{ nullptr }, handle { vk::PipelineLayout() }, globalSet{ nullptr }, localSet{ nullptr } {}
+PipelineLayout::PipelineLayout() : device{ nullptr }, handle { vk::PipelineLayout() } {}
 
-PipelineLayout::PipelineLayout(vk::Device* device, vk::PipelineLayout layout, vk::DescriptorSetLayout* global, vk::DescriptorSetLayout* local) : device{ device }, handle { layout }, globalSet{ global }, localSet{ local } {}
+PipelineLayout::PipelineLayout(vk::Device* device, vk::PipelineLayout layout, const std::vector<vk::DescriptorSetLayout*>& sets, const std::vector<vk::PushConstantRange>& pushConstants) :
+	device{ device }, handle { layout }, sets{ sets }, pushConstants{ pushConstants } {}
 
-PipelineLayout::PipelineLayout(PipelineLayout && x) : device{ x.device }, handle { x.handle }, globalSet{ x.globalSet }, localSet{ x.localSet }
+PipelineLayout::PipelineLayout(PipelineLayout && x) : device{ x.device }, handle { x.handle }, sets{ std::move(x.sets) }, pushConstants{ std::move(x.pushConstants) }
 {
 	x.handle = vk::PipelineLayout();
 	x.device = nullptr;
-	x.globalSet = nullptr;
-	x.localSet = nullptr;
+	x.sets.clear();
+	x.pushConstants.clear();
 }
 
 
@@ -18,15 +19,16 @@ PipelineLayout& PipelineLayout::operator=(PipelineLayout && x)
 {
 	if (this != &x)
 	{
+		clear();
 		handle = x.handle;
 		device = x.device;
-		globalSet = x.globalSet;
-		localSet = x.localSet;
+		sets = std::move(x.sets);
+		pushConstants = std::move(x.pushConstants);
 
 		x.handle = vk::PipelineLayout();
 		x.device = nullptr;
-		x.globalSet = nullptr;
-		x.localSet = nullptr;
+		x.sets.clear();
+		x.pushConstants.clear();
 	}
 	return *this;
 }
@@ -38,12 +40,35 @@ PipelineLayout::operator vk::PipelineLayout() const
 
 vk::DescriptorSetLayout* PipelineLayout::getGlobalSet() const
 {
-	return globalSet;
+	return sets.size() > 0 ? sets[0] : nullptr;
 }
 
 vk::DescriptorSetLayout* PipelineLayout::getLocalSet() const
 {
-	return localSet;
+	return sets.size() > 1 ? sets[1] : nullptr;
+}
+
+vk::DescriptorSetLayout* PipelineLayout::getSet(uint32_t index) const
+{
+	return index < sets.size() ? sets[index] : nullptr;
+}
+
+bool PipelineLayout::matches(const std::vector<vk::DescriptorSetLayout*>& sets, const std::vector<vk::PushConstantRange>& pushConstants) const
+{
+	if (this->sets != sets || this->pushConstants.size() != pushConstants.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < pushConstants.size(); i++)
+	{
+		const vk::PushConstantRange& a = this->pushConstants[i];
+		const vk::PushConstantRange& b = pushConstants[i];
+		if (a.stageFlags != b.stageFlags || a.offset != b.offset || a.size != b.size)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 PipelineLayout::~PipelineLayout()
@@ -60,7 +85,7 @@ void PipelineLayout::clear()
 	}
 	handle = vk::PipelineLayout();
 	device = nullptr;
-	globalSet = nullptr;
-	localSet = nullptr;
+	sets.clear();
+	pushConstants.clear();
 }
 
@@ -2,6 +2,10 @@
 
 #include<vulkan\vulkan.hpp>
 #include"ShaderUsage.h"
+#include"PipelineVariant.h"
+#include<vector>
+#include<array>
+#include<future>
 
 /**
 	Stracture used to store pointers to two descriptors sets.
@@ -27,10 +31,10 @@ public:
 	/**
 		Constructor.
 		@param layout handle to a vulkan's pipeline layout handle.
-		@param global pointer to a descriptor set layout of global shader variables used to create layout.
-		@param local pointer to a descriptor set layout of local shader variables used to create layout.
+		@param sets pointers to descriptor set layouts used to create layout, in the order of sets.
+		@param pushConstants push constant ranges used to create layout.
 	*/
-	PipelineLayout(vk::Device* device, vk::PipelineLayout layout, vk::DescriptorSetLayout* global, vk::DescriptorSetLayout* local);
+	PipelineLayout(vk::Device* device, vk::PipelineLayout layout, const std::vector<vk::DescriptorSetLayout*>& sets, const std::vector<vk::PushConstantRange>& pushConstants);
 	PipelineLayout(const PipelineLayout& x) = delete;
 	/**
 		Move constructor.
@@ -48,14 +52,27 @@ public:
 	operator vk::PipelineLayout() const;
 	/**
 		Returns a descriptor set layout of global shader variables used to create layout.
-		@return descriptor set layout of global shader variables used to create layout.
+		@return descriptor set layout of global shader variables used to create layout, nullptr if the layout has no sets.
 	*/
 	vk::DescriptorSetLayout* getGlobalSet() const;
 	/**
 		Returns a descriptor set layout of local shader variables used to create layout.
-		@return descriptor set layout of local shader variables used to create layout.
+		@return descriptor set layout of local shader variables used to create layout, nullptr if the layout has no local set.
 	*/
 	vk::DescriptorSetLayout* getLocalSet() const;
+	/**
+		Returns a descriptor set layout used to create layout.
+		@param index index of the set.
+		@return descriptor set layout of the set, nullptr if the layout has fewer sets.
+	*/
+	vk::DescriptorSetLayout* getSet(uint32_t index) const;
+	/**
+		Checks if the layout was created out of the given sets and push constants.
+		@param sets pointers to descriptor set layouts, in the order of sets.
+		@param pushConstants push constant ranges.
+		@return true if the layout can be used in their place, false otherwise.
+	*/
+	bool matches(const std::vector<vk::DescriptorSetLayout*>& sets, const std::vector<vk::PushConstantRange>& pushConstants) const;
 	/**
 		Destructor.
 	*/
@@ -67,8 +84,18 @@ private:
 	void clear();
 	const vk::Device* device;			//*< Vulkan's logic device handle used by the layout.
 	vk::PipelineLayout handle;			//*< Vulkan's layout handle.
-	vk::DescriptorSetLayout* globalSet;	//*< pointer to a descriptor set layout of global shader variables used to create layout.
-	vk::DescriptorSetLayout* localSet;	//*< pointer to a descriptor set layout of local shader variables used to create layout.
+	std::vector<vk::DescriptorSetLayout*> sets;			//*< Pointers to descriptor set layouts used to create layout. First one is the global set, second one the local set.
+	std::vector<vk::PushConstantRange> pushConstants;	//*< Push constant ranges used to create layout.
+};
+
+/**
+	Structure describing a layout of global descriptor sets. Scenes create one global set for every such layout.
+*/
+struct GlobalSetLayout
+{
+	vk::DescriptorSetLayout* layout;						//*< Pointer to the descriptor set layout.
+	std::vector<vk::DescriptorSetLayoutBinding> bindings;	//*< Bindings the layout was created out of.
+	ShaderUsage usage;										//*< Flags representing global shader variables in the set.
 };
 
 struct Pipeline
@@ -77,5 +104,30 @@ struct Pipeline
 	PipelineLayout* layout;				//*< Pointer to a layout used to create the pipeline.
 	ShaderUsage globalReq;				//*< Flags representing global shader variables needed for pipeline to function.
 	ShaderUsage localReq;				//*< Flags representing local shader variables needed for pipeline to function.
+	uint32_t globalSet;					//*< Index of the scene's global descriptor set bound with the pipeline, noGlobalSet if the pipeline doesn't use one.
+
+	static const uint32_t noGlobalSet = ~0u;	//*< Global set index of pipelines which don't use global variables.
+};
+
+/**
+	Structure holding a pipeline being created on a worker thread.
+*/
+struct PendingPipeline
+{
+	vk::Pipeline* handle;				//*< Handle to which the pipeline is written once it is created.
+	std::future<vk::Pipeline> pending;	//*< Pipeline being created.
+};
+
+/**
+	Structure holding a specialised variant of a graphics pipeline and of its indirect variant.
+	Variants are created on worker threads when a scene first draws with them, the base pipelines are used until then.
+*/
+struct SpecialisedPipeline
+{
+	PipelineVariant variant;							//*< Type and constants of the variant.
+	std::future<std::array<vk::Pipeline, 2>> pending;	//*< Handles of the graphics and indirect pipeline being created, invalid if no creation is in flight.
+	Pipeline pipeline;									//*< Variant of the graphics pipeline, its handle is empty until it is created.
+	Pipeline indirect;									//*< Variant of the indirect pipeline, its handle is empty until it is created or if there is no indirect pipeline.
+	bool requested;										//*< Flag determining if the variant was requested since pipelines were last created.
 };
 
@@ -0,0 +1,62 @@
+#include "PipelineVariant.h"
+#include<cstring>
+
+PipelineVariant::PipelineVariant(PipelineType type) : type{ type } {}
+
+PipelineVariant & PipelineVariant::set(ShaderConstant constant, int32_t value)
+{
+	setValue(constant, static_cast<uint32_t>(value));
+	return *this;
+}
+
+PipelineVariant & PipelineVariant::set(ShaderConstant constant, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	setValue(constant, bits);
+	return *this;
+}
+
+PipelineType PipelineVariant::getType() const
+{
+	return type;
+}
+
+const std::vector<SpecializationConstant>& PipelineVariant::getConstants() const
+{
+	return constants;
+}
+
+bool PipelineVariant::operator==(const PipelineVariant & other) const
+{
+	if (type != other.type || constants.size() != other.constants.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < constants.size(); i++)
+	{
+		if (constants[i].id != other.constants[i].id || constants[i].value != other.constants[i].value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void PipelineVariant::setValue(ShaderConstant constant, uint32_t value)
+{
+	// constants are kept sorted, so variants setting the same constants in a different order are equal
+	auto it = constants.begin();
+	while (it != constants.end() && it->id < constant)
+	{
+		it++;
+	}
+	if (it != constants.end() && it->id == constant)
+	{
+		it->value = value;
+	}
+	else
+	{
+		constants.insert(it, SpecializationConstant{ constant, value });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include<vector>
+#include<cstdint>
+#include"PipelineType.h"
+
+/**
+	Shader constant enumerator.
+	Enumerator which represents specialization constants of shaders. Values are the constant ids declared in the shaders, so they are unique across all shaders.
+*/
+enum class ShaderConstant : uint32_t
+{
+	eParallaxMinLayers = 0,	//*< Number of layers parallax mapping samples when a surface is viewed head on. Integer, 10 by default.
+	eParallaxMaxLayers,		//*< Number of layers parallax mapping samples when a surface is viewed at a grazing angle. Integer, 20 by default.
+	eParallaxHeightScale,	//*< Depth of parallax mapped surfaces. Float, 0.1 by default.
+	eToonBands,				//*< Number of shading bands of toon shading. Integer, 4 by default.
+	eShininess				//*< Specular exponent of Phong shading. Float, 16 by default, 5 for bump mapping.
+};
+
+/**
+	Structure holding a value of a specialization constant.
+*/
+struct SpecializationConstant
+{
+	ShaderConstant id;	//*< Constant which is specialised.
+	uint32_t value;		//*< Bits of the value. Integer, float and boolean constants are all 32 bits wide.
+};
+
+/**
+	Pipeline variant class.
+	Describes a pipeline whose shaders are specialised with constants, so quality of a pipeline type can be traded for speed without new pipeline types.
+	Constants the pipeline's shaders don't declare are ignored.
+*/
+class PipelineVariant
+{
+public:
+	/**
+		Constructor. Creates a variant which uses default values of all constants.
+		@param type type of the pipeline which is specialised.
+	*/
+	PipelineVariant(PipelineType type);
+	/**
+		Sets the value of an integer constant.
+		@param constant constant which is set.
+		@param value value of the constant.
+		@return reference to the variant.
+	*/
+	PipelineVariant& set(ShaderConstant constant, int32_t value);
+	/**
+		Sets the value of a float constant.
+		@param constant constant which is set.
+		@param value value of the constant.
+		@return reference to the variant.
+	*/
+	PipelineVariant& set(ShaderConstant constant, float value);
+	/**
+		Returns the type of the specialised pipeline.
+		@return pipeline type.
+	*/
+	PipelineType getType() const;
+	/**
+		Returns values of the constants set in the variant.
+		@return constants sorted by their ids, empty if the variant is the base pipeline.
+	*/
+	const std::vector<SpecializationConstant>& getConstants() const;
+	/**
+		Checks if two variants describe the same pipeline.
+		@param other variant to compare with.
+		@return true if both variants have the same type and constants, false otherwise.
+	*/
+	bool operator==(const PipelineVariant& other) const;
+private:
+	/**
+		Sets the bits of a constant's value, keeping constants sorted.
+	*/
+	void setValue(ShaderConstant constant, uint32_t value);
+	PipelineType type;								//*< Type of the specialised pipeline.
+	std::vector<SpecializationConstant> constants;	//*< Values of the constants, sorted by their ids.
+};
\ No newline at end of file
@@ -1,27 +1,17 @@
 #include "Shader.h"
-#include <fstream>
+#include "..\ResourceManagers\FileSystem.h"
+#include "..\ResourceManagers\ShaderCompiler.h"
 
-static std::vector<char> readFile(const std::string& fileName)
-{
-	std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+Shader::Shader() : module{ }, device{ nullptr }, info{ } {}
 
-	if (!file.is_open())
-	{
-		throw std::runtime_error("failed to open file!");
-	}
-	size_t fileSize = static_cast<size_t>(file.tellg());
-	std::vector<char> buffer(fileSize);
-	file.seekg(0);
-	file.read(buffer.data(), fileSize);
-	file.close();
-	return buffer;
+Shader::Shader(const vk::Device * device, const char * filename)
+{
+	createShader(device, filename);
 }
 
-Shader::Shader() : module{ }, device{ nullptr }, info{ } {}
-
-Shader::Shader(const vk::Device * device, const char * filename, const vk::ShaderStageFlagBits & shaderType, const ShaderUsage& globalUse, const ShaderUsage& localUse)
+Shader::Shader(const vk::Device * device, const char * source, const char * binary, const std::vector<std::string>& defines)
 {
-	createShader(device, filename, shaderType, globalUse, localUse);
+	createShader(device, source, binary, defines);
 }
 
 Shader::Shader(Shader && x)
@@ -29,14 +19,12 @@ Shader::Shader(Shader && x)
 	module = x.module;
 	device = x.device;
 	info = x.info;
-	local = x.local;
-	global = x.global;
+	reflection = std::move(x.reflection);
 
 	x.module = vk::ShaderModule();
 	x.device = nullptr;
 	x.info = {};
-	x.local = ShaderUsage::Empty;
-	x.global = ShaderUsage::Empty;
+	x.reflection = ShaderReflection();
 }
 
 Shader & Shader::operator=(Shader && x)
@@ -47,33 +35,45 @@ Shader & Shader::operator=(Shader && x)
 		module = x.module;
 		device = x.device;
 		info = x.info;
-		local = x.local;
-		global = x.global;
+		reflection = std::move(x.reflection);
 
 		x.module = vk::ShaderModule();
 		x.device = nullptr;
 		x.info = {};
-		x.local = ShaderUsage::Empty;
-		x.global = ShaderUsage::Empty;
+		x.reflection = ShaderReflection();
 	}
 	return *this;
 }
 
-void Shader::createShader(const vk::Device * device, const char * filename, const vk::ShaderStageFlagBits & shaderType, const ShaderUsage& globalUse, const ShaderUsage& localUse)
+void Shader::createShader(const vk::Device * device, const char * filename)
+{
+	//read the file with the code, packed files are aligned so the code is used in place.
+	createModule(device, FileSystem::open(filename));
+}
+
+void Shader::createShader(const vk::Device * device, const char * source, const char * binary, const std::vector<std::string>& defines)
+{
+	createModule(device, ShaderCompiler::load(source, binary, defines));
+}
+
+void Shader::createModule(const vk::Device * device, const FileView & code)
 {
 	clear();
 
-	global = globalUse;
-	local = localUse;
 	this->device = device;
-	//read the file with the code
-	const std::vector<char> code = readFile(filename);
+	if (!code.isValid())
+	{
+		throw std::runtime_error("failed to open file!");
+	}
+	//reflect the code, so the stage and variables of the shader don't need to be specified.
+	reflection = ShaderReflection{ reinterpret_cast<const uint32_t*>(code.getData()), code.getSize() };
 	//fill the shader information.
-	vk::ShaderModuleCreateInfo shaderInfo{ vk::ShaderModuleCreateFlags(), code.size(), (uint32_t*)code.data() };
+	vk::ShaderModuleCreateInfo shaderInfo{ vk::ShaderModuleCreateFlags(), code.getSize(), reinterpret_cast<const uint32_t*>(code.getData()) };
 	//create the shader.
 	module = device->createShaderModule(shaderInfo);
 	// fill pipeline shader stage creation info.
-	info = vk::PipelineShaderStageCreateInfo{ vk::PipelineShaderStageCreateFlags(), shaderType, module, "main" };
+	vk::ShaderStageFlagBits stage = static_cast<vk::ShaderStageFlagBits>(static_cast<VkShaderStageFlags>(reflection.getStages()));
+	info = vk::PipelineShaderStageCreateInfo{ vk::PipelineShaderStageCreateFlags(), stage, module, "main" };
 }
 
 vk::PipelineShaderStageCreateInfo Shader::getCreateInfo() const
@@ -83,12 +83,17 @@ vk::PipelineShaderStageCreateInfo Shader::getCreateInfo() const
 
 ShaderUsage Shader::getGlobalUsage() const
 {
-	return global;
+	return reflection.getGlobalUsage();
 }
 
 ShaderUsage Shader::getLocalUsage() const
 {
-	return local;
+	return reflection.getLocalUsage();
+}
+
+const ShaderReflection & Shader::getReflection() const
+{
+	return reflection;
 }
 
 
@@ -104,7 +109,6 @@ void Shader::clear()
 		device->destroyShaderModule(module);
 		device = nullptr;
 		info = {};
-		global = ShaderUsage::Empty;
-		local = ShaderUsage::Empty;
+		reflection = ShaderReflection();
 	}
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include <vulkan\vulkan.hpp>
-#include "ShaderUsage.h"
+#include<string>
+#include<vector>
+#include "ShaderReflection.h"
+#include "..\ResourceManagers\FileView.h"
 
 /**
 	Shader class.
@@ -14,14 +17,19 @@ public:
 	*/
 	Shader();
 	/** 
-		Constructor.
+		Constructor. Type of the shader and variables it contains are reflected from its code.
 		@param device logical device used to create a shader.
 		@param filename filename of a file containing shader code.
-		@param shaderType type of a sheder.
-		@param globalUse global variables shader contains.
-		@param localUse local variables shader contains.
 	*/
-	Shader(const vk::Device* device, const char* filename, const vk::ShaderStageFlagBits& shaderType, const ShaderUsage& globalUse, const ShaderUsage& localUse);
+	Shader(const vk::Device* device, const char* filename);
+	/**
+		Constructor. Compiles the shader from its source if runtime compilation is enabled.
+		@param device logical device used to create a shader.
+		@param source filename of a file containing GLSL source of the shader.
+		@param binary filename of a file containing shader code compiled offline.
+		@param defines macros defined for the variant of the shader.
+	*/
+	Shader(const vk::Device* device, const char* source, const char* binary, const std::vector<std::string>& defines = std::vector<std::string>());
 	Shader(Shader& x) = delete;
 	/**
 		Move constructor.
@@ -34,13 +42,19 @@ public:
 	Shader& operator=(Shader&& x);
 	/**
 		Function used to create a shader. By calling this function existing shader will be replaced, if there is one.
+		Type of the shader and variables it contains are reflected from its code.
 		@param device logical device used to create a shader.
 		@param filename filename of a file containing shader code.
-		@param shaderType type of a sheder.
-		@param globalUse global variables shader contains.
-		@param localUse local variables shader contains.
 	*/
-	void createShader(const vk::Device* device, const char* filename, const vk::ShaderStageFlagBits& shaderType, const ShaderUsage& globalUse, const ShaderUsage& localUse);
+	void createShader(const vk::Device* device, const char* filename);
+	/**
+		Function used to create a shader from its source, compiled if runtime compilation is enabled. By calling this function existing shader will be replaced, if there is one.
+		@param device logical device used to create a shader.
+		@param source filename of a file containing GLSL source of the shader.
+		@param binary filename of a file containing shader code compiled offline.
+		@param defines macros defined for the variant of the shader.
+	*/
+	void createShader(const vk::Device* device, const char* source, const char* binary, const std::vector<std::string>& defines = std::vector<std::string>());
 	/**
 		Returns information for creating a pipeline shader stage with this shader.
 		@return information for creating a pipeline shader stage.
@@ -56,6 +70,11 @@ public:
 		@return flags representing local variables in the shader.
 	*/
 	ShaderUsage getLocalUsage() const;
+	/**
+		Returns reflection of the shader's code.
+		@return resources and inputs of the shader.
+	*/
+	const ShaderReflection& getReflection() const;
 	/**
 		Destructor.
 	*/
@@ -65,9 +84,14 @@ private:
 		Resets all variables.
 	*/
 	void clear();
+	/**
+		Creates the shader module from its code and reflects it.
+		@param device logical device used to create a shader.
+		@param code SPIR-V code of the shader.
+	*/
+	void createModule(const vk::Device* device, const FileView& code);
 	vk::ShaderModule module;				//*< Handle of a created shader.
 	const vk::Device* device;						//*< Pointer to a logical device.
 	vk::PipelineShaderStageCreateInfo info;	//*< Information for creating a pipeline shader stage.
-	ShaderUsage global;						//*< Flags representing global variables in the shader.
-	ShaderUsage local;						//*< Flags representing local variables in the shader.
+	ShaderReflection reflection;			//*< Resources and inputs of the shader.
 };
\ No newline at end of file
@@ -0,0 +1,497 @@
+#include "ShaderReflection.h"
+#include<unordered_map>
+#include<algorithm>
+#include<stdexcept>
+
+namespace
+{
+	const uint32_t spirvMagic = 0x07230203;	//*< First word of every SPIR-V module.
+	const uint32_t headerSize = 5;			//*< Number of words in the header of a SPIR-V module.
+	const uint32_t noDecoration = ~0u;		//*< Value of a decoration which wasn't found.
+	const uint32_t tangentLocation = 3;		//*< Location of the tangent attribute of vertices with tangents.
+
+	/**
+		Global variables by their bindings in the global set, in the order VulkanEngine writes them.
+	*/
+	const ShaderUsage globalUsages[] = { ShaderUsage::VS_PVTransform, ShaderUsage::VS_Light, ShaderUsage::VS_CameraPos };
+	/**
+		Local variables by their bindings in the local set, in the order VulkanEngine writes them.
+	*/
+	const ShaderUsage localUsages[] = { ShaderUsage::VS_ModelTransform, ShaderUsage::FS_Texture, ShaderUsage::FS_NormalMap, ShaderUsage::FS_DepthMap };
+
+	/**
+		Instructions and enumerants of the SPIR-V specification used by the reflection.
+	*/
+	enum SpirV : uint32_t
+	{
+		OpEntryPoint = 15,
+		OpTypeBool = 20,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeMatrix = 24,
+		OpTypeImage = 25,
+		OpTypeSampler = 26,
+		OpTypeSampledImage = 27,
+		OpTypeArray = 28,
+		OpTypeRuntimeArray = 29,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpConstant = 43,
+		OpSpecConstant = 50,
+		OpVariable = 59,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+
+		DecorationBufferBlock = 3,
+		DecorationArrayStride = 6,
+		DecorationMatrixStride = 7,
+		DecorationBuiltIn = 11,
+		DecorationLocation = 30,
+		DecorationBinding = 33,
+		DecorationDescriptorSet = 34,
+		DecorationOffset = 35,
+
+		StorageUniformConstant = 0,
+		StorageInput = 1,
+		StorageUniform = 2,
+		StoragePushConstant = 9,
+		StorageBuffer = 12,
+
+		DimBuffer = 5,
+		DimSubpassData = 6
+	};
+
+	/**
+		Structure describing a result id of a SPIR-V module.
+	*/
+	struct SpirvId
+	{
+		std::vector<uint32_t> words;				//*< Words of the instruction which defines the id.
+		uint32_t set{ noDecoration };				//*< Descriptor set the variable is in.
+		uint32_t binding{ noDecoration };			//*< Binding of the variable in its set.
+		uint32_t location{ noDecoration };			//*< Location of the variable.
+		uint32_t arrayStride{ 0 };					//*< Stride of the array type, zero if it isn't decorated.
+		bool builtIn{ false };						//*< Whether the variable is a built-in variable.
+		bool bufferBlock{ false };					//*< Whether the struct type is a storage buffer block.
+		std::vector<uint32_t> memberOffsets;		//*< Offsets of members of the struct type.
+		std::vector<uint32_t> memberMatrixStrides;	//*< Strides of matrix members of the struct type, zero if they aren't decorated.
+	};
+
+	/**
+		Returns the opcode of an id's definition.
+	*/
+	uint32_t getOpcode(const SpirvId& id)
+	{
+		return id.words.empty() ? 0 : id.words[0] & 0xFFFF;
+	}
+
+	/**
+		Returns the number of elements of an array type, one if it isn't known.
+	*/
+	uint32_t getArrayLength(std::unordered_map<uint32_t, SpirvId>& ids, const SpirvId& array)
+	{
+		// lengths are constants, specialization constants are counted with their default values
+		const SpirvId& length = ids[array.words[3]];
+		return length.words.size() > 3 && length.words[3] > 0 ? length.words[3] : 1;
+	}
+
+	/**
+		Orders bindings by their sets and bindings.
+	*/
+	bool isBindingBefore(const ReflectedBinding& a, const ReflectedBinding& b)
+	{
+		return a.set < b.set || (a.set == b.set && a.binding < b.binding);
+	}
+
+	/**
+		Orders vertex inputs by their locations.
+	*/
+	bool isInputBefore(const ReflectedInput& a, const ReflectedInput& b)
+	{
+		return a.location < b.location;
+	}
+
+	/**
+		Returns size of a type in bytes, as it is laid out in a buffer.
+		@param ids ids of the module.
+		@param type id of the type.
+		@param matrixStride stride of the matrix type, zero if it isn't decorated.
+	*/
+	uint32_t getTypeSize(std::unordered_map<uint32_t, SpirvId>& ids, uint32_t type, uint32_t matrixStride = 0)
+	{
+		const SpirvId& id = ids[type];
+		switch (getOpcode(id))
+		{
+		case OpTypeBool:
+			return 4;
+		case OpTypeInt:
+		case OpTypeFloat:
+			return id.words[2] / 8;
+		case OpTypeVector:
+			return id.words[3] * getTypeSize(ids, id.words[2]);
+		case OpTypeMatrix:
+			return id.words[3] * (matrixStride > 0 ? matrixStride : getTypeSize(ids, id.words[2]));
+		case OpTypeArray:
+			return getArrayLength(ids, id) * (id.arrayStride > 0 ? id.arrayStride : getTypeSize(ids, id.words[2]));
+		case OpTypeStruct:
+		{
+			uint32_t size = 0;
+			for (uint32_t i = 2; i < id.words.size(); i++)
+			{
+				uint32_t member = i - 2;
+				uint32_t offset = member < id.memberOffsets.size() ? id.memberOffsets[member] : size;
+				uint32_t stride = member < id.memberMatrixStrides.size() ? id.memberMatrixStrides[member] : 0;
+				size = std::max(size, offset + getTypeSize(ids, id.words[i], stride));
+			}
+			return size;
+		}
+		default:
+			return 0;
+		}
+	}
+
+	/**
+		Returns the format of a vertex attribute of a scalar or vector type, undefined format for other types.
+	*/
+	vk::Format getFormat(std::unordered_map<uint32_t, SpirvId>& ids, uint32_t type)
+	{
+		const vk::Format floatFormats[] = { vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat };
+		const vk::Format intFormats[] = { vk::Format::eR32Sint, vk::Format::eR32G32Sint, vk::Format::eR32G32B32Sint, vk::Format::eR32G32B32A32Sint };
+		const vk::Format uintFormats[] = { vk::Format::eR32Uint, vk::Format::eR32G32Uint, vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint };
+		uint32_t components = 1;
+		const SpirvId* scalar = &ids[type];
+		if (getOpcode(*scalar) == OpTypeVector)
+		{
+			components = scalar->words[3];
+			scalar = &ids[scalar->words[2]];
+		}
+		if (components < 1 || components > 4 || scalar->words.size() < 3 || scalar->words[2] != 32)
+		{
+			return vk::Format::eUndefined;
+		}
+		switch (getOpcode(*scalar))
+		{
+		case OpTypeFloat:
+			return floatFormats[components - 1];
+		case OpTypeInt:
+			return scalar->words[3] ? intFormats[components - 1] : uintFormats[components - 1];
+		default:
+			return vk::Format::eUndefined;
+		}
+	}
+
+	/**
+		Returns the descriptor type through which a resource of the given type is accessed.
+		@param ids ids of the module.
+		@param type id of the resource's type with arrays stripped.
+		@param storage storage class of the resource.
+		@param descriptorType filled with the descriptor type.
+		@return true if the resource is accessed through a descriptor, false otherwise.
+	*/
+	bool getDescriptorType(std::unordered_map<uint32_t, SpirvId>& ids, uint32_t type, uint32_t storage, vk::DescriptorType& descriptorType)
+	{
+		const SpirvId& id = ids[type];
+		switch (getOpcode(id))
+		{
+		case OpTypeSampledImage:
+			descriptorType = vk::DescriptorType::eCombinedImageSampler;
+			return true;
+		case OpTypeSampler:
+			descriptorType = vk::DescriptorType::eSampler;
+			return true;
+		case OpTypeImage:
+			// sampled operand is 1 for images used with a sampler and 2 for storage images
+			if (id.words[3] == DimSubpassData)
+			{
+				descriptorType = vk::DescriptorType::eInputAttachment;
+			}
+			else if (id.words[3] == DimBuffer)
+			{
+				descriptorType = id.words[7] == 2 ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+			}
+			else
+			{
+				descriptorType = id.words[7] == 2 ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+			}
+			return true;
+		case OpTypeStruct:
+			if (storage == StorageBuffer || (storage == StorageUniform && id.bufferBlock))
+			{
+				descriptorType = vk::DescriptorType::eStorageBuffer;
+				return true;
+			}
+			if (storage == StorageUniform)
+			{
+				descriptorType = vk::DescriptorType::eUniformBuffer;
+				return true;
+			}
+			return false;
+		default:
+			return false;
+		}
+	}
+}
+
+ShaderReflection::ShaderReflection() {}
+
+ShaderReflection::ShaderReflection(const uint32_t * code, size_t size)
+{
+	size_t count = size / sizeof(uint32_t);
+	if (code == nullptr || size % sizeof(uint32_t) != 0 || count < headerSize || code[0] != spirvMagic)
+	{
+		throw std::runtime_error("invalid shader code!");
+	}
+	const vk::ShaderStageFlagBits models[] = { vk::ShaderStageFlagBits::eVertex, vk::ShaderStageFlagBits::eTessellationControl, vk::ShaderStageFlagBits::eTessellationEvaluation,
+		vk::ShaderStageFlagBits::eGeometry, vk::ShaderStageFlagBits::eFragment, vk::ShaderStageFlagBits::eCompute };
+	vk::ShaderStageFlagBits stage = vk::ShaderStageFlagBits::eAll;
+	std::unordered_map<uint32_t, SpirvId> ids;
+	std::vector<uint32_t> variables;
+	// a single pass collects definitions and decorations, resources are resolved once all types are known.
+	for (size_t i = headerSize; i < count;)
+	{
+		uint32_t opcode = code[i] & 0xFFFF;
+		uint32_t length = code[i] >> 16;
+		if (length == 0 || i + length > count)
+		{
+			throw std::runtime_error("invalid shader code!");
+		}
+		const uint32_t* words = code + i;
+		i += length;
+		switch (opcode)
+		{
+		case OpEntryPoint:
+			if (length > 1 && stage == vk::ShaderStageFlagBits::eAll && words[1] < sizeof(models) / sizeof(models[0]))
+			{
+				stage = models[words[1]];
+			}
+			break;
+		case OpDecorate:
+			if (length > 3)
+			{
+				SpirvId& id = ids[words[1]];
+				switch (words[2])
+				{
+				case DecorationDescriptorSet: id.set = words[3]; break;
+				case DecorationBinding: id.binding = words[3]; break;
+				case DecorationLocation: id.location = words[3]; break;
+				case DecorationArrayStride: id.arrayStride = words[3]; break;
+				case DecorationBuiltIn: id.builtIn = true; break;
+				}
+			}
+			else if (length > 2)
+			{
+				ids[words[1]].bufferBlock = ids[words[1]].bufferBlock || words[2] == DecorationBufferBlock;
+			}
+			break;
+		case OpMemberDecorate:
+			if (length > 4 && (words[3] == DecorationOffset || words[3] == DecorationMatrixStride))
+			{
+				SpirvId& id = ids[words[1]];
+				std::vector<uint32_t>& values = words[3] == DecorationOffset ? id.memberOffsets : id.memberMatrixStrides;
+				if (values.size() <= words[2])
+				{
+					values.resize(words[2] + 1, 0);
+				}
+				values[words[2]] = words[4];
+			}
+			break;
+		case OpTypeBool:
+		case OpTypeInt:
+		case OpTypeFloat:
+		case OpTypeVector:
+		case OpTypeMatrix:
+		case OpTypeImage:
+		case OpTypeSampler:
+		case OpTypeSampledImage:
+		case OpTypeArray:
+		case OpTypeRuntimeArray:
+		case OpTypeStruct:
+		case OpTypePointer:
+			if (length > 1)
+			{
+				ids[words[1]].words.assign(words, words + length);
+			}
+			break;
+		case OpConstant:
+		case OpSpecConstant:
+		case OpVariable:
+			if (length > 3)
+			{
+				ids[words[2]].words.assign(words, words + length);
+				if (opcode == OpVariable)
+				{
+					variables.push_back(words[2]);
+				}
+			}
+			break;
+		}
+	}
+	if (stage == vk::ShaderStageFlagBits::eAll)
+	{
+		throw std::runtime_error("shader code has no entry point!");
+	}
+	stages = stage;
+
+	for (uint32_t variable : variables)
+	{
+		const SpirvId& id = ids[variable];
+		const SpirvId& pointer = ids[id.words[1]];
+		if (getOpcode(pointer) != OpTypePointer)
+		{
+			continue;
+		}
+		uint32_t storage = id.words[3];
+		uint32_t type = pointer.words[3];
+		if (storage == StorageInput && stage == vk::ShaderStageFlagBits::eVertex && !id.builtIn && id.location != noDecoration)
+		{
+			vk::Format format = getFormat(ids, type);
+			if (format != vk::Format::eUndefined)
+			{
+				inputs.push_back(ReflectedInput{ id.location, format });
+			}
+		}
+		else if (storage == StoragePushConstant)
+		{
+			const SpirvId& block = ids[type];
+			uint32_t offset = block.memberOffsets.empty() ? 0 : *std::min_element(block.memberOffsets.begin(), block.memberOffsets.end());
+			uint32_t end = getTypeSize(ids, type);
+			if (end > offset)
+			{
+				pushConstants.push_back(vk::PushConstantRange{ stage, offset, end - offset });
+			}
+		}
+		else if (id.set != noDecoration && id.binding != noDecoration)
+		{
+			// arrays of resources are bound as several descriptors of the same binding.
+			uint32_t descriptorCount = 1;
+			while (getOpcode(ids[type]) == OpTypeArray || getOpcode(ids[type]) == OpTypeRuntimeArray)
+			{
+				const SpirvId& array = ids[type];
+				if (getOpcode(array) == OpTypeArray)
+				{
+					descriptorCount *= getArrayLength(ids, array);
+				}
+				type = array.words[2];
+			}
+			vk::DescriptorType descriptorType;
+			if (getDescriptorType(ids, type, storage, descriptorType))
+			{
+				bindings.push_back(ReflectedBinding{ id.set, id.binding, descriptorType, descriptorCount, stage });
+			}
+		}
+	}
+	std::sort(bindings.begin(), bindings.end(), isBindingBefore);
+	std::sort(inputs.begin(), inputs.end(), isInputBefore);
+}
+
+void ShaderReflection::merge(const ShaderReflection & other)
+{
+	stages |= other.stages;
+	for (const ReflectedBinding& binding : other.bindings)
+	{
+		auto it = std::find_if(bindings.begin(), bindings.end(), [&binding](const ReflectedBinding& x) { return x.set == binding.set && x.binding == binding.binding; });
+		if (it == bindings.end())
+		{
+			bindings.push_back(binding);
+		}
+		else
+		{
+			it->stages |= binding.stages;
+		}
+	}
+	std::sort(bindings.begin(), bindings.end(), isBindingBefore);
+	for (const vk::PushConstantRange& range : other.pushConstants)
+	{
+		auto it = std::find_if(pushConstants.begin(), pushConstants.end(), [&range](const vk::PushConstantRange& x) { return x.stageFlags == range.stageFlags; });
+		if (it == pushConstants.end())
+		{
+			pushConstants.push_back(range);
+		}
+	}
+	for (const ReflectedInput& input : other.inputs)
+	{
+		auto it = std::find_if(inputs.begin(), inputs.end(), [&input](const ReflectedInput& x) { return x.location == input.location; });
+		if (it == inputs.end())
+		{
+			inputs.push_back(input);
+		}
+	}
+	std::sort(inputs.begin(), inputs.end(), isInputBefore);
+}
+
+vk::ShaderStageFlags ShaderReflection::getStages() const
+{
+	return stages;
+}
+
+const std::vector<ReflectedBinding>& ShaderReflection::getBindings() const
+{
+	return bindings;
+}
+
+uint32_t ShaderReflection::getSetCount() const
+{
+	return bindings.empty() ? 0 : bindings.back().set + 1;
+}
+
+std::vector<vk::DescriptorSetLayoutBinding> ShaderReflection::getSetBindings(uint32_t set) const
+{
+	std::vector<vk::DescriptorSetLayoutBinding> setBindings;
+	for (const ReflectedBinding& binding : bindings)
+	{
+		if (binding.set == set)
+		{
+			setBindings.push_back(vk::DescriptorSetLayoutBinding{ binding.binding, binding.type, binding.count, binding.stages, nullptr });
+		}
+	}
+	return setBindings;
+}
+
+const std::vector<vk::PushConstantRange>& ShaderReflection::getPushConstants() const
+{
+	return pushConstants;
+}
+
+const std::vector<ReflectedInput>& ShaderReflection::getInputs() const
+{
+	return inputs;
+}
+
+ShaderUsage ShaderReflection::getGlobalUsage() const
+{
+	ShaderUsage usage = ShaderUsage::Empty;
+	for (const ReflectedBinding& binding : bindings)
+	{
+		if (binding.set == globalSet && binding.binding < sizeof(globalUsages) / sizeof(globalUsages[0]))
+		{
+			usage = usage | globalUsages[binding.binding];
+		}
+	}
+	return usage;
+}
+
+ShaderUsage ShaderReflection::getLocalUsage() const
+{
+	ShaderUsage usage = ShaderUsage::Empty;
+	for (const ReflectedBinding& binding : bindings)
+	{
+		if (binding.set == localSet && binding.binding < sizeof(localUsages) / sizeof(localUsages[0]))
+		{
+			usage = usage | localUsages[binding.binding];
+		}
+		// indirect variants read model transformations from the object set instead
+		else if (binding.set == objectSet && binding.binding == 0)
+		{
+			usage = usage | ShaderUsage::VS_ModelTransform;
+		}
+	}
+	for (const ReflectedInput& input : inputs)
+	{
+		if (input.location == tangentLocation)
+		{
+			usage = usage | ShaderUsage::VS_Tangents;
+		}
+	}
+	return usage;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include<vulkan\vulkan.hpp>
+#include<vector>
+#include"ShaderUsage.h"
+
+/**
+	Structure describing a resource which a shader accesses through a descriptor set.
+*/
+struct ReflectedBinding
+{
+	uint32_t set;					//*< Index of the descriptor set.
+	uint32_t binding;				//*< Binding of the resource in the set.
+	vk::DescriptorType type;		//*< Type of the descriptor.
+	uint32_t count;					//*< Number of descriptors, greater than one for arrays.
+	vk::ShaderStageFlags stages;	//*< Shader stages which access the resource.
+};
+
+/**
+	Structure describing a vertex attribute read by a vertex shader.
+*/
+struct ReflectedInput
+{
+	uint32_t location;	//*< Location of the attribute.
+	vk::Format format;	//*< Format in which the shader reads the attribute.
+};
+
+/**
+	Shader reflection class.
+	Describes the interface of SPIR-V code: descriptor sets and bindings, push constant ranges and vertex inputs.
+	Reflections of all shaders of a pipeline are merged, so layouts of the pipeline can be created out of them.
+*/
+class ShaderReflection
+{
+public:
+	static const uint32_t globalSet = 0;	//*< Set with variables shared by all objects in a scene.
+	static const uint32_t localSet = 1;		//*< Set with variables of a single object.
+	static const uint32_t objectSet = 2;	//*< Set with transformations of all objects drawn with indirect draw calls.
+	/**
+		Constructor. Creates an empty reflection.
+	*/
+	ShaderReflection();
+	/**
+		Constructor. Reflects SPIR-V code.
+		@param code SPIR-V code.
+		@param size size of the code in bytes.
+		@throws std::runtime_error if the code isn't valid SPIR-V.
+	*/
+	ShaderReflection(const uint32_t* code, size_t size);
+	/**
+		Adds resources of another shader. Resources both shaders access are merged into one, accessed from stages of both.
+		@param other reflection of the other shader.
+	*/
+	void merge(const ShaderReflection& other);
+	/**
+		Returns stages of the reflected shaders.
+		@return flags of all shader stages merged into the reflection.
+	*/
+	vk::ShaderStageFlags getStages() const;
+	/**
+		Returns resources accessed through descriptor sets, sorted by sets and bindings.
+		@return reflected bindings.
+	*/
+	const std::vector<ReflectedBinding>& getBindings() const;
+	/**
+		Returns the number of descriptor sets a pipeline layout needs for the shaders.
+		@return index of the last set accessed increased by one, zero if no set is accessed.
+	*/
+	uint32_t getSetCount() const;
+	/**
+		Returns bindings of a descriptor set, from which a descriptor set layout can be created.
+		@param set index of the set.
+		@return bindings of the set sorted by their binding, empty if the set isn't accessed.
+	*/
+	std::vector<vk::DescriptorSetLayoutBinding> getSetBindings(uint32_t set) const;
+	/**
+		Returns push constant ranges, one for each stage which has push constants.
+		@return reflected push constant ranges.
+	*/
+	const std::vector<vk::PushConstantRange>& getPushConstants() const;
+	/**
+		Returns vertex attributes read by the vertex shader.
+		@return reflected vertex inputs sorted by their locations.
+	*/
+	const std::vector<ReflectedInput>& getInputs() const;
+	/**
+		Returns global variables accessed by the shaders, determined by bindings of the global set the engine writes.
+		@return flags representing global variables in the shaders.
+	*/
+	ShaderUsage getGlobalUsage() const;
+	/**
+		Returns local variables accessed by the shaders, determined by bindings of the local and object sets the engine writes and vertex attributes.
+		@return flags representing local variables in the shaders.
+	*/
+	ShaderUsage getLocalUsage() const;
+private:
+	vk::ShaderStageFlags stages;						//*< Stages of the reflected shaders.
+	std::vector<ReflectedBinding> bindings;				//*< Resources accessed through descriptor sets.
+	std::vector<vk::PushConstantRange> pushConstants;	//*< Push constant ranges of the shaders.
+	std::vector<ReflectedInput> inputs;					//*< Vertex attributes read by the vertex shader.
+};
\ No newline at end of file
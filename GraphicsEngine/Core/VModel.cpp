@@ -1,15 +1,42 @@
 #include "VModel.h"
+#include<algorithm>
 
-VModel::VModel(){}
+VModel::VModel() : range{ 0, 0, 0, 0 }, allocation{ 0, 0, 0, 0 }, boundsMin{ 0.0f }, boundsMax{ 0.0f }, quantization{ 0.0f, 0.0f, 0.0f, 1.0f }, version{ 0 } {}
 
-VModel::VModel(VModel && x) : vertices{ std::move(x.vertices) }, indices{ std::move(x.indices) } {}
+VModel::VModel(VModel && x) : arena{ std::move(x.arena) }, range{ x.range }, allocation{ x.allocation }, lods{ std::move(x.lods) }, boundsMin{ x.boundsMin }, boundsMax{ x.boundsMax }, quantization{ x.quantization },
+								positions{ std::move(x.positions) }, indices{ std::move(x.indices) }, version{ x.version } {}
 
 VModel & VModel::operator=(VModel && x)
 {
 	if (this != &x)
 	{
-		vertices = std::move(x.vertices);
+		arena = std::move(x.arena);
+		range = x.range;
+		allocation = x.allocation;
+		lods = std::move(x.lods);
+		boundsMin = x.boundsMin;
+		boundsMax = x.boundsMax;
+		quantization = x.quantization;
+		positions = std::move(x.positions);
 		indices = std::move(x.indices);
+		version = x.version;
 	}
 	return *this;
 }
+
+
+const MeshRange & VModel::getLod(const uint32_t level) const
+{
+	if (lods.empty())
+	{
+		return range;
+	}
+	return lods[std::min(level, static_cast<uint32_t>(lods.size() - 1))];
+}
+
+glm::mat4 VModel::getDequantization() const
+{
+	glm::mat4 dequantization{ quantization.w };
+	dequantization[3] = glm::vec4{ glm::vec3{ quantization }, 1.0f };
+	return dequantization;
+}
\ No newline at end of file
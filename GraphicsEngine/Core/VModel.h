@@ -1,9 +1,11 @@
 #pragma once
-#include"VertexBuffer.h"
-#include"IndexBuffer.h"
+#include<memory>
+#include<glm\glm.hpp>
+#include<vector>
+#include"MeshArena.h"
 
 /**
-	Structure representing a model. Holds the model's vertices and indices stored in the GPU.
+	Structure representing a model. Holds the location of the model's vertices and indices inside of a mesh arena stored in the GPU.
 */
 struct VModel
 {
@@ -21,6 +23,26 @@ struct VModel
 		Move assignment operator.
 	*/
 	VModel& operator=(VModel&& x);
-	VertexBuffer vertices;			//*< GPU buffer holding model's vertices.
-	IndexBuffer indices;			//*< GPU buffer holding model's indices.
+	/**
+		Returns the location of a level of detail inside of the arena. Levels past the coarsest one return the coarsest one.
+		@param level level of detail, 0 being the full model.
+		@return location of the level inside of the arena.
+	*/
+	const MeshRange& getLod(const uint32_t level) const;
+	/**
+		Returns the transformation which decodes model's quantised vertex positions into model space.
+		It has to be applied before the model's transformation.
+		@return dequantization transformation.
+	*/
+	glm::mat4 getDequantization() const;
+	std::shared_ptr<MeshArena> arena;	//*< Arena in which model's vertices and indices are stored.
+	MeshRange range;					//*< Location of the model's full detail level inside of the arena.
+	MeshRange allocation;				//*< Whole space the model occupies in the arena, including indices of all levels of detail.
+	std::vector<MeshRange> lods;		//*< Locations of model's levels of detail, from the full one to the coarsest. Share vertices with the full level. Empty for 2D models.
+	glm::vec3 boundsMin;				//*< Corner of the model's bounding box with the smallest coordinates.
+	glm::vec3 boundsMax;				//*< Corner of the model's bounding box with the largest coordinates.
+	glm::vec4 quantization;				//*< Center of the quantised positions in xyz and their scale in w. Identity for models which aren't quantised.
+	std::vector<glm::vec3> positions;	//*< Model space vertex positions kept on the CPU for occlusion culling. Empty for 2D models.
+	std::vector<uint32_t> indices;		//*< Triangle indices kept on the CPU for occlusion culling. Empty for 2D models.
+	uint32_t version;					//*< Number of times model's geometry was replaced by a reload. Components drawing it upload a new dequantization when it changes.
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "VTexture.h"
+#include<algorithm>
 
-VTexture::VTexture() : device{ nullptr }, textureImage{ vk::Image() }, textureImageMemory{ vk::DeviceMemory() }, textureImageView{ vk::ImageView() }, sampler{vk::Sampler()}, texWidth{ 0 }, texHeight{ 0 } {}
+VTexture::VTexture() : device{ nullptr }, textureImage{ vk::Image() }, textureImageMemory{ vk::DeviceMemory() }, textureImageView{ vk::ImageView() }, sampler{vk::Sampler()}, texWidth{ 0 }, texHeight{ 0 },
+						mipLevels{ 1 }, version{ 0 }, demand{ 0.0f } {}
 
 VTexture::VTexture(VTexture && x)
 {
@@ -11,6 +13,9 @@ VTexture::VTexture(VTexture && x)
 	sampler = x.sampler;
 	texWidth = x.texWidth;
 	texHeight = x.texHeight;
+	mipLevels = x.mipLevels;
+	version = x.version;
+	demand = x.demand;
 
 	x.device = nullptr;
 	x.textureImage = vk::Image();
@@ -32,6 +37,9 @@ VTexture & VTexture::operator=(VTexture && x)
 		sampler = x.sampler;
 		texWidth = x.texWidth;
 		texHeight = x.texHeight;
+		mipLevels = x.mipLevels;
+		version = x.version;
+		demand = x.demand;
 
 		x.device = nullptr;
 		x.textureImage = vk::Image();
@@ -65,6 +73,54 @@ uint32_t VTexture::getHeight() const
 	return texHeight;
 }
 
+uint32_t VTexture::getMipLevels() const
+{
+	return mipLevels;
+}
+
+uint32_t VTexture::getVersion() const
+{
+	return version;
+}
+
+void VTexture::request(float pixels)
+{
+	demand = std::max(demand, pixels);
+}
+
+float VTexture::takeDemand()
+{
+	float requested = demand;
+	demand = 0.0f;
+	return requested;
+}
+
+void VTexture::replace(VTexture && x)
+{
+	if (this == &x)
+	{
+		return;
+	}
+	clear();
+	device = x.device;
+	textureImage = x.textureImage;
+	textureImageMemory = x.textureImageMemory;
+	textureImageView = x.textureImageView;
+	sampler = x.sampler;
+	texWidth = x.texWidth;
+	texHeight = x.texHeight;
+	mipLevels = x.mipLevels;
+	version++;
+
+	x.device = nullptr;
+	x.textureImage = vk::Image();
+	x.textureImageMemory = vk::DeviceMemory();
+	x.textureImageView = vk::ImageView();
+	x.sampler = vk::Sampler();
+	x.texHeight = 0;
+	x.texWidth = 0;
+}
+
 VTexture::~VTexture()
 {
 	clear();
@@ -43,6 +43,32 @@ public:
 		@return texture's height.
 	*/
 	uint32_t getHeight() const;
+	/**
+		Returns the number of mip levels of a texture.
+		@return number of mip levels.
+	*/
+	uint32_t getMipLevels() const;
+	/**
+		Returns the number of times the texture's image was replaced. Descriptors written with an older version refer to a destroyed image.
+		@return texture's version.
+	*/
+	uint32_t getVersion() const;
+	/**
+		Records that the texture is drawn this frame on an object of a given size, so a streamed texture can load mip levels fine enough for it.
+		@param pixels size of the object on the screen in pixels.
+	*/
+	void request(float pixels);
+	/**
+		Returns the largest size requested since the last call, and resets it.
+		@return largest requested size in pixels, 0 if the texture wasn't requested.
+	*/
+	float takeDemand();
+	/**
+		Replaces texture's image with the one of another texture, destroying the current one and increasing the version.
+		The image must not be used by any command buffer that is still going to be submitted.
+		@param x texture whose image is taken.
+	*/
+	void replace(VTexture&& x);
 	/**
 		Destructor
 	*/
@@ -60,4 +86,7 @@ private:
 	vk::Sampler sampler;					//*< Handle of a sampler object.
 	uint32_t texWidth;						//*< Texture's width.
 	uint32_t texHeight;						//*< Texture's height.
+	uint32_t mipLevels;						//*< Number of texture's mip levels.
+	uint32_t version;						//*< Number of times texture's image was replaced.
+	float demand;							//*< Largest size in pixels the texture was requested for since the demand was last taken.
 };
\ No newline at end of file
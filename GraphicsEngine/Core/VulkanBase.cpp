@@ -5,19 +5,31 @@
 #include "VTexture.h"
 #include"VertexBuffer.h"
 #include"IndexBuffer.h"
+#include"MeshArena.h"
+#include<algorithm>
 #include"..\DebugTools\Assert.h"
+#include"..\DebugTools\Profiler.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include<stb_image_write.h>
 
-void VulkanBase::init(const char * appName, const bool& validating, uint32_t screenWidth, uint32_t screenHeight)
+void VulkanBase::init(const char * appName, const bool& validating, uint32_t screenWidth, uint32_t screenHeight, const bool headless)
 {
-	glfwInit();
-	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	this->headless = headless;
+	if (!headless)
+	{
+		glfwInit();
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	}
 	createInstance(appName, validating);
 	if (validating)
 	{
 		setupDebugCallback();
 	}
-	createSurface(appName, screenWidth, screenHeight);
+	if (!headless)
+	{
+		createSurface(appName, screenWidth, screenHeight);
+	}
 	pickPhysicalDevice();
 	createLogicalDevice(validating);
 	swapExtent = vk::Extent2D(screenWidth, screenHeight);
@@ -26,6 +38,7 @@ void VulkanBase::init(const char * appName, const bool& validating, uint32_t scr
 	createDescriptorSetLayout();
 	createGraphicsPipeline();
 	createCommandPool();
+	gpuProfiler.init(&logicDevice, physDev, findQueueIndex(physDev, vk::QueueFlagBits::eGraphics, surface), instance, debugLabels);
 	createFramebuffers();
 	createDescriptorPool();
 	createSemaphores();
@@ -38,7 +51,10 @@ glm::vec2 VulkanBase::getScreenSize() const
 
 void VulkanBase::setWindowSize(uint32_t width, uint32_t height)
 {
-	glfwSetWindowSize(window, width, height);
+	if (!headless)
+	{
+		glfwSetWindowSize(window, width, height);
+	}
 	swapExtent.width = width;
 	swapExtent.height = height;
 	recreateSwapChain();
@@ -46,6 +62,7 @@ void VulkanBase::setWindowSize(uint32_t width, uint32_t height)
 
 VTexture VulkanBase::createTexture(unsigned char * pixels, unsigned int width, unsigned int height, bool useStaging) const
 {
+	PROFILE_FUNCTION()
 	ASSERT(pixels != nullptr)
 	VTexture tex{};
 	tex.device = &logicDevice;
@@ -97,11 +114,123 @@ VTexture VulkanBase::createTexture(unsigned char * pixels, unsigned int width, u
 	return tex;
 }
 
+VTexture VulkanBase::createMipmappedTexture(const unsigned char * levels, uint32_t width, uint32_t height, uint32_t mipLevels) const
+{
+	PROFILE_FUNCTION()
+	ASSERT(levels != nullptr)
+	ASSERT(mipLevels > 0)
+	VTexture tex{};
+	tex.device = &logicDevice;
+	tex.texWidth = width;
+	tex.texHeight = height;
+	tex.mipLevels = mipLevels;
+
+	// one copy region per level, levels are stored from the coarsest one
+	std::vector<vk::BufferImageCopy> regions(mipLevels);
+	vk::DeviceSize size = 0;
+	for (uint32_t i = 0; i < mipLevels; i++)
+	{
+		uint32_t level = mipLevels - 1 - i;
+		uint32_t levelWidth = std::max(width >> level, 1u);
+		uint32_t levelHeight = std::max(height >> level, 1u);
+		regions[i] = vk::BufferImageCopy{ size, 0, 0, vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, level, 0, 1 }, vk::Offset3D{ 0, 0, 0 }, vk::Extent3D{ levelWidth, levelHeight, 1 } };
+		size += static_cast<vk::DeviceSize>(levelWidth) * levelHeight * 4;
+	}
+	vk::Buffer stagingBuffer;
+	vk::DeviceMemory stagingBufferMemory;
+	stagingBuffer = createBuffer(size, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, &stagingBufferMemory);
+	void* data = logicDevice.mapMemory(stagingBufferMemory, 0, size);
+	memcpy(data, levels, static_cast<size_t>(size));
+	logicDevice.unmapMemory(stagingBufferMemory);
+
+	tex.textureImage = createImage(vk::Extent3D{ width, height, 1 }, vk::Format::eR8G8B8A8Unorm, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+									vk::MemoryPropertyFlagBits::eDeviceLocal, &tex.textureImageMemory, mipLevels);
+	transitionImageLayout(tex.textureImage, vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::ePreinitialized, vk::ImageLayout::eTransferDstOptimal, mipLevels);
+
+	{
+		std::lock_guard<std::mutex> lock{ queueMutex };
+		vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
+		gpuProfiler.beginUpload(commandBuffer);
+		commandBuffer.copyBufferToImage(stagingBuffer, tex.textureImage, vk::ImageLayout::eTransferDstOptimal, regions);
+		gpuProfiler.endUpload(commandBuffer);
+		endSingleTimeCommands(commandBuffer);
+		gpuProfiler.resolveUpload();
+	}
+
+	transitionImageLayout(tex.textureImage, vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, mipLevels);
+	logicDevice.freeMemory(stagingBufferMemory);
+	logicDevice.destroyBuffer(stagingBuffer);
+
+	tex.textureImageView = createImageView(tex.textureImage, vk::Format::eR8G8B8A8Unorm, vk::ImageAspectFlagBits::eColor, mipLevels);
+
+	vk::SamplerCreateInfo samplerInfo{ vk::SamplerCreateFlags(), vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear,
+		vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, 0.0f,
+		VK_TRUE, 16, VK_FALSE, vk::CompareOp::eAlways, 0.0f, static_cast<float>(mipLevels), vk::BorderColor::eIntOpaqueBlack, VK_FALSE };
+
+	tex.sampler = logicDevice.createSampler(samplerInfo);
+	return tex;
+}
+
 GLFWwindow * VulkanBase::getWindow() const
 {
 	return window;
 }
 
+bool VulkanBase::isHeadless() const
+{
+	return headless;
+}
+
+std::vector<unsigned char> VulkanBase::readFrame() const
+{
+	if (!headless)
+	{
+		throw std::runtime_error("frame readback is supported only in headless mode!");
+	}
+	if (!frameRendered)
+	{
+		throw std::runtime_error("no frame was rendered yet!");
+	}
+	vk::DeviceSize imageSize = swapExtent.width * swapExtent.height * 4;
+	vk::Buffer stagingBuffer;
+	vk::DeviceMemory stagingBufferMemory;
+	stagingBuffer = createBuffer(imageSize, vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, &stagingBufferMemory);
+
+	//render pass leaves offscreen images in transfer source layout so we can copy them directly.
+	{
+		std::lock_guard<std::mutex> lock{ queueMutex };
+		vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
+		vk::BufferImageCopy region{ 0, 0, 0, vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 0, 0, 1 }, vk::Offset3D{ 0,0,0 }, vk::Extent3D{ swapExtent.width, swapExtent.height, 1 } };
+		commandBuffer.copyImageToBuffer(swapImages[0], vk::ImageLayout::eTransferSrcOptimal, stagingBuffer, region);
+		endSingleTimeCommands(commandBuffer);
+	}
+
+	std::vector<unsigned char> pixels(static_cast<size_t>(imageSize));
+	void* data = logicDevice.mapMemory(stagingBufferMemory, 0, imageSize);
+	memcpy(pixels.data(), data, pixels.size());
+	logicDevice.unmapMemory(stagingBufferMemory);
+
+	logicDevice.freeMemory(stagingBufferMemory);
+	logicDevice.destroyBuffer(stagingBuffer);
+	return pixels;
+}
+
+std::vector<GpuTiming> VulkanBase::getGpuTimings() const
+{
+	std::lock_guard<std::mutex> lock{ queueMutex };
+	return gpuProfiler.getTimings();
+}
+
+void VulkanBase::saveFrame(const char * filename) const
+{
+	ASSERT(filename != nullptr)
+	std::vector<unsigned char> pixels = readFrame();
+	if (stbi_write_png(filename, swapExtent.width, swapExtent.height, 4, pixels.data(), swapExtent.width * 4) == 0)
+	{
+		throw std::runtime_error("failed to write frame to a file!");
+	}
+}
+
 VulkanBase::~VulkanBase()
 {
 	logicDevice.destroySemaphore(renderFinishedSemaphore);
@@ -110,6 +239,8 @@ VulkanBase::~VulkanBase()
 	logicDevice.freeMemory(depthImageMemory);
 	logicDevice.destroyImage(depthImage);
 	logicDevice.destroyDescriptorPool(descriptorPool);
+	gpuProfiler.destroy();
+	logicDevice.destroyCommandPool(singleTimePool);
 	logicDevice.destroyCommandPool(commandPool);
 	for (auto& pipe : graphicsPipelines)
 	{
@@ -133,16 +264,21 @@ VulkanBase::~VulkanBase()
 		logicDevice.destroyImageView(view);
 	}
 	swapImageViews.clear();
+	destroyOffscreenImages();
 	logicDevice.destroySwapchainKHR(swapChain);
 	logicDevice.destroy();
 	instance.destroySurfaceKHR(surface);
-	glfwDestroyWindow(window);
+	if (window != nullptr)
+	{
+		glfwDestroyWindow(window);
+	}
 	debug::DestroyDebugReportCallbackEXT(instance, debug, nullptr);
 	instance.destroy();
 }
 
 VertexBuffer VulkanBase::createVertexBuffer(void* vertices, const size_t& bufferSize, bool useStaging) const
 {
+	PROFILE_FUNCTION()
 	VertexBuffer buffer;
 	buffer.device = &logicDevice;
 
@@ -175,10 +311,22 @@ VertexBuffer VulkanBase::createVertexBuffer(void* vertices, const size_t& buffer
 
 IndexBuffer VulkanBase::createIndexBuffer(const std::vector<uint32_t>& indices, bool useStaging) const
 {
+	return createIndexBuffer(indices.data(), static_cast<uint32_t>(indices.size()), vk::IndexType::eUint32, useStaging);
+}
+
+IndexBuffer VulkanBase::createIndexBuffer(const std::vector<uint16_t>& indices, bool useStaging) const
+{
+	return createIndexBuffer(indices.data(), static_cast<uint32_t>(indices.size()), vk::IndexType::eUint16, useStaging);
+}
+
+IndexBuffer VulkanBase::createIndexBuffer(const void * indices, uint32_t indexCount, vk::IndexType indexType, bool useStaging) const
+{
+	PROFILE_FUNCTION()
 	IndexBuffer buffer;
 	buffer.device = &logicDevice;
-	vk::DeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-	buffer.numIndices = indices.size();
+	buffer.indexType = indexType;
+	vk::DeviceSize bufferSize = static_cast<vk::DeviceSize>(buffer.getIndexSize()) * indexCount;
+	buffer.numIndices = indexCount;
 	if (useStaging)
 	{
 		vk::Buffer stagingBuffer;
@@ -186,7 +334,7 @@ IndexBuffer VulkanBase::createIndexBuffer(const std::vector<uint32_t>& indices,
 		stagingBuffer = createBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, &stagingBufferMemory);
 
 		void* data = logicDevice.mapMemory(stagingBufferMemory, 0, bufferSize);
-		memcpy(data, indices.data(), (size_t)bufferSize);
+		memcpy(data, indices, (size_t)bufferSize);
 		logicDevice.unmapMemory(stagingBufferMemory);
 
 		buffer.buffer = createBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, &buffer.memory);
@@ -199,12 +347,82 @@ IndexBuffer VulkanBase::createIndexBuffer(const std::vector<uint32_t>& indices,
 	{
 		buffer.buffer = createBuffer(bufferSize, vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eHostVisible, &buffer.memory);
 		void* data = logicDevice.mapMemory(buffer.memory, 0, bufferSize);
-		memcpy(data, indices.data(), (size_t)bufferSize);
+		memcpy(data, indices, (size_t)bufferSize);
 		logicDevice.unmapMemory(buffer.memory);
 	}
 	return buffer;
 }
 
+MeshArena VulkanBase::createMeshArena(uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t indexSize) const
+{
+	ASSERT(vertexStride > 0)
+	ASSERT(indexSize == sizeof(uint16_t) || indexSize == sizeof(uint32_t))
+	MeshArena arena;
+	arena.vertexStride = vertexStride;
+	arena.indices.indexType = indexSize == sizeof(uint16_t) ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+	reserveMeshArena(arena, std::max(vertexCapacity, 1u), std::max(indexCapacity, 1u));
+	return arena;
+}
+
+MeshRange VulkanBase::allocateMesh(MeshArena & arena, const void * vertices, uint32_t vertexCount, const void * indices, uint32_t indexCount) const
+{
+	PROFILE_FUNCTION()
+	ASSERT(arena.vertexStride > 0)
+	uint32_t indexSize = arena.indices.getIndexSize();
+	// reuse space of freed meshes if the mesh fits into it, append to the end of the buffers otherwise
+	uint32_t firstVertex = arena.vertexCount;
+	uint32_t firstIndex = arena.indexCount;
+	MeshArena::take(arena.freeVertices, vertexCount, firstVertex);
+	MeshArena::take(arena.freeIndices, indexCount, firstIndex);
+	uint32_t vertexEnd = std::max(arena.vertexCount, firstVertex + vertexCount);
+	uint32_t indexEnd = std::max(arena.indexCount, firstIndex + indexCount);
+	if (vertexEnd > arena.vertexCapacity || indexEnd > arena.indexCapacity)
+	{
+		// grow at least twice so the number of copies stays logarithmic in the number of meshes.
+		reserveMeshArena(arena, std::max(vertexEnd, arena.vertexCapacity * 2), std::max(indexEnd, arena.indexCapacity * 2));
+	}
+	MeshRange range{ firstIndex, indexCount, static_cast<int32_t>(firstVertex), vertexCount };
+	uploadToBuffer(arena.vertices, static_cast<vk::DeviceSize>(firstVertex) * arena.vertexStride, vertices, static_cast<vk::DeviceSize>(vertexCount) * arena.vertexStride);
+	uploadToBuffer(arena.indices, static_cast<vk::DeviceSize>(firstIndex) * indexSize, indices, static_cast<vk::DeviceSize>(indexCount) * indexSize);
+	arena.vertexCount = vertexEnd;
+	arena.indexCount = indexEnd;
+	arena.indices.numIndices = arena.indexCount;
+	return range;
+}
+
+void VulkanBase::reserveMeshArena(MeshArena & arena, uint32_t vertexCapacity, uint32_t indexCapacity) const
+{
+	//NOTE buffers are replaced, so command buffers recorded with the old buffers must not be submitted after this call.
+	if (vertexCapacity > arena.vertexCapacity)
+	{
+		VertexBuffer buffer;
+		buffer.device = &logicDevice;
+		buffer.buffer = createBuffer(static_cast<vk::DeviceSize>(vertexCapacity) * arena.vertexStride, vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+									vk::MemoryPropertyFlagBits::eDeviceLocal, &buffer.memory);
+		if (arena.vertexCount > 0)
+		{
+			copyBuffer(arena.vertices, buffer.buffer, static_cast<vk::DeviceSize>(arena.vertexCount) * arena.vertexStride);
+		}
+		arena.vertices = std::move(buffer);
+		arena.vertexCapacity = vertexCapacity;
+	}
+	if (indexCapacity > arena.indexCapacity)
+	{
+		IndexBuffer buffer;
+		buffer.device = &logicDevice;
+		buffer.numIndices = arena.indexCount;
+		buffer.indexType = arena.indices.indexType;
+		buffer.buffer = createBuffer(static_cast<vk::DeviceSize>(indexCapacity) * buffer.getIndexSize(), vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+									vk::MemoryPropertyFlagBits::eDeviceLocal, &buffer.memory);
+		if (arena.indexCount > 0)
+		{
+			copyBuffer(arena.indices, buffer.buffer, static_cast<vk::DeviceSize>(arena.indexCount) * buffer.getIndexSize());
+		}
+		arena.indices = std::move(buffer);
+		arena.indexCapacity = indexCapacity;
+	}
+}
+
 void VulkanBase::createInstance(const char * appName, const bool & validating)
 {
 	vk::ApplicationInfo appInfo{appName, VK_MAKE_VERSION(1, 0, 0),
@@ -253,7 +471,29 @@ void VulkanBase::createLogicalDevice(const bool & validating)
 	vk::DeviceQueueCreateInfo queueInfo{ vk::DeviceQueueCreateFlags(), queueIndex, 1, &queuePriority };
 	vk::PhysicalDeviceFeatures deviceFeatures = {};
 	deviceFeatures.fillModeNonSolid = VK_TRUE;
-	const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	//features needed for GPU culling are optional, engine falls back to drawing object by object without them.
+	vk::PhysicalDeviceFeatures supported = physDev.getFeatures();
+	deviceFeatures.multiDrawIndirect = supported.multiDrawIndirect;
+	deviceFeatures.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+	maxDrawIndirectCount = supported.multiDrawIndirect ? physDev.getProperties().limits.maxDrawIndirectCount : 1;
+	indirectDrawing = supported.drawIndirectFirstInstance == VK_TRUE && (physDev.getQueueFamilyProperties()[queueIndex].queueFlags & vk::QueueFlagBits::eCompute);
+	std::vector<const char*> deviceExtensions;
+	if (!headless)
+	{
+		deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+	bool indirectCount = false;
+#ifdef VK_KHR_draw_indirect_count
+	for (const vk::ExtensionProperties& ext : physDev.enumerateDeviceExtensionProperties())
+	{
+		if (strcmp(ext.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+		{
+			deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+			indirectCount = true;
+			break;
+		}
+	}
+#endif
 
 	vk::DeviceCreateInfo deviceInfo{ vk::DeviceCreateFlags(), 1, &queueInfo, 0, nullptr, deviceExtensions.size(), deviceExtensions.data(), &deviceFeatures };
 	if (validating)
@@ -263,6 +503,10 @@ void VulkanBase::createLogicalDevice(const bool & validating)
 	}
 
 	logicDevice = physDev.createDevice(deviceInfo);
+	if (indirectCount)
+	{
+		drawIndexedIndirectCount = reinterpret_cast<void*>(vkGetDeviceProcAddr(static_cast<VkDevice>(logicDevice), "vkCmdDrawIndexedIndirectCountKHR"));
+	}
 
 	queue = logicDevice.getQueue(queueIndex, 0);
 }
@@ -270,6 +514,11 @@ void VulkanBase::createLogicalDevice(const bool & validating)
 void VulkanBase::createSwapChain()
 {
 	ASSERT(swapExtent.width > 0 && swapExtent.height > 0)
+	if (headless)
+	{
+		createOffscreenImages();
+		return;
+	}
 	SwapChainSupportDetails detail = querySwapChainSupport(physDev, surface);
 
 	vk::SurfaceFormatKHR format = chooseSwapSurfaceFormat(detail.formats);
@@ -319,9 +568,48 @@ void VulkanBase::createSwapChain()
 	}
 }
 
+void VulkanBase::createOffscreenImages()
+{
+	destroyOffscreenImages();
+	//one image is enough since headless frames are not presented and we wait for each one to finish.
+	swapFormat = vk::Format::eR8G8B8A8Unorm;
+	swapImages.resize(1);
+	offscreenImageMemory.resize(swapImages.size());
+	swapImageViews.resize(swapImages.size());
+	for (uint32_t i = 0; i < swapImages.size(); i++)
+	{
+		swapImages[i] = createImage(vk::Extent3D{ swapExtent.width, swapExtent.height, 1 }, swapFormat, vk::ImageTiling::eOptimal,
+									vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eDeviceLocal, &offscreenImageMemory[i]);
+		swapImageViews[i] = createImageView(swapImages[i], swapFormat, vk::ImageAspectFlagBits::eColor);
+	}
+	frameRendered = false;
+}
+
+void VulkanBase::destroyOffscreenImages()
+{
+	if (offscreenImageMemory.size() == 0)
+	{
+		return;
+	}
+	for (auto& view : swapImageViews)
+	{
+		logicDevice.destroyImageView(view);
+	}
+	swapImageViews.clear();
+	for (size_t i = 0; i < swapImages.size(); i++)
+	{
+		logicDevice.destroyImage(swapImages[i]);
+		logicDevice.freeMemory(offscreenImageMemory[i]);
+	}
+	swapImages.clear();
+	offscreenImageMemory.clear();
+}
+
 void VulkanBase::recreateSwapChain()
 {
+	std::unique_lock<std::mutex> lock{ queueMutex };
 	logicDevice.waitIdle();
+	lock.unlock();
 
 	createSwapChain();
 	createRenderPass();
@@ -377,6 +665,9 @@ void VulkanBase::createCommandPool()
 {
 	vk::CommandPoolCreateInfo poolInfo{ {}, findQueueIndex(physDev, vk::QueueFlagBits::eGraphics, surface) };
 	commandPool = logicDevice.createCommandPool(poolInfo);
+	//single time commands get their own pool, so loading threads don't record into the pool of the frame's command buffers.
+	poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+	singleTimePool = logicDevice.createCommandPool(poolInfo);
 }
 
 void VulkanBase::createSemaphores()
@@ -389,8 +680,12 @@ void VulkanBase::createSemaphores()
 std::vector<const char*> VulkanBase::getRequiredExtensions(bool enableValidationLayers)
 {
 	unsigned int glfwExstensionCnt = 0;
-	const char** glfwExtension;
-	glfwExtension = glfwGetRequiredInstanceExtensions(&glfwExstensionCnt);
+	const char** glfwExtension = nullptr;
+	//headless mode doesn't present anything so it doesn't need any surface extensions.
+	if (!headless)
+	{
+		glfwExtension = glfwGetRequiredInstanceExtensions(&glfwExstensionCnt);
+	}
 
 	std::vector<const char*> extensions(glfwExstensionCnt + enableValidationLayers);
 
@@ -403,6 +698,18 @@ std::vector<const char*> VulkanBase::getRequiredExtensions(bool enableValidation
 	{
 		extensions[glfwExstensionCnt] = VK_EXT_DEBUG_REPORT_EXTENSION_NAME;
 	}
+#ifdef VK_EXT_debug_utils
+	// debug labels are enabled whenever available so profiler regions show up in captures.
+	for (const vk::ExtensionProperties& ext : vk::enumerateInstanceExtensionProperties())
+	{
+		if (strcmp(ext.extensionName, VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0)
+		{
+			extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			debugLabels = true;
+			break;
+		}
+	}
+#endif
 
 	return extensions;
 }
@@ -413,7 +720,7 @@ uint32_t VulkanBase::findQueueIndex(const vk::PhysicalDevice& device, const vk::
 
 	for (uint32_t i = 0; i < queues.size(); i++)
 	{
-		if ((queues[i].queueFlags & flags) && device.getSurfaceSupportKHR(i, present))
+		if ((queues[i].queueFlags & flags) && (!present || device.getSurfaceSupportKHR(i, present)))
 		{
 			return i;
 		}
@@ -507,7 +814,7 @@ uint32_t VulkanBase::findMemoryType(const vk::PhysicalDevice & device, uint32_t
 
 vk::CommandBuffer VulkanBase::beginSingleTimeCommands() const
 {
-	vk::CommandBufferAllocateInfo allocInfo{ commandPool, vk::CommandBufferLevel::ePrimary, 1 };
+	vk::CommandBufferAllocateInfo allocInfo{ singleTimePool, vk::CommandBufferLevel::ePrimary, 1 };
 
 	vk::CommandBuffer commandBuffer = logicDevice.allocateCommandBuffers(allocInfo)[0];
 
@@ -526,7 +833,7 @@ void VulkanBase::endSingleTimeCommands(vk::CommandBuffer commandBuffer) const
 
 	queue.submit(submitInfo, vk::Fence());
 	queue.waitIdle();
-	logicDevice.freeCommandBuffers(commandPool, commandBuffer);
+	logicDevice.freeCommandBuffers(singleTimePool, commandBuffer);
 }
 
 vk::Buffer VulkanBase::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::DeviceMemory * bufferMemory) const
@@ -549,21 +856,49 @@ vk::Buffer VulkanBase::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags us
 
 void VulkanBase::copyBuffer(vk::Buffer srcBuffer, vk::Buffer dstBuffer, vk::DeviceSize size) const
 {
+	std::lock_guard<std::mutex> lock{ queueMutex };
 	vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
+	gpuProfiler.beginUpload(commandBuffer);
 
 	vk::BufferCopy region = {0, 0, size};
 	commandBuffer.copyBuffer(srcBuffer, dstBuffer, region);
 
+	gpuProfiler.endUpload(commandBuffer);
 	endSingleTimeCommands(commandBuffer);
+	gpuProfiler.resolveUpload();
 }
 
 void VulkanBase::copyBuffer(vk::Buffer srcBuffer, vk::Buffer dstBuffer, vk::BufferCopy copyRegion) const
 {
+	std::lock_guard<std::mutex> lock{ queueMutex };
 	vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
+	gpuProfiler.beginUpload(commandBuffer);
 	
 	commandBuffer.copyBuffer(srcBuffer, dstBuffer, copyRegion);
 
+	gpuProfiler.endUpload(commandBuffer);
 	endSingleTimeCommands(commandBuffer);
+	gpuProfiler.resolveUpload();
+}
+
+void VulkanBase::uploadToBuffer(vk::Buffer dstBuffer, vk::DeviceSize offset, const void * data, vk::DeviceSize size) const
+{
+	if (size == 0)
+	{
+		return;
+	}
+	vk::Buffer stagingBuffer;
+	vk::DeviceMemory stagingBufferMemory;
+	stagingBuffer = createBuffer(size, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, &stagingBufferMemory);
+
+	void* mapped = logicDevice.mapMemory(stagingBufferMemory, 0, size);
+	memcpy(mapped, data, static_cast<size_t>(size));
+	logicDevice.unmapMemory(stagingBufferMemory);
+
+	copyBuffer(stagingBuffer, dstBuffer, vk::BufferCopy{ 0, offset, size });
+
+	logicDevice.freeMemory(stagingBufferMemory);
+	logicDevice.destroyBuffer(stagingBuffer);
 }
 
 vk::Format VulkanBase::findDepthFormat()
@@ -572,9 +907,9 @@ vk::Format VulkanBase::findDepthFormat()
 		vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eDepthStencilAttachment);
 }
 //NOTE helper only. device needs to destroy it
-vk::Image VulkanBase::createImage(vk::Extent3D extent, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::DeviceMemory * imageMemory) const
+vk::Image VulkanBase::createImage(vk::Extent3D extent, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::DeviceMemory * imageMemory, uint32_t mipLevels) const
 {
-	vk::ImageCreateInfo imageInfo{ vk::ImageCreateFlags(), vk::ImageType::e2D, format, extent, 1,1,vk::SampleCountFlagBits::e1,
+	vk::ImageCreateInfo imageInfo{ vk::ImageCreateFlags(), vk::ImageType::e2D, format, extent, mipLevels,1,vk::SampleCountFlagBits::e1,
 		tiling, usage, vk::SharingMode::eExclusive, 0, nullptr, vk::ImageLayout::ePreinitialized };
 
 	vk::Image image = logicDevice.createImage(imageInfo);
@@ -592,7 +927,9 @@ vk::Image VulkanBase::createImage(vk::Extent3D extent, vk::Format format, vk::Im
 
 void VulkanBase::copyImage(vk::Image srcImage, vk::Image dstImage, uint32_t width, uint32_t height) const
 {
+	std::lock_guard<std::mutex> lock{ queueMutex };
 	vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
+	gpuProfiler.beginUpload(commandBuffer);
 
 	vk::ImageSubresourceLayers subResource{ vk::ImageAspectFlagBits::eColor, 0, 0 ,1 };
 
@@ -600,11 +937,14 @@ void VulkanBase::copyImage(vk::Image srcImage, vk::Image dstImage, uint32_t widt
 
 	commandBuffer.copyImage(srcImage, vk::ImageLayout::eTransferSrcOptimal, dstImage,vk::ImageLayout::eTransferDstOptimal, 1, &region);
 
+	gpuProfiler.endUpload(commandBuffer);
 	endSingleTimeCommands(commandBuffer);
+	gpuProfiler.resolveUpload();
 }
 
-void VulkanBase::transitionImageLayout(vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) const
+void VulkanBase::transitionImageLayout(vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels) const
 {
+	std::lock_guard<std::mutex> lock{ queueMutex };
 	vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
 
 	vk::ImageMemoryBarrier barrier{ {},{}, oldLayout, newLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
@@ -623,7 +963,7 @@ void VulkanBase::transitionImageLayout(vk::Image image, vk::Format format, vk::I
 		barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
 	}
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -662,12 +1002,12 @@ bool VulkanBase::hasStencilComponent(vk::Format format) const
 	return format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint;
 }
 
-vk::ImageView VulkanBase::createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags) const
+vk::ImageView VulkanBase::createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags, uint32_t mipLevels) const
 {
 	vk::ImageView imageView;
 	vk::ImageViewCreateInfo viewInfo{ vk::ImageViewCreateFlags(), image, vk::ImageViewType::e2D, format,
 		vk::ComponentMapping{ vk::ComponentSwizzle::eIdentity,vk::ComponentSwizzle::eIdentity ,vk::ComponentSwizzle::eIdentity ,vk::ComponentSwizzle::eIdentity },
-		vk::ImageSubresourceRange{ aspectFlags, 0, 1, 0, 1 } };
+		vk::ImageSubresourceRange{ aspectFlags, 0, mipLevels, 0, 1 } };
 
 	imageView = logicDevice.createImageView(viewInfo);
 
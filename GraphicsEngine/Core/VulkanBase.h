@@ -5,7 +5,10 @@
 #include<vulkan\vulkan.hpp>
 #include "DynamicBuffer.h"
 #include"Pipeline.h"
+#include<deque>
+#include<mutex>
 #include"GraphicsEngine.h"
+#include"..\DebugTools\GpuProfiler.h"
 
 struct SwapChainSupportDetails;
 
@@ -21,8 +24,10 @@ public:
 		@param validation flag determining if debugging features are turned on.
 		@param screenWidth screen's width we want to set.
 		@param screenHeight screen's height we want to set.
+		@param headless flag determining if the engine renders to offscreen images instead of a window.
+		Headless mode doesn't create a window, surface or swapchain so it can run on machines without a display.
 	*/
-	virtual void init(const char* appName, const bool& validating, uint32_t screenWidth, uint32_t screenHeight);
+	virtual void init(const char* appName, const bool& validating, uint32_t screenWidth, uint32_t screenHeight, const bool headless = false);
 	/**
 		Returns the screen size.
 		@return screen size as two dimensional vector. First value is width, and second is height.
@@ -49,6 +54,32 @@ public:
 		@return IndexBuffer object created with given parameters.
 	*/
 	IndexBuffer createIndexBuffer(const std::vector<uint32_t>& indices, bool useStaging = true) const override;
+	/**
+		Creates an index buffer with 16-bit indices.
+		@param indices vector of indices.
+		@param useStaging flag used to determine if we should try to enhance performane in creation of the buffer or not.
+		@return IndexBuffer object created with given parameters.
+	*/
+	IndexBuffer createIndexBuffer(const std::vector<uint16_t>& indices, bool useStaging = true) const override;
+	/**
+		Creates an empty mesh arena. Arena stores vertices and indices of many meshes with the same vertex layout in shared buffers.
+		@param vertexStride size of a single vertex in bytes.
+		@param vertexCapacity number of vertices for which the space is initially reserved.
+		@param indexCapacity number of indices for which the space is initially reserved.
+		@param indexSize size of a single index in bytes, either 2 or 4.
+		@return created mesh arena.
+	*/
+	MeshArena createMeshArena(uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t indexSize = sizeof(uint32_t)) const override;
+	/**
+		Uploads a mesh into the arena. Arena's buffers are grown if there is not enough space left in them.
+		@param arena arena in which to store the mesh.
+		@param vertices pointer to an array of vertices in the arena's vertex layout.
+		@param vertexCount number of vertices in the array.
+		@param indices pointer to an array of indices of the arena's index size, relative to the first vertex of the mesh.
+		@param indexCount number of indices in the array.
+		@return location of the mesh inside of the arena.
+	*/
+	MeshRange allocateMesh(MeshArena& arena, const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount) const override;
 	/**
 		Creates a texture used by GPU.
 		@param pixels pointer to an array of pixels. Data needs to be in 4 channel format.
@@ -58,6 +89,15 @@ public:
 		@return VTexture object containing created texture stored in the GPU.
 	*/
 	VTexture createTexture(unsigned char* pixels, unsigned int width, unsigned int height, bool useStaging = true) const override;
+	/**
+		Creates a texture with a chain of mip levels used by GPU.
+		@param levels pointer to 4 channel pixels of all mip levels, tightly packed one after another from the coarsest to the finest level.
+		@param width width of the finest level.
+		@param height height of the finest level.
+		@param mipLevels number of mip levels, each one half the size of the previous one and at least one pixel large.
+		@return VTexture object containing created texture stored in the GPU.
+	*/
+	VTexture createMipmappedTexture(const unsigned char* levels, uint32_t width, uint32_t height, uint32_t mipLevels) const override;
 	/**
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
@@ -70,6 +110,26 @@ public:
 		@return shared pointer to the component created with given parameters.
 	*/
 	GLFWwindow* getWindow() const override;
+	/**
+		Checks if the engine renders to offscreen images instead of a window.
+		@return true if engine is headless, false otherwise.
+	*/
+	bool isHeadless() const override;
+	/**
+		Reads back the last rendered frame. Supported only in headless mode.
+		@return pixels of the frame in tightly packed 4 channel RGBA format, row by row starting from the top.
+	*/
+	std::vector<unsigned char> readFrame() const override;
+	/**
+		Saves the last rendered frame to a PNG file. Supported only in headless mode.
+		@param filename name of the file in which to store the frame.
+	*/
+	void saveFrame(const char* filename) const override;
+	/**
+		Returns GPU timings of the measured regions such as the render pass, pipeline batches and uploads.
+		@return array of timings, empty if timestamps are not supported.
+	*/
+	std::vector<GpuTiming> getGpuTimings() const override;
 	/**
 		Destructor.
 	*/
@@ -89,16 +149,26 @@ protected:
 	std::vector<vk::ImageView> swapImageViews;				//*< Array of image views used to access swapchain images.
 	vk::RenderPass renderPass;								//*< Handle for the render pass which contains the information about framebuffer attachments and how to handle them.
 	std::vector<vk::Framebuffer> swapFramebuffers;			//*< Array of framebuffers. Framebuffer is a collection of images used for a rendering operation.
-	std::vector<vk::DescriptorSetLayout> descriptorLayouts;	//*< Array of layouts used to create descriptor sets.
-	std::vector<PipelineLayout> pipelineLayouts;			//*< Array of layouts used to create pipelines.
+	std::deque<vk::DescriptorSetLayout> descriptorLayouts;	//*< Layouts used to create descriptor sets. Pipelines and sets point to them, so they don't move when layouts are added.
+	std::deque<PipelineLayout> pipelineLayouts;				//*< Layouts used to create pipelines. Pipelines point to them, so they don't move when layouts are added.
 	std::vector<Pipeline> graphicsPipelines;				//*< Array of graphics pipeline used to draw objects.
 	vk::CommandPool commandPool;							//*< Handle to a pool used to allocate command buffers.
+	vk::CommandPool singleTimePool;							//*< Handle to a pool used to allocate command buffers of single time commands, which loading threads record too.
+	mutable std::mutex queueMutex;							//*< Mutex guarding the queue, the pool of single time commands and upload timings, as Vulkan requires them to be externally synchronized.
 	vk::DescriptorPool descriptorPool;						//*< Handle to a pool used to allocate descriptor sets.
 	vk::Image depthImage;									//*< Handle to an image used for representing depth.
 	vk::DeviceMemory depthImageMemory;						//*< Handle to a memory used to store a depth image.
 	vk::ImageView depthImageView;							//*< Handel to a image view used to access depth image.
 	vk::Semaphore imageAvailableSemaphore;					//*< Semaphore used to signal when an image is avaliable so we can render to it.
 	vk::Semaphore renderFinishedSemaphore;					//*< Semapjore used to signal that rendering is finished.
+	bool headless{ false };									//*< Flag determining if we render to offscreen images instead of a window.
+	bool frameRendered{ false };							//*< Flag determining if offscreen images contain a rendered frame.
+	std::vector<vk::DeviceMemory> offscreenImageMemory;		//*< Array of memory handles of offscreen images used instead of swapchain images in headless mode.
+	mutable GpuProfiler gpuProfiler;						//*< Profiler measuring GPU time of the rendering and upload work.
+	bool debugLabels{ false };								//*< Flag determining if debug utils extension is enabled so command buffer labels can be emitted.
+	bool indirectDrawing{ false };							//*< Flag determining if the device can run culling shaders and draw with indirect commands that select per object data.
+	uint32_t maxDrawIndirectCount{ 1 };						//*< Maximum number of draws a single indirect call can issue. One if multi draw indirect is not supported.
+	void* drawIndexedIndirectCount{ nullptr };				//*< Pointer to vkCmdDrawIndexedIndirectCountKHR if draw indirect count extension is enabled, nullptr otherwise.
 
 	/**
 		Creates a buffer which is updated often.
@@ -135,6 +205,15 @@ protected:
 		Creates a swapchain which is a queue out of which we get images waiting to be presented on screen.
 	*/
 	void createSwapChain();
+	/**
+		Creates images used as render targets in headless mode.
+		Images are stored as swapchain images so the rest of the engine can use them the same way.
+	*/
+	void createOffscreenImages();
+	/**
+		Destroys images used as render targets in headless mode.
+	*/
+	void destroyOffscreenImages();
 	/**
 		Recreates swapchain and all other neccessary components which need to be recreated when swapchain is recreated.
 	*/
@@ -160,7 +239,7 @@ protected:
 	*/
 	virtual void createGraphicsPipeline() = 0;
 	/**
-	C	reates a pool out of which command buffers are allocated.
+	C	reates pools out of which command buffers are allocated.
 	*/
 	void createCommandPool();
 	/**
@@ -182,6 +261,7 @@ protected:
 	uint32_t findMemoryType(const vk::PhysicalDevice& device, uint32_t typeFilter, vk::MemoryPropertyFlags properties) const;
 	/**
 		Creates a command buffer and starts commands that will be used only once.
+		queueMutex needs to be locked until the commands are ended.
 		@return command buffer to which we submit one time commands.
 	*/
 	vk::CommandBuffer beginSingleTimeCommands() const;
@@ -213,6 +293,31 @@ protected:
 		@param copyRegion region of the buffer we want to copy.
 	*/
 	void copyBuffer(vk::Buffer srcBuffer, vk::Buffer dstBuffer, vk::BufferCopy copyRegion) const;
+	/**
+		Uploads data into a part of a device local buffer using a staging buffer.
+		@param dstBuffer buffer into which to upload the data. Needs to be created with transfer destination usage.
+		@param offset offset in bytes at which to place the data.
+		@param data pointer to the data to upload.
+		@param size size of the data in bytes.
+	*/
+	void uploadToBuffer(vk::Buffer dstBuffer, vk::DeviceSize offset, const void* data, vk::DeviceSize size) const;
+	/**
+		Grows arena's buffers so they can hold at least the given number of vertices and indices.
+		Existing contents are copied to the new buffers.
+		@param arena arena whose buffers need to grow.
+		@param vertexCapacity number of vertices the arena needs to be able to hold.
+		@param indexCapacity number of indices the arena needs to be able to hold.
+	*/
+	void reserveMeshArena(MeshArena& arena, uint32_t vertexCapacity, uint32_t indexCapacity) const;
+	/**
+		Creates an index buffer out of an array of indices.
+		@param indices pointer to an array of indices.
+		@param indexCount number of indices in the array.
+		@param indexType type of the indices.
+		@param useStaging flag used to determine if we should try to enhance performane in creation of the buffer or not.
+		@return IndexBuffer object created with given parameters.
+	*/
+	IndexBuffer createIndexBuffer(const void* indices, uint32_t indexCount, vk::IndexType indexType, bool useStaging) const;
 	/**
 		Finds which format has a depth component.
 		@param return format with depth component.
@@ -226,9 +331,10 @@ protected:
 		@param usage flags determining for what operations the image will be used.
 		@param properties properties of a memory in which the image will be stored.
 		@param[out] imageMemory pointer to a memory handle in which memory associated with the image will be stored.
+		@param mipLevels number of mip levels of the image.
 		@return created image.
 	*/
-	vk::Image createImage(vk::Extent3D extent, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::DeviceMemory* imageMemory) const;
+	vk::Image createImage(vk::Extent3D extent, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::DeviceMemory* imageMemory, uint32_t mipLevels = 1) const;
 	/**
 		Copies an image.
 		@param srcImage image we want to copy.
@@ -243,8 +349,9 @@ protected:
 		@param format image's format.
 		@param oldLayout image's current layout.
 		@param newLayout layout we want to set for the image.
+		@param mipLevels number of mip levels of the image, all of which are transitioned.
 	*/
-	void transitionImageLayout(vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) const;
+	void transitionImageLayout(vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels = 1) const;
 	/**
 		Checks if given format has a stencil component.
 		@param format handle of the format for which we want to check if it has a stencil component.
@@ -256,8 +363,9 @@ protected:
 		@param image image for which te image view is created.
 		@param format image's format.
 		@param aspectFlags flags determining which aspects of the image are included in the view.
+		@param mipLevels number of mip levels of the image included in the view.
 	*/
-	vk::ImageView createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags) const;
+	vk::ImageView createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags, uint32_t mipLevels = 1) const;
 
 private:
 	/**
@@ -315,8 +423,9 @@ inline DynamicBuffer<T> VulkanBase::createDynamicBuffer()
 {
 	DynamicBuffer<T> buff;
 	buff.device = &logicDevice;
-	buff.pool = &commandPool;
+	buff.pool = &singleTimePool;
 	buff.queue = &queue;
+	buff.queueMutex = &queueMutex;
 	vk::BufferCreateInfo bufferInfo{ vk::BufferCreateFlags(), sizeof(T), vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, 0, nullptr };
 
 	buff.uniformStagingBuffer = logicDevice.createBuffer(bufferInfo);
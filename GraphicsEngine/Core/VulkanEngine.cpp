@@ -3,22 +3,264 @@
 #include<glm\gtc\matrix_transform.hpp>
 #include<chrono>
 #include"..\DebugTools\Assert.h"
+#include"..\DebugTools\Profiler.h"
 #include"..\Graphics\Vertex.h"
 #include<tiny_obj_loader.h>
 #include<unordered_map>
+#include<algorithm>
 #include"..\Graphics\BumpMapComponent.h"
 #include"..\Graphics\ParallaxComponent.h"
+#include"MeshArena.h"
+#include"..\ResourceManagers\FileSystem.h"
+#include"..\ResourceManagers\ShaderCompiler.h"
+#include"VModel.h"
+#include<iostream>
+
+namespace
+{
+	/**
+		Names of the pipelines used to label profiler regions. Order needs to match PipelineType enumerator.
+	*/
+	const char* pipelineNames[] = { "no light", "ortho textured", "phong", "toon", "wireframe", "skybox", "bump map", "parallax" };
+	const uint32_t cullGroupSize = 64;			//*< Local size of the culling shader.
+	const uint32_t minGpuSceneCapacity = 256;	//*< Number of objects reserved when GPU scene buffers are first created.
+
+	/**
+		Checks if a changed file is a shader, so pipelines have to be recreated.
+		@param path path to the file.
+		@return true if the file is a complete SPIR-V module or a source compiled at runtime, false if it is another file or it isn't completely written yet.
+	*/
+	bool isShader(const std::string& path)
+	{
+		if (ShaderCompiler::isEnabled() && ShaderCompiler::isSource(path))
+		{
+			return true;
+		}
+		if (path.size() < 4 || path.compare(path.size() - 4, 4, ".spv") != 0)
+		{
+			return false;
+		}
+		return ShaderCompiler::isSpirv(FileSystem::open(path));
+	}
+
+	/**
+		Merges reflections of a pipeline's shaders.
+		@return reflection of the vertex shader merged with the reflection of the fragment shader.
+	*/
+	ShaderReflection merge(const Shader& vert, const Shader& frag)
+	{
+		ShaderReflection reflection = vert.getReflection();
+		reflection.merge(frag.getReflection());
+		return reflection;
+	}
+
+	/**
+		Checks if two descriptor set layouts would be created out of the same bindings.
+	*/
+	bool sameBindings(const std::vector<vk::DescriptorSetLayoutBinding>& a, const std::vector<vk::DescriptorSetLayoutBinding>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (a[i].binding != b[i].binding || a[i].descriptorType != b[i].descriptorType || a[i].descriptorCount != b[i].descriptorCount || a[i].stageFlags != b[i].stageFlags)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+		Vertex formats read by graphics pipelines.
+	*/
+	enum class VertexFormat { ePacked, ePackedTangents, e2D };
+
+	/**
+		Description of a graphics pipeline, out of which the pipeline, its indirect variant and its specialised variants are created.
+	*/
+	struct PipelineDescription
+	{
+		PipelineType type;				//*< Type of the pipeline.
+		const char* vertShader[2];		//*< Source and binary of the vertex shader.
+		const char* indirectShader[2];	//*< Source and binary of the vertex shader of the indirect variant, nullptr if the pipeline has no indirect variant.
+		const char* fragShader[2];		//*< Source and binary of the fragment shader.
+		VertexFormat format;			//*< Format of vertices read by the pipeline.
+		vk::PolygonMode polygonMode;	//*< Mode in which polygons are rasterised.
+		bool depthWrite;				//*< Flag determining if the pipeline writes depth.
+	};
+
+	/**
+		Descriptions of all graphics pipelines. Order needs to match PipelineType enumerator.
+	*/
+	const PipelineDescription pipelineDescriptions[] = {
+		{ PipelineType::eNoLight, { "shaders/simpleShader.vert", "shaders/simpleV.spv" }, { "shaders/simpleIndirect.vert", "shaders/simpleIndirectV.spv" },
+			{ "shaders/simpleTextured.frag", "shaders/simpleTexturedF.spv" }, VertexFormat::ePacked, vk::PolygonMode::eFill, true },
+		{ PipelineType::eOrthoTextured, { "shaders/orthoTextured.vert", "shaders/orthoTexturedV.spv" }, { nullptr, nullptr },
+			{ "shaders/simpleTextured.frag", "shaders/simpleTexturedF.spv" }, VertexFormat::e2D, vk::PolygonMode::eFill, true },
+		{ PipelineType::ePhong, { "shaders/lightShader.vert", "shaders/lightV.spv" }, { "shaders/lightIndirect.vert", "shaders/lightIndirectV.spv" },
+			{ "shaders/phong.frag", "shaders/phongF.spv" }, VertexFormat::ePacked, vk::PolygonMode::eFill, true },
+		{ PipelineType::eToon, { "shaders/lightShader.vert", "shaders/lightV.spv" }, { "shaders/lightIndirect.vert", "shaders/lightIndirectV.spv" },
+			{ "shaders/toon.frag", "shaders/toonF.spv" }, VertexFormat::ePacked, vk::PolygonMode::eFill, true },
+		{ PipelineType::eWireframe, { "shaders/simpleShader.vert", "shaders/simpleV.spv" }, { "shaders/simpleIndirect.vert", "shaders/simpleIndirectV.spv" },
+			{ "shaders/simpleTextured.frag", "shaders/simpleTexturedF.spv" }, VertexFormat::ePacked, vk::PolygonMode::eLine, true },
+		{ PipelineType::eSkybox, { "shaders/simpleShader.vert", "shaders/simpleV.spv" }, { "shaders/simpleIndirect.vert", "shaders/simpleIndirectV.spv" },
+			{ "shaders/simpleTextured.frag", "shaders/simpleTexturedF.spv" }, VertexFormat::ePacked, vk::PolygonMode::eFill, false },
+		{ PipelineType::eBumpMap, { "shaders/tangentSpace.vert", "shaders/tangentSpaceV.spv" }, { "shaders/tangentSpaceIndirect.vert", "shaders/tangentSpaceIndirectV.spv" },
+			{ "shaders/bumpMapPhong.frag", "shaders/bumpMapPhongF.spv" }, VertexFormat::ePackedTangents, vk::PolygonMode::eFill, true },
+		{ PipelineType::eParallax, { "shaders/tangentSpace.vert", "shaders/tangentSpaceV.spv" }, { "shaders/tangentSpaceIndirect.vert", "shaders/tangentSpaceIndirectV.spv" },
+			{ "shaders/parallaxPhong.frag", "shaders/parallaxPhongF.spv" }, VertexFormat::ePackedTangents, vk::PolygonMode::eFill, true } };
+
+	/**
+		Fixed function state and shader stages of a graphics pipeline.
+		Create info points to the other members, so the state can't be copied.
+	*/
+	struct PipelineState
+	{
+		/**
+			Constructor. Fills the state out of a pipeline's description, shaders are set separately.
+			@param description description of the pipeline.
+			@param extent extent of the swapchain images the pipeline draws to.
+			@param renderPass render pass in which the pipeline is used.
+		*/
+		PipelineState(const PipelineDescription& description, vk::Extent2D extent, vk::RenderPass renderPass)
+		{
+			switch (description.format)
+			{
+			case VertexFormat::ePacked:
+				binding = PackedVertex3DT::bindingDescription();
+				attributes = PackedVertex3DT::attributeDescriptions();
+				break;
+			case VertexFormat::ePackedTangents:
+				binding = PackedVertex3DTT::bindingDescription();
+				attributes = PackedVertex3DTT::attributeDescriptions();
+				break;
+			case VertexFormat::e2D:
+				binding = Vertex2DT::bindingDescription();
+				attributes = Vertex2DT::attributeDescriptions();
+				break;
+			}
+			vertexInput = vk::PipelineVertexInputStateCreateInfo{ vk::PipelineVertexInputStateCreateFlags(), 1, &binding, static_cast<uint32_t>(attributes.size()), attributes.data() };
+			//Defines topology input to pipeline
+			inputAssembly = vk::PipelineInputAssemblyStateCreateInfo{ vk::PipelineInputAssemblyStateCreateFlags(), vk::PrimitiveTopology::eTriangleList, VK_FALSE };
+			viewport = vk::Viewport{ 0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f };
+			scissor = vk::Rect2D{ vk::Offset2D{ 0,0 }, extent };
+			viewportState = vk::PipelineViewportStateCreateInfo{ vk::PipelineViewportStateCreateFlags(), 1, &viewport, 1, &scissor };
+			rasterizer = vk::PipelineRasterizationStateCreateInfo{ vk::PipelineRasterizationStateCreateFlags(), VK_FALSE, VK_FALSE, description.polygonMode,
+				vk::CullModeFlagBits::eBack , vk::FrontFace::eCounterClockwise, VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f };
+			multisampling = vk::PipelineMultisampleStateCreateInfo{ vk::PipelineMultisampleStateCreateFlags(), vk::SampleCountFlagBits::e1, VK_FALSE, 1.0f, nullptr,
+				VK_FALSE, VK_FALSE };
+			depthStencil = vk::PipelineDepthStencilStateCreateInfo{ vk::PipelineDepthStencilStateCreateFlags(), VK_TRUE, description.depthWrite ? VK_TRUE : VK_FALSE,
+				vk::CompareOp::eLessOrEqual, VK_FALSE, VK_FALSE, vk::StencilOpState(), vk::StencilOpState(), 0.0f, 1.0f };
+			colorBlendAttachment = vk::PipelineColorBlendAttachmentState{ VK_TRUE, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd,
+				vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd,
+				vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA };
+			colorBlending = vk::PipelineColorBlendStateCreateInfo{ vk::PipelineColorBlendStateCreateFlags(), VK_FALSE, vk::LogicOp::eCopy,
+				1, &colorBlendAttachment, { { 0.0f,0.0f,0.0f,0.0f } } };
+			info = vk::GraphicsPipelineCreateInfo{ vk::PipelineCreateFlags(), 2, stages, &vertexInput, &inputAssembly,
+				nullptr, &viewportState, &rasterizer, &multisampling, &depthStencil, &colorBlending,
+				nullptr, vk::PipelineLayout(), renderPass, 0, vk::Pipeline(), -1 };
+		}
+		PipelineState(PipelineState& x) = delete;
+		PipelineState& operator=(PipelineState& x) = delete;
+		/**
+			Sets shaders of the pipeline and specialises both of them with constants. Constants a shader doesn't declare don't affect it.
+			@param vert create info of the vertex shader, its module needs to exist until the pipeline is created.
+			@param frag create info of the fragment shader, its module needs to exist until the pipeline is created.
+			@param constants values of specialization constants, empty to use the defaults declared in shaders.
+		*/
+		void setShaders(const vk::PipelineShaderStageCreateInfo& vert, const vk::PipelineShaderStageCreateInfo& frag, const std::vector<SpecializationConstant>& constants)
+		{
+			stages[0] = vert;
+			stages[1] = frag;
+			if (constants.empty())
+			{
+				return;
+			}
+			for (const SpecializationConstant& constant : constants)
+			{
+				entries.push_back(vk::SpecializationMapEntry{ static_cast<uint32_t>(constant.id), static_cast<uint32_t>(data.size() * sizeof(uint32_t)), sizeof(uint32_t) });
+				data.push_back(constant.value);
+			}
+			specialization = vk::SpecializationInfo{ static_cast<uint32_t>(entries.size()), entries.data(), data.size() * sizeof(uint32_t), data.data() };
+			stages[0].setPSpecializationInfo(&specialization);
+			stages[1].setPSpecializationInfo(&specialization);
+		}
+		vk::VertexInputBindingDescription binding;
+		std::vector<vk::VertexInputAttributeDescription> attributes;
+		vk::PipelineVertexInputStateCreateInfo vertexInput;
+		vk::PipelineInputAssemblyStateCreateInfo inputAssembly;
+		vk::Viewport viewport;
+		vk::Rect2D scissor;
+		vk::PipelineViewportStateCreateInfo viewportState;
+		vk::PipelineRasterizationStateCreateInfo rasterizer;
+		vk::PipelineMultisampleStateCreateInfo multisampling;
+		vk::PipelineDepthStencilStateCreateInfo depthStencil;
+		vk::PipelineColorBlendAttachmentState colorBlendAttachment;
+		vk::PipelineColorBlendStateCreateInfo colorBlending;
+		std::vector<vk::SpecializationMapEntry> entries;
+		std::vector<uint32_t> data;
+		vk::SpecializationInfo specialization;
+		vk::PipelineShaderStageCreateInfo stages[2];
+		vk::GraphicsPipelineCreateInfo info;
+	};
+
+	/**
+		Creates a graphics pipeline. Called on worker threads, so nothing but the device and the internally synchronised cache is shared with other threads.
+		@param device device which creates the pipeline.
+		@param cache pipeline cache.
+		@param description description of the pipeline.
+		@param vert create info of the vertex shader, its module needs to exist until the pipeline is created.
+		@param frag create info of the fragment shader, its module needs to exist until the pipeline is created.
+		@param constants values of specialization constants, empty to use the defaults declared in shaders.
+		@param layout layout of the pipeline.
+		@param extent extent of the swapchain images the pipeline draws to.
+		@param renderPass render pass in which the pipeline is used.
+		@return handle of the created pipeline.
+	*/
+	vk::Pipeline buildPipeline(const vk::Device* device, vk::PipelineCache cache, const PipelineDescription& description, const vk::PipelineShaderStageCreateInfo& vert,
+		const vk::PipelineShaderStageCreateInfo& frag, const std::vector<SpecializationConstant>& constants, vk::PipelineLayout layout, vk::Extent2D extent, vk::RenderPass renderPass)
+	{
+		PipelineState state{ description, extent, renderPass };
+		state.setShaders(vert, frag, constants);
+		state.info.setLayout(layout);
+		return device->createGraphicsPipeline(cache, state.info);
+	}
+
+	/**
+		Creates a specialised pipeline. Called on worker threads, shaders are loaded by the worker as well.
+		@param device device which creates the pipeline.
+		@param cache pipeline cache.
+		@param description description of the pipeline.
+		@param indirect true if the indirect variant of the pipeline is created, false otherwise.
+		@param constants values of specialization constants.
+		@param layout layout of the base pipeline.
+		@param extent extent of the swapchain images the pipeline draws to.
+		@param renderPass render pass in which the pipeline is used.
+		@return handle of the created pipeline.
+	*/
+	vk::Pipeline createSpecialisedPipeline(const vk::Device* device, vk::PipelineCache cache, const PipelineDescription& description, bool indirect,
+		const std::vector<SpecializationConstant>& constants, vk::PipelineLayout layout, vk::Extent2D extent, vk::RenderPass renderPass)
+	{
+		const char* const* vertFiles = indirect ? description.indirectShader : description.vertShader;
+		Shader vertShader{ device, vertFiles[0], vertFiles[1] };
+		Shader fragShader{ device, description.fragShader[0], description.fragShader[1] };
+		return buildPipeline(device, cache, description, vertShader.getCreateInfo(), fragShader.getCreateInfo(), constants, layout, extent, renderPass);
+	}
+}
 
 VulkanEngine::VulkanEngine() : textureManager{ this }, modelManager{ this } {}
 
-std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id, const char * model, const char * texFilename, PipelineType pipeline, int layer, ModelType loadType)
+std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, PipelineType pipeline, int layer, ModelType loadType)
 {
 	Pipeline graphPipeline = getPipeline(pipeline);
 	std::shared_ptr<GraphicsComponent> item = std::make_shared<GraphicsComponent>();
 	item->uniform = createDynamicBuffer<glm::mat4>();
 
-	item->model = modelManager.get(std::string(model), loadType);
-	item->texture = textureManager.get(std::string(texFilename));
+	item->model = modelManager.get(model, loadType);
+	item->texture = textureManager.get(texFilename);
 	item->layer = layer;
 
 	vk::DescriptorSetLayout layouts[] = { *graphPipeline.layout->getLocalSet() };
@@ -38,18 +280,19 @@ std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id,
 		vk::WriteDescriptorSet{ item->descriptor, 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr } };
 
 	logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+	item->textureVersion = item->getTextureVersion();
 	return item;
 }
 
-std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id, const char * model, const char * texFilename, const char * normalMap, PipelineType pipeline, int layer)
+std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, const AssetId& normalMap, PipelineType pipeline, int layer)
 {
 	Pipeline graphPipeline = getPipeline(pipeline);
 	std::shared_ptr<BumpMapComponent> item = std::make_shared<BumpMapComponent>();
 	item->uniform = createDynamicBuffer<glm::mat4>();
 
-	item->model = modelManager.get(std::string(model), ModelType::e3DTangent);
-	item->texture = textureManager.get(std::string(texFilename));
-	item->normalMap = textureManager.get(std::string(normalMap));
+	item->model = modelManager.get(model, ModelType::e3DTangent);
+	item->texture = textureManager.get(texFilename);
+	item->normalMap = textureManager.get(normalMap);
 	item->layer = layer;
 
 	vk::DescriptorSetLayout layouts[] = { *graphPipeline.layout->getLocalSet() };
@@ -72,19 +315,20 @@ std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id,
 		vk::WriteDescriptorSet{ item->descriptor, 2, 0, 1, vk::DescriptorType::eCombinedImageSampler, &normalMapInfo, nullptr, nullptr } };
 
 	logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+	item->textureVersion = item->getTextureVersion();
 	return item;
 }
 
-std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id, const char * model, const char * texFilename, const char * normalMap, const char * depthMap, PipelineType pipeline, int layer)
+std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, const AssetId& normalMap, const AssetId& depthMap, PipelineType pipeline, int layer)
 {
 	Pipeline graphPipeline = getPipeline(pipeline);
 	std::shared_ptr<ParallaxComponent> item = std::make_shared<ParallaxComponent>();
 	item->uniform = createDynamicBuffer<glm::mat4>();
 
-	item->model = modelManager.get(std::string(model), ModelType::e3DTangent);
-	item->texture = textureManager.get(std::string(texFilename));
-	item->normalMap = textureManager.get(std::string(normalMap));
-	item->depthMap = textureManager.get(std::string(depthMap));
+	item->model = modelManager.get(model, ModelType::e3DTangent);
+	item->texture = textureManager.get(texFilename);
+	item->normalMap = textureManager.get(normalMap);
+	item->depthMap = textureManager.get(depthMap);
 	item->layer = layer;
 
 	vk::DescriptorSetLayout layouts[] = { *graphPipeline.layout->getLocalSet() };
@@ -109,15 +353,20 @@ std::shared_ptr<GraphicsComponent> VulkanEngine::createGraphicsComponent(int id,
 		vk::WriteDescriptorSet{ item->descriptor, 3, 0, 1, vk::DescriptorType::eCombinedImageSampler, &depthMapInfo, nullptr, nullptr } };
 
 	logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+	item->textureVersion = item->getTextureVersion();
 	return item;
 }
 
 void VulkanEngine::update(int sceneId)
 {
+	PROFILE_FUNCTION()
 	if (commandBuffers.size() > 0)
 	{
 		logicDevice.freeCommandBuffers(commandPool, commandBuffers);
 	}
+	reloadAssets();
+	//pipelines are created in the background while the application loads its assets or after a shader reload, they are first needed here.
+	waitForPipelines();
 	ASSERT(scenes[sceneId].id == sceneId)
 	std::vector<DescriptorSet>& sets = scenes[sceneId].descriptors; 
 	std::list<std::shared_ptr<GraphicsComponent>>& components = scenes[sceneId].items;
@@ -125,116 +374,360 @@ void VulkanEngine::update(int sceneId)
 	{
 		return;
 	}
+	GpuScene& gpu = scenes[sceneId].gpu;
+	streamTextures(scenes[sceneId]);
+	//models are reloaded after the scene uploaded its transformations, components of reloaded models upload the new dequantization before they are drawn.
+	for (const std::shared_ptr<GraphicsComponent>& component : components)
+	{
+		if (component->uploaded && component->modelVersion != component->model->version)
+		{
+			component->updateUniform(component->transform);
+		}
+	}
+	updateGpuScene(scenes[sceneId]);
+	updateSpecialisedPipelines(scenes[sceneId]);
 
 	vk::CommandBufferAllocateInfo bufferInfo{ commandPool, vk::CommandBufferLevel::ePrimary, swapFramebuffers.size() };
 	commandBuffers = logicDevice.allocateCommandBuffers(bufferInfo);
+	{
+		//timings of the previous frame are added to the history which uploads on loading threads write to as well.
+		std::lock_guard<std::mutex> lock{ queueMutex };
+		gpuProfiler.beginFrame();
+	}
 
 	for (size_t i = 0; i < commandBuffers.size(); i++)
 	{
 		vk::CommandBufferBeginInfo beginInfo{ vk::CommandBufferUsageFlagBits::eSimultaneousUse, nullptr };
 
 		commandBuffers[i].begin(beginInfo);
+		gpuProfiler.beginRecording(commandBuffers[i]);
+		if (gpu.objectCount > 0)
+		{
+			uint32_t cullRegion = gpuProfiler.beginRegion(commandBuffers[i], "culling");
+			recordCulling(commandBuffers[i], gpu);
+			gpuProfiler.endRegion(commandBuffers[i], cullRegion);
+		}
+		uint32_t passRegion = gpuProfiler.beginRegion(commandBuffers[i], "render pass");
 
 		std::array<vk::ClearValue, 2> clearValues{ vk::ClearColorValue{ std::array<float, 4>{0.1f, 0.1f, 0.1f, 1.0f} }, vk::ClearDepthStencilValue{ 1.0f, 0 } };
 		vk::RenderPassBeginInfo renderPassInfo{ renderPass, swapFramebuffers[i], vk::Rect2D{ { 0,0 }, swapExtent }, clearValues.size(), clearValues.data() };
 
 		commandBuffers[i].beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
 
-		PipelineType current = components.front()->getDrawType();
-		int index = static_cast<int>(current);
-
-		std::vector<DescriptorSet>::iterator it;
-		for (it = sets.begin(); it != sets.end(); it++)
+		const Pipeline* bound = nullptr;
+		uint32_t batchRegion = 0;
+		const MeshArena* boundArena = nullptr;	// Vertex and index buffers stay bound across pipeline changes, so arenas are only rebound when they change.
+		for (const DrawBatch& batch : gpu.batches)
 		{
-			if (it->getUsage() == graphicsPipelines[index].globalReq && it->getDescriptorLayout() == *graphicsPipelines[index].layout->getGlobalSet())
+			int index = static_cast<int>(batch.type);
+			const Pipeline* pipeline = selectPipeline(scenes[sceneId], batch);
+			if (pipeline != bound)
 			{
-				break;
-			}
-		}
-		ASSERT(it != sets.end())
+				if (bound != nullptr)
+				{
+					gpuProfiler.endRegion(commandBuffers[i], batchRegion);
+				}
+				batchRegion = gpuProfiler.beginRegion(commandBuffers[i], pipelineNames[index]);
 
-		commandBuffers[i].bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipelines[index].handle);
-		commandBuffers[i].bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *graphicsPipelines[index].layout, 0, vk::ArrayProxy<const vk::DescriptorSet>(*it), nullptr);
-		for (const std::shared_ptr<GraphicsComponent> component : components)
-		{
-			if (component->getDrawType() != current)
+				commandBuffers[i].bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->handle);
+				//index of the pipeline's global set is computed when the pipeline is created.
+				if (pipeline->globalSet != Pipeline::noGlobalSet)
+				{
+					ASSERT(pipeline->globalSet < sets.size())
+					commandBuffers[i].bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline->layout, 0, vk::ArrayProxy<const vk::DescriptorSet>(sets[pipeline->globalSet]), nullptr);
+				}
+				bound = pipeline;
+			}
+			if (batch.indirect)
 			{
-				current = component->getDrawType();
-				index = static_cast<int>(current);
-
-				std::vector<DescriptorSet>::iterator it;
-				for (it = sets.begin(); it != sets.end(); it++)
+				const GraphicsComponent& first = **batch.begin;
+				if (first.model->arena.get() != boundArena)
 				{
-					if (it->getUsage() == graphicsPipelines[index].globalReq && it->getDescriptorLayout() == *graphicsPipelines[index].layout->getGlobalSet())
-					{
-						break;
-					}
+					boundArena = first.model->arena.get();
+					boundArena->bind(commandBuffers[i]);
 				}
-
-				commandBuffers[i].bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipelines[index].handle);
-				if (it != sets.end())
+				// All components in the batch share textures, so descriptor of the first one is used and transformations come from the storage buffer.
+				std::array<vk::DescriptorSet, 2> batchSets{ first.descriptor, gpu.drawSet };
+				commandBuffers[i].bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline->layout, 1, batchSets, nullptr);
+				drawBatch(commandBuffers[i], gpu, batch, static_cast<uint32_t>(&batch - gpu.batches.data()));
+			}
+			else
+			{
+				for (auto it = batch.begin; it != batch.end; it++)
 				{
-					commandBuffers[i].bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *graphicsPipelines[index].layout, 0, vk::ArrayProxy<const vk::DescriptorSet>(*it), nullptr);
+					const std::shared_ptr<GraphicsComponent>& component = *it;
+					// Components hidden by the scene's culling pass are skipped.
+					if (!component->visible)
+					{
+						continue;
+					}
+					if (component->model->arena.get() != boundArena)
+					{
+						boundArena = component->model->arena.get();
+						boundArena->bind(commandBuffers[i]);
+					}
+					component->draw(commandBuffers[i], *pipeline);
 				}
 			}
-			component->draw(commandBuffers[i], graphicsPipelines[index]);
 		}
+		gpuProfiler.endRegion(commandBuffers[i], batchRegion);
 		commandBuffers[i].endRenderPass();
+		gpuProfiler.endRegion(commandBuffers[i], passRegion);
 		commandBuffers[i].end();
 	}
 }
 
-GlobalBuffers VulkanEngine::createGlobalBuffers()
+void VulkanEngine::streamTextures(SceneGraphics & scene)
 {
-	GlobalBuffers buffers;
-	buffers.transform = createDynamicBuffer<glm::mat4>();
-	buffers.light = createDynamicBuffer<glm::vec3>();
-	buffers.camera = createDynamicBuffer<glm::vec3>();
-	return buffers;
+	PROFILE_FUNCTION()
+	VTexture* textures[GraphicsComponent::maxTextures];
+	if (textureManager.isStreaming())
+	{
+		for (const std::shared_ptr<GraphicsComponent>& component : scene.items)
+		{
+			if (!component->visible)
+			{
+				continue;
+			}
+			float pixels = component->coverage * swapExtent.height;
+			uint32_t count = component->getTextures(textures);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				textures[i]->request(pixels);
+			}
+		}
+		textureManager.stream();
+	}
+	//descriptors written before an image of a texture was replaced refer to the destroyed image, also when it happened while another scene was drawn.
+	for (const std::shared_ptr<GraphicsComponent>& component : scene.items)
+	{
+		uint32_t version = component->getTextureVersion();
+		if (version == component->textureVersion)
+		{
+			continue;
+		}
+		uint32_t count = component->getTextures(textures);
+		std::array<vk::DescriptorImageInfo, GraphicsComponent::maxTextures> imageInfos;
+		std::vector<vk::WriteDescriptorSet> descriptorWrites;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			imageInfos[i] = vk::DescriptorImageInfo{ textures[i]->getSampler(), textures[i]->getImageView(), vk::ImageLayout::eShaderReadOnlyOptimal };
+			descriptorWrites.push_back(vk::WriteDescriptorSet{ component->descriptor, i + 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfos[i], nullptr, nullptr });
+		}
+		logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+		component->textureVersion = version;
+	}
 }
 
-std::vector<DescriptorSet> VulkanEngine::createGlobalDescriptors(const GlobalBuffers & buffers)
+void VulkanEngine::reloadAssets()
 {
-	std::vector<DescriptorSet> sets{ 3 };
-	//Create first set with only pv transform.
-	vk::DescriptorSetLayout layouts[] = { descriptorLayouts[0] };
-	vk::DescriptorSetAllocateInfo allocInfo{ descriptorPool, 1, layouts };
-	sets[0] = DescriptorSet(logicDevice.allocateDescriptorSets(allocInfo)[0], &descriptorLayouts[0], ShaderUsage::VS_PVTransform);
-	sets[0].setDestructor(&logicDevice, &descriptorPool);
+	PROFILE_FUNCTION()
+	if (!watcher)
+	{
+		return;
+	}
+	bool shaderChanged = false;
+	for (const std::string& path : watcher->takeChanges())
+	{
+		textureManager.reload(path);
+		modelManager.reload(path);
+		shaderChanged = isShader(path) || shaderChanged;
+	}
+	textureManager.applyReloads();
+	modelManager.applyReloads();
+	// pipelines share layouts and fixed function state, so they are all recreated like when the swapchain is
+	if (shaderChanged)
+	{
+		std::unique_lock<std::mutex> lock{ queueMutex };
+		logicDevice.waitIdle();
+		lock.unlock();
+		createGraphicsPipeline();
+	}
+}
 
-	vk::DescriptorBufferInfo transformInfo{ buffers.transform, 0, buffers.transform.size() };
-	vk::DescriptorBufferInfo lightInfo{ buffers.light, 0, buffers.light.size() };
-	vk::DescriptorBufferInfo cameraInfo{ buffers.camera, 0, buffers.camera.size() };
+void VulkanEngine::updateGpuScene(SceneGraphics & scene)
+{
+	PROFILE_FUNCTION()
+	GpuScene& gpu = scene.gpu;
+	// Batches are rebuilt every update. It is a single pass over the components, while recording stays proportional to the number of batches.
+	gpu.batches.clear();
+	uint32_t count = 0;
+	for (auto it = scene.items.cbegin(); it != scene.items.cend(); it++)
+	{
+		const GraphicsComponent& component = **it;
+		int index = static_cast<int>(component.drawType);
+		bool indirect = gpuCulling && indirectPipelines[index].handle;
+		bool fits = false;
+		if (!gpu.batches.empty())
+		{
+			const DrawBatch& last = gpu.batches.back();
+			const GraphicsComponent& first = **last.begin;
+			fits = last.type == component.drawType && last.indirect == indirect &&
+				(!indirect || (first.model->arena == component.model->arena && first.sharesMaterial(component)));
+		}
+		if (!fits)
+		{
+			gpu.batches.push_back(DrawBatch{ component.drawType, it, it, count, 0, indirect });
+		}
+		gpu.batches.back().end = std::next(it);
+		gpu.batches.back().drawCount++;
+		count++;
+	}
 
-	std::vector<vk::WriteDescriptorSet> descriptorWrites{
-		vk::WriteDescriptorSet{ sets[0], 0,0,1,vk::DescriptorType::eUniformBuffer, nullptr, &transformInfo, nullptr } };
+	if (!gpuCulling)
+	{
+		gpu.objectCount = 0;
+		return;
+	}
+	reserveGpuScene(gpu, count);
+	// Every component gets an object slot, even the ones drawn directly, so slot of an object is also its draw command index.
+	uint32_t object = 0;
+	for (uint32_t batch = 0; batch < gpu.batches.size(); batch++)
+	{
+		const DrawBatch& current = gpu.batches[batch];
+		for (auto it = current.begin; it != current.end; it++, object++)
+		{
+			const GraphicsComponent& component = **it;
+			const VModel& model = *component.model;
+			GpuObject& data = gpu.objects[object];
+			// Bounds are stored in quantised space, as the uploaded transformation decodes quantised positions
+			glm::vec3 center = ((model.boundsMin + model.boundsMax) * 0.5f - glm::vec3{ model.quantization }) / model.quantization.w;
+			data.bounds = glm::vec4{ center, glm::length(model.boundsMax - model.boundsMin) * 0.5f / model.quantization.w };
+			const MeshRange& range = model.getLod(component.lod);
+			data.firstIndex = range.firstIndex;
+			data.indexCount = range.indexCount;
+			data.vertexOffset = range.vertexOffset;
+			data.batch = batch;
+			data.batchFirst = current.firstDraw;
+			data.flags = current.indirect && component.visible ? 0 : GpuObject::eHidden;
+			// Skybox surrounds the camera so it is never culled.
+			if (component.drawType == PipelineType::eSkybox)
+			{
+				data.flags |= GpuObject::eNoCull;
+			}
+			gpu.transforms[object] = component.transform * model.getDequantization();
+		}
+	}
+	gpu.objectCount = count;
+}
 
-	logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+void VulkanEngine::reserveGpuScene(GpuScene & gpu, uint32_t count)
+{
+	if (count <= gpu.capacity)
+	{
+		return;
+	}
+	//NOTE buffers are replaced, so command buffers recorded with the old buffers must not be submitted after this call.
+	uint32_t capacity = std::max(count, std::max(gpu.capacity * 2, minGpuSceneCapacity));
+	gpu.clear();
+	gpu.device = &logicDevice;
+	gpu.capacity = capacity;
+
+	vk::DeviceSize objectSize = sizeof(GpuObject) * capacity;
+	vk::DeviceSize transformSize = sizeof(glm::mat4) * capacity;
+	vk::DeviceSize commandSize = sizeof(vk::DrawIndexedIndirectCommand) * capacity;
+	vk::DeviceSize countSize = sizeof(uint32_t) * capacity;
+	gpu.objectBuffer = createBuffer(objectSize, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, &gpu.objectMemory);
+	gpu.transformBuffer = createBuffer(transformSize, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, &gpu.transformMemory);
+	gpu.commandBuffer = createBuffer(commandSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, &gpu.commandMemory);
+	gpu.countBuffer = createBuffer(countSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal, &gpu.countMemory);
+	gpu.objects = static_cast<GpuObject*>(logicDevice.mapMemory(gpu.objectMemory, 0, objectSize));
+	gpu.transforms = static_cast<glm::mat4*>(logicDevice.mapMemory(gpu.transformMemory, 0, transformSize));
+
+	if (!vk::DescriptorSet(gpu.cullSet))
+	{
+		vk::DescriptorSetLayout layouts[] = { *cullSetLayout, *objectSetLayout };
+		vk::DescriptorSetAllocateInfo allocInfo{ descriptorPool, 2, layouts };
+		std::vector<vk::DescriptorSet> allocated = logicDevice.allocateDescriptorSets(allocInfo);
+		gpu.cullSet = DescriptorSet{ allocated[0], cullSetLayout, ShaderUsage::Empty };
+		gpu.cullSet.setDestructor(&logicDevice, &descriptorPool);
+		gpu.drawSet = DescriptorSet{ allocated[1], objectSetLayout, ShaderUsage::Empty };
+		gpu.drawSet.setDestructor(&logicDevice, &descriptorPool);
+	}
 
-	//Create second set with pv transform and light.
-	layouts[0] = descriptorLayouts[2];
-	sets[1]  = DescriptorSet(logicDevice.allocateDescriptorSets(allocInfo)[0], &descriptorLayouts[2], ShaderUsage::VS_PVTransform | ShaderUsage::VS_Light);
-	sets[1].setDestructor(&logicDevice, &descriptorPool);
+	vk::DescriptorBufferInfo objectInfo{ gpu.objectBuffer, 0, objectSize };
+	vk::DescriptorBufferInfo transformInfo{ gpu.transformBuffer, 0, transformSize };
+	vk::DescriptorBufferInfo commandInfo{ gpu.commandBuffer, 0, commandSize };
+	vk::DescriptorBufferInfo countInfo{ gpu.countBuffer, 0, countSize };
+	vk::DescriptorBufferInfo cameraInfo{ gpu.cameraBuffer, 0, sizeof(glm::mat4) };
 
-	std::vector<vk::WriteDescriptorSet> descriptorWritesLight{
-		vk::WriteDescriptorSet{ sets[1], 0,0,1,vk::DescriptorType::eUniformBuffer, nullptr, &transformInfo, nullptr },
-		vk::WriteDescriptorSet{ sets[1], 1,0,1,vk::DescriptorType::eUniformBuffer, nullptr, &lightInfo, nullptr } };
+	std::vector<vk::WriteDescriptorSet> descriptorWrites{
+		vk::WriteDescriptorSet{ gpu.cullSet, 0, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &objectInfo, nullptr },
+		vk::WriteDescriptorSet{ gpu.cullSet, 1, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &transformInfo, nullptr },
+		vk::WriteDescriptorSet{ gpu.cullSet, 2, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &commandInfo, nullptr },
+		vk::WriteDescriptorSet{ gpu.cullSet, 3, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &countInfo, nullptr },
+		vk::WriteDescriptorSet{ gpu.cullSet, 4, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &cameraInfo, nullptr },
+		vk::WriteDescriptorSet{ gpu.drawSet, 0, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &transformInfo, nullptr } };
 
-	logicDevice.updateDescriptorSets(descriptorWritesLight, nullptr);
+	logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+}
 
-	//Create second set with pv transform, light and camera position.
-	layouts[0] = descriptorLayouts[4];
-	sets[2] = DescriptorSet(logicDevice.allocateDescriptorSets(allocInfo)[0], &descriptorLayouts[4], ShaderUsage::VS_PVTransform | ShaderUsage::VS_Light | ShaderUsage::VS_CameraPos);
-	sets[2].setDestructor(&logicDevice, &descriptorPool);
+void VulkanEngine::recordCulling(const vk::CommandBuffer & buffer, const GpuScene & gpu)
+{
+	buffer.fillBuffer(gpu.countBuffer, 0, sizeof(uint32_t) * gpu.batches.size(), 0);
+	vk::MemoryBarrier clearBarrier{ vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite };
+	buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), clearBarrier, nullptr, nullptr);
+
+	buffer.bindPipeline(vk::PipelineBindPoint::eCompute, cullPipeline);
+	buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *cullLayout, 0, vk::ArrayProxy<const vk::DescriptorSet>(gpu.cullSet), nullptr);
+	// Compaction is only useful when the number of draws can be read from the count buffer.
+	std::array<uint32_t, 2> parameters{ gpu.objectCount, drawIndexedIndirectCount != nullptr ? 1u : 0u };
+	buffer.pushConstants<uint32_t>(*cullLayout, vk::ShaderStageFlagBits::eCompute, 0, parameters);
+	buffer.dispatch((gpu.objectCount + cullGroupSize - 1) / cullGroupSize, 1, 1);
+
+	vk::MemoryBarrier cullBarrier{ vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead };
+	buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, vk::DependencyFlags(), cullBarrier, nullptr, nullptr);
+}
 
-	std::vector<vk::WriteDescriptorSet> descriptorWritesCamera{
-		vk::WriteDescriptorSet{ sets[2], 0,0,1,vk::DescriptorType::eUniformBuffer, nullptr, &transformInfo, nullptr },
-		vk::WriteDescriptorSet{ sets[2], 1,0,1,vk::DescriptorType::eUniformBuffer, nullptr, &lightInfo, nullptr },
-		vk::WriteDescriptorSet{ sets[2], 2,0,1,vk::DescriptorType::eUniformBuffer, nullptr, &cameraInfo, nullptr } };
+void VulkanEngine::drawBatch(const vk::CommandBuffer & buffer, const GpuScene & gpu, const DrawBatch & batch, uint32_t batchIndex)
+{
+	const uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+	vk::DeviceSize offset = static_cast<vk::DeviceSize>(batch.firstDraw) * stride;
+#ifdef VK_KHR_draw_indirect_count
+	if (drawIndexedIndirectCount != nullptr && batch.drawCount <= maxDrawIndirectCount)
+	{
+		reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(drawIndexedIndirectCount)(static_cast<VkCommandBuffer>(buffer), gpu.commandBuffer, offset,
+																						gpu.countBuffer, batchIndex * sizeof(uint32_t), batch.drawCount, stride);
+		return;
+	}
+#endif
+	// Without multi draw indirect only one draw per call is allowed. Culling still happens on the GPU, but recording becomes per object.
+	for (uint32_t first = 0; first < batch.drawCount; first += maxDrawIndirectCount)
+	{
+		uint32_t count = std::min(batch.drawCount - first, maxDrawIndirectCount);
+		buffer.drawIndexedIndirect(gpu.commandBuffer, offset + static_cast<vk::DeviceSize>(first) * stride, count, stride);
+	}
+}
 
-	logicDevice.updateDescriptorSets(descriptorWritesCamera, nullptr);
+GlobalBuffers VulkanEngine::createGlobalBuffers()
+{
+	GlobalBuffers buffers;
+	buffers.transform = createDynamicBuffer<glm::mat4>();
+	buffers.light = createDynamicBuffer<glm::vec3>();
+	buffers.camera = createDynamicBuffer<glm::vec3>();
+	return buffers;
+}
 
-	return sets;
+void VulkanEngine::createGlobalDescriptors(SceneGraphics& scene)
+{
+	//Global layouts are only ever added, so sets created earlier keep their indices.
+	for (size_t i = scene.descriptors.size(); i < globalLayouts.size(); i++)
+	{
+		const GlobalSetLayout& global = globalLayouts[i];
+		vk::DescriptorSetLayout layouts[] = { *global.layout };
+		vk::DescriptorSetAllocateInfo allocInfo{ descriptorPool, 1, layouts };
+		DescriptorSet set{ logicDevice.allocateDescriptorSets(allocInfo)[0], global.layout, global.usage };
+		set.setDestructor(&logicDevice, &descriptorPool);
+
+		std::vector<vk::WriteDescriptorSet> descriptorWrites;
+		for (const vk::DescriptorSetLayoutBinding& binding : global.bindings)
+		{
+			ASSERT(binding.binding < scene.globalBuffers.size() && binding.descriptorType == vk::DescriptorType::eUniformBuffer)
+			descriptorWrites.push_back(vk::WriteDescriptorSet{ set, binding.binding, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &scene.globalBuffers[binding.binding], nullptr });
+		}
+		logicDevice.updateDescriptorSets(descriptorWrites, nullptr);
+		scene.descriptors.push_back(std::move(set));
+	}
 }
 
 int VulkanEngine::registerScene(const GlobalBuffers & buffers)
@@ -247,7 +740,12 @@ int VulkanEngine::registerScene(const GlobalBuffers & buffers)
 		scenes.push_back(SceneGraphics());
 	}
 	scenes[id].id = id;
-	scenes[id].descriptors = createGlobalDescriptors(buffers);
+	scenes[id].globalBuffers = {
+		vk::DescriptorBufferInfo{ buffers.transform, 0, buffers.transform.size() },
+		vk::DescriptorBufferInfo{ buffers.light, 0, buffers.light.size() },
+		vk::DescriptorBufferInfo{ buffers.camera, 0, buffers.camera.size() } };
+	createGlobalDescriptors(scenes[id]);
+	scenes[id].gpu.cameraBuffer = buffers.transform;
 	return id;
 }
 
@@ -255,11 +753,35 @@ void VulkanEngine::deRegisterScene(int id)
 {
 	scenes[id].id = -1;
 	scenes[id].descriptors.clear();
+	scenes[id].globalBuffers.clear();
+	scenes[id].variants.clear();
+	scenes[id].gpu = GpuScene();
 	//When scene is deleted all remaining object are move to unassigned list
 	unassignedComponents.splice(unassignedComponents.end(), scenes[id].items, scenes[id].items.begin(), scenes[id].items.end());
 	ASSERT(scenes[id].items.size() == 0)
 }
 
+void VulkanEngine::setPipelineVariant(int sceneId, const PipelineVariant & variant)
+{
+	ASSERT(sceneId < static_cast<int>(scenes.size()) && sceneId >= 0)
+	SceneGraphics& scene = scenes[sceneId];
+	size_t index = static_cast<size_t>(variant.getType());
+	scene.variants.resize(graphicsPipelines.size(), -1);
+	if (variant.getConstants().empty())
+	{
+		scene.variants[index] = -1;
+		return;
+	}
+	//scenes using the same constants share the variant, it is only created when a scene first draws with it.
+	auto it = std::find_if(specialisedPipelines.begin(), specialisedPipelines.end(), [&variant](const SpecialisedPipeline& x) { return x.variant == variant; });
+	if (it == specialisedPipelines.end())
+	{
+		specialisedPipelines.push_back(SpecialisedPipeline{ variant, std::future<std::array<vk::Pipeline, 2>>(), Pipeline(), Pipeline(), false });
+		it = specialisedPipelines.end() - 1;
+	}
+	scene.variants[index] = static_cast<int32_t>(it - specialisedPipelines.begin());
+}
+
 void VulkanEngine::attachObject(int sceneId, int objectId)
 {
 	ASSERT(sceneId < static_cast<int>(scenes.size()) && sceneId >= 0)
@@ -308,16 +830,68 @@ void VulkanEngine::setObjectLayer(int objectId, int newLayer, int sceneId)
 
 bool VulkanEngine::isWindowActive() const
 {
+	//headless engine has no window which could be closed.
+	if (headless)
+	{
+		return true;
+	}
 	return !glfwWindowShouldClose(window);
 }
 
+MeshStats VulkanEngine::getMeshStats() const
+{
+	return modelManager.getMeshStats();
+}
+
+ResourceStats VulkanEngine::getTextureStats() const
+{
+	return textureManager.getStats();
+}
+
+ResourceStats VulkanEngine::getModelStats() const
+{
+	return modelManager.getStats();
+}
+
+void VulkanEngine::setResourceBudgets(uint64_t textureBytes, uint64_t modelBytes)
+{
+	textureManager.setBudget(textureBytes);
+	modelManager.setBudget(modelBytes);
+}
+
+void VulkanEngine::setTextureStreaming(bool streaming)
+{
+	textureManager.setStreaming(streaming);
+}
+
+void VulkanEngine::setHotReload(bool enabled)
+{
+	if (!enabled)
+	{
+		watcher.reset();
+	}
+	else if (!watcher)
+	{
+		// directories the engine and the samples load assets from
+		watcher.reset(new FileWatcher{ std::vector<std::string>{ "Models", "Textures", "shaders" } });
+	}
+}
+
 void VulkanEngine::finish()
 {
+	std::lock_guard<std::mutex> lock{ queueMutex };
 	logicDevice.waitIdle();
 }
 
 VulkanEngine::~VulkanEngine()
 {
+	waitForPipelines();
+	destroySpecialisedPipelines();
+	destroyIndirectPipelines();
+	if (pipelineCache)
+	{
+		logicDevice.destroyPipelineCache(pipelineCache);
+	}
 }
 
 void VulkanEngine::createRenderPass()
@@ -327,10 +901,12 @@ void VulkanEngine::createRenderPass()
 		logicDevice.destroyRenderPass(renderPass);
 	}
 
+	//offscreen images are not presented, they are left ready to be copied so the frame can be read back.
+	vk::ImageLayout finalLayout = headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
 	vk::AttachmentDescription attachment{vk::AttachmentDescriptionFlags(), swapFormat, vk::SampleCountFlagBits::e1,
 											vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore,
 											vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare,
-											vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR };
+											vk::ImageLayout::eUndefined, finalLayout };
 
 	vk::AttachmentDescription depthAttachment{ vk::AttachmentDescriptionFlags(), findDepthFormat(), vk::SampleCountFlagBits::e1,
 											vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare,
@@ -356,62 +932,131 @@ void VulkanEngine::createRenderPass()
 
 void VulkanEngine::createDescriptorSetLayout()
 {
-	//Set with only one uniform in vertex; Global
-	vk::DescriptorSetLayoutBinding globalUboLayoutBinding{ 0, vk::DescriptorType::eUniformBuffer, 1,
-														vk::ShaderStageFlagBits::eVertex, nullptr };
-
-	vk::DescriptorSetLayoutCreateInfo globalLayoutInfo{ vk::DescriptorSetLayoutCreateFlags(), 1, &globalUboLayoutBinding };
-
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(globalLayoutInfo));
-
-	//Set with one uniform in vertex and one sampler in fragment; Local
-	vk::DescriptorSetLayoutBinding modelUboLayoutBinding{ 0, vk::DescriptorType::eUniformBuffer, 1,
-														vk::ShaderStageFlagBits::eVertex, nullptr };
-
-	vk::DescriptorSetLayoutBinding samplerLayoutBinding{ 1, vk::DescriptorType::eCombinedImageSampler, 1,
-														vk::ShaderStageFlagBits::eFragment, nullptr };
-
-	std::array<vk::DescriptorSetLayoutBinding, 2> bindings = { modelUboLayoutBinding, samplerLayoutBinding };
-	vk::DescriptorSetLayoutCreateInfo modelLayoutInfo{ vk::DescriptorSetLayoutCreateFlags(), bindings.size(), bindings.data() };
+	//Layouts are created out of shader reflection together with pipelines, only the empty set filling gaps between sets a pipeline uses is created up front.
+	getDescriptorLayout(std::vector<vk::DescriptorSetLayoutBinding>());
+}
 
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(modelLayoutInfo));
+vk::DescriptorSetLayout* VulkanEngine::getDescriptorLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+	for (size_t i = 0; i < layoutBindings.size(); i++)
+	{
+		if (sameBindings(layoutBindings[i], bindings))
+		{
+			return &descriptorLayouts[i];
+		}
+	}
+	vk::DescriptorSetLayoutCreateInfo layoutInfo{ vk::DescriptorSetLayoutCreateFlags(), static_cast<uint32_t>(bindings.size()), bindings.data() };
+	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(layoutInfo));
+	layoutBindings.push_back(bindings);
+	return &descriptorLayouts.back();
+}
 
-	//Set with two uniforms in vertex; Global
-	vk::DescriptorSetLayoutBinding globalLightLayoutBinding{ 1, vk::DescriptorType::eUniformBuffer, 1,
-														vk::ShaderStageFlagBits::eVertex, nullptr };
-	bindings[0] = globalUboLayoutBinding;
-	bindings[1] = globalLightLayoutBinding;
-	vk::DescriptorSetLayoutCreateInfo lightLayoutInfo{ vk::DescriptorSetLayoutCreateFlags(), bindings.size(), bindings.data() };
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(lightLayoutInfo));
+PipelineLayout* VulkanEngine::getPipelineLayout(const ShaderReflection& reflection, std::deque<PipelineLayout>& layouts)
+{
+	//sets the shaders don't access get the empty layout, so a pipeline layout can have gaps between sets.
+	std::vector<vk::DescriptorSetLayout*> sets;
+	for (uint32_t set = 0; set < reflection.getSetCount(); set++)
+	{
+		sets.push_back(getDescriptorLayout(reflection.getSetBindings(set)));
+	}
+	const std::vector<vk::PushConstantRange>& pushConstants = reflection.getPushConstants();
+	for (PipelineLayout& layout : layouts)
+	{
+		if (layout.matches(sets, pushConstants))
+		{
+			return &layout;
+		}
+	}
+	std::vector<vk::DescriptorSetLayout> handles;
+	for (vk::DescriptorSetLayout* set : sets)
+	{
+		handles.push_back(*set);
+	}
+	vk::PipelineLayoutCreateInfo layoutInfo{ vk::PipelineLayoutCreateFlags(), static_cast<uint32_t>(handles.size()), handles.data(),
+		static_cast<uint32_t>(pushConstants.size()), pushConstants.data() };
+	layouts.push_back(PipelineLayout{ &logicDevice, logicDevice.createPipelineLayout(layoutInfo), sets, pushConstants });
+	return &layouts.back();
+}
 
-	//Set with one uniform in vertex and two samplers in fragment; Local
-	vk::DescriptorSetLayoutBinding normalMapLayoutBinding{ 2, vk::DescriptorType::eCombinedImageSampler, 1,
-														vk::ShaderStageFlagBits::eFragment, nullptr };
-	std::array<vk::DescriptorSetLayoutBinding, 3> bindings3 = { modelUboLayoutBinding, samplerLayoutBinding, normalMapLayoutBinding };
-	vk::DescriptorSetLayoutCreateInfo bumpLayoutInfo{ vk::DescriptorSetLayoutCreateFlags(), bindings3.size(), bindings3.data() };
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(bumpLayoutInfo));
-	//Set with three uniform in vertex; Global;
-	vk::DescriptorSetLayoutBinding cameraLayoutBinding{ 2, vk::DescriptorType::eUniformBuffer, 1,
-														vk::ShaderStageFlagBits::eVertex , nullptr };
-	bindings3[0] = globalUboLayoutBinding;
-	bindings3[1] = globalLightLayoutBinding;
-	bindings3[2] = cameraLayoutBinding;
-	vk::DescriptorSetLayoutCreateInfo cameraLayoutInfo{ vk::DescriptorSetLayoutCreateFlags(), bindings3.size(), bindings3.data() };
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(cameraLayoutInfo));
+void VulkanEngine::createPipeline(PipelineType type, const ShaderReflection& reflection, Shader&& vert, Shader&& frag, bool indirect)
+{
+	size_t index = static_cast<size_t>(type);
+	Pipeline& pipeline = indirect ? indirectPipelines[index] : graphicsPipelines[index];
+	pipeline.layout = getPipelineLayout(reflection, indirect ? indirectLayouts : pipelineLayouts);
+	pipeline.globalReq = reflection.getGlobalUsage();
+	pipeline.localReq = reflection.getLocalUsage();
+	pipeline.globalSet = getGlobalSet(*pipeline.layout, reflection);
+	if (!indirect)
+	{
+		pipelineReflections[index] = reflection;
+	}
+	//Layouts are needed right away to create components and global sets, only the handle is created on a worker thread.
+	const PipelineDescription description = pipelineDescriptions[index];
+	const vk::Device* device = &logicDevice;
+	vk::PipelineCache cache = pipelineCache;
+	vk::PipelineShaderStageCreateInfo vertStage = vert.getCreateInfo();
+	vk::PipelineShaderStageCreateInfo fragStage = frag.getCreateInfo();
+	vk::PipelineLayout layout = *pipeline.layout;
+	vk::Extent2D extent = swapExtent;
+	vk::RenderPass pass = renderPass;
+	pendingPipelines.push_back(PendingPipeline{ &pipeline.handle, std::async(std::launch::async, [=]()
+	{
+		return buildPipeline(device, cache, description, vertStage, fragStage, std::vector<SpecializationConstant>(), layout, extent, pass);
+	}) });
+	pendingShaders.push_back(std::move(vert));
+	pendingShaders.push_back(std::move(frag));
+}
 
-	//Set with one uniform in vertex and three samplers in fragment; Local
-	vk::DescriptorSetLayoutBinding depthMapLayoutBinding{ 3, vk::DescriptorType::eCombinedImageSampler, 1,
-		vk::ShaderStageFlagBits::eFragment, nullptr };
-	std::array<vk::DescriptorSetLayoutBinding, 4> bindings4 = { modelUboLayoutBinding, samplerLayoutBinding, normalMapLayoutBinding, depthMapLayoutBinding };
-	vk::DescriptorSetLayoutCreateInfo parallaxLayoutInfo{ vk::DescriptorSetLayoutCreateFlags(), bindings4.size(), bindings4.data() };
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(parallaxLayoutInfo));
+void VulkanEngine::waitForPipelines()
+{
+	if (pendingPipelines.empty())
+	{
+		return;
+	}
+	PROFILE_FUNCTION()
+	//every worker is waited for even if one fails, so no pipeline is left being created when the error is handled.
+	std::exception_ptr error;
+	for (PendingPipeline& pending : pendingPipelines)
+	{
+		try
+		{
+			*pending.handle = pending.pending.get();
+		}
+		catch (...)
+		{
+			error = error ? error : std::current_exception();
+		}
+	}
+	pendingPipelines.clear();
+	pendingShaders.clear();
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
 
-	//EmptySet
-	descriptorLayouts.push_back(logicDevice.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo{}));
+uint32_t VulkanEngine::getGlobalSet(const PipelineLayout & layout, const ShaderReflection & reflection)
+{
+	std::vector<vk::DescriptorSetLayoutBinding> bindings = reflection.getSetBindings(ShaderReflection::globalSet);
+	if (bindings.empty())
+	{
+		return Pipeline::noGlobalSet;
+	}
+	for (size_t i = 0; i < globalLayouts.size(); i++)
+	{
+		if (globalLayouts[i].layout == layout.getGlobalSet())
+		{
+			return static_cast<uint32_t>(i);
+		}
+	}
+	globalLayouts.push_back(GlobalSetLayout{ layout.getGlobalSet(), bindings, reflection.getGlobalUsage() });
+	return static_cast<uint32_t>(globalLayouts.size() - 1);
 }
 
 void VulkanEngine::createGraphicsPipeline()
 {
+	waitForPipelines();
+	destroySpecialisedPipelines();
 	if (graphicsPipelines.size() > 0)
 	{
 		for (auto& pipe : graphicsPipelines)
@@ -421,175 +1066,259 @@ void VulkanEngine::createGraphicsPipeline()
 		graphicsPipelines.clear();
 		pipelineLayouts.clear();
 	}
-	graphicsPipelines.resize(8);
-
-	Shader vertShader{ &logicDevice, "shaders/simpleV.spv", vk::ShaderStageFlagBits::eVertex, ShaderUsage::VS_PVTransform, ShaderUsage::VS_ModelTransform };
-	Shader fragShader{ &logicDevice, "shaders/simpleTexturedF.spv", vk::ShaderStageFlagBits::eFragment, ShaderUsage::Empty, ShaderUsage::FS_Texture };
-
-	vk::PipelineShaderStageCreateInfo shaderStages[] = { vertShader.getCreateInfo(), fragShader.getCreateInfo() };
-
-	vk::VertexInputBindingDescription bindingDescription = Vertex3DT::bindingDescription();
-	std::vector<vk::VertexInputAttributeDescription> attributeDescriptions = Vertex3DT::attributeDescriptions();
-	vk::PipelineVertexInputStateCreateInfo vertexInputInfo{ vk::PipelineVertexInputStateCreateFlags(), 1, &bindingDescription,
-															attributeDescriptions.size(), attributeDescriptions.data() };
-	//Defines topology input to pipeline
-	vk::PipelineInputAssemblyStateCreateInfo inputAssembly{ vk::PipelineInputAssemblyStateCreateFlags(), vk::PrimitiveTopology::eTriangleList, VK_FALSE };
-
-	vk::Viewport viewport{ 0.0f, 0.0f, static_cast<float>(swapExtent.width), static_cast<float>(swapExtent.height), 0.0f, 1.0f };
-
-	vk::Rect2D scissor{ vk::Offset2D{0,0},swapExtent };
-
-	vk::PipelineViewportStateCreateInfo viewportState{ vk::PipelineViewportStateCreateFlags(), 1, &viewport, 1, &scissor };
-
-	vk::PipelineRasterizationStateCreateInfo rasterizer{ vk::PipelineRasterizationStateCreateFlags(), VK_FALSE, VK_FALSE, vk::PolygonMode::eFill,
-											vk::CullModeFlagBits::eBack , vk::FrontFace::eCounterClockwise, VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f };
-
-	vk::PipelineMultisampleStateCreateInfo multisampling{ vk::PipelineMultisampleStateCreateFlags(), vk::SampleCountFlagBits::e1, VK_FALSE, 1.0f, nullptr,
-											VK_FALSE, VK_FALSE };
-
-	vk::PipelineDepthStencilStateCreateInfo depthStencil{ vk::PipelineDepthStencilStateCreateFlags(), VK_TRUE, VK_TRUE, vk::CompareOp::eLessOrEqual,
-											VK_FALSE, VK_FALSE, vk::StencilOpState(), vk::StencilOpState(), 0.0f, 1.0f };
-
-	vk::PipelineColorBlendAttachmentState colorBlendAttachment{ VK_TRUE, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd,
-													vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd,
-													vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA };
-
-	vk::PipelineColorBlendStateCreateInfo colorBlending{ vk::PipelineColorBlendStateCreateFlags(), VK_FALSE, vk::LogicOp::eCopy,
-										1, &colorBlendAttachment, {{0.0f,0.0f,0.0f,0.0f}} };
-
-	vk::DescriptorSetLayout descLayouts[2];
-	pipelineLayouts.resize(5);
-	vk::PipelineLayoutCreateInfo pipelineLayoutInfo{ vk::PipelineLayoutCreateFlags(), 2, descLayouts,
-													0, nullptr };
-	//Create first pipeline layout
-	descLayouts[0] = descriptorLayouts[0];
-	descLayouts[1] = descriptorLayouts[1];
-									//Descriptor sets corespond to first and second layout used in pipeline layout info respectively
-	pipelineLayouts[0] = PipelineLayout{ &logicDevice, logicDevice.createPipelineLayout(pipelineLayoutInfo), &descriptorLayouts[0], &descriptorLayouts[1] };
-	//Create second pipeline layout
-	descLayouts[0] = descriptorLayouts[2];
-	descLayouts[1] = descriptorLayouts[1];
-									//Descriptor sets corespond to first and second layout used in pipeline layout info respectively
-	pipelineLayouts[1] = PipelineLayout{ &logicDevice, logicDevice.createPipelineLayout(pipelineLayoutInfo), &descriptorLayouts[2], &descriptorLayouts[1] };
-	//Create third pipeline layout
-	descLayouts[0] = descriptorLayouts[4];
-	descLayouts[1] = descriptorLayouts[3];
-									//Descriptor sets corespond to first and second layout used in pipeline layout info respectively
-	pipelineLayouts[2] = PipelineLayout{ &logicDevice, logicDevice.createPipelineLayout(pipelineLayoutInfo), &descriptorLayouts[4], &descriptorLayouts[3] };
-	//Create third pipeline layout
-	descLayouts[0] = descriptorLayouts[4];
-	descLayouts[1] = descriptorLayouts[5];
-	//Descriptor sets corespond to first and second layout used in pipeline layout info respectively
-	pipelineLayouts[3] = PipelineLayout{ &logicDevice, logicDevice.createPipelineLayout(pipelineLayoutInfo), &descriptorLayouts[4], &descriptorLayouts[5] };
-	//Create fourth pipeline layout
-	descLayouts[0] = descriptorLayouts[6];
-	descLayouts[1] = descriptorLayouts[1];
-	//Descriptor sets corespond to first and second layout used in pipeline layout info respectively
-	pipelineLayouts[4] = PipelineLayout{ &logicDevice, logicDevice.createPipelineLayout(pipelineLayoutInfo), &descriptorLayouts[6], &descriptorLayouts[1] };
-	                                                                           
-	vk::GraphicsPipelineCreateInfo pipelineInfo{ vk::PipelineCreateFlags(), 2, shaderStages, &vertexInputInfo, &inputAssembly,
-										nullptr, &viewportState, &rasterizer, &multisampling, &depthStencil, &colorBlending,
-										nullptr, pipelineLayouts[0], renderPass, 0, vk::Pipeline(), -1 };
-
-
-	graphicsPipelines[static_cast<int>(PipelineType::eNoLight)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eNoLight)].layout = &pipelineLayouts[0];
-	graphicsPipelines[static_cast<int>(PipelineType::eNoLight)].globalReq = vertShader.getGlobalUsage() | fragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eNoLight)].localReq = vertShader.getLocalUsage() | fragShader.getLocalUsage();
-	//Create skybox shader
-	depthStencil.setDepthWriteEnable(VK_FALSE);
-	graphicsPipelines[static_cast<int>(PipelineType::eSkybox)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eSkybox)].layout = &pipelineLayouts[0];
-	graphicsPipelines[static_cast<int>(PipelineType::eSkybox)].globalReq = vertShader.getGlobalUsage() | fragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eSkybox)].localReq = vertShader.getLocalUsage() | fragShader.getLocalUsage();
-	//Create wireframe shader
-	depthStencil.setDepthWriteEnable(VK_TRUE);
-	rasterizer.setPolygonMode(vk::PolygonMode::eLine);
-	graphicsPipelines[static_cast<int>(PipelineType::eWireframe)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eWireframe)].layout = &pipelineLayouts[0];
-	graphicsPipelines[static_cast<int>(PipelineType::eWireframe)].globalReq = vertShader.getGlobalUsage() | fragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eWireframe)].localReq = vertShader.getLocalUsage() | fragShader.getLocalUsage();
-	//Create phong shader
-	Shader lightVertShader{ &logicDevice, "shaders/lightV.spv", vk::ShaderStageFlagBits::eVertex, ShaderUsage::VS_PVTransform | ShaderUsage::VS_Light, ShaderUsage::VS_ModelTransform };
-	Shader phongFragShader{ &logicDevice, "shaders/phongF.spv", vk::ShaderStageFlagBits::eFragment, ShaderUsage::Empty, ShaderUsage::FS_Texture };
-	rasterizer.setPolygonMode(vk::PolygonMode::eFill);
-	shaderStages[0] = lightVertShader.getCreateInfo();
-	shaderStages[1] = phongFragShader.getCreateInfo();
-	pipelineInfo.setLayout(pipelineLayouts[1]);
-
-	graphicsPipelines[static_cast<int>(PipelineType::ePhong)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::ePhong)].layout = &pipelineLayouts[1];
-	graphicsPipelines[static_cast<int>(PipelineType::ePhong)].globalReq = lightVertShader.getGlobalUsage() | phongFragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::ePhong)].localReq = lightVertShader.getLocalUsage() | phongFragShader.getLocalUsage();
-	//Create Toon shader
-	Shader toonFragShader{ &logicDevice, "shaders/toonF.spv", vk::ShaderStageFlagBits::eFragment, ShaderUsage::Empty, ShaderUsage::FS_Texture };
-
-	shaderStages[1] = toonFragShader.getCreateInfo();
-	graphicsPipelines[static_cast<int>(PipelineType::eToon)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eToon)].layout = &pipelineLayouts[1];
-	graphicsPipelines[static_cast<int>(PipelineType::eToon)].globalReq = lightVertShader.getGlobalUsage() | toonFragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eToon)].localReq = lightVertShader.getLocalUsage() | toonFragShader.getLocalUsage();
-	//Create Bump map shader
-	Shader tangentVertShader{ &logicDevice, "shaders/tangentSpaceV.spv", vk::ShaderStageFlagBits::eVertex, ShaderUsage::VS_PVTransform | ShaderUsage::VS_Light | ShaderUsage::VS_CameraPos, ShaderUsage::VS_ModelTransform | ShaderUsage::VS_Tangents };
-	Shader bumpFragShader{ &logicDevice, "shaders/bumpMapPhongF.spv", vk::ShaderStageFlagBits::eFragment, ShaderUsage::Empty, ShaderUsage::FS_Texture | ShaderUsage::FS_NormalMap };
-	shaderStages[0] = tangentVertShader.getCreateInfo();
-	shaderStages[1] = bumpFragShader.getCreateInfo();
-	vk::VertexInputBindingDescription bumpBindingDescription = Vertex3DTT::bindingDescription();
-	std::vector<vk::VertexInputAttributeDescription> bumpAttributeDescriptions = Vertex3DTT::attributeDescriptions();
-	vertexInputInfo.setPVertexBindingDescriptions(&bumpBindingDescription);
-	vertexInputInfo.setVertexAttributeDescriptionCount(bumpAttributeDescriptions.size());
-	vertexInputInfo.setPVertexAttributeDescriptions(bumpAttributeDescriptions.data());
-	pipelineInfo.setLayout(pipelineLayouts[2]);
-	graphicsPipelines[static_cast<int>(PipelineType::eBumpMap)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eBumpMap)].layout = &pipelineLayouts[2];
-	graphicsPipelines[static_cast<int>(PipelineType::eBumpMap)].globalReq = tangentVertShader.getGlobalUsage() | bumpFragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eBumpMap)].localReq = tangentVertShader.getLocalUsage() | bumpFragShader.getLocalUsage();
-	//Create parallax map shader
-	Shader parallaxFragShader{ &logicDevice, "shaders/parallaxPhongF.spv", vk::ShaderStageFlagBits::eFragment, ShaderUsage::Empty, ShaderUsage::FS_Texture | ShaderUsage::FS_NormalMap | ShaderUsage::FS_DepthMap };
-	shaderStages[0] = tangentVertShader.getCreateInfo();
-	shaderStages[1] = parallaxFragShader.getCreateInfo();
-	pipelineInfo.setLayout(pipelineLayouts[3]);
-	graphicsPipelines[static_cast<int>(PipelineType::eParallax)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eParallax)].layout = &pipelineLayouts[3];
-	graphicsPipelines[static_cast<int>(PipelineType::eParallax)].globalReq = tangentVertShader.getGlobalUsage() | parallaxFragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eParallax)].localReq = tangentVertShader.getLocalUsage() | parallaxFragShader.getLocalUsage();
-
-	//Create orthographic shader
-	Shader orthoVertShader{ &logicDevice, "shaders/orthoTexturedV.spv", vk::ShaderStageFlagBits::eVertex, ShaderUsage::Empty, ShaderUsage::VS_ModelTransform };
-	Shader orthoFragShader{ &logicDevice, "shaders/simpleTexturedF.spv", vk::ShaderStageFlagBits::eFragment, ShaderUsage::Empty, ShaderUsage::FS_Texture };
-
-	shaderStages[0] = orthoVertShader.getCreateInfo();
-	shaderStages[1] = orthoFragShader.getCreateInfo();
-	vk::VertexInputBindingDescription orthoBindingDescription = Vertex2DT::bindingDescription();
-	std::vector<vk::VertexInputAttributeDescription> orthoAttributeDescriptions = Vertex2DT::attributeDescriptions();
-	vertexInputInfo.setPVertexBindingDescriptions(&orthoBindingDescription);
-	vertexInputInfo.setVertexAttributeDescriptionCount(orthoAttributeDescriptions.size());
-	vertexInputInfo.setPVertexAttributeDescriptions(orthoAttributeDescriptions.data());
-	pipelineInfo.setLayout(pipelineLayouts[4]);
-
-	graphicsPipelines[static_cast<int>(PipelineType::eOrthoTextured)].handle = logicDevice.createGraphicsPipeline(vk::PipelineCache(), pipelineInfo);
-	graphicsPipelines[static_cast<int>(PipelineType::eOrthoTextured)].layout = &pipelineLayouts[4];
-	graphicsPipelines[static_cast<int>(PipelineType::eOrthoTextured)].globalReq = orthoVertShader.getGlobalUsage() | orthoFragShader.getGlobalUsage();
-	graphicsPipelines[static_cast<int>(PipelineType::eOrthoTextured)].localReq = orthoVertShader.getLocalUsage() | orthoFragShader.getLocalUsage();
+	//Pipelines and their variants are created through one cache, so variants share compiled state with each other and with base pipelines.
+	if (!pipelineCache)
+	{
+		pipelineCache = logicDevice.createPipelineCache(vk::PipelineCacheCreateInfo());
+	}
+	graphicsPipelines.resize(sizeof(pipelineDescriptions) / sizeof(pipelineDescriptions[0]));
+	pipelineReflections.resize(graphicsPipelines.size());
+
+	for (const PipelineDescription& description : pipelineDescriptions)
+	{
+		ASSERT(&description - pipelineDescriptions == static_cast<int>(description.type))
+		Shader vertShader{ &logicDevice, description.vertShader[0], description.vertShader[1] };
+		Shader fragShader{ &logicDevice, description.fragShader[0], description.fragShader[1] };
+		ShaderReflection reflection = merge(vertShader, fragShader);
+		createPipeline(description.type, reflection, std::move(vertShader), std::move(fragShader));
+	}
+
+	createIndirectPipelines();
+	//pipelines may use global sets no pipeline used before, scenes registered earlier get them as well.
+	for (SceneGraphics& scene : scenes)
+	{
+		if (scene.id != -1)
+		{
+			createGlobalDescriptors(scene);
+		}
+	}
+}
+
+void VulkanEngine::createIndirectPipelines()
+{
+	destroyIndirectPipelines();
+	indirectPipelines.resize(graphicsPipelines.size(), Pipeline{ vk::Pipeline(), nullptr, ShaderUsage::Empty, ShaderUsage::Empty, Pipeline::noGlobalSet });
+	gpuCulling = false;
+	if (!indirectDrawing)
+	{
+		return;
+	}
+	const char* files[][2] = { { "shaders/cull.comp", "shaders/cullC.spv" }, { "shaders/simpleIndirect.vert", "shaders/simpleIndirectV.spv" },
+		{ "shaders/lightIndirect.vert", "shaders/lightIndirectV.spv" }, { "shaders/tangentSpaceIndirect.vert", "shaders/tangentSpaceIndirectV.spv" } };
+	for (const auto& file : files)
+	{
+		//shaders are optional, without them objects are drawn one by one.
+		if (!FileSystem::exists(file[1]) && !(ShaderCompiler::isEnabled() && FileSystem::exists(file[0])))
+		{
+			return;
+		}
+	}
+
+	//Culling pipeline, the shader reads all of its buffers from its first set.
+	Shader cullShader{ &logicDevice, "shaders/cull.comp", "shaders/cullC.spv" };
+	cullLayout = getPipelineLayout(cullShader.getReflection(), indirectLayouts);
+	cullSetLayout = cullLayout->getGlobalSet();
+	vk::ComputePipelineCreateInfo cullInfo{ vk::PipelineCreateFlags(), cullShader.getCreateInfo(), *cullLayout, vk::Pipeline(), -1 };
+	const vk::Device* device = &logicDevice;
+	vk::PipelineCache cache = pipelineCache;
+	pendingPipelines.push_back(PendingPipeline{ &cullPipeline, std::async(std::launch::async, [=]()
+	{
+		return device->createComputePipeline(cache, cullInfo);
+	}) });
+	pendingShaders.push_back(std::move(cullShader));
+
+	for (const PipelineDescription& description : pipelineDescriptions)
+	{
+		if (description.indirectShader[0] == nullptr)
+		{
+			continue;
+		}
+		int index = static_cast<int>(description.type);
+		Shader vertShader{ &logicDevice, description.indirectShader[0], description.indirectShader[1] };
+		Shader fragShader{ &logicDevice, description.fragShader[0], description.fragShader[1] };
+		//Variants bind local sets of regular pipelines' components, so their layouts include sets of regular pipelines and the object set.
+		ShaderReflection reflection = pipelineReflections[index];
+		reflection.merge(vertShader.getReflection());
+		reflection.merge(fragShader.getReflection());
+		createPipeline(description.type, reflection, std::move(vertShader), std::move(fragShader), true);
+		objectSetLayout = indirectPipelines[index].layout->getSet(ShaderReflection::objectSet);
+	}
+	gpuCulling = true;
+}
+
+void VulkanEngine::updateSpecialisedPipelines(const SceneGraphics & scene)
+{
+	PROFILE_FUNCTION()
+	for (const DrawBatch& batch : scene.gpu.batches)
+	{
+		size_t index = static_cast<size_t>(batch.type);
+		if (index >= scene.variants.size() || scene.variants[index] == -1)
+		{
+			continue;
+		}
+		SpecialisedPipeline& specialised = specialisedPipelines[scene.variants[index]];
+		if (specialised.requested)
+		{
+			continue;
+		}
+		//everything the worker needs is copied, pipelines are only recreated after the workers finish.
+		specialised.requested = true;
+		const PipelineDescription description = pipelineDescriptions[index];
+		const vk::Device* device = &logicDevice;
+		vk::PipelineCache cache = pipelineCache;
+		std::vector<SpecializationConstant> constants = specialised.variant.getConstants();
+		vk::PipelineLayout layout = *graphicsPipelines[index].layout;
+		vk::PipelineLayout indirectLayout = indirectPipelines[index].handle ? static_cast<vk::PipelineLayout>(*indirectPipelines[index].layout) : vk::PipelineLayout();
+		vk::Extent2D extent = swapExtent;
+		vk::RenderPass pass = renderPass;
+		specialised.pending = std::async(std::launch::async, [=]()
+		{
+			std::array<vk::Pipeline, 2> handles;
+			handles[0] = createSpecialisedPipeline(device, cache, description, false, constants, layout, extent, pass);
+			if (indirectLayout)
+			{
+				try
+				{
+					handles[1] = createSpecialisedPipeline(device, cache, description, true, constants, indirectLayout, extent, pass);
+				}
+				catch (...)
+				{
+					device->destroyPipeline(handles[0]);
+					throw;
+				}
+			}
+			return handles;
+		});
+	}
+	for (SpecialisedPipeline& specialised : specialisedPipelines)
+	{
+		if (!specialised.pending.valid() || specialised.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			continue;
+		}
+		size_t index = static_cast<size_t>(specialised.variant.getType());
+		try
+		{
+			std::array<vk::Pipeline, 2> handles = specialised.pending.get();
+			//variants only differ in constants, so they share layouts and global sets with base pipelines.
+			specialised.pipeline = graphicsPipelines[index];
+			specialised.pipeline.handle = handles[0];
+			specialised.indirect = indirectPipelines[index];
+			specialised.indirect.handle = handles[1];
+		}
+		catch (const std::exception& error)
+		{
+			// a variant which can't be created shouldn't stop the application, the scene keeps drawing with the base pipeline
+			std::cerr << "failed to create a variant of the " << pipelineNames[index] << " pipeline!" << std::endl << error.what() << std::endl;
+		}
+	}
+}
+
+const Pipeline * VulkanEngine::selectPipeline(const SceneGraphics & scene, const DrawBatch & batch) const
+{
+	size_t index = static_cast<size_t>(batch.type);
+	if (index < scene.variants.size() && scene.variants[index] != -1)
+	{
+		const SpecialisedPipeline& specialised = specialisedPipelines[scene.variants[index]];
+		const Pipeline& variant = batch.indirect ? specialised.indirect : specialised.pipeline;
+		if (variant.handle)
+		{
+			return &variant;
+		}
+	}
+	return batch.indirect ? &indirectPipelines[index] : &graphicsPipelines[index];
+}
+
+void VulkanEngine::destroySpecialisedPipelines()
+{
+	//variants are kept, so scenes keep referring to them, and are created again when scenes draw with them.
+	for (SpecialisedPipeline& specialised : specialisedPipelines)
+	{
+		if (specialised.pending.valid())
+		{
+			try
+			{
+				std::array<vk::Pipeline, 2> handles = specialised.pending.get();
+				specialised.pipeline.handle = handles[0];
+				specialised.indirect.handle = handles[1];
+			}
+			catch (const std::exception&)
+			{
+			}
+		}
+		if (specialised.pipeline.handle)
+		{
+			logicDevice.destroyPipeline(specialised.pipeline.handle);
+		}
+		if (specialised.indirect.handle)
+		{
+			logicDevice.destroyPipeline(specialised.indirect.handle);
+		}
+		specialised.pipeline = Pipeline();
+		specialised.indirect = Pipeline();
+		specialised.requested = false;
+	}
+}
+
+void VulkanEngine::destroyIndirectPipelines()
+{
+	for (auto& pipe : indirectPipelines)
+	{
+		if (pipe.handle)
+		{
+			logicDevice.destroyPipeline(pipe.handle);
+		}
+	}
+	indirectPipelines.clear();
+	if (cullPipeline)
+	{
+		logicDevice.destroyPipeline(cullPipeline);
+		cullPipeline = vk::Pipeline();
+	}
+	cullLayout = nullptr;
+	indirectLayouts.clear();
+	gpuCulling = false;
 }
 
 void VulkanEngine::createDescriptorPool()
 {
-	std::array<vk::DescriptorPoolSize, 2> poolSizes{ vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer, 128},
-														vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, 127 } };
-	vk::DescriptorPoolCreateInfo poolInfo{ vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, 128, poolSizes.size(), poolSizes.data() };
+	std::array<vk::DescriptorPoolSize, 3> poolSizes{ vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer, 144},
+														vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, 127 },
+														vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, 80 } };
+	vk::DescriptorPoolCreateInfo poolInfo{ vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, 160, poolSizes.size(), poolSizes.data() };
 
 	descriptorPool = logicDevice.createDescriptorPool(poolInfo);
 }
 
 void VulkanEngine::recreateSwapChain()
 {
+	//pipelines being created use the old render pass, so they are finished before it is destroyed.
+	waitForPipelines();
+	std::unique_lock<std::mutex> lock{ queueMutex };
+	logicDevice.waitIdle();
+	lock.unlock();
+	destroySpecialisedPipelines();
 	VulkanBase::recreateSwapChain();
 	//NOTE if createCommandBuffer is not called every frame it needs to be called here as well
 }
 
 void VulkanEngine::draw()
 {
+	PROFILE_FUNCTION()
+	if (headless)
+	{
+		if (commandBuffers.size() == 0)
+		{
+			return;
+		}
+		vk::SubmitInfo submit{ 0, nullptr, nullptr, 1, &commandBuffers[0], 0, nullptr };
+		std::lock_guard<std::mutex> lock{ queueMutex };
+		queue.submit(submit, vk::Fence());
+		gpuProfiler.endFrame();
+		queue.waitIdle();
+		frameRendered = true;
+		return;
+	}
 	vk::ResultValue<uint32_t> imageIndex = logicDevice.acquireNextImageKHR(swapChain, std::numeric_limits<uint64_t>::max(), imageAvailableSemaphore, vk::Fence());
 	if (imageIndex.result == vk::Result::eErrorOutOfDateKHR)
 	{
@@ -606,12 +1335,15 @@ void VulkanEngine::draw()
 	vk::PipelineStageFlags waitStages[] = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
 	vk::SubmitInfo submit{ 1, waitSemaphores, waitStages,1, &commandBuffers[imageIndex.value], 1, signalSemaphores };
 
+	std::unique_lock<std::mutex> lock{ queueMutex };
 	queue.submit(submit, vk::Fence());
+	gpuProfiler.endFrame();
 	queue.waitIdle();
 	vk::SwapchainKHR swapChains[] = { swapChain };
 	vk::PresentInfoKHR presentInfo{ 1, signalSemaphores, 1, swapChains, &imageIndex.value, nullptr };
 
 	vk::Result result = queue.presentKHR(presentInfo);
+	lock.unlock();
 
 	if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR)
 	{
@@ -2,11 +2,14 @@
 #include"VulkanBase.h"
 #include"PipelineType.h"
 #include"DescriptorSet.h"
+#include"ShaderReflection.h"
+#include"Shader.h"
 #include"..\Graphics\GlobalBuffers.h"
 #include"..\Graphics\SceneGraphics.h"
 #include<memory>
 #include"..\ResourceManagers\TextureManager.h"
 #include"..\ResourceManagers\ModelManager.h"
+#include"..\ResourceManagers\FileWatcher.h"
 #include"..\DebugTools\Result.h"
 
 /**
@@ -25,39 +28,39 @@ public:
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
 		Uniqueness of the id needs to be handeled externally, otherwise problems may arrise if there happen to be components with same ids.
-		@param model filename of the model used.
-		@param texFilename filename of the texture used.
+		@param model id or filename of the model used.
+		@param texFilename id or filename of the texture used.
 		@param pipeline enumerator which determines how we want to draw the object.
 		@param layer layer to which the object is assigned.
 		@param loadType type of the model we want to use.
 		@return shared pointer to the component created with given parameters.
 	*/
-	std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const char * model, const char * texFilename, PipelineType pipeline, int layer, ModelType loadType) override;
+	std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, PipelineType pipeline, int layer, ModelType loadType) override;
 	/**
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
 		Uniqueness of the id needs to be handeled externally, otherwise problems may arrise if there happen to be components with same ids.
-		@param model filename of the model used.
-		@param texFilename filename of the texture used.
-		@param normalMap filename of the normal map used.
+		@param model id or filename of the model used.
+		@param texFilename id or filename of the texture used.
+		@param normalMap id or filename of the normal map used.
 		@param pipeline enumerator which determines how we want to draw the object.
 		@param layer layer to which the object is assigned.
 		@return shared pointer to the component created with given parameters.
 	*/
-	std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const char * model, const char * texFilename, const char* normalMap, PipelineType pipeline, int layer) override;
+	std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, const AssetId& normalMap, PipelineType pipeline, int layer) override;
 	/**
 		Creates a graphics components, for desired game object, which holds all neccessary information to draw an object.
 		@param id id of the game object for which we create a component. Id will be assigned to a component as well so it has a connection to a game object.
 		Uniqueness of the id needs to be handeled externally, otherwise problems may arrise if there happen to be components with same ids.
-		@param model filename of the model used.
-		@param texFilename filename of the texture used.
-		@param normalMap filename of the normal map used.
-		@param depthMap filename of the depth map used.
+		@param model id or filename of the model used.
+		@param texFilename id or filename of the texture used.
+		@param normalMap id or filename of the normal map used.
+		@param depthMap id or filename of the depth map used.
 		@param pipeline enumerator which determines how we want to draw the object.
 		@param layer layer to which the object is assigned.
 		@return shared pointer to the component created with given parameters.
 	*/
-	std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const char * model, const char * texFilename, const char* normalMap, const char* depthMap, PipelineType pipeline, int layer) override;
+	std::shared_ptr<GraphicsComponent> createGraphicsComponent(int id, const AssetId& model, const AssetId& texFilename, const AssetId& normalMap, const AssetId& depthMap, PipelineType pipeline, int layer) override;
 	/**
 		Signals the engine to update all internal data related to the given scene so it can be drawn.
 		Doesn't need to be called every frame, it can be called when a change occurs.
@@ -80,6 +83,12 @@ public:
 		@param id id of the scene we want to deregister.
 	*/
 	void deRegisterScene(int id) override;
+	/**
+		Sets the variant of a pipeline used to draw a scene. The variant is created on a worker thread when the scene first draws with it, until then the base pipeline is used.
+		@param sceneId id of the scene.
+		@param variant variant of a pipeline type, a variant without constants restores the base pipeline.
+	*/
+	void setPipelineVariant(int sceneId, const PipelineVariant& variant) override;
 	/**
 		Attaches an object to the scene.
 		@param sceneId id of the scene to which we want to attach the object.
@@ -110,6 +119,38 @@ public:
 		@return true if window is active, false otherwise.
 	*/
 	bool isWindowActive() const override;
+	/**
+		Returns statistics of the vertex cache optimisation of loaded models.
+		@return mesh statistics.
+	*/
+	MeshStats getMeshStats() const override;
+	/**
+		Returns statistics of the texture manager.
+		@return texture statistics.
+	*/
+	ResourceStats getTextureStats() const override;
+	/**
+		Returns statistics of the model manager.
+		@return model statistics.
+	*/
+	ResourceStats getModelStats() const override;
+	/**
+		Sets GPU memory budgets of loaded textures and models. Least recently used resources no component uses are released to stay within them.
+		@param textureBytes budget of textures in bytes.
+		@param modelBytes budget of models in bytes.
+	*/
+	void setResourceBudgets(uint64_t textureBytes, uint64_t modelBytes) override;
+	/**
+		Sets whether textures loaded from now on are streamed, starting with their coarsest mip levels and loading finer ones as objects using them get closer.
+		@param streaming true to stream textures, false to load them whole.
+	*/
+	void setTextureStreaming(bool streaming) override;
+	/**
+		Sets whether textures, models and shaders are reloaded when their files change. Changed files are re-imported in the background
+		and replace loaded resources between frames, so components using them keep working without being recreated.
+		@param enabled true to watch asset directories, false to stop watching them.
+	*/
+	void setHotReload(bool enabled) override;
 	/**
 		Tells the engine we are finished working with it, so it can clean up everything it needs to.
 		Needs to be called when we are finished working with it.
@@ -134,6 +175,7 @@ protected:
 	/**
 		Creates descriptor set layout. Descriptor layout specifies the types of resources that a certain set in the shader has.
 		For example it describes how many uniform variables, samplers or other variables a shader set has.
+		Layouts of shader sets are created out of shader reflections when pipelines are created, only the empty layout is created here.
 	*/
 	virtual void createDescriptorSetLayout() override;
 	/**
@@ -160,14 +202,123 @@ protected:
 	std::list<std::shared_ptr<GraphicsComponent>> unassignedComponents;	//*< List of components which are currently not in any scene.
 	TextureManager textureManager;										//*< Resource manager used to load textures.
 	ModelManager modelManager;											//*< Resource manager used to load models.
+	std::vector<Pipeline> indirectPipelines;							//*< Variants of graphics pipelines which read model transformations from a storage buffer. Indexed by PipelineType, handle is empty if there is no variant.
+	std::deque<PipelineLayout> indirectLayouts;							//*< Layouts used to create indirect pipelines and the culling pipeline.
+	PipelineLayout* cullLayout{ nullptr };								//*< Layout of the culling pipeline.
+	vk::DescriptorSetLayout* cullSetLayout{ nullptr };					//*< Layout of the set with buffers read and written by the culling pipeline.
+	vk::DescriptorSetLayout* objectSetLayout{ nullptr };				//*< Layout of the set with model transformations read by indirect pipelines.
+	vk::Pipeline cullPipeline;											//*< Compute pipeline which culls objects and writes indirect draw commands.
+	bool gpuCulling{ false };											//*< Flag determining if objects are culled on the GPU and drawn with indirect draw calls.
+	std::unique_ptr<FileWatcher> watcher;								//*< Watcher of asset directories used for hot reload, null if it is disabled.
+	std::deque<std::vector<vk::DescriptorSetLayoutBinding>> layoutBindings;	//*< Bindings out of which descriptor set layouts were created, in the same order as the layouts.
+	std::vector<GlobalSetLayout> globalLayouts;							//*< Distinct layouts of global sets used by pipelines. Scenes have one global set for each of them.
+	std::vector<ShaderReflection> pipelineReflections;					//*< Merged reflections of shaders of graphics pipelines. Indexed by PipelineType.
+	std::vector<SpecialisedPipeline> specialisedPipelines;				//*< Variants of pipelines used by scenes. Variants are never removed, so scenes refer to them by their indices.
+	vk::PipelineCache pipelineCache;									//*< Cache through which all pipelines and their variants are created.
+	std::vector<PendingPipeline> pendingPipelines;						//*< Pipelines being created on worker threads.
+	std::vector<Shader> pendingShaders;									//*< Shaders of pipelines being created, destroyed once all of them are created.
 private:
 	/**
 		Creates descriptor sets which describe global(same for all models) shader variables and links
-		those sets to desired buffers.
-		@param buffers buffers used to store global shader variables.
-		@return vector of created descriptor sets.
+		those sets to desired buffers. Only sets of global layouts the scene doesn't have yet are created.
+		@param scene scene whose global sets are created.
+	*/
+	void createGlobalDescriptors(SceneGraphics& scene);
+	/**
+		Returns a descriptor set layout with the given bindings, creating it if no such layout exists yet.
+		@param bindings bindings of the layout.
+		@return pointer to the layout, which stays valid until the engine is destroyed.
+	*/
+	vk::DescriptorSetLayout* getDescriptorLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+	/**
+		Returns a pipeline layout for shaders, creating it if none of the given layouts matches.
+		@param reflection merged reflection of the shaders.
+		@param layouts layouts which are searched and to which the new layout is added.
+		@return pointer to the layout.
+	*/
+	PipelineLayout* getPipelineLayout(const ShaderReflection& reflection, std::deque<PipelineLayout>& layouts);
+	/**
+		Creates layout and requirements of a graphics pipeline out of shader reflection, and starts creating the pipeline on a worker thread.
+		The pipeline's handle is set by waitForPipelines.
+		@param type type of the pipeline.
+		@param reflection merged reflection of the pipeline's shaders.
+		@param vert vertex shader of the pipeline, kept until the pipeline is created.
+		@param frag fragment shader of the pipeline, kept until the pipeline is created.
+		@param indirect true if an indirect variant of the pipeline is created, false otherwise.
+	*/
+	void createPipeline(PipelineType type, const ShaderReflection& reflection, Shader&& vert, Shader&& frag, bool indirect = false);
+	/**
+		Waits until all pipelines being created on worker threads are created and sets their handles.
+		@throws std::exception the first error of a worker, after all workers finished.
+	*/
+	void waitForPipelines();
+	/**
+		Returns the index of the global layout which a pipeline layout uses, adding the layout if it is new.
+		@param layout layout of the pipeline.
+		@param reflection merged reflection of the pipeline's shaders.
+		@return index of the global layout, Pipeline::noGlobalSet if the pipeline doesn't use global variables.
+	*/
+	uint32_t getGlobalSet(const PipelineLayout& layout, const ShaderReflection& reflection);
+	/**
+		Creates the culling pipeline and indirect variants of graphics pipelines.
+		GPU culling stays disabled if the device doesn't support it or the shaders are missing.
+	*/
+	void createIndirectPipelines();
+	/**
+		Destroys the culling pipeline and indirect variants of graphics pipelines.
+	*/
+	void destroyIndirectPipelines();
+	/**
+		Starts creating variants a scene draws with which weren't requested yet, and takes variants whose creation finished.
+		@param scene scene which will be drawn.
+	*/
+	void updateSpecialisedPipelines(const SceneGraphics& scene);
+	/**
+		Returns the pipeline with which a batch of a scene is drawn.
+		@param scene scene to which the batch belongs.
+		@param batch batch which is drawn.
+		@return pointer to the scene's variant of the batch's pipeline if it is created, pointer to the base pipeline otherwise.
+	*/
+	const Pipeline* selectPipeline(const SceneGraphics& scene, const DrawBatch& batch) const;
+	/**
+		Waits for variants being created and destroys all variants. Variants are created again when scenes draw with them.
+	*/
+	void destroySpecialisedPipelines();
+	/**
+		Requests mip levels of visible textures out of their screen coverage, streams them and rewrites descriptors of components whose textures were replaced.
+		@param scene scene which will be drawn.
+	*/
+	void streamTextures(SceneGraphics& scene);
+	/**
+		Re-imports textures, models and shaders whose files changed and replaces the loaded ones. All pipelines are recreated if a shader changed.
+		Needs to be called when the GPU doesn't use any resources, before descriptors of replaced textures are rewritten.
+	*/
+	void reloadAssets();
+	/**
+		Splits scene's components into batches and, if GPU culling is enabled, uploads their data for the culling shader.
+		@param scene scene which will be drawn.
+	*/
+	void updateGpuScene(SceneGraphics& scene);
+	/**
+		Makes sure GPU scene buffers can hold the given number of objects. Buffers are recreated if they are too small.
+		@param gpu GPU scene whose buffers need to grow.
+		@param count number of objects buffers need to hold.
+	*/
+	void reserveGpuScene(GpuScene& gpu, uint32_t count);
+	/**
+		Records the culling dispatch which writes draw commands of all objects. Needs to be recorded outside of a render pass.
+		@param buffer command buffer used for issuing commands.
+		@param gpu GPU scene which is culled.
+	*/
+	void recordCulling(const vk::CommandBuffer& buffer, const GpuScene& gpu);
+	/**
+		Issues indirect draw calls for a batch. Indirect pipeline, arena and descriptor sets must already be bound.
+		@param buffer command buffer used for issuing commands.
+		@param gpu GPU scene to which the batch belongs.
+		@param batch batch which is drawn.
+		@param batchIndex index of the batch in the GPU scene.
 	*/
-	std::vector<DescriptorSet> createGlobalDescriptors(const GlobalBuffers& buffers);
+	void drawBatch(const vk::CommandBuffer& buffer, const GpuScene& gpu, const DrawBatch& batch, uint32_t batchIndex);
 	/**
 		Transfers an object from one list to another.
 		@param from list from which to transfer the object.
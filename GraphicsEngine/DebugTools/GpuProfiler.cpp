@@ -0,0 +1,212 @@
+#include "GpuProfiler.h"
+#include"Assert.h"
+
+namespace
+{
+	const uint32_t queriesPerFrame = GpuProfiler::maxRegions * 2;					//*< Every region has a begin and an end timestamp.
+	const uint32_t uploadQuery = GpuProfiler::latency * queriesPerFrame;			//*< Index of the first query used to measure uploads.
+	const uint32_t invalidRegion = GpuProfiler::maxRegions;						//*< Index returned when there is no more room for regions.
+}
+
+void GpuProfiler::init(const vk::Device* device, const vk::PhysicalDevice & physDev, uint32_t queueFamily, const vk::Instance & instance, bool labels)
+{
+	uint32_t validBits = physDev.getQueueFamilyProperties()[queueFamily].timestampValidBits;
+	if (validBits == 0)
+	{
+		return;
+	}
+	this->device = device;
+	period = physDev.getProperties().limits.timestampPeriod;
+	mask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	vk::QueryPoolCreateInfo poolInfo{ vk::QueryPoolCreateFlags(), vk::QueryType::eTimestamp, uploadQuery + 2, vk::QueryPipelineStatisticFlags() };
+	pool = device->createQueryPool(poolInfo);
+#ifdef VK_EXT_debug_utils
+	if (labels)
+	{
+		beginLabel = reinterpret_cast<void*>(vkGetInstanceProcAddr(static_cast<VkInstance>(instance), "vkCmdBeginDebugUtilsLabelEXT"));
+		endLabel = reinterpret_cast<void*>(vkGetInstanceProcAddr(static_cast<VkInstance>(instance), "vkCmdEndDebugUtilsLabelEXT"));
+	}
+#endif
+}
+
+void GpuProfiler::destroy()
+{
+	if (device != nullptr)
+	{
+		device->destroyQueryPool(pool);
+		device = nullptr;
+	}
+}
+
+void GpuProfiler::beginFrame()
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	frame = (frame + 1) % latency;
+	cursor = 0;
+	recordings = 0;
+	FrameQueries& queries = frames[frame];
+	if (queries.submitted && queries.names.size() > 0)
+	{
+		// queries are about to be reused so results need to be read now, usually they are long available.
+		std::vector<uint64_t> results(queries.names.size() * 2);
+		vk::Result result = device->getQueryPoolResults(pool, frame * queriesPerFrame, results.size(), results.size() * sizeof(uint64_t), results.data(),
+													sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+		if (result == vk::Result::eSuccess)
+		{
+			// regions with the same name are summed up, for example when the same pipeline is bound more than once.
+			std::map<std::string, double> times;
+			for (size_t i = 0; i < queries.names.size(); i++)
+			{
+				times[queries.names[i]] += toMilliseconds(results[i * 2], results[i * 2 + 1]);
+			}
+			for (const auto& time : times)
+			{
+				addSample(time.first, time.second);
+			}
+		}
+	}
+	queries.names.clear();
+	queries.submitted = false;
+}
+
+void GpuProfiler::beginRecording(const vk::CommandBuffer & commandBuffer)
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	commandBuffer.resetQueryPool(pool, frame * queriesPerFrame, queriesPerFrame);
+	cursor = 0;
+	recordings++;
+}
+
+uint32_t GpuProfiler::beginRegion(const vk::CommandBuffer & commandBuffer, const std::string & name)
+{
+	label(commandBuffer, name.c_str());
+	if (!isEnabled() || cursor >= maxRegions)
+	{
+		return invalidRegion;
+	}
+	std::vector<std::string>& names = frames[frame].names;
+	// names are taken from the first recording, other recordings of the same frame need to match it.
+	if (recordings == 1)
+	{
+		names.push_back(name);
+	}
+	ASSERT(cursor < names.size() && names[cursor] == name)
+	uint32_t region = cursor++;
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, pool, frame * queriesPerFrame + region * 2);
+	return region;
+}
+
+void GpuProfiler::endRegion(const vk::CommandBuffer & commandBuffer, uint32_t region)
+{
+	label(commandBuffer, nullptr);
+	if (!isEnabled() || region == invalidRegion)
+	{
+		return;
+	}
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, pool, frame * queriesPerFrame + region * 2 + 1);
+}
+
+void GpuProfiler::endFrame()
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	frames[frame].submitted = recordings > 0;
+}
+
+void GpuProfiler::beginUpload(const vk::CommandBuffer & commandBuffer)
+{
+	label(commandBuffer, "upload");
+	if (!isEnabled())
+	{
+		return;
+	}
+	commandBuffer.resetQueryPool(pool, uploadQuery, 2);
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, pool, uploadQuery);
+}
+
+void GpuProfiler::endUpload(const vk::CommandBuffer & commandBuffer)
+{
+	label(commandBuffer, nullptr);
+	if (!isEnabled())
+	{
+		return;
+	}
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, pool, uploadQuery + 1);
+}
+
+void GpuProfiler::resolveUpload()
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	uint64_t results[2];
+	vk::Result result = device->getQueryPoolResults(pool, uploadQuery, 2, sizeof(results), results, sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+	if (result == vk::Result::eSuccess)
+	{
+		addSample("upload", toMilliseconds(results[0], results[1]));
+	}
+}
+
+std::vector<GpuTiming> GpuProfiler::getTimings() const
+{
+	std::vector<GpuTiming> timings;
+	timings.reserve(history.size());
+	for (const auto& region : history)
+	{
+		const History& h = region.second;
+		uint32_t last = (h.next + historySize - 1) % historySize;
+		timings.push_back(GpuTiming{ region.first, h.values[last], h.sum / h.count, h.count });
+	}
+	return timings;
+}
+
+bool GpuProfiler::isEnabled() const
+{
+	return device != nullptr;
+}
+
+void GpuProfiler::addSample(const std::string & name, double time)
+{
+	History& h = history[name];
+	if (h.count == historySize)
+	{
+		h.sum -= h.values[h.next];
+	}
+	else
+	{
+		h.count++;
+	}
+	h.values[h.next] = time;
+	h.sum += time;
+	h.next = (h.next + 1) % historySize;
+}
+
+double GpuProfiler::toMilliseconds(uint64_t begin, uint64_t end) const
+{
+	return ((end - begin) & mask) * period / 1000000.0;
+}
+
+void GpuProfiler::label(const vk::CommandBuffer & commandBuffer, const char * name) const
+{
+#ifdef VK_EXT_debug_utils
+	if (name != nullptr && beginLabel != nullptr)
+	{
+		VkDebugUtilsLabelEXT labelInfo{ VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT, nullptr, name, { 0.f, 0.f, 0.f, 0.f } };
+		reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(beginLabel)(static_cast<VkCommandBuffer>(commandBuffer), &labelInfo);
+	}
+	else if (name == nullptr && endLabel != nullptr)
+	{
+		reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(endLabel)(static_cast<VkCommandBuffer>(commandBuffer));
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+#include<vulkan\vulkan.hpp>
+#include<string>
+#include<vector>
+#include<map>
+#include<array>
+
+/**
+	GpuTiming structure.
+	Contains measured GPU time of a single named region.
+*/
+struct GpuTiming
+{
+	std::string name;	//*< Name of the measured region.
+	double last;		//*< Time in milliseconds measured in the last resolved frame.
+	double average;		//*< Average time in milliseconds over the last resolved frames.
+	uint32_t samples;	//*< Number of frames the average is calculated from.
+};
+
+/**
+	GpuProfiler class.
+	Measures GPU time of named regions of command buffers using timestamp queries.
+	Results are read back a few frames after they are submitted so reading them doesn't stall the GPU.
+	Regions are also emitted as debug labels when debug utils extension is available so they show up in captures.
+*/
+class GpuProfiler
+{
+public:
+	static const uint32_t maxRegions = 64;		//*< Maximum number of regions measured in a frame.
+	static const uint32_t latency = 3;			//*< Number of frames after which the results are read back.
+	static const uint32_t historySize = 64;		//*< Number of frames used to calculate rolling averages.
+	/**
+		Creates a query pool and prepares the profiler for use.
+		If timestamps are not supported by the queue, profiler stays disabled and all calls are ignored.
+		@param device pointer to a logical device on which queries are created.
+		@param physDev physical device from which the device was created.
+		@param queueFamily index of the queue family to which command buffers are submitted.
+		@param instance instance used to load debug label functions.
+		@param labels flag determining if debug utils extension is enabled so labels can be emitted.
+	*/
+	void init(const vk::Device* device, const vk::PhysicalDevice& physDev, uint32_t queueFamily, const vk::Instance& instance, bool labels);
+	/**
+		Destroys the query pool.
+	*/
+	void destroy();
+	/**
+		Starts a new frame. Reads back results of the frame submitted latency frames ago, since its queries are reused.
+	*/
+	void beginFrame();
+	/**
+		Prepares queries of the current frame in the command buffer. Needs to be called outside of a render pass,
+		before any region is recorded into the command buffer.
+		All command buffers recorded for the same frame need to contain the same regions in the same order.
+		@param commandBuffer command buffer which is being recorded.
+	*/
+	void beginRecording(const vk::CommandBuffer& commandBuffer);
+	/**
+		Starts a named region.
+		@param commandBuffer command buffer which is being recorded.
+		@param name name of the region. Regions with the same name are summed up.
+		@return index of the region used to end it.
+	*/
+	uint32_t beginRegion(const vk::CommandBuffer& commandBuffer, const std::string& name);
+	/**
+		Ends a region.
+		@param commandBuffer command buffer which is being recorded.
+		@param region index of the region returned by beginRegion.
+	*/
+	void endRegion(const vk::CommandBuffer& commandBuffer, uint32_t region);
+	/**
+		Signals that the command buffer recorded for the current frame was submitted, so its results can be read back later.
+	*/
+	void endFrame();
+	/**
+		Starts measuring upload work in a single time command buffer.
+		@param commandBuffer command buffer which is being recorded.
+	*/
+	void beginUpload(const vk::CommandBuffer& commandBuffer);
+	/**
+		Ends measuring upload work.
+		@param commandBuffer command buffer which is being recorded.
+	*/
+	void endUpload(const vk::CommandBuffer& commandBuffer);
+	/**
+		Reads back the time of the measured upload. Needs to be called after the upload command buffer has finished executing.
+	*/
+	void resolveUpload();
+	/**
+		Returns rolling timings of all regions measured so far.
+		@return array of timings sorted by region name.
+	*/
+	std::vector<GpuTiming> getTimings() const;
+	/**
+		Checks if the profiler is measuring.
+		@return true if timestamps are supported and profiler is initialized, false otherwise.
+	*/
+	bool isEnabled() const;
+private:
+	/**
+		FrameQueries structure.
+		Contains regions recorded for one frame.
+	*/
+	struct FrameQueries
+	{
+		std::vector<std::string> names;		//*< Names of the recorded regions.
+		bool submitted{ false };			//*< Flag determining if the frame was submitted and its results need to be read.
+	};
+	/**
+		History structure.
+		Contains last measured times of a region.
+	*/
+	struct History
+	{
+		std::array<double, historySize> values;	//*< Ring buffer of measured times.
+		uint32_t next{ 0 };						//*< Index at which the next time will be stored.
+		uint32_t count{ 0 };					//*< Number of stored times.
+		double sum{ 0 };						//*< Sum of stored times.
+	};
+	/**
+		Adds a measured time to the history of the region.
+		@param name name of the region.
+		@param time measured time in milliseconds.
+	*/
+	void addSample(const std::string& name, double time);
+	/**
+		Converts two timestamps into milliseconds.
+		@param begin timestamp at the beginning of a region.
+		@param end timestamp at the end of a region.
+		@return time between timestamps in milliseconds.
+	*/
+	double toMilliseconds(uint64_t begin, uint64_t end) const;
+	/**
+		Emits a debug label in the command buffer if labels are enabled.
+		@param commandBuffer command buffer which is being recorded.
+		@param name name of the label, nullptr ends the current label.
+	*/
+	void label(const vk::CommandBuffer& commandBuffer, const char* name) const;
+
+	const vk::Device* device{ nullptr };			//*< Pointer to a device on which queries are created.
+	vk::QueryPool pool;								//*< Pool of timestamp queries.
+	double period{ 0 };								//*< Number of nanoseconds per timestamp tick.
+	uint64_t mask{ 0 };								//*< Mask of valid timestamp bits.
+	uint32_t frame{ 0 };							//*< Index of the current frame in the ring of frames.
+	uint32_t cursor{ 0 };							//*< Index of the next region in the command buffer being recorded.
+	uint32_t recordings{ 0 };						//*< Number of command buffers recorded in the current frame.
+	std::array<FrameQueries, latency> frames;		//*< Regions recorded for each frame in flight.
+	std::map<std::string, History> history;		//*< Measured times of each region.
+	void* beginLabel{ nullptr };					//*< Pointer to a function used to begin a debug label.
+	void* endLabel{ nullptr };						//*< Pointer to a function used to end a debug label.
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "Profiler.h"
+#if PROFILING_ENABLED
+#include<atomic>
+#include<chrono>
+#include<fstream>
+#include<memory>
+#include<mutex>
+#include<vector>
+
+namespace
+{
+	const uint32_t bufferSize = 1 << 16;	//*< Number of events stored per thread. Older events are overwritten.
+
+	/**
+		ThreadBuffer structure.
+		Ring buffer of events recorded by a single thread.
+	*/
+	struct ThreadBuffer
+	{
+		uint32_t threadId;					//*< Sequential id of the thread used in the trace.
+		std::atomic<uint64_t> written{ 0 };	//*< Number of events written so far.
+		profiler::Event events[bufferSize];	//*< Stored events.
+	};
+
+	std::mutex buffersMutex;								//*< Mutex guarding the list of buffers.
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;		//*< Buffers of all threads that recorded an event. Kept alive until exit so they can be dumped.
+	std::mutex dumpMutex;									//*< Mutex preventing two threads from writing the trace at once.
+	double spikeThreshold = 0;								//*< Frame time in milliseconds after which the trace is written.
+	const char* spikeFilename = nullptr;					//*< File to which the trace is written on a spike.
+
+	/**
+		Returns the buffer of the calling thread. Buffer is created and registered on the first call.
+		@return buffer of the calling thread.
+	*/
+	ThreadBuffer& getBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+		if (buffer == nullptr)
+		{
+			std::unique_ptr<ThreadBuffer> created{ new ThreadBuffer };
+			std::lock_guard<std::mutex> lock{ buffersMutex };
+			created->threadId = static_cast<uint32_t>(buffers.size());
+			buffer = created.get();
+			buffers.push_back(std::move(created));
+		}
+		return *buffer;
+	}
+}
+
+uint64_t profiler::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void profiler::record(const char * name, uint64_t begin, uint64_t end)
+{
+	ThreadBuffer& buffer = getBuffer();
+	uint64_t index = buffer.written.load(std::memory_order_relaxed);
+	buffer.events[index % bufferSize] = Event{ name, begin, end };
+	// publish the event so a dumping thread sees it completely written.
+	buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool profiler::writeChromeTrace(const char * filename)
+{
+	std::lock_guard<std::mutex> dumpLock{ dumpMutex };
+	std::ofstream file{ filename };
+	if (!file.is_open())
+	{
+		return false;
+	}
+	file << std::fixed;
+	file.precision(3);
+	file << "{\"traceEvents\":[";
+	bool first = true;
+	std::lock_guard<std::mutex> lock{ buffersMutex };
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+	{
+		// events can be overwritten by their thread while we are reading, which at most corrupts the oldest few events.
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t start = written > bufferSize ? written - bufferSize : 0;
+		for (uint64_t i = start; i < written; i++)
+		{
+			const Event& e = buffer->events[i % bufferSize];
+			file << (first ? "\n" : ",\n") << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << e.begin / 1000.0 << ",\"dur\":" << (e.end - e.begin) / 1000.0 << "}";
+			first = false;
+		}
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+	return true;
+}
+
+void profiler::setSpikeTrace(double thresholdMs, const char * filename)
+{
+	spikeThreshold = thresholdMs;
+	spikeFilename = filename;
+}
+
+void profiler::frameFinished(double frameMs)
+{
+	if (spikeThreshold > 0 && frameMs > spikeThreshold && spikeFilename != nullptr)
+	{
+		writeChromeTrace(spikeFilename);
+	}
+}
+#endif
\ No newline at end of file
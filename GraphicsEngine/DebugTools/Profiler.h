@@ -0,0 +1,99 @@
+#pragma once
+#include<cstdint>
+
+// Profiling can be turned off from the build by defining PROFILING_ENABLED as 0, in which case all markers compile to nothing.
+#ifndef PROFILING_ENABLED
+#define PROFILING_ENABLED 1
+#endif
+
+#if PROFILING_ENABLED
+/**
+	profiler namespace
+	Contains scoped CPU timing markers which are stored in per thread ring buffers and can be exported as a Chrome trace.
+*/
+namespace profiler
+{
+	/**
+		Event structure.
+		Contains a single measured scope.
+	*/
+	struct Event
+	{
+		const char* name;	//*< Name of the scope. Needs to be a string literal or otherwise outlive the profiler.
+		uint64_t begin;		//*< Time at which the scope was entered in nanoseconds.
+		uint64_t end;		//*< Time at which the scope was left in nanoseconds.
+	};
+
+	/**
+		Returns current time used for timestamps.
+		@return time in nanoseconds since an arbitrary point.
+	*/
+	uint64_t now();
+	/**
+		Stores an event in the ring buffer of the calling thread.
+		@param name name of the scope.
+		@param begin time at which the scope was entered.
+		@param end time at which the scope was left.
+	*/
+	void record(const char* name, uint64_t begin, uint64_t end);
+	/**
+		Writes events of all threads to a file in Chrome trace format which can be opened in chrome://tracing or Perfetto.
+		@param filename name of the file to write.
+		@return true if the file was written, false otherwise.
+	*/
+	bool writeChromeTrace(const char* filename);
+	/**
+		Sets a threshold above which a frame is considered a spike and the trace is written automatically.
+		@param thresholdMs frame time in milliseconds. 0 turns automatic writing off.
+		@param filename name of the file to write the trace to. Needs to outlive the profiler.
+	*/
+	void setSpikeTrace(double thresholdMs, const char* filename);
+	/**
+		Signals the end of a frame. Writes the trace if the frame was a spike.
+		@param frameMs duration of the finished frame in milliseconds.
+	*/
+	void frameFinished(double frameMs);
+
+	/**
+		Scope class.
+		Measures time between its construction and destruction.
+	*/
+	class Scope
+	{
+	public:
+		/**
+			Constructor.
+			@param name name of the scope. Needs to be a string literal.
+		*/
+		Scope(const char* name) : name{ name }, begin{ now() } {}
+		Scope(Scope& x) = delete;
+		Scope& operator=(Scope& x) = delete;
+		/**
+			Destructor. Records the event.
+		*/
+		~Scope() { record(name, begin, now()); }
+	private:
+		const char* name;	//*< Name of the scope.
+		uint64_t begin;		//*< Time at which the scope was entered.
+	};
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+// measures the time until the end of the current scope
+#define PROFILE_SCOPE(name) profiler::Scope PROFILE_CONCAT(profileScope, __LINE__){ name };
+// measures the time until the end of the current function
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+// signals the end of a frame so spikes can be detected
+#define PROFILE_FRAME(frameMs) profiler::frameFinished(frameMs);
+// writes the trace of all threads to a file
+#define PROFILE_DUMP(filename) profiler::writeChromeTrace(filename);
+// sets the frame time after which the trace is written automatically
+#define PROFILE_SPIKE_TRACE(thresholdMs, filename) profiler::setSpikeTrace(thresholdMs, filename);
+#else
+#define PROFILE_SCOPE(name) // evaluates to nothing
+#define PROFILE_FUNCTION() // evaluates to nothing
+#define PROFILE_FRAME(frameMs) // evaluates to nothing
+#define PROFILE_DUMP(filename) // evaluates to nothing
+#define PROFILE_SPIKE_TRACE(thresholdMs, filename) // evaluates to nothing
+#endif
\ No newline at end of file
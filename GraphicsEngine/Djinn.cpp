@@ -3,6 +3,9 @@
 #include<chrono>
 #include"Factories\SceneFactory.h"
 #include"Factories\ObjectFactory.h"
+#include"DebugTools\Profiler.h"
+#include"ResourceManagers\FileSystem.h"
+#include"ResourceManagers\ShaderCompiler.h"
 
 #ifdef _DEBUG
 	static bool validating = true;
@@ -10,10 +13,10 @@
 	static bool validating = false;
 #endif
 
-void Djinn::initialize(const char* appName, uint32_t screenWidth, uint32_t screenHeight)
+void Djinn::initialize(const char* appName, uint32_t screenWidth, uint32_t screenHeight, bool headless)
 {
 	VulkanEngine* e = new VulkanEngine();
-	e->init(appName, validating, screenWidth, screenHeight);
+	e->init(appName, validating, screenWidth, screenHeight, headless);
 	engine = e;
 	SceneFactory::engine = engine;
 	ObjectFactory::engine = engine;
@@ -40,23 +43,101 @@ void Djinn::setObjectLayer(int objectId, int newLayer, int sceneId)
 	engine->setObjectLayer(objectId, newLayer, sceneId);
 }
 
-void Djinn::run()
+void Djinn::run(uint32_t maxFrames)
 {
-	while (engine->isWindowActive() && scene != nullptr)
+	uint32_t frame = 0;
+	while (engine->isWindowActive() && scene != nullptr && (maxFrames == 0 || frame < maxFrames))
 	{
-		glfwPollEvents();
-		int state = glfwGetKey(engine->getWindow(), GLFW_KEY_K);
-		if (state == GLFW_PRESS)
+		if (!engine->isHeadless())
 		{
-			setObjectLayer(16, -1, 0);
+			glfwPollEvents();
+			int state = glfwGetKey(engine->getWindow(), GLFW_KEY_K);
+			if (state == GLFW_PRESS)
+			{
+				setObjectLayer(16, -1, 0);
+			}
+			state = glfwGetKey(engine->getWindow(), GLFW_KEY_F12);
+			if (state == GLFW_PRESS)
+			{
+				PROFILE_DUMP("profile.json")
+			}
 		}
-		engine->update(scene->getId());
-		update();
-		engine->draw();
+		FrameStats stats = runFrame();
+		PROFILE_FRAME(stats.total)
+		frame++;
 	}
 	engine->finish();
 }
 
+FrameStats Djinn::runFrame()
+{
+	PROFILE_SCOPE("frame")
+	FrameStats stats;
+	auto start = std::chrono::high_resolution_clock::now();
+	engine->update(scene->getId());
+	auto recorded = std::chrono::high_resolution_clock::now();
+	update();
+	auto updated = std::chrono::high_resolution_clock::now();
+	engine->draw();
+	auto submitted = std::chrono::high_resolution_clock::now();
+
+	stats.record = std::chrono::duration<double, std::milli>(recorded - start).count();
+	stats.update = std::chrono::duration<double, std::milli>(updated - recorded).count();
+	stats.submit = std::chrono::duration<double, std::milli>(submitted - updated).count();
+	stats.total = std::chrono::duration<double, std::milli>(submitted - start).count();
+	return stats;
+}
+
+void Djinn::saveFrame(const char* filename) const
+{
+	engine->saveFrame(filename);
+}
+
+std::vector<GpuTiming> Djinn::getGpuTimings() const
+{
+	return engine->getGpuTimings();
+}
+
+MeshStats Djinn::getMeshStats() const
+{
+	return engine->getMeshStats();
+}
+
+ResourceStats Djinn::getTextureStats() const
+{
+	return engine->getTextureStats();
+}
+
+ResourceStats Djinn::getModelStats() const
+{
+	return engine->getModelStats();
+}
+
+void Djinn::setResourceBudgets(uint64_t textureBytes, uint64_t modelBytes)
+{
+	engine->setResourceBudgets(textureBytes, modelBytes);
+}
+
+void Djinn::setTextureStreaming(bool streaming)
+{
+	engine->setTextureStreaming(streaming);
+}
+
+void Djinn::setHotReload(bool enabled)
+{
+	engine->setHotReload(enabled);
+}
+
+void Djinn::setShaderCompilation(bool enabled)
+{
+	ShaderCompiler::setEnabled(enabled);
+}
+
+bool Djinn::mountPack(const std::string & filename)
+{
+	return FileSystem::mount(filename);
+}
+
 Djinn::~Djinn()
 {
 	delete engine;
@@ -71,6 +152,7 @@ void Djinn::update()
 	float time = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count() / 1000.0f;
 	startTime = std::chrono::high_resolution_clock::now();
 
+	PROFILE_SCOPE("scene update")
 	scene->update(time);
 	
 }
@@ -1,16 +1,42 @@
 #pragma once
 #include"Scene\Scene.h"
+#include"DebugTools\GpuProfiler.h"
+#include"ResourceManagers\MeshOptimizer.h"
+#include"ResourceManagers\ResourceManager.h"
 
 class GraphicsEngine;
 
+/**
+	FrameStats structure.
+	Contains CPU time in milliseconds spent in each stage of a frame.
+*/
+struct FrameStats
+{
+	double update;	//*< Time spent updating the scene and its objects.
+	double record;	//*< Time spent by the engine recording commands for the scene.
+	double submit;	//*< Time spent submitting and presenting the frame.
+	double total;	//*< Time spent on the whole frame.
+};
+
 class Djinn
 {
 public:
-	void initialize(const char* appName, uint32_t screenWidth, uint32_t screenHeight);
+	void initialize(const char* appName, uint32_t screenWidth, uint32_t screenHeight, bool headless = false);
 	void setWindowSize(const uint32_t& screenWidth, const uint32_t& screenHeight);
 	void setScene(Scene* scene);
 	void setObjectLayer(int objectId, int newLayer, int sceneId = -1);
-	void run();
+	void run(uint32_t maxFrames = 0);
+	FrameStats runFrame();
+	void saveFrame(const char* filename) const;
+	std::vector<GpuTiming> getGpuTimings() const;
+	MeshStats getMeshStats() const;
+	ResourceStats getTextureStats() const;
+	ResourceStats getModelStats() const;
+	void setResourceBudgets(uint64_t textureBytes, uint64_t modelBytes);
+	void setTextureStreaming(bool streaming);
+	void setHotReload(bool enabled);
+	void setShaderCompilation(bool enabled);
+	bool mountPack(const std::string& filename);
 	~Djinn();
 private:
 	void update();
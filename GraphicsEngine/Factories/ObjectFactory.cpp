@@ -18,11 +18,11 @@ GameObject* ObjectFactory::createGameObject(const ObjectCreate & params)
 {
 	GameObject* go = new GameObject();
 	go->engine = engine;
-	if (params.normalMap == nullptr && params.depthMap == nullptr)
+	if (!params.normalMap.isValid() && !params.depthMap.isValid())
 	{
 		go->graph = engine->createGraphicsComponent(go->getId(), params.mesh, params.texture, params.drawType, params.layer, ModelType::e3D);
 	}
-	else if (params.depthMap == nullptr)
+	else if (!params.depthMap.isValid())
 	{
 		go->graph = engine->createGraphicsComponent(go->getId(), params.mesh, params.texture, params.normalMap, params.drawType, params.layer);
 	}
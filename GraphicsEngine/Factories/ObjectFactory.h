@@ -2,12 +2,13 @@
 #include"..\Graphics\GameObject.h"
 #include"..\Core\PipelineType.h"
 #include"..\Graphics\Axis.h"
+#include"..\ResourceManagers\AssetId.h"
 
 class Scene;
 
 /**
 	ObjectCreate structure.
-	Contains information needed to create a object.
+	Contains information needed to create a object. Assets can be given as paths or as ids created once up front.
 */
 struct ObjectCreate
 {
@@ -15,10 +16,10 @@ struct ObjectCreate
 	glm::vec3 scale;		//*< Scale factors for the object.
 	float radians;			//*< Angle in radians by which to rotate the object.
 	glm::vec3 rotationAxis;	//*< Axis by which to rotate the object.
-	const char* mesh;		//*< File name of a mesh file.
-	const char* texture;	//*< File name of the objects texture.
-	const char* normalMap;	//*< File name of the normal map.
-	const char* depthMap;	//*< File name of the depth map.
+	AssetId mesh;			//*< File name of a mesh file.
+	AssetId texture;		//*< File name of the objects texture.
+	AssetId normalMap;		//*< File name of the normal map, null if the object has none.
+	AssetId depthMap;		//*< File name of the depth map, null if the object has none.
 	PipelineType drawType;	//*< Pipeline with which to draw the object.
 	int layer;				//*< Layer in which the object will be drawn.
 };
@@ -35,7 +36,7 @@ struct BillboardCreate
 	glm::vec3 scale;		//*< Scale factors for the object.
 	float radians;			//*< Angle in radians by which to rotate the object.
 	glm::vec3 rotationAxis;	//*< Axis by which to rotate the object.
-	const char* texture;	//*< File name of the objects texture.
+	AssetId texture;		//*< File name of the objects texture.
 	PipelineType drawType;	//*< Pipeline with which to draw the object.
 	int layer;				//*< Layer in which the object will be drawn.
 };
@@ -19,6 +19,18 @@ BumpMapComponent::~BumpMapComponent()
 	GraphicsComponent::clear();
 }
 
+bool BumpMapComponent::sharesMaterial(const GraphicsComponent & other) const
+{
+	return GraphicsComponent::sharesMaterial(other) && normalMap == static_cast<const BumpMapComponent&>(other).normalMap;
+}
+
+uint32_t BumpMapComponent::getTextures(VTexture * textures[]) const
+{
+	GraphicsComponent::getTextures(textures);
+	textures[1] = normalMap.get();
+	return 2;
+}
+
 void BumpMapComponent::clear()
 {
 }
\ No newline at end of file
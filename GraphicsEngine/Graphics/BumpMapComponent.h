@@ -24,6 +24,18 @@ public:
 		Destructor.
 	*/
 	~BumpMapComponent();
+	/**
+		Checks if two components use the same textures so they can be drawn with the same descriptor set by indirect pipelines.
+		@param other component to compare with.
+		@return true if components share textures, false otherwise.
+	*/
+	bool sharesMaterial(const GraphicsComponent& other) const override;
+	/**
+		Returns component's textures in the order of their bindings in the component's descriptor set, starting with binding 1.
+		@param textures array filled with pointers to the textures.
+		@return number of textures.
+	*/
+	uint32_t getTextures(VTexture* textures[]) const override;
 	friend VulkanEngine;
 protected:
 	/**
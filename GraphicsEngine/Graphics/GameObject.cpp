@@ -150,6 +150,25 @@ int GameObject::getLayer() const
 	throw GraphicsException();
 }
 
+const std::shared_ptr<GraphicsComponent>& GameObject::getGraphics() const
+{
+	if (graph != nullptr)
+	{
+		return graph;
+	}
+	throw GraphicsException();
+}
+
+void GameObject::setOccluder(const bool occluder)
+{
+	if (graph != nullptr)
+	{
+		graph->setOccluder(occluder);
+		return;
+	}
+	throw GraphicsException();
+}
+
 int32_t GameObject::getSceneId() const
 {
 	return sceneId;
@@ -85,6 +85,18 @@ public:
 		@throw GraphicsException object does not have graphics.
 	*/
 	int32_t getLayer() const;
+	/**
+		Returns object's graphics component. If object does not have graphics this throw GraphicsException.
+		@return pointer to object's graphics component.
+		@throw GraphicsException object does not have graphics.
+	*/
+	const std::shared_ptr<GraphicsComponent>& getGraphics() const;
+	/**
+		Sets whether the object is used as an occluder by occlusion culling. If object does not have graphics this throw GraphicsException.
+		@param occluder true if object should hide objects behind it, false otherwise.
+		@throw GraphicsException object does not have graphics.
+	*/
+	void setOccluder(const bool occluder);
 	/**
 		Returns id of the scene in which the object is contained.
 		@return id of the scene in which the object is contained.
@@ -2,9 +2,13 @@
 #include"vulkan\vulkan.hpp"
 #include"..\DebugTools\Assert.h"
 #include"..\Core\VModel.h"
+#include"..\Core\VTexture.h"
+#include<typeinfo>
 
 GraphicsComponent::GraphicsComponent(GraphicsComponent && x) : id{ x.id }, layer{ x.layer }, drawType{ x.drawType }, model{ std::move(x.model) }, texture{ std::move(x.texture) }, 
-																descriptor{ std::move(x.descriptor) }, uniform{ std::move(x.uniform) }
+																descriptor{ std::move(x.descriptor) }, uniform{ std::move(x.uniform) }, transform{ x.transform },
+																visible{ x.visible }, occluder{ x.occluder }, uploaded{ x.uploaded }, modelVersion{ x.modelVersion }, moved{ x.moved }, lod{ x.lod }, coverage{ x.coverage },
+																textureVersion{ x.textureVersion }, proxy{ x.proxy }
 {
 	x.id = -1;
 }
@@ -21,13 +25,34 @@ GraphicsComponent & GraphicsComponent::operator=(GraphicsComponent && x)
 		texture = std::move(x.texture);
 		descriptor = std::move(x.descriptor);
 		uniform = std::move(x.uniform);
+		transform = x.transform;
+		visible = x.visible;
+		occluder = x.occluder;
+		uploaded = x.uploaded;
+		modelVersion = x.modelVersion;
+		moved = x.moved;
+		lod = x.lod;
+		coverage = x.coverage;
+		textureVersion = x.textureVersion;
+		proxy = x.proxy;
 	}
 	return *this;
 }
 
 void GraphicsComponent::updateUniform(const glm::mat4& mat)
 {
-	uniform.updateBuffer(mat);
+	//static objects keep their transformation, so there is nothing to upload unless their model was reloaded.
+	if (uploaded && mat == transform && modelVersion == model->version)
+	{
+		return;
+	}
+	//quantised vertex positions are decoded by the uploaded transformation.
+	uniform.updateBuffer(mat * model->getDequantization());
+	transform = mat;
+	uploaded = true;
+	modelVersion = model->version;
+	//a reloaded model has new bounds, so the component is refitted in the spatial index as if it moved.
+	moved = true;
 }
 
 PipelineType GraphicsComponent::getDrawType() const
@@ -43,14 +68,69 @@ void GraphicsComponent::setDrawType(const PipelineType type)
 void GraphicsComponent::draw(const vk::CommandBuffer& buffer, const Pipeline& pipeline) const
 {
 	ASSERT(*pipeline.layout->getLocalSet() == descriptor.getDescriptorLayout())
-	// Bind vertex buffer
-	model->vertices.bind(buffer, 0);
-	// Bind index buffer
-	model->indices.bind(buffer, 0);
 	// Bind descriptor set to pipeline
 	buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline.layout, 1, vk::ArrayProxy<const vk::DescriptorSet>(descriptor), nullptr);
-	// Issue a draw call
-	buffer.drawIndexed(model->indices.getIndicesCount(), 1, 0, 0, 0);
+	// Issue a draw call for model's part of the arena
+	const MeshRange& range = model->getLod(lod);
+	buffer.drawIndexed(range.indexCount, 1, range.firstIndex, range.vertexOffset, 0);
+}
+
+bool GraphicsComponent::sharesMaterial(const GraphicsComponent & other) const
+{
+	return typeid(*this) == typeid(other) && texture == other.texture;
+}
+
+uint32_t GraphicsComponent::getTextures(VTexture * textures[]) const
+{
+	textures[0] = texture.get();
+	return 1;
+}
+
+uint32_t GraphicsComponent::getTextureVersion() const
+{
+	VTexture* textures[maxTextures];
+	uint32_t count = getTextures(textures);
+	uint32_t version = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		version += textures[i]->getVersion();
+	}
+	return version;
+}
+
+const glm::mat4 & GraphicsComponent::getTransform() const
+{
+	return transform;
+}
+
+const VModel & GraphicsComponent::getModel() const
+{
+	return *model;
+}
+
+bool GraphicsComponent::isVisible() const
+{
+	return visible;
+}
+
+void GraphicsComponent::setVisible(const bool visible)
+{
+	this->visible = visible;
+}
+
+bool GraphicsComponent::isOccluder() const
+{
+	return occluder;
+}
+
+void GraphicsComponent::setOccluder(const bool occluder)
+{
+	this->occluder = occluder;
+}
+
+uint32_t GraphicsComponent::getLod() const
+{
+	return lod;
 }
 
 uint32_t GraphicsComponent::getId() const
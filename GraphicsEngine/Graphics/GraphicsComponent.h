@@ -46,10 +46,64 @@ public:
 	void setDrawType(const PipelineType type);
 	/**
 		Issues a draw command for drawing a component. Command buffer must be started and graphics pipeline must be bound before issuing this call.
+		Mesh arena in which component's model is stored must be bound as well.
 		@param buffer command buffer used for issuing commands.
 		@param pipeline graphics pipeline with which the component will be drawn.
 	*/
 	virtual void draw(const vk::CommandBuffer& buffer, const Pipeline& pipeline) const;
+	/**
+		Checks if two components use the same textures so they can be drawn with the same descriptor set by indirect pipelines.
+		@param other component to compare with.
+		@return true if components share textures, false otherwise.
+	*/
+	virtual bool sharesMaterial(const GraphicsComponent& other) const;
+	/**
+		Returns component's textures in the order of their bindings in the component's descriptor set, starting with binding 1.
+		@param textures array filled with pointers to the textures.
+		@return number of textures.
+	*/
+	virtual uint32_t getTextures(VTexture* textures[]) const;
+	/**
+		Returns the sum of versions of component's textures, which changes whenever one of their images is replaced.
+		@return version of component's textures.
+	*/
+	uint32_t getTextureVersion() const;
+	/**
+		Returns component's model transformation set by the last uniform update.
+		@return model transformation matrix.
+	*/
+	const glm::mat4& getTransform() const;
+	/**
+		Returns the model drawn by the component.
+		@return component's model.
+	*/
+	const VModel& getModel() const;
+	/**
+		Checks if the component is drawn. Components hidden by culling are not drawn.
+		@return true if component is drawn, false otherwise.
+	*/
+	bool isVisible() const;
+	/**
+		Sets whether the component is drawn.
+		@param visible true if component should be drawn, false otherwise.
+	*/
+	void setVisible(const bool visible);
+	/**
+		Checks if the component is used as an occluder by occlusion culling.
+		@return true if component is an occluder, false otherwise.
+	*/
+	bool isOccluder() const;
+	/**
+		Sets whether the component is used as an occluder by occlusion culling.
+		Good occluders are large, closed and simple meshes such as walls and floors.
+		@param occluder true if component should be an occluder, false otherwise.
+	*/
+	void setOccluder(const bool occluder);
+	/**
+		Returns the level of detail the component is drawn with.
+		@return level of detail, 0 being the full model.
+	*/
+	uint32_t getLod() const;
 	/**
 		Returns component's id.
 		@return component's id.
@@ -64,7 +118,9 @@ public:
 		Destructor.
 	*/
 	virtual ~GraphicsComponent();
+	static const uint32_t maxTextures = 3;	//*< Largest number of textures a component uses.
 	friend class VulkanEngine;
+	friend class Scene;
 protected:
 	/**
 		Clears all neccesary components.
@@ -77,4 +133,14 @@ protected:
 	std::shared_ptr<VTexture> texture;	//*< Pointer to component's texture. 
 	DescriptorSet descriptor;			//*< Descriptor set which describes a local 
 	DynamicBuffer<glm::mat4> uniform;	//*< Buffer used to store component's model transformation.
+	glm::mat4 transform{ 1.0f };		//*< Copy of component's model transformation uploaded for indirect drawing.
+	bool visible{ true };				//*< Flag determining if the component is drawn.
+	bool occluder{ false };				//*< Flag determining if the component is used as an occluder.
+	bool uploaded{ false };				//*< Flag determining if transformation was already uploaded to the uniform buffer.
+	uint32_t modelVersion{ 0 };			//*< Version of component's model when its transformation was uploaded.
+	bool moved{ true };					//*< Flag set when transformation changes, cleared by the scene once its spatial index is updated.
+	uint32_t lod{ 0 };					//*< Level of detail of the model the component is drawn with, chosen by the scene.
+	float coverage{ 1.0f };				//*< Diameter of component's bounds on the screen relative to the screen height, set by the scene. Components which aren't culled cover the whole screen.
+	uint32_t textureVersion{ 0 };		//*< Sum of versions of component's textures when their descriptors were written.
+	int32_t proxy{ -1 };				//*< Proxy of the component in the spatial index of its scene, -1 if it isn't indexed.
 };
\ No newline at end of file
@@ -20,6 +20,19 @@ ParallaxComponent::~ParallaxComponent()
 	GraphicsComponent::clear();
 }
 
+bool ParallaxComponent::sharesMaterial(const GraphicsComponent & other) const
+{
+	return GraphicsComponent::sharesMaterial(other) && normalMap == static_cast<const ParallaxComponent&>(other).normalMap && depthMap == static_cast<const ParallaxComponent&>(other).depthMap;
+}
+
+uint32_t ParallaxComponent::getTextures(VTexture * textures[]) const
+{
+	GraphicsComponent::getTextures(textures);
+	textures[1] = normalMap.get();
+	textures[2] = depthMap.get();
+	return 3;
+}
+
 void ParallaxComponent::clear()
 {
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include<list>
 #include"..\Core\DescriptorSet.h"
+#include"..\Core\GpuScene.h"
 #include"GraphicsComponent.h"
 
 /**
@@ -9,6 +10,9 @@
 struct SceneGraphics
 {
 	int32_t id{ -1 };										//*< Scene's id.
-	std::vector<DescriptorSet> descriptors;					//*< Descriptor sets containing global shader sets.
+	std::vector<DescriptorSet> descriptors;					//*< Descriptor sets containing global shader sets, one for every global layout used by pipelines.
+	std::vector<vk::DescriptorBufferInfo> globalBuffers;	//*< Buffers of global shader variables indexed by their bindings in global sets. Not owned.
+	std::vector<int32_t> variants;							//*< Indices of the engine's specialised pipelines the scene draws with, indexed by PipelineType. -1 if the base pipeline is used.
 	std::list<std::shared_ptr<GraphicsComponent>> items;	//*< Items contained in the scene.
+	GpuScene gpu;											//*< Buffers and batches used to cull and draw the scene on the GPU.
 };
\ No newline at end of file
@@ -31,11 +31,10 @@ struct Vertex3DTT
 	glm::vec3 pos;
 	glm::vec3 normal;
 	glm::vec2 uv;
-	glm::vec3 tangent;
-	glm::vec3 bitangent;
+	glm::vec4 tangent;	//*< Unit tangent in xyz and handedness in w, bitangent = w * cross(normal, tangent).
 	bool operator==(const Vertex3DTT& other) const
 	{
-		return pos == other.pos && normal == other.normal && uv == other.uv && tangent == other.tangent && bitangent == other.bitangent;
+		return pos == other.pos && normal == other.normal && uv == other.uv && tangent == other.tangent;
 	}
 	static vk::VertexInputBindingDescription bindingDescription()
 	{
@@ -46,8 +45,75 @@ struct Vertex3DTT
 		return std::vector<vk::VertexInputAttributeDescription>{vk::VertexInputAttributeDescription{ 0,0,vk::Format::eR32G32B32Sfloat, offsetof(Vertex3DTT, pos) },
 			vk::VertexInputAttributeDescription{ 1,0,vk::Format::eR32G32B32Sfloat, offsetof(Vertex3DTT, normal) },
 			vk::VertexInputAttributeDescription{ 2,0,vk::Format::eR32G32Sfloat, offsetof(Vertex3DTT, uv) },
-			vk::VertexInputAttributeDescription{ 3,0,vk::Format::eR32G32B32Sfloat, offsetof(Vertex3DTT, tangent) },
-			vk::VertexInputAttributeDescription{ 4,0,vk::Format::eR32G32B32Sfloat, offsetof(Vertex3DTT, bitangent) } };
+			vk::VertexInputAttributeDescription{ 3,0,vk::Format::eR32G32B32A32Sfloat, offsetof(Vertex3DTT, tangent) } };
+	}
+};
+
+/**
+	Encoding of quantised positions. Both store positions relative to the bounds of the mesh, in range [-1, 1].
+*/
+enum class PositionEncoding
+{
+	eSnorm16,	//*< 16-bit signed normalized integers, uniform precision across the mesh.
+	eHalf		//*< 16-bit floats, more precise near the center of the mesh and less near its bounds.
+};
+
+/**
+	Returns the vertex input format of four quantised position components.
+	@param encoding encoding of the positions.
+	@return vertex input format.
+*/
+inline vk::Format getPositionFormat(const PositionEncoding encoding)
+{
+	return encoding == PositionEncoding::eHalf ? vk::Format::eR16G16B16A16Sfloat : vk::Format::eR16G16B16A16Snorm;
+}
+
+/**
+	Packed counterpart of Vertex3DT which is stored in the GPU. 16 bytes instead of 32.
+	Normal is octahedral encoded and uvs are half floats. Decoded by simpleShader.vert and lightShader.vert.
+*/
+struct PackedVertex3DT
+{
+	static const PositionEncoding positionEncoding = PositionEncoding::eSnorm16;	//*< Encoding of positions of models of type e3D.
+	uint16_t pos[4];	//*< Position relative to mesh bounds, last component is unused.
+	int16_t normal[2];	//*< Octahedral encoded normal.
+	uint16_t uv[2];		//*< Texture coordinates as half floats.
+
+	static vk::VertexInputBindingDescription bindingDescription()
+	{
+		return vk::VertexInputBindingDescription{ 0, sizeof(PackedVertex3DT), vk::VertexInputRate::eVertex };
+	}
+	static std::vector<vk::VertexInputAttributeDescription> attributeDescriptions()
+	{
+		return std::vector<vk::VertexInputAttributeDescription>{vk::VertexInputAttributeDescription{ 0,0,getPositionFormat(positionEncoding), offsetof(PackedVertex3DT, pos) },
+			vk::VertexInputAttributeDescription{ 1,0,vk::Format::eR16G16Snorm, offsetof(PackedVertex3DT, normal) },
+			vk::VertexInputAttributeDescription{ 2,0,vk::Format::eR16G16Sfloat, offsetof(PackedVertex3DT, uv) } };
+	}
+};
+
+/**
+	Packed counterpart of Vertex3DTT which is stored in the GPU. 20 bytes instead of 48.
+	Normal and tangent are octahedral encoded and the bitangent is rebuilt from them, using the sign stored in the last position component.
+	Decoded by tangentSpace.vert.
+*/
+struct PackedVertex3DTT
+{
+	static const PositionEncoding positionEncoding = PositionEncoding::eSnorm16;	//*< Encoding of positions of models of type e3DTangent.
+	uint16_t pos[4];	//*< Position relative to mesh bounds, last component is the sign of the bitangent.
+	int16_t normal[2];	//*< Octahedral encoded normal.
+	uint16_t uv[2];		//*< Texture coordinates as half floats.
+	int16_t tangent[2];	//*< Octahedral encoded tangent.
+
+	static vk::VertexInputBindingDescription bindingDescription()
+	{
+		return vk::VertexInputBindingDescription{ 0, sizeof(PackedVertex3DTT), vk::VertexInputRate::eVertex };
+	}
+	static std::vector<vk::VertexInputAttributeDescription> attributeDescriptions()
+	{
+		return std::vector<vk::VertexInputAttributeDescription>{vk::VertexInputAttributeDescription{ 0,0,getPositionFormat(positionEncoding), offsetof(PackedVertex3DTT, pos) },
+			vk::VertexInputAttributeDescription{ 1,0,vk::Format::eR16G16Snorm, offsetof(PackedVertex3DTT, normal) },
+			vk::VertexInputAttributeDescription{ 2,0,vk::Format::eR16G16Sfloat, offsetof(PackedVertex3DTT, uv) },
+			vk::VertexInputAttributeDescription{ 3,0,vk::Format::eR16G16Snorm, offsetof(PackedVertex3DTT, tangent) } };
 	}
 };
 
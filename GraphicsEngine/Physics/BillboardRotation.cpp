@@ -4,7 +4,7 @@
 #include"..\DebugTools\Assert.h"
 #include"..\Core\Constants.h"
 
-BillboardRotation::BillboardRotation(const Scene * scene, const Axis axis) : scene{ scene }
+BillboardRotation::BillboardRotation(const Scene * scene, const Axis axis) : scene{ scene }, lastCameraVersion{ 0 }
 {
 	axisMask = glm::vec3{ 1,1,1 };
 	// if we rotate around X axis we take in consideration only Y and Z axis when calculating
@@ -26,8 +26,19 @@ BillboardRotation::BillboardRotation(const Scene * scene, const Axis axis) : sce
 
 void BillboardRotation::update(GameObject * obj, const double time)
 {
-	glm::vec3 camPos = scene->getCameraPosition();
+	uint64_t cameraVersion = scene->getCameraVersion();
 	glm::vec3 objPos = obj->getPosition();
+	glm::mat4 rotMatrix = obj->getRotationMatrix();
+	// if neither camera nor the object changed since the last update, object is already facing the camera.
+	if (cameraVersion == lastCameraVersion && objPos == lastPosition && rotMatrix == lastRotation)
+	{
+		return;
+	}
+	lastCameraVersion = cameraVersion;
+	lastPosition = objPos;
+	lastRotation = rotMatrix;
+
+	glm::vec3 camPos = scene->getCameraPosition();
 
 	// if camera and object are in the same position, we don't rotate the object
 	if (camPos == objPos)
@@ -41,7 +52,6 @@ void BillboardRotation::update(GameObject * obj, const double time)
 	objToCamVector = glm::normalize(axisMask * objToCamVector);
 
 	//calculate objects forward vector and mask it.
-	glm::mat4 rotMatrix = obj->getRotationMatrix();
 	glm::vec4 forward = rotMatrix * cnst::forwardVector;
 	glm::vec3 forwardMasked = axisMask * glm::vec3{ forward.x, forward.y, forward.z };
 
@@ -79,6 +89,7 @@ void BillboardRotation::update(GameObject * obj, const double time)
 	float radians = glm::acos(cosine);
 	glm::mat4 newMatrix = glm::rotate(glm::mat4(), radians, rotationVector);
 	obj->setRotationMatrix(newMatrix * rotMatrix);
+	lastRotation = obj->getRotationMatrix();
 
 	ASSERT(!std::isnan(obj->getRotationMatrix()[0][0]))
 }
\ No newline at end of file
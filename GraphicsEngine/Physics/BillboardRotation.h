@@ -26,4 +26,7 @@ public:
 private:
 	const Scene* scene;		//*< Pointer to a Scene object.
 	glm::vec3 axisMask;		//*< 3D vector used to determine around which axis we need to rotate the object.
+	uint64_t lastCameraVersion;		//*< Version of the camera at the time of the last update.
+	glm::vec3 lastPosition;			//*< Position of the object at the time of the last update.
+	glm::mat4 lastRotation;			//*< Rotation matrix of the object after the last update.
 };
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "AssetId.h"
+#include<cctype>
+#include<mutex>
+#include<stdexcept>
+#include<unordered_map>
+
+namespace
+{
+	/**
+		Interned path.
+	*/
+	struct InternedPath
+	{
+		std::string normalized;		//*< Normalised path, used to detect different paths with the same hash.
+		std::string path;			//*< First spelling of the path.
+	};
+
+	/**
+		Table of interned paths.
+	*/
+	struct InternTable
+	{
+		std::mutex mutex;										//*< Mutex guarding the table.
+		std::unordered_map<uint64_t, InternedPath> paths;		//*< Interned paths by their hashes. Nodes don't move, so ids can point to their paths.
+	};
+
+	/**
+		Returns the table of interned paths. It's created on first use, so ids can be created during static initialisation.
+	*/
+	InternTable& getTable()
+	{
+		static InternTable table;
+		return table;
+	}
+
+	/**
+		Skips the leading "./" of a path, which doesn't change the file it refers to.
+	*/
+	const char* skipPrefix(const char* path)
+	{
+		while (path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+		{
+			path += 2;
+		}
+		return path;
+	}
+
+	/**
+		Returns the normalised form of a single character of a path.
+	*/
+	char normalizeChar(char c)
+	{
+		return c == '\\' ? '/' : static_cast<char>(tolower(static_cast<unsigned char>(c)));
+	}
+
+	/**
+		Checks if a path normalises to a given normalised path.
+	*/
+	bool matches(const char* path, const std::string& normalized)
+	{
+		path = skipPrefix(path);
+		size_t i = 0;
+		for (; path[i] != '\0'; i++)
+		{
+			if (i == normalized.size() || normalizeChar(path[i]) != normalized[i])
+			{
+				return false;
+			}
+		}
+		return i == normalized.size();
+	}
+}
+
+AssetId::AssetId() : pathHash{ 0 }, path{ nullptr } {}
+
+AssetId::AssetId(const char * path) : pathHash{ 0 }, path{ nullptr }
+{
+	if (path == nullptr)
+	{
+		return;
+	}
+	pathHash = hash(path);
+	InternTable& table = getTable();
+	std::lock_guard<std::mutex> lock{ table.mutex };
+	auto it = table.paths.find(pathHash);
+	if (it == table.paths.end())
+	{
+		it = table.paths.emplace(pathHash, InternedPath{ normalize(path), path }).first;
+	}
+	else if (!matches(path, it->second.normalized))
+	{
+		throw std::runtime_error("asset " + std::string(path) + " has the same id as " + it->second.path);
+	}
+	this->path = &it->second.path;
+}
+
+AssetId::AssetId(const std::string & path) : AssetId{ path.c_str() } {}
+
+bool AssetId::isValid() const
+{
+	return path != nullptr;
+}
+
+uint64_t AssetId::getHash() const
+{
+	return pathHash;
+}
+
+const std::string & AssetId::getPath() const
+{
+	static const std::string empty;
+	return path != nullptr ? *path : empty;
+}
+
+bool AssetId::operator==(const AssetId & x) const
+{
+	// paths are interned, so equal hashes mean equal paths
+	return pathHash == x.pathHash && path == x.path;
+}
+
+std::string AssetId::normalize(const std::string & path)
+{
+	std::string normalized = skipPrefix(path.c_str());
+	for (char& c : normalized)
+	{
+		c = normalizeChar(c);
+	}
+	return normalized;
+}
+
+uint64_t AssetId::hash(const char * path)
+{
+	uint64_t value = 14695981039346656037ull;
+	for (const char* c = skipPrefix(path); *c != '\0'; c++)
+	{
+		value ^= static_cast<unsigned char>(normalizeChar(*c));
+		value *= 1099511628211ull;
+	}
+	return value;
+}
\ No newline at end of file
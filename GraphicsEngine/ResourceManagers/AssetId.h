@@ -0,0 +1,67 @@
+#pragma once
+#include<string>
+#include<cstdint>
+
+/**
+	Asset id class.
+	Identifies an asset by the hash of its normalised path, with forward slashes and lowercase, so different spellings of a path are the same asset.
+	Paths are interned when an id is created: the first spelling of a path is kept for loading the asset, and two paths with the same hash are
+	reported instead of being silently treated as one asset. Creating an id of an already interned path doesn't allocate, and copying an id is free,
+	so ids created once can be passed around instead of paths.
+*/
+class AssetId
+{
+public:
+	/**
+		Constructor of an id of no asset.
+	*/
+	AssetId();
+	/**
+		Constructor.
+		@param path path to the asset, null for no asset.
+		@throws std::runtime_error if a different path with the same hash was interned before.
+	*/
+	AssetId(const char* path);
+	/**
+		Constructor.
+		@param path path to the asset.
+		@throws std::runtime_error if a different path with the same hash was interned before.
+	*/
+	AssetId(const std::string& path);
+	/**
+		Checks if the id refers to an asset.
+		@return true if the id was created from a path, false otherwise.
+	*/
+	bool isValid() const;
+	/**
+		Returns the hash of the normalised path.
+		@return hash of the asset.
+	*/
+	uint64_t getHash() const;
+	/**
+		Returns the path the asset was first requested with.
+		@return path to the asset, empty for no asset.
+	*/
+	const std::string& getPath() const;
+	/**
+		Compares two ids.
+		@param x id to compare with.
+		@return true if both ids refer to the same asset.
+	*/
+	bool operator==(const AssetId& x) const;
+	/**
+		Returns the normalised form of a path.
+		@param path path to normalise.
+		@return path with forward slashes, lowercase and without leading "./".
+	*/
+	static std::string normalize(const std::string& path);
+	/**
+		Returns the hash of the normalised form of a path, without building it.
+		@param path path to hash.
+		@return 64 bit FNV-1a hash of the normalised path.
+	*/
+	static uint64_t hash(const char* path);
+private:
+	uint64_t pathHash;			//*< Hash of the normalised path.
+	const std::string* path;	//*< Interned path, null for no asset.
+};
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "AssetPack.h"
+#include "FileSystem.h"
+#include "Lz4.h"
+#include "AssetId.h"
+#include<algorithm>
+#include<cstring>
+#include<fstream>
+#include<stdexcept>
+#ifdef _WIN32
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+namespace
+{
+	const uint32_t magic = 0x4b434150;	//*< Identifier at the start of every pack, reads "PACK".
+
+	/**
+		Header of a pack.
+	*/
+	struct Header
+	{
+		uint32_t magic;				//*< Identifier of the file format.
+		uint32_t version;			//*< Version of the format.
+		uint32_t entryCount;		//*< Number of files.
+		uint32_t namesSize;			//*< Size of the table of names.
+	};
+
+	/**
+		Rounds an offset up to the alignment of files.
+	*/
+	uint64_t align(uint64_t offset)
+	{
+		return (offset + AssetPack::alignment - 1) / AssetPack::alignment * AssetPack::alignment;
+	}
+
+	/**
+		Compares entries by the hashes of their paths.
+	*/
+	bool compareHash(const PackEntry& entry, uint64_t hash)
+	{
+		return entry.hash < hash;
+	}
+}
+
+AssetPack::AssetPack() : data{ nullptr }, size{ 0 }, entries{ nullptr }, entryCount{ 0 }, names{ nullptr },
+#ifdef _WIN32
+	file{ INVALID_HANDLE_VALUE }, mapping{ nullptr }
+#else
+	file{ -1 }
+#endif
+{
+}
+
+bool AssetPack::open(const std::string & filename)
+{
+	close();
+	name = filename;
+#ifdef _WIN32
+	file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	LARGE_INTEGER fileSize;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+	{
+		close();
+		return false;
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		close();
+		return false;
+	}
+	data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr)
+	{
+		close();
+		return false;
+	}
+#else
+	file = ::open(filename.c_str(), O_RDONLY);
+	struct stat info;
+	if (file < 0 || fstat(file, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header)))
+	{
+		close();
+		return false;
+	}
+	size = static_cast<size_t>(info.st_size);
+	void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	if (mapped == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	data = static_cast<const char*>(mapped);
+	// start reading the whole pack ahead, so first loads don't fault pages in one by one
+	madvise(mapped, size, MADV_WILLNEED);
+#endif
+	// validate the pack once, so lookups and reads don't need to check bounds
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	uint64_t namesOffset = sizeof(Header) + static_cast<uint64_t>(header.entryCount) * sizeof(PackEntry);
+	if (header.magic != magic || header.version != version || namesOffset + header.namesSize > size)
+	{
+		close();
+		return false;
+	}
+	entries = reinterpret_cast<const PackEntry*>(data + sizeof(Header));
+	entryCount = header.entryCount;
+	names = data + namesOffset;
+	for (uint32_t i = 0; i < entryCount; i++)
+	{
+		const PackEntry& entry = entries[i];
+		if (entry.offset > size || entry.storedSize > size - entry.offset || static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > header.namesSize ||
+			(entry.compression == PackCompression::eNone && entry.storedSize != entry.size) || entry.compression > PackCompression::eLz4 ||
+			(i > 0 && entries[i - 1].hash > entry.hash))
+		{
+			close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void AssetPack::close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mapping != nullptr)
+	{
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+	}
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data != nullptr)
+	{
+		munmap(const_cast<char*>(data), size);
+	}
+	if (file >= 0)
+	{
+		::close(file);
+	}
+	file = -1;
+#endif
+	data = nullptr;
+	size = 0;
+	entries = nullptr;
+	entryCount = 0;
+	names = nullptr;
+}
+
+const std::string & AssetPack::getName() const
+{
+	return name;
+}
+
+const PackEntry * AssetPack::find(const std::string & path) const
+{
+	std::string normalized = AssetId::normalize(path);
+	uint64_t pathHash = AssetId::hash(normalized.c_str());
+	const PackEntry* end = entries + entryCount;
+	// different paths may share a hash, so all entries with it are compared
+	for (const PackEntry* entry = std::lower_bound(entries, end, pathHash, compareHash); entry != end && entry->hash == pathHash; entry++)
+	{
+		if (entry->nameLength == normalized.size() && memcmp(names + entry->nameOffset, normalized.data(), normalized.size()) == 0)
+		{
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+FileView AssetPack::read(const PackEntry & entry, size_t maxSize) const
+{
+	size_t fileSize = static_cast<size_t>(entry.size);
+	if (entry.compression == PackCompression::eNone)
+	{
+		return FileView{ data + entry.offset, std::min(fileSize, maxSize) };
+	}
+	std::vector<char> buffer(fileSize);
+	if (!Lz4::decompress(data + entry.offset, static_cast<size_t>(entry.storedSize), buffer.data(), buffer.size()))
+	{
+		throw std::runtime_error("corrupted file " + std::string(names + entry.nameOffset, entry.nameLength) + " in pack " + name);
+	}
+	buffer.resize(std::min(fileSize, maxSize));
+	return FileView{ std::move(buffer) };
+}
+
+AssetPack::~AssetPack()
+{
+	close();
+}
+
+PackStats AssetPack::build(const std::string & filename, const std::vector<std::string>& paths, bool compress)
+{
+	PackStats stats;
+	std::vector<PackEntry> table;
+	std::vector<std::vector<char>> blobs;
+	std::string nameTable;
+	for (const std::string& path : paths)
+	{
+		FileView view = FileSystem::open(path);
+		PackEntry entry{};
+		if (!view.isValid() || !FileSystem::getInfo(path, entry.size, entry.time))
+		{
+			throw std::runtime_error("failed to read " + path);
+		}
+		std::string normalized = AssetId::normalize(path);
+		entry.hash = AssetId::hash(normalized.c_str());
+		entry.nameOffset = static_cast<uint32_t>(nameTable.size());
+		entry.nameLength = static_cast<uint32_t>(normalized.size());
+		nameTable += normalized;
+		std::vector<char> blob{ view.getData(), view.getData() + view.getSize() };
+		entry.compression = PackCompression::eNone;
+		if (compress)
+		{
+			// already compressed formats such as PNG or JPEG don't shrink, and are better read without a copy
+			std::vector<char> compressed = Lz4::compress(view.getData(), view.getSize());
+			if (compressed.size() < blob.size() - blob.size() / 8)
+			{
+				blob = std::move(compressed);
+				entry.compression = PackCompression::eLz4;
+			}
+		}
+		entry.storedSize = blob.size();
+		stats.files++;
+		stats.size += entry.size;
+		stats.storedSize += entry.storedSize;
+		table.push_back(entry);
+		blobs.push_back(std::move(blob));
+	}
+	// files follow the table of contents in the given order
+	uint64_t offset = align(sizeof(Header) + table.size() * sizeof(PackEntry) + nameTable.size());
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		table[i].offset = offset;
+		offset = align(offset + table[i].storedSize);
+	}
+	std::vector<size_t> order(table.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&table](size_t a, size_t b) { return table[a].hash < table[b].hash; });
+	for (size_t i = 1; i < order.size(); i++)
+	{
+		const PackEntry& a = table[order[i - 1]];
+		const PackEntry& b = table[order[i]];
+		if (a.hash == b.hash && a.nameLength == b.nameLength && nameTable.compare(a.nameOffset, a.nameLength, nameTable, b.nameOffset, b.nameLength) == 0)
+		{
+			throw std::runtime_error("file " + nameTable.substr(a.nameOffset, a.nameLength) + " is packed twice");
+		}
+	}
+
+	std::ofstream file{ filename, std::ios::binary | std::ios::trunc };
+	if (!file.is_open())
+	{
+		throw std::runtime_error("failed to open " + filename);
+	}
+	Header header{ magic, version, static_cast<uint32_t>(table.size()), static_cast<uint32_t>(nameTable.size()) };
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (size_t index : order)
+	{
+		file.write(reinterpret_cast<const char*>(&table[index]), sizeof(PackEntry));
+	}
+	file.write(nameTable.data(), nameTable.size());
+	const char padding[alignment] = {};
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		file.write(padding, static_cast<std::streamsize>(table[i].offset - static_cast<uint64_t>(file.tellp())));
+		file.write(blobs[i].data(), blobs[i].size());
+	}
+	stats.packSize = static_cast<uint64_t>(file.tellp());
+	if (!file)
+	{
+		throw std::runtime_error("failed to write " + filename);
+	}
+	return stats;
+}
\ No newline at end of file
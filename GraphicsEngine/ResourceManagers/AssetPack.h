@@ -0,0 +1,114 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<cstdint>
+#include"FileView.h"
+
+/**
+	Compression of a file stored in an asset pack.
+*/
+enum class PackCompression : uint32_t {
+	eNone = 0,	//*< Stored as it is, read without copying.
+	eLz4		//*< Stored as a single LZ4 block.
+};
+
+/**
+	Entry of the table of contents of an asset pack.
+*/
+struct PackEntry
+{
+	uint64_t hash;				//*< Hash of the normalised path of the file, same as its asset id, entries are sorted by it.
+	uint64_t offset;			//*< Offset of the stored file from the start of the pack.
+	uint64_t storedSize;		//*< Size of the stored, possibly compressed file.
+	uint64_t size;				//*< Size of the file.
+	int64_t time;				//*< Modification time of the file when it was packed.
+	uint32_t nameOffset;		//*< Offset of the normalised path in the table of names.
+	uint32_t nameLength;		//*< Length of the normalised path.
+	PackCompression compression;	//*< Compression of the stored file.
+	uint32_t padding;			//*< Unused, keeps entries 8 byte aligned.
+};
+
+/**
+	Statistics of a built asset pack.
+*/
+struct PackStats
+{
+	uint32_t files{ 0 };		//*< Number of packed files.
+	uint64_t size{ 0 };			//*< Total size of the packed files.
+	uint64_t storedSize{ 0 };	//*< Total size of the files as stored in the pack.
+	uint64_t packSize{ 0 };		//*< Size of the pack file.
+};
+
+/**
+	Asset pack class.
+	Single file containing many asset files, mapped into memory as a whole so files are read without opening them one by one.
+	Files are stored under their normalised paths, as paths aren't case sensitive on Windows.
+	Pack starts with a table of contents sorted by hashes of the paths, followed by the paths and by the files, each aligned to 64 bytes.
+	Files are stored in the order they were given to the builder, so files loaded together are read sequentially.
+*/
+class AssetPack
+{
+public:
+	static const uint32_t version = 1;		//*< Version of the pack format. Packs with a different version aren't opened.
+	static const uint64_t alignment = 64;	//*< Alignment of files in the pack.
+	/**
+		Constructor.
+	*/
+	AssetPack();
+	AssetPack(AssetPack& x) = delete;
+	AssetPack& operator=(AssetPack& x) = delete;
+	/**
+		Maps a pack file into memory.
+		@param filename path to the pack.
+		@return true if the pack was opened, false if it is missing or isn't a valid pack.
+	*/
+	bool open(const std::string& filename);
+	/**
+		Unmaps the pack. Views of its files become invalid.
+	*/
+	void close();
+	/**
+		Returns the name of the pack file.
+		@return path to the pack.
+	*/
+	const std::string& getName() const;
+	/**
+		Finds a file in the pack.
+		@param path path of the file.
+		@return entry of the file, null if the pack doesn't contain it.
+	*/
+	const PackEntry* find(const std::string& path) const;
+	/**
+		Reads a file from the pack. Uncompressed files aren't copied.
+		@param entry entry of the file.
+		@param maxSize largest number of bytes from the start of the file which are needed.
+		@return view of the file.
+	*/
+	FileView read(const PackEntry& entry, size_t maxSize = SIZE_MAX) const;
+	/**
+		Destructor.
+	*/
+	~AssetPack();
+	/**
+		Builds a pack out of files on disk.
+		@param filename path of the pack to write.
+		@param paths paths of the files to pack, in the order they should be stored.
+		@param compress whether files which compress well are stored compressed.
+		@return statistics of the pack.
+		@throws std::runtime_error if a file can't be read or the pack can't be written.
+	*/
+	static PackStats build(const std::string& filename, const std::vector<std::string>& paths, bool compress);
+private:
+	std::string name;				//*< Path to the pack.
+	const char* data;				//*< Mapped contents of the pack.
+	size_t size;					//*< Size of the pack in bytes.
+	const PackEntry* entries;		//*< Table of contents.
+	uint32_t entryCount;			//*< Number of files in the pack.
+	const char* names;				//*< Table of normalised paths.
+#ifdef _WIN32
+	void* file;						//*< Handle of the pack file.
+	void* mapping;					//*< Handle of the file mapping.
+#else
+	int file;						//*< Descriptor of the pack file.
+#endif
+};
\ No newline at end of file
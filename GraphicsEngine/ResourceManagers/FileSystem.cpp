@@ -0,0 +1,109 @@
+#include "FileSystem.h"
+#include "AssetPack.h"
+#include<algorithm>
+#include<memory>
+#include<mutex>
+#include<vector>
+#include<fstream>
+#include<sys\stat.h>
+
+namespace
+{
+	std::mutex packsMutex;								//*< Mutex guarding the list of mounted packs.
+	std::vector<std::unique_ptr<AssetPack>> packs;		//*< Mounted packs in the order they were mounted.
+
+	/**
+		Finds a file in the mounted packs.
+		@return entry of the file, null if no pack contains it.
+	*/
+	const PackEntry* findPacked(const std::string& path, const AssetPack*& pack)
+	{
+		for (auto it = packs.rbegin(); it != packs.rend(); ++it)
+		{
+			const PackEntry* entry = (*it)->find(path);
+			if (entry != nullptr)
+			{
+				pack = it->get();
+				return entry;
+			}
+		}
+		return nullptr;
+	}
+}
+
+bool FileSystem::mount(const std::string & filename)
+{
+	std::unique_ptr<AssetPack> pack{ new AssetPack() };
+	if (!pack->open(filename))
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock{ packsMutex };
+	packs.push_back(std::move(pack));
+	return true;
+}
+
+void FileSystem::unmountAll()
+{
+	std::lock_guard<std::mutex> lock{ packsMutex };
+	packs.clear();
+}
+
+FileView FileSystem::open(const std::string & path, size_t maxSize)
+{
+	const AssetPack* pack = nullptr;
+	const PackEntry* entry;
+	{
+		std::lock_guard<std::mutex> lock{ packsMutex };
+		entry = findPacked(path, pack);
+	}
+	// packs stay mapped until unmountAll, so decompression doesn't need to hold the lock
+	if (entry != nullptr)
+	{
+		return pack->read(*entry, maxSize);
+	}
+	std::ifstream file{ path, std::ios::ate | std::ios::binary };
+	if (!file.is_open())
+	{
+		return FileView{};
+	}
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	std::vector<char> buffer(std::min(fileSize, maxSize));
+	file.seekg(0);
+	file.read(buffer.data(), buffer.size());
+	if (!file)
+	{
+		return FileView{};
+	}
+	return FileView{ std::move(buffer) };
+}
+
+bool FileSystem::exists(const std::string & path)
+{
+	uint64_t size;
+	int64_t time;
+	return getInfo(path, size, time);
+}
+
+bool FileSystem::getInfo(const std::string & path, uint64_t & size, int64_t & time)
+{
+	{
+		std::lock_guard<std::mutex> lock{ packsMutex };
+		const AssetPack* pack;
+		const PackEntry* entry = findPacked(path, pack);
+		if (entry != nullptr)
+		{
+			size = entry->size;
+			time = entry->time;
+			return true;
+		}
+	}
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+	{
+		return false;
+	}
+	size = static_cast<uint64_t>(info.st_size);
+	time = static_cast<int64_t>(info.st_mtime);
+	return true;
+}
\ No newline at end of file
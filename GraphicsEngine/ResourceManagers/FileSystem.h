@@ -0,0 +1,46 @@
+#pragma once
+#include<string>
+#include<cstdint>
+#include"FileView.h"
+
+/**
+	File system class.
+	Virtual file system through which all loaders read assets. Files are looked up in mounted asset packs, the most recently mounted first,
+	and read from disk if no pack contains them. Paths of packed files aren't case sensitive and may use either kind of slashes.
+	Functions can be called from several threads at once.
+*/
+class FileSystem
+{
+public:
+	/**
+		Mounts an asset pack.
+		@param filename path to the pack.
+		@return true if the pack was mounted, false if it is missing or isn't a valid pack.
+	*/
+	static bool mount(const std::string& filename);
+	/**
+		Unmounts all asset packs. Views of packed files become invalid, so it may be called only when nothing holds them.
+	*/
+	static void unmountAll();
+	/**
+		Reads a file.
+		@param path path to the file.
+		@param maxSize largest number of bytes from the start of the file which are needed.
+		@return view of the file, invalid if the file doesn't exist.
+	*/
+	static FileView open(const std::string& path, size_t maxSize = SIZE_MAX);
+	/**
+		Checks if a file exists.
+		@param path path to the file.
+		@return true if the file exists, false otherwise.
+	*/
+	static bool exists(const std::string& path);
+	/**
+		Reads size and modification time of a file. Packed files report the ones they had when they were packed.
+		@param path path to the file.
+		@param size size of the file in bytes.
+		@param time modification time of the file.
+		@return true if the file exists, false otherwise.
+	*/
+	static bool getInfo(const std::string& path, uint64_t& size, int64_t& time);
+};
\ No newline at end of file
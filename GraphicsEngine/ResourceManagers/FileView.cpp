@@ -0,0 +1,64 @@
+#include "FileView.h"
+
+FileView::FileView() : data{ nullptr }, size{ 0 }, valid{ false } {}
+
+FileView::FileView(const char * data, size_t size) : data{ data }, size{ size }, valid{ true } {}
+
+FileView::FileView(std::vector<char>&& buffer) : valid{ true }, buffer{ std::move(buffer) }
+{
+	data = this->buffer.data();
+	size = this->buffer.size();
+}
+
+FileView::FileView(FileView && x)
+{
+	// moving the buffer keeps its storage, so data stays valid
+	buffer = std::move(x.buffer);
+	data = x.data;
+	size = x.size;
+	valid = x.valid;
+
+	x.data = nullptr;
+	x.size = 0;
+	x.valid = false;
+}
+
+FileView & FileView::operator=(FileView && x)
+{
+	if (this != &x)
+	{
+		buffer = std::move(x.buffer);
+		data = x.data;
+		size = x.size;
+		valid = x.valid;
+
+		x.data = nullptr;
+		x.size = 0;
+		x.valid = false;
+	}
+	return *this;
+}
+
+bool FileView::isValid() const
+{
+	return valid;
+}
+
+const char * FileView::getData() const
+{
+	return data;
+}
+
+size_t FileView::getSize() const
+{
+	return size;
+}
+
+ViewBuffer::ViewBuffer(const FileView & view)
+{
+	// the get area is never written to, streambuf just doesn't have a const version
+	char* begin = const_cast<char*>(view.getData());
+	setg(begin, begin, begin + view.getSize());
+}
+
+ViewStream::ViewStream(const FileView & view) : ViewBuffer{ view }, std::istream{ static_cast<ViewBuffer*>(this) } {}
\ No newline at end of file
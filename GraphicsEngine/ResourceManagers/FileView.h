@@ -0,0 +1,85 @@
+#pragma once
+#include<vector>
+#include<istream>
+#include<streambuf>
+
+/**
+	File view class.
+	Read only view of the contents of a file. Views of files stored uncompressed in a mounted asset pack point directly into the mapped pack,
+	other views own a buffer with the contents. Views of packed files are valid only while their pack is mounted.
+*/
+class FileView
+{
+public:
+	/**
+		Constructor of a view of a missing file.
+	*/
+	FileView();
+	/**
+		Constructor of a view of data owned by somebody else.
+		@param data contents of the file.
+		@param size size of the file in bytes.
+	*/
+	FileView(const char* data, size_t size);
+	/**
+		Constructor of a view owning the contents of the file.
+		@param buffer contents of the file.
+	*/
+	FileView(std::vector<char>&& buffer);
+	FileView(FileView& x) = delete;
+	/**
+		Move constructor.
+	*/
+	FileView(FileView&& x);
+	FileView& operator=(FileView& x) = delete;
+	/**
+		Move assignment operator.
+	*/
+	FileView& operator=(FileView&& x);
+	/**
+		Checks if the file was found.
+		@return true if the view has the file's contents, false otherwise.
+	*/
+	bool isValid() const;
+	/**
+		Returns the contents of the file.
+		@return pointer to the first byte of the file.
+	*/
+	const char* getData() const;
+	/**
+		Returns the size of the file.
+		@return size of the file in bytes.
+	*/
+	size_t getSize() const;
+private:
+	const char* data;			//*< Contents of the file.
+	size_t size;				//*< Size of the file in bytes.
+	bool valid;					//*< Whether the file was found.
+	std::vector<char> buffer;	//*< Contents of the file if the view owns them.
+};
+
+/**
+	Stream buffer reading a file view.
+*/
+class ViewBuffer : public std::streambuf
+{
+public:
+	/**
+		Constructor.
+		@param view view to read, needs to outlive the buffer.
+	*/
+	ViewBuffer(const FileView& view);
+};
+
+/**
+	Input stream reading a file view, for loaders parsing streams instead of files.
+*/
+class ViewStream : private ViewBuffer, public std::istream
+{
+public:
+	/**
+		Constructor.
+		@param view view to read, needs to outlive the stream.
+	*/
+	ViewStream(const FileView& view);
+};
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "FileWatcher.h"
+#ifdef _WIN32
+#include<algorithm>
+#include<windows.h>
+#else
+#include<sys/inotify.h>
+#include<dirent.h>
+#include<poll.h>
+#include<unistd.h>
+#include<cstring>
+#endif
+
+namespace
+{
+	const std::chrono::milliseconds settleTime{ 50 };	//*< Time a changed file has to stay untouched before its change is reported.
+	const size_t bufferSize = 64 * 1024;		//*< Size of the buffer notifications are read into.
+#ifndef _WIN32
+	const int pollTimeout = 100;				//*< Milliseconds the background thread waits for notifications before checking if it should stop.
+	const uint32_t events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;	//*< Notifications requested for watched directories.
+#endif
+}
+
+FileWatcher::FileWatcher(const std::vector<std::string>& directories)
+{
+#ifdef _WIN32
+	stopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	for (const std::string& directory : directories)
+	{
+		HANDLE handle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (handle != INVALID_HANDLE_VALUE)
+		{
+			handles.push_back(handle);
+			this->directories.push_back(directory);
+		}
+	}
+	if (stopEvent == nullptr || handles.empty())
+	{
+		return;
+	}
+#else
+	notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notify < 0)
+	{
+		return;
+	}
+	for (const std::string& directory : directories)
+	{
+		size_t count = watches.size();
+		watch(directory);
+		if (watches.size() > count)
+		{
+			this->directories.push_back(directory);
+		}
+	}
+	if (watches.empty())
+	{
+		return;
+	}
+#endif
+	running = true;
+	thread = std::thread{ &FileWatcher::run, this };
+}
+
+bool FileWatcher::isWatching() const
+{
+	return running;
+}
+
+std::vector<std::string> FileWatcher::takeChanges()
+{
+	std::vector<std::string> settled;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock{ mutex };
+	for (auto it = changes.begin(); it != changes.end();)
+	{
+		if (now - it->second >= settleTime)
+		{
+			settled.push_back(it->first);
+			it = changes.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	return settled;
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (running)
+	{
+		running = false;
+#ifdef _WIN32
+		SetEvent(stopEvent);
+#endif
+		thread.join();
+	}
+#ifdef _WIN32
+	for (void* handle : handles)
+	{
+		CloseHandle(handle);
+	}
+	if (stopEvent != nullptr)
+	{
+		CloseHandle(stopEvent);
+	}
+#else
+	if (notify >= 0)
+	{
+		close(notify);
+	}
+#endif
+}
+
+void FileWatcher::addChange(const std::string & path)
+{
+	std::lock_guard<std::mutex> lock{ mutex };
+	changes[path] = std::chrono::steady_clock::now();
+}
+
+#ifdef _WIN32
+void FileWatcher::run()
+{
+	// every directory has its own overlapped read, the last wait handle is the stop event
+	size_t count = handles.size();
+	std::vector<OVERLAPPED> overlapped(count);
+	std::vector<std::vector<DWORD>> buffers(count, std::vector<DWORD>(bufferSize / sizeof(DWORD)));
+	std::vector<HANDLE> waits(count + 1);
+	const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+	for (size_t i = 0; i < count; i++)
+	{
+		overlapped[i] = OVERLAPPED{};
+		overlapped[i].hEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+		waits[i] = overlapped[i].hEvent;
+		ReadDirectoryChangesW(handles[i], buffers[i].data(), static_cast<DWORD>(bufferSize), TRUE, filter, nullptr, &overlapped[i], nullptr);
+	}
+	waits[count] = stopEvent;
+	while (running)
+	{
+		DWORD result = WaitForMultipleObjects(static_cast<DWORD>(waits.size()), waits.data(), FALSE, INFINITE);
+		if (result < WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + count)
+		{
+			break;
+		}
+		size_t i = result - WAIT_OBJECT_0;
+		DWORD bytes = 0;
+		// no bytes means the buffer overflowed and the notifications were lost
+		if (GetOverlappedResult(handles[i], &overlapped[i], &bytes, FALSE) && bytes > 0)
+		{
+			const char* data = reinterpret_cast<const char*>(buffers[i].data());
+			while (true)
+			{
+				const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(data);
+				if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+				{
+					int length = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+					int size = WideCharToMultiByte(CP_ACP, 0, info->FileName, length, nullptr, 0, nullptr, nullptr);
+					std::string name(size, '\0');
+					WideCharToMultiByte(CP_ACP, 0, info->FileName, length, &name[0], size, nullptr, nullptr);
+					std::replace(name.begin(), name.end(), '\\', '/');
+					addChange(directories[i] + "/" + name);
+				}
+				if (info->NextEntryOffset == 0)
+				{
+					break;
+				}
+				data += info->NextEntryOffset;
+			}
+		}
+		ReadDirectoryChangesW(handles[i], buffers[i].data(), static_cast<DWORD>(bufferSize), TRUE, filter, nullptr, &overlapped[i], nullptr);
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		DWORD bytes = 0;
+		CancelIo(handles[i]);
+		GetOverlappedResult(handles[i], &overlapped[i], &bytes, TRUE);
+		CloseHandle(overlapped[i].hEvent);
+	}
+}
+#else
+void FileWatcher::watch(const std::string & path)
+{
+	int descriptor = inotify_add_watch(notify, path.c_str(), events | IN_ONLYDIR);
+	if (descriptor < 0)
+	{
+		return;
+	}
+	watches[descriptor] = path;
+	// inotify doesn't watch subdirectories, so each of them is watched on its own
+	DIR* directory = opendir(path.c_str());
+	if (directory == nullptr)
+	{
+		return;
+	}
+	while (dirent* entry = readdir(directory))
+	{
+		if (entry->d_type == DT_DIR && strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+		{
+			watch(path + "/" + entry->d_name);
+		}
+	}
+	closedir(directory);
+}
+
+void FileWatcher::run()
+{
+	// events are read into an aligned buffer, as they hold integers
+	std::vector<uint64_t> buffer(bufferSize / sizeof(uint64_t));
+	pollfd descriptor{ notify, POLLIN, 0 };
+	while (running)
+	{
+		if (poll(&descriptor, 1, pollTimeout) <= 0)
+		{
+			continue;
+		}
+		ssize_t bytes;
+		while ((bytes = read(notify, buffer.data(), bufferSize)) > 0)
+		{
+			const char* data = reinterpret_cast<const char*>(buffer.data());
+			for (ssize_t offset = 0; offset < bytes;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(data + offset);
+				offset += sizeof(inotify_event) + event->len;
+				auto it = watches.find(event->wd);
+				if (event->mask & IN_IGNORED)
+				{
+					watches.erase(event->wd);
+					continue;
+				}
+				if (it == watches.end() || event->len == 0)
+				{
+					continue;
+				}
+				std::string path = it->second + "/" + event->name;
+				if (event->mask & IN_ISDIR)
+				{
+					// new subdirectories are watched as well, files created in them before the watch was added are missed
+					if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					{
+						watch(path);
+					}
+				}
+				// created files are reported once they are closed after writing
+				else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				{
+					addChange(path);
+				}
+			}
+		}
+	}
+}
+#endif
\ No newline at end of file
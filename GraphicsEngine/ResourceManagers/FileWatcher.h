@@ -0,0 +1,70 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<unordered_map>
+#include<thread>
+#include<mutex>
+#include<atomic>
+#include<chrono>
+
+/**
+	File watcher class.
+	Watches directories and their subdirectories for files which were written, created or renamed on a background thread,
+	using notifications of the operating system (ReadDirectoryChangesW on Windows, inotify on Linux).
+	Editors and exporters often write a file in several steps, so a change is reported only once the file wasn't touched for a while.
+*/
+class FileWatcher
+{
+public:
+	/**
+		Constructor. Starts watching the given directories, directories which don't exist are skipped.
+		@param directories paths to the watched directories.
+	*/
+	FileWatcher(const std::vector<std::string>& directories);
+	FileWatcher(FileWatcher& x) = delete;
+	FileWatcher& operator=(FileWatcher& x) = delete;
+	/**
+		Checks if any of the directories is watched.
+		@return true if changes of at least one directory are reported, false otherwise.
+	*/
+	bool isWatching() const;
+	/**
+		Returns files which changed since the last call. Can be called from any thread.
+		@return paths of the changed files, made of the path of the watched directory and the path of the file inside of it joined with '/'.
+	*/
+	std::vector<std::string> takeChanges();
+	/**
+		Destructor. Stops watching.
+	*/
+	~FileWatcher();
+private:
+	/**
+		Waits for notifications until the watcher is destroyed. Runs on the background thread.
+	*/
+	void run();
+	/**
+		Records a change of a file.
+		@param path path of the file.
+	*/
+	void addChange(const std::string& path);
+#ifndef _WIN32
+	/**
+		Watches a directory and all of its subdirectories.
+		@param path path to the directory.
+	*/
+	void watch(const std::string& path);
+#endif
+
+	std::vector<std::string> directories;		//*< Paths to the watched directories.
+	std::mutex mutex;							//*< Mutex guarding the changes.
+	std::unordered_map<std::string, std::chrono::steady_clock::time_point> changes;	//*< Changed files and the time they were last touched.
+	std::atomic<bool> running{ false };			//*< Whether the background thread keeps waiting for notifications.
+	std::thread thread;							//*< Background thread waiting for notifications.
+#ifdef _WIN32
+	std::vector<void*> handles;					//*< Handles of the watched directories, in the same order as their paths.
+	void* stopEvent;							//*< Event waking up the background thread when the watcher is destroyed.
+#else
+	int notify;									//*< Descriptor of the inotify instance.
+	std::unordered_map<int, std::string> watches;	//*< Paths of the watched directories and subdirectories by their watch descriptors.
+#endif
+};
\ No newline at end of file
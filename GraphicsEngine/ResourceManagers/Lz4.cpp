@@ -0,0 +1,171 @@
+#include "Lz4.h"
+#include<algorithm>
+#include<cstdint>
+#include<cstring>
+
+namespace
+{
+	const size_t minMatch = 4;			//*< Shortest match the format can encode.
+	const size_t lastLiterals = 5;		//*< Number of bytes at the end of a block which are always literals.
+	const size_t matchLimit = 12;		//*< Matches can't start in the last bytes of a block.
+	const size_t maxOffset = 65535;		//*< Largest distance of a match.
+	const uint32_t hashBits = 14;		//*< Size of the table of recent positions as a power of two.
+
+	/**
+		Reads 4 bytes of the data.
+	*/
+	uint32_t read32(const char* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	/**
+		Returns the index in the table of recent positions of 4 bytes of the data.
+	*/
+	uint32_t hash(uint32_t value)
+	{
+		return (value * 2654435761u) >> (32 - hashBits);
+	}
+
+	/**
+		Writes a length which didn't fit into its 4 bits of a token.
+	*/
+	void writeLength(std::vector<char>& block, size_t length)
+	{
+		while (length >= 255)
+		{
+			block.push_back(static_cast<char>(255));
+			length -= 255;
+		}
+		block.push_back(static_cast<char>(length));
+	}
+
+	/**
+		Writes a sequence of literals followed by a match, or only literals for the last sequence.
+	*/
+	void writeSequence(std::vector<char>& block, const char* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		size_t matchCode = matchLength == 0 ? 0 : matchLength - minMatch;
+		char token = static_cast<char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+		block.push_back(token);
+		if (literalCount >= 15)
+		{
+			writeLength(block, literalCount - 15);
+		}
+		block.insert(block.end(), literals, literals + literalCount);
+		if (matchLength == 0)
+		{
+			return;
+		}
+		block.push_back(static_cast<char>(offset & 0xff));
+		block.push_back(static_cast<char>(offset >> 8));
+		if (matchCode >= 15)
+		{
+			writeLength(block, matchCode - 15);
+		}
+	}
+
+	/**
+		Reads a length continued after its 4 bits of a token.
+		@return false if the block ends before the length does.
+	*/
+	bool readLength(const unsigned char*& in, const unsigned char* end, size_t& length)
+	{
+		unsigned char byte;
+		do
+		{
+			if (in == end)
+			{
+				return false;
+			}
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+}
+
+std::vector<char> Lz4::compress(const char * data, size_t size)
+{
+	std::vector<char> block;
+	block.reserve(size + size / 255 + 16);
+	std::vector<uint32_t> table(static_cast<size_t>(1) << hashBits, UINT32_MAX);
+	size_t anchor = 0;
+	size_t position = 0;
+	while (size > matchLimit && position + matchLimit <= size)
+	{
+		uint32_t value = read32(data + position);
+		uint32_t& slot = table[hash(value)];
+		size_t candidate = slot;
+		slot = static_cast<uint32_t>(position);
+		if (candidate == UINT32_MAX || position - candidate > maxOffset || read32(data + candidate) != value)
+		{
+			position++;
+			continue;
+		}
+		size_t length = minMatch;
+		while (position + length + lastLiterals < size && data[candidate + length] == data[position + length])
+		{
+			length++;
+		}
+		writeSequence(block, data + anchor, position - anchor, position - candidate, length);
+		position += length;
+		anchor = position;
+	}
+	writeSequence(block, data + anchor, size - anchor, 0, 0);
+	return block;
+}
+
+bool Lz4::decompress(const char * block, size_t blockSize, char * data, size_t size)
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(block);
+	const unsigned char* inEnd = in + blockSize;
+	size_t out = 0;
+	while (in < inEnd)
+	{
+		unsigned char token = *in++;
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(in, inEnd, literalCount))
+		{
+			return false;
+		}
+		if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > size - out)
+		{
+			return false;
+		}
+		memcpy(data + out, in, literalCount);
+		in += literalCount;
+		out += literalCount;
+		//the last sequence has no match.
+		if (in == inEnd)
+		{
+			break;
+		}
+		if (inEnd - in < 2)
+		{
+			return false;
+		}
+		size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+		size_t length = token & 15;
+		if (length == 15 && !readLength(in, inEnd, length))
+		{
+			return false;
+		}
+		length += minMatch;
+		if (offset == 0 || offset > out || length > size - out)
+		{
+			return false;
+		}
+		//matches may overlap the bytes they produce, so they are copied byte by byte.
+		const char* match = data + out - offset;
+		for (size_t i = 0; i < length; i++)
+		{
+			data[out + i] = match[i];
+		}
+		out += length;
+	}
+	return out == size;
+}
\ No newline at end of file
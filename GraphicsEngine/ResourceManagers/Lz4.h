@@ -0,0 +1,29 @@
+#pragma once
+#include<vector>
+#include<cstddef>
+
+/**
+	Lz4 class.
+	Compresses and decompresses data in the LZ4 block format, used for compressed entries of asset packs.
+	Decompression is fast enough to keep loading bound by the disk, compression is a simple greedy one done by the pack builder.
+*/
+class Lz4
+{
+public:
+	/**
+		Compresses data into a single LZ4 block.
+		@param data data to compress.
+		@param size size of the data in bytes.
+		@return compressed block.
+	*/
+	static std::vector<char> compress(const char* data, size_t size);
+	/**
+		Decompresses a single LZ4 block.
+		@param block compressed block.
+		@param blockSize size of the block in bytes.
+		@param data buffer to which the data is decompressed.
+		@param size size of the decompressed data in bytes.
+		@return true if the block was decompressed to exactly size bytes, false if it is corrupted.
+	*/
+	static bool decompress(const char* block, size_t blockSize, char* data, size_t size);
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "MeshCache.h"
+#include<cstdio>
+#include<fstream>
+#include"FileSystem.h"
+
+namespace
+{
+	const uint32_t magic = 0x4853454d;	//*< Identifier at the start of every cache file, reads "MESH".
+
+	/**
+		Header of a cache file.
+	*/
+	struct Header
+	{
+		uint32_t magic;				//*< Identifier of the file format.
+		uint32_t version;			//*< Version of the format.
+		uint64_t sourceSize;		//*< Size of the source file.
+		int64_t sourceTime;			//*< Modification time of the source file.
+		uint32_t vertexStride;		//*< Size of a single vertex in bytes.
+		uint32_t vertexCount;		//*< Number of vertices.
+		uint32_t indexCount;		//*< Number of indices of all levels of detail.
+		uint32_t lodCount;			//*< Number of levels of detail.
+		MeshStats stats;			//*< Statistics of the optimisation.
+	};
+}
+
+std::string MeshCache::getPath(const std::string & source, const std::string & suffix)
+{
+	return source + "." + suffix + ".mesh";
+}
+
+bool MeshCache::read(const std::string & path, const std::string & source, const uint32_t vertexStride, CachedMesh & mesh)
+{
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!FileSystem::getInfo(source, sourceSize, sourceTime))
+	{
+		return false;
+	}
+	FileView view = FileSystem::open(path);
+	if (!view.isValid())
+	{
+		return false;
+	}
+	ViewStream file{ view };
+	Header header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != magic || header.version != version ||
+		header.sourceSize != sourceSize || header.sourceTime != sourceTime || header.vertexStride != vertexStride || header.lodCount == 0)
+	{
+		return false;
+	}
+	mesh.vertexStride = header.vertexStride;
+	mesh.lodCounts.resize(header.lodCount);
+	mesh.vertices.resize(static_cast<size_t>(header.vertexCount) * header.vertexStride);
+	mesh.indices.resize(header.indexCount);
+	file.read(reinterpret_cast<char*>(mesh.lodCounts.data()), mesh.lodCounts.size() * sizeof(uint32_t));
+	file.read(mesh.vertices.data(), mesh.vertices.size());
+	file.read(reinterpret_cast<char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+	if (!file)
+	{
+		return false;
+	}
+	mesh.stats = header.stats;
+	mesh.stats.cached = mesh.stats.models;
+	return true;
+}
+
+void MeshCache::write(const std::string & path, const std::string & source, const CachedMesh & mesh)
+{
+	Header header{};
+	if (!FileSystem::getInfo(source, header.sourceSize, header.sourceTime))
+	{
+		return;
+	}
+	header.magic = magic;
+	header.version = version;
+	header.vertexStride = mesh.vertexStride;
+	header.vertexCount = static_cast<uint32_t>(mesh.vertices.size() / mesh.vertexStride);
+	header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+	header.lodCount = static_cast<uint32_t>(mesh.lodCounts.size());
+	header.stats = mesh.stats;
+	header.stats.cached = 0;
+	std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+	if (!file.is_open())
+	{
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(mesh.lodCounts.data()), mesh.lodCounts.size() * sizeof(uint32_t));
+	file.write(mesh.vertices.data(), mesh.vertices.size());
+	file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+	//a partially written file would be rejected by the size checks, but don't leave it behind.
+	if (!file)
+	{
+		file.close();
+		std::remove(path.c_str());
+	}
+}
\ No newline at end of file
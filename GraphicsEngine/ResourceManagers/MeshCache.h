@@ -0,0 +1,50 @@
+#pragma once
+#include<string>
+#include<vector>
+#include"MeshOptimizer.h"
+
+/**
+	Processed mesh as stored in the mesh cache.
+*/
+struct CachedMesh
+{
+	uint32_t vertexStride{ 0 };			//*< Size of a single vertex in bytes.
+	std::vector<char> vertices;			//*< Vertices in their final order.
+	std::vector<uint32_t> indices;		//*< Indices of all levels of detail one after another.
+	std::vector<uint32_t> lodCounts;	//*< Number of indices of every level of detail, starting with the full one.
+	MeshStats stats;					//*< Statistics of the optimisation done when the mesh was cached.
+};
+
+/**
+	Mesh cache class.
+	Stores imported, optimised and simplified meshes in binary files next to their source files, so the processing is done only once.
+	Cached mesh is used only if the size and modification time of the source file match the ones recorded when it was written.
+*/
+class MeshCache
+{
+public:
+	static const uint32_t version = 3;	//*< Version of the cache format and of the processing. Cached meshes with a different version are rebuilt.
+	/**
+		Returns the path of a cache file for a source file.
+		@param source path to the source file.
+		@param suffix suffix distinguishing different vertex layouts of the same source.
+		@return path to the cache file.
+	*/
+	static std::string getPath(const std::string& source, const std::string& suffix);
+	/**
+		Reads a cached mesh.
+		@param path path to the cache file.
+		@param source path to the source file the mesh was made from.
+		@param vertexStride size of a single vertex in bytes the mesh needs to have.
+		@param mesh structure to which the mesh is read.
+		@return true if a valid cached mesh was read, false if it needs to be rebuilt.
+	*/
+	static bool read(const std::string& path, const std::string& source, const uint32_t vertexStride, CachedMesh& mesh);
+	/**
+		Writes a mesh to the cache. Failures are ignored, the mesh is then rebuilt next time.
+		@param path path to the cache file.
+		@param source path to the source file the mesh was made from.
+		@param mesh mesh to write.
+	*/
+	static void write(const std::string& path, const std::string& source, const CachedMesh& mesh);
+};
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "MeshOptimizer.h"
+#include<algorithm>
+
+void MeshStats::add(const MeshStats & other)
+{
+	models += other.models;
+	cached += other.cached;
+	triangles += other.triangles;
+	vertices += other.vertices;
+	transformsBefore += other.transformsBefore;
+	transformsAfter += other.transformsAfter;
+}
+
+double MeshStats::getAcmrBefore() const
+{
+	return triangles > 0 ? static_cast<double>(transformsBefore) / triangles : 0.0;
+}
+
+double MeshStats::getAcmrAfter() const
+{
+	return triangles > 0 ? static_cast<double>(transformsAfter) / triangles : 0.0;
+}
+
+double MeshStats::getAtvrBefore() const
+{
+	return vertices > 0 ? static_cast<double>(transformsBefore) / vertices : 0.0;
+}
+
+double MeshStats::getAtvrAfter() const
+{
+	return vertices > 0 ? static_cast<double>(transformsAfter) / vertices : 0.0;
+}
+
+std::vector<uint32_t> MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, const uint32_t vertexCount)
+{
+	std::vector<uint32_t> clusters;
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return clusters;
+	}
+	//triangles using each vertex, and the number of those which weren't emitted yet.
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		offsets[indices[i] + 1]++;
+	}
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+	std::vector<uint32_t> live(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		live[i] = offsets[i + 1] - offsets[i];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> cursor{ offsets.begin(), offsets.end() - 1 };
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	uint32_t time = cacheSize + 1;
+	uint32_t scan = 0;
+	//returns a vertex with unemitted triangles, preferring recently used ones.
+	auto skipDeadEnd = [&]() -> int64_t
+	{
+		while (!deadEnd.empty())
+		{
+			uint32_t vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[vertex] > 0)
+			{
+				return vertex;
+			}
+		}
+		for (; scan < vertexCount; scan++)
+		{
+			if (live[scan] > 0)
+			{
+				return scan;
+			}
+		}
+		return -1;
+	};
+
+	int64_t fanning = skipDeadEnd();
+	bool newCluster = true;
+	while (fanning >= 0)
+	{
+		if (newCluster)
+		{
+			clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+			newCluster = false;
+		}
+		//emit all remaining triangles around the fanning vertex.
+		candidates.clear();
+		for (uint32_t i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+		{
+			uint32_t triangle = adjacency[i];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+			for (int j = 0; j < 3; j++)
+			{
+				uint32_t vertex = indices[triangle * 3 + j];
+				output.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				if (time - cacheTime[vertex] > cacheSize)
+				{
+					cacheTime[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+		//next fanning vertex is the oldest candidate which will still be in the cache after its remaining triangles are emitted.
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (live[vertex] == 0)
+			{
+				continue;
+			}
+			int64_t priority = 0;
+			if (time - cacheTime[vertex] + 2 * live[vertex] <= cacheSize)
+			{
+				priority = time - cacheTime[vertex];
+			}
+			if (priority > bestPriority)
+			{
+				best = vertex;
+				bestPriority = priority;
+			}
+		}
+		if (best == -1)
+		{
+			best = skipDeadEnd();
+			newCluster = true;
+		}
+		fanning = best;
+	}
+	indices.swap(output);
+	return clusters;
+}
+
+bool MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const std::vector<glm::vec3>& positions, const float threshold)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (clusters.size() < 2)
+	{
+		return false;
+	}
+	//area weighted centroid of the mesh.
+	glm::vec3 meshCentroid{ 0.0f };
+	float meshArea = 0;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		const glm::vec3& p0 = positions[indices[i * 3]];
+		const glm::vec3& p1 = positions[indices[i * 3 + 1]];
+		const glm::vec3& p2 = positions[indices[i * 3 + 2]];
+		float area = glm::length(glm::cross(p1 - p0, p2 - p0));
+		meshCentroid += (p0 + p1 + p2) * (area / 3.0f);
+		meshArea += area;
+	}
+	if (meshArea > 0)
+	{
+		meshCentroid /= meshArea;
+	}
+	//clusters facing away from the centroid are likely to occlude the rest of the mesh.
+	std::vector<std::pair<float, uint32_t>> order(clusters.size());
+	for (uint32_t c = 0; c < clusters.size(); c++)
+	{
+		size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+		glm::vec3 centroid{ 0.0f };
+		glm::vec3 normal{ 0.0f };
+		float area = 0;
+		for (size_t i = clusters[c]; i < end; i++)
+		{
+			const glm::vec3& p0 = positions[indices[i * 3]];
+			const glm::vec3& p1 = positions[indices[i * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[i * 3 + 2]];
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float a = glm::length(n);
+			centroid += (p0 + p1 + p2) * (a / 3.0f);
+			normal += n;
+			area += a;
+		}
+		float length = glm::length(normal);
+		float key = 0;
+		if (area > 0 && length > 0)
+		{
+			key = glm::dot(centroid / area - meshCentroid, normal / length);
+		}
+		order[c] = std::make_pair(-key, c);
+	}
+	std::stable_sort(order.begin(), order.end(), [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) { return a.first < b.first; });
+
+	std::vector<uint32_t> reordered;
+	reordered.reserve(indices.size());
+	for (const auto& cluster : order)
+	{
+		size_t end = cluster.second + 1 < clusters.size() ? clusters[cluster.second + 1] : triangleCount;
+		reordered.insert(reordered.end(), indices.begin() + clusters[cluster.second] * 3, indices.begin() + end * 3);
+	}
+	uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+	uint64_t before = countTransforms(indices.data(), indices.size(), vertexCount);
+	uint64_t after = countTransforms(reordered.data(), reordered.size(), vertexCount);
+	if (after > before * threshold)
+	{
+		return false;
+	}
+	indices.swap(reordered);
+	return true;
+}
+
+uint32_t MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, const uint32_t vertexCount, std::vector<uint32_t>& remap)
+{
+	remap.assign(vertexCount, ~0u);
+	uint32_t next = 0;
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == ~0u)
+		{
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+	return next;
+}
+
+uint64_t MeshOptimizer::countTransforms(const uint32_t * indices, const size_t indexCount, const uint32_t vertexCount)
+{
+	//vertex is in the cache if fewer than cacheSize vertices were added after it.
+	std::vector<uint64_t> cacheTime(vertexCount, 0);
+	uint64_t time = cacheSize + 1;
+	uint64_t transforms = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t vertex = indices[i];
+		if (time - cacheTime[vertex] > cacheSize)
+		{
+			cacheTime[vertex] = time++;
+			transforms++;
+		}
+	}
+	return transforms;
+}
\ No newline at end of file
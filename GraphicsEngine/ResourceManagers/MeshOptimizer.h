@@ -0,0 +1,84 @@
+#pragma once
+#include<glm\glm.hpp>
+#include<vector>
+
+/**
+	Statistics of optimised meshes. Cache behaviour is simulated with a FIFO post-transform cache.
+*/
+struct MeshStats
+{
+	uint32_t models{ 0 };				//*< Number of meshes.
+	uint32_t cached{ 0 };				//*< Number of meshes loaded from the mesh cache instead of being optimised.
+	uint64_t triangles{ 0 };			//*< Number of triangles of full detail levels.
+	uint64_t vertices{ 0 };				//*< Number of vertices.
+	uint64_t transformsBefore{ 0 };		//*< Number of vertex shader invocations needed to draw full detail levels before optimisation.
+	uint64_t transformsAfter{ 0 };		//*< Number of vertex shader invocations needed to draw full detail levels after optimisation.
+	/**
+		Adds statistics of other meshes.
+		@param other statistics to add.
+	*/
+	void add(const MeshStats& other);
+	/**
+		Returns average cache miss ratio, that is the number of transformed vertices per triangle, before optimisation.
+		@return ACMR before optimisation.
+	*/
+	double getAcmrBefore() const;
+	/**
+		Returns average cache miss ratio after optimisation.
+		@return ACMR after optimisation.
+	*/
+	double getAcmrAfter() const;
+	/**
+		Returns average transform to vertex ratio, that is the number of times every vertex is transformed, before optimisation.
+		@return ATVR before optimisation.
+	*/
+	double getAtvrBefore() const;
+	/**
+		Returns average transform to vertex ratio after optimisation.
+		@return ATVR after optimisation.
+	*/
+	double getAtvrAfter() const;
+};
+
+/**
+	Mesh optimizer class.
+	Reorders indices and vertices of triangle lists so the GPU transforms fewer vertices, shades fewer hidden pixels and fetches vertices in order.
+*/
+class MeshOptimizer
+{
+public:
+	static const uint32_t cacheSize = 16;	//*< Size of the simulated post-transform cache. Small enough to suit any GPU.
+	/**
+		Reorders triangles for the post-transform vertex cache using the Tipsify algorithm.
+		@param indices indices of a triangle list, reordered in place.
+		@param vertexCount number of vertices referenced by the indices.
+		@return index of the first triangle of every cluster. Clusters start where the algorithm ran into a dead end and can be reordered freely.
+	*/
+	static std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& indices, const uint32_t vertexCount);
+	/**
+		Reorders clusters so the ones facing away from the mesh's center are drawn first, which lets the depth test reject more hidden pixels.
+		Reordering is kept only if it doesn't increase ACMR by more than the threshold.
+		@param indices indices of a triangle list optimised by optimizeVertexCache, reordered in place.
+		@param clusters index of the first triangle of every cluster.
+		@param positions positions of the vertices.
+		@param threshold largest allowed ratio between ACMR after and before reordering.
+		@return true if clusters were reordered, false otherwise.
+	*/
+	static bool optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const std::vector<glm::vec3>& positions, const float threshold);
+	/**
+		Renumbers vertices in the order in which indices first use them so vertex fetch reads memory sequentially. Unused vertices are dropped.
+		@param indices indices of a triangle list, rewritten to use new vertex numbers.
+		@param vertexCount number of vertices referenced by the indices.
+		@param remap filled with new number of every vertex, ~0 for unused vertices.
+		@return number of used vertices.
+	*/
+	static uint32_t optimizeVertexFetch(std::vector<uint32_t>& indices, const uint32_t vertexCount, std::vector<uint32_t>& remap);
+	/**
+		Counts vertex shader invocations needed to draw a triangle list with a FIFO post-transform cache.
+		@param indices pointer to indices of the triangle list.
+		@param indexCount number of indices.
+		@param vertexCount number of vertices referenced by the indices.
+		@return number of transformed vertices.
+	*/
+	static uint64_t countTransforms(const uint32_t* indices, const size_t indexCount, const uint32_t vertexCount);
+};
\ No newline at end of file
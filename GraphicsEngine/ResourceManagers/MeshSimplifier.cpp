@@ -0,0 +1,254 @@
+#include "MeshSimplifier.h"
+#include<algorithm>
+#include<cmath>
+#include<unordered_map>
+
+namespace
+{
+	/**
+		Hash of a position used to find vertices sharing the same position.
+	*/
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& p) const
+		{
+			std::hash<float> hasher;
+			return ((hasher(p.x) * 73856093) ^ (hasher(p.y) * 19349663)) ^ (hasher(p.z) * 83492791);
+		}
+	};
+}
+
+void MeshSimplifier::Quadric::add(const Quadric & other)
+{
+	xx += other.xx; xy += other.xy; xz += other.xz;
+	yy += other.yy; yz += other.yz; zz += other.zz;
+	xw += other.xw; yw += other.yw; zw += other.zw;
+	ww += other.ww;
+	weight += other.weight;
+}
+
+double MeshSimplifier::Quadric::evaluate(const glm::vec3 & p) const
+{
+	double x = p.x, y = p.y, z = p.z;
+	return xx * x * x + yy * y * y + zz * z * z + 2.0 * (xy * x * y + xz * x * z + yz * y * z) + 2.0 * (xw * x + yw * y + zw * z) + ww;
+}
+
+MeshSimplifier::MeshSimplifier(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) : positions{ positions }, indices{ indices },
+	quadrics(positions.size(), Quadric{}), locked(positions.size(), false), extent{ 1.0f }
+{
+	if (positions.empty())
+	{
+		return;
+	}
+	glm::vec3 min = positions[0];
+	glm::vec3 max = positions[0];
+	for (const glm::vec3& p : positions)
+	{
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+	extent = std::max(glm::length(max - min), 1e-6f);
+
+	//vertices sharing a position with another vertex lie on an attribute seam.
+	std::vector<uint32_t> welded(positions.size());
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> unique;
+	for (uint32_t i = 0; i < positions.size(); i++)
+	{
+		auto result = unique.emplace(positions[i], i);
+		welded[i] = result.first->second;
+		if (!result.second)
+		{
+			locked[i] = true;
+			locked[welded[i]] = true;
+		}
+	}
+	//edges used by a single triangle lie on an open border.
+	std::unordered_map<uint64_t, uint32_t> edges;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			uint64_t a = welded[indices[i + e]];
+			uint64_t b = welded[indices[i + (e + 1) % 3]];
+			edges[std::min(a, b) << 32 | std::max(a, b)]++;
+		}
+	}
+	std::vector<bool> border(positions.size(), false);
+	for (const auto& edge : edges)
+	{
+		if (edge.second == 1)
+		{
+			border[edge.first >> 32] = true;
+			border[edge.first & 0xffffffff] = true;
+		}
+	}
+	for (uint32_t i = 0; i < positions.size(); i++)
+	{
+		if (border[welded[i]])
+		{
+			locked[i] = true;
+		}
+	}
+
+	//every vertex starts with the planes of its triangles weighted by their area.
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const glm::vec3& p0 = positions[indices[i]];
+		glm::vec3 normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+		float length = glm::length(normal);
+		if (length == 0)
+		{
+			continue;
+		}
+		normal /= length;
+		double d = -glm::dot(normal, p0);
+		double area = 0.5 * length;
+		Quadric q{ area * normal.x * normal.x, area * normal.x * normal.y, area * normal.x * normal.z, area * normal.y * normal.y, area * normal.y * normal.z,
+					area * normal.z * normal.z, area * normal.x * d, area * normal.y * d, area * normal.z * d, area * d * d, area };
+		for (int j = 0; j < 3; j++)
+		{
+			quadrics[indices[i + j]].add(q);
+		}
+	}
+}
+
+const std::vector<uint32_t>& MeshSimplifier::simplify(const size_t targetIndexCount, const float maxError)
+{
+	double limit = static_cast<double>(maxError) * extent;
+	limit *= limit;
+	size_t vertexCount = positions.size();
+	std::vector<Collapse> candidates;
+	std::vector<bool> touched;
+	std::vector<uint32_t> remap;
+	//every pass does as many independent collapses as it can, then the index buffer is rewritten.
+	while (indices.size() > targetIndexCount)
+	{
+		adjacencyOffsets.assign(vertexCount + 1, 0);
+		for (uint32_t index : indices)
+		{
+			adjacencyOffsets[index + 1]++;
+		}
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		}
+		adjacency.resize(indices.size());
+		std::vector<uint32_t> cursor{ adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 };
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		candidates.clear();
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				uint32_t a = indices[i + e];
+				uint32_t b = indices[i + (e + 1) % 3];
+				const uint32_t pairs[2][2] = { { a, b }, { b, a } };
+				for (const auto& pair : pairs)
+				{
+					if (locked[pair[0]])
+					{
+						continue;
+					}
+					Quadric q = quadrics[pair[0]];
+					q.add(quadrics[pair[1]]);
+					candidates.push_back(Collapse{ pair[0], pair[1], q.evaluate(positions[pair[1]]) / std::max(q.weight, 1e-12) });
+				}
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+		touched.assign(vertexCount, false);
+		remap.resize(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			remap[i] = i;
+		}
+		size_t removable = (indices.size() - targetIndexCount + 2) / 3;
+		size_t removed = 0;
+		bool collapsed = false;
+		for (const Collapse& collapse : candidates)
+		{
+			if (collapse.error > limit || removed >= removable)
+			{
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to] || flips(collapse.from, collapse.to))
+			{
+				continue;
+			}
+			for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; i++)
+			{
+				const uint32_t* triangle = &indices[adjacency[i] * 3];
+				if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+				{
+					removed++;
+				}
+				//triangles around the removed vertex change, so their vertices can't collapse in this pass.
+				for (int j = 0; j < 3; j++)
+				{
+					touched[triangle[j]] = true;
+				}
+			}
+			touched[collapse.to] = true;
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to].add(quadrics[collapse.from]);
+			error = std::max(error, collapse.error);
+			collapsed = true;
+		}
+		if (!collapsed)
+		{
+			break;
+		}
+		size_t write = 0;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			uint32_t a = remap[indices[i]];
+			uint32_t b = remap[indices[i + 1]];
+			uint32_t c = remap[indices[i + 2]];
+			if (a == b || b == c || a == c)
+			{
+				continue;
+			}
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+		indices.resize(write);
+	}
+	return indices;
+}
+
+float MeshSimplifier::getError() const
+{
+	return static_cast<float>(std::sqrt(error)) / extent;
+}
+
+bool MeshSimplifier::flips(const uint32_t from, const uint32_t to) const
+{
+	for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++)
+	{
+		const uint32_t* triangle = &indices[adjacency[i] * 3];
+		if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+		{
+			continue;
+		}
+		glm::vec3 corners[3];
+		glm::vec3 moved[3];
+		for (int j = 0; j < 3; j++)
+		{
+			corners[j] = positions[triangle[j]];
+			moved[j] = triangle[j] == from ? positions[to] : corners[j];
+		}
+		glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+		glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+		if (glm::dot(before, after) <= 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include<glm\glm.hpp>
+#include<vector>
+
+/**
+	Mesh simplifier.
+	Reduces the number of triangles of an indexed mesh by collapsing edges into one of their vertices, choosing the collapses with the
+	smallest quadric error first. Only indices are changed so all levels of detail share the original vertices.
+	Vertices on open borders and on attribute seams are never moved so the simplified mesh doesn't tear.
+	Simplification is progressive, every call continues from the result of the previous one.
+*/
+class MeshSimplifier
+{
+public:
+	/**
+		Constructor.
+		@param positions positions of mesh's vertices.
+		@param indices indices of mesh's triangles.
+	*/
+	MeshSimplifier(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+	/**
+		Simplifies the mesh until it has at most the target number of indices or no further collapse is within the error limit.
+		@param targetIndexCount number of indices to reduce the mesh to.
+		@param maxError largest allowed error relative to the size of the mesh.
+		@return indices of the simplified mesh.
+	*/
+	const std::vector<uint32_t>& simplify(const size_t targetIndexCount, const float maxError);
+	/**
+		Returns the largest error of all collapses done so far.
+		@return error relative to the size of the mesh.
+	*/
+	float getError() const;
+private:
+	/**
+		Quadric measuring the sum of squared distances from a set of planes.
+	*/
+	struct Quadric
+	{
+		double xx, xy, xz, yy, yz, zz, xw, yw, zw, ww;	//*< Elements of the symmetric 4x4 matrix.
+		double weight;									//*< Sum of the weights of the planes.
+		/**
+			Adds another quadric.
+		*/
+		void add(const Quadric& other);
+		/**
+			Returns the weighted sum of squared distances of a point from the planes.
+		*/
+		double evaluate(const glm::vec3& p) const;
+	};
+	/**
+		Candidate for an edge collapse.
+	*/
+	struct Collapse
+	{
+		uint32_t from;	//*< Vertex that is removed.
+		uint32_t to;	//*< Vertex into which the removed vertex is moved.
+		double error;	//*< Error of the collapse.
+	};
+	/**
+		Checks if moving a vertex to another vertex flips any of its triangles.
+		@param from vertex that is moved.
+		@param to vertex to which it is moved.
+		@return true if a triangle would flip, false otherwise.
+	*/
+	bool flips(const uint32_t from, const uint32_t to) const;
+	std::vector<glm::vec3> positions;		//*< Positions of mesh's vertices.
+	std::vector<uint32_t> indices;			//*< Indices of the current mesh.
+	std::vector<Quadric> quadrics;			//*< Accumulated quadric of each vertex.
+	std::vector<bool> locked;				//*< Flags determining which vertices can't be removed.
+	std::vector<uint32_t> adjacencyOffsets;	//*< Offset of each vertex's triangles inside of adjacency array.
+	std::vector<uint32_t> adjacency;		//*< Triangles using each vertex.
+	float extent;							//*< Size of the mesh used to make errors relative.
+	double error{ 0 };						//*< Largest squared error of all collapses done so far.
+};
\ No newline at end of file
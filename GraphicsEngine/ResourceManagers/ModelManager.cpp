@@ -2,267 +2,775 @@
 #include<tiny_obj_loader.h>
 #include "ModelManager.h"
 #include"..\DebugTools\Assert.h"
+#include"..\DebugTools\Profiler.h"
 #include "..\Core\GraphicsEngine.h"
-#include<unordered_map>
+#include"..\Core\MeshArena.h"
+#include"MeshSimplifier.h"
+#include"MeshOptimizer.h"
+#include"MeshCache.h"
+#include"TangentGenerator.h"
+#include"FileSystem.h"
+#include<cstring>
+#include<algorithm>
+#include<chrono>
+#include<glm\gtc\packing.hpp>
 #include"..\Graphics\Vertex.h"
 #ifdef _DEBUG
 #include<iostream>
 #endif
 
+namespace
+{
+	const uint32_t initialArenaVertices = 65536;	//*< Number of vertices reserved when an arena is created.
+	const uint32_t initialArenaIndices = 196608;	//*< Number of indices reserved when an arena is created.
+	const uint32_t maxShortIndexVertices = 65536;	//*< Largest number of vertices of a model whose indices are stored in 16 bits.
+	const uint32_t maxLods = 4;						//*< Largest number of levels of detail of a model, including the full one.
+	const float lodReduction = 0.5f;				//*< Ratio of triangles every level of detail aims to keep from the previous one.
+	const float minLodReduction = 0.8f;				//*< Level of detail is dropped if it keeps more than this ratio of the previous level's triangles.
+	const float lodMaxError = 0.05f;				//*< Largest simplification error relative to the size of the model.
+	const float overdrawThreshold = 1.05f;			//*< Largest allowed increase of ACMR caused by reordering triangles for overdraw.
+
+	/**
+		Converts a vertex position to 3D.
+	*/
+	glm::vec3 toPosition(const glm::vec3& pos)
+	{
+		return pos;
+	}
+	glm::vec3 toPosition(const glm::vec2& pos)
+	{
+		return glm::vec3{ pos, 0.0f };
+	}
+	/**
+		Calculates the axis aligned bounding box of the vertices and stores it in the model.
+		@param vertices vertices of the model.
+		@param model model in which to store the bounds.
+	*/
+	template<typename T>
+	void computeBounds(const std::vector<T>& vertices, VModel& model)
+	{
+		if (vertices.empty())
+		{
+			return;
+		}
+		model.boundsMin = toPosition(vertices[0].pos);
+		model.boundsMax = model.boundsMin;
+		for (const T& vertex : vertices)
+		{
+			glm::vec3 pos = toPosition(vertex.pos);
+			model.boundsMin = glm::min(model.boundsMin, pos);
+			model.boundsMax = glm::max(model.boundsMax, pos);
+		}
+	}
+	/**
+		Calculates the center and scale which map model's bounds into range [-1, 1] and stores them in the model.
+		The same scale is used on all axes so the dequantization doesn't skew normals.
+		@param model model with computed bounds.
+	*/
+	void computeQuantization(VModel& model)
+	{
+		glm::vec3 extent = (model.boundsMax - model.boundsMin) * 0.5f;
+		float scale = std::max(extent.x, std::max(extent.y, extent.z));
+		model.quantization = glm::vec4{ (model.boundsMin + model.boundsMax) * 0.5f, scale > 0.0f ? scale : 1.0f };
+	}
+	/**
+		Encodes a value in range [-1, 1] as a quantised position component.
+	*/
+	uint16_t encodePosition(const float value, const PositionEncoding encoding)
+	{
+		float clamped = glm::clamp(value, -1.0f, 1.0f);
+		return encoding == PositionEncoding::eHalf ? glm::packHalf1x16(clamped) : glm::packSnorm1x16(clamped);
+	}
+	/**
+		Encodes vertex position relative to model's bounds.
+		@param pos position in model space.
+		@param quantization center and scale of the quantization.
+		@param encoding encoding of the position components.
+		@param encoded array of three components to which position is written.
+	*/
+	void encodePosition(const glm::vec3& pos, const glm::vec4& quantization, const PositionEncoding encoding, uint16_t* encoded)
+	{
+		glm::vec3 relative = (pos - glm::vec3{ quantization }) / quantization.w;
+		for (int i = 0; i < 3; i++)
+		{
+			encoded[i] = encodePosition(relative[i], encoding);
+		}
+	}
+	/**
+		Encodes a direction with octahedral mapping into two signed normalized components.
+		@param direction direction to encode, doesn't need to be normalized. Zero vector is encoded as positive z axis.
+		@param encoded array of two components to which direction is written.
+	*/
+	void encodeOctahedral(const glm::vec3& direction, int16_t* encoded)
+	{
+		float length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+		glm::vec2 octahedral{ 0.0f };
+		if (length > 0.0f)
+		{
+			glm::vec3 v = direction / length;
+			octahedral = glm::vec2{ v.x, v.y };
+			//lower hemisphere is folded over the diagonals.
+			if (v.z < 0.0f)
+			{
+				octahedral.x = (1.0f - std::abs(v.y)) * (v.x >= 0.0f ? 1.0f : -1.0f);
+				octahedral.y = (1.0f - std::abs(v.x)) * (v.y >= 0.0f ? 1.0f : -1.0f);
+			}
+		}
+		encoded[0] = static_cast<int16_t>(glm::packSnorm1x16(octahedral.x));
+		encoded[1] = static_cast<int16_t>(glm::packSnorm1x16(octahedral.y));
+	}
+	/**
+		Packs vertices into the layout stored in the GPU.
+		@param vertices vertices of the model.
+		@param quantization center and scale of the position quantization.
+		@return packed vertices.
+	*/
+	std::vector<PackedVertex3DT> packVertices(const std::vector<Vertex3DT>& vertices, const glm::vec4& quantization)
+	{
+		PROFILE_FUNCTION()
+		std::vector<PackedVertex3DT> packed(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			encodePosition(vertices[i].pos, quantization, PackedVertex3DT::positionEncoding, packed[i].pos);
+			packed[i].pos[3] = encodePosition(1.0f, PackedVertex3DT::positionEncoding);
+			encodeOctahedral(vertices[i].normal, packed[i].normal);
+			packed[i].uv[0] = glm::packHalf1x16(vertices[i].uv.x);
+			packed[i].uv[1] = glm::packHalf1x16(vertices[i].uv.y);
+		}
+		return packed;
+	}
+	/**
+		Packs vertices with tangents into the layout stored in the GPU.
+		@param vertices vertices of the model.
+		@param quantization center and scale of the position quantization.
+		@return packed vertices.
+	*/
+	std::vector<PackedVertex3DTT> packVertices(const std::vector<Vertex3DTT>& vertices, const glm::vec4& quantization)
+	{
+		PROFILE_FUNCTION()
+		std::vector<PackedVertex3DTT> packed(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const Vertex3DTT& vertex = vertices[i];
+			encodePosition(vertex.pos, quantization, PackedVertex3DTT::positionEncoding, packed[i].pos);
+			packed[i].pos[3] = encodePosition(vertex.tangent.w, PackedVertex3DTT::positionEncoding);
+			encodeOctahedral(vertex.normal, packed[i].normal);
+			encodeOctahedral(glm::vec3{ vertex.tangent }, packed[i].tangent);
+			packed[i].uv[0] = glm::packHalf1x16(vertex.uv.x);
+			packed[i].uv[1] = glm::packHalf1x16(vertex.uv.y);
+		}
+		return packed;
+	}
+	/**
+		Returns positions of vertices.
+		@param vertices vertices of the model.
+		@return array of positions.
+	*/
+	template<typename T>
+	std::vector<glm::vec3> getPositions(const std::vector<T>& vertices)
+	{
+		std::vector<glm::vec3> positions;
+		positions.reserve(vertices.size());
+		for (const T& vertex : vertices)
+		{
+			positions.push_back(toPosition(vertex.pos));
+		}
+		return positions;
+	}
+	/**
+		Keeps a CPU copy of model's positions and indices used for occlusion culling.
+		@param vertices vertices of the model.
+		@param indices indices of the model.
+		@param count number of indices of the full detail level.
+		@param model model in which to store the geometry.
+	*/
+	template<typename T>
+	void keepGeometry(const std::vector<T>& vertices, const std::vector<uint32_t>& indices, const uint32_t count, VModel& model)
+	{
+		model.positions = getPositions(vertices);
+		model.indices.assign(indices.begin(), indices.begin() + count);
+	}
+	/**
+		Copies vertices into an array of bytes.
+		@param vertices vertices to copy.
+		@return bytes of the vertices.
+	*/
+	template<typename T>
+	std::vector<char> toBytes(const std::vector<T>& vertices)
+	{
+		std::vector<char> bytes(vertices.size() * sizeof(T));
+		memcpy(bytes.data(), vertices.data(), bytes.size());
+		return bytes;
+	}
+	/**
+		Generates coarser levels of detail out of model's geometry and appends their indices after the full level.
+		Every level is reordered for the vertex cache.
+		@param positions positions of model's vertices.
+		@param indices indices of the full level, coarser levels are appended to them.
+		@return number of indices of every level, starting with the full one.
+	*/
+	std::vector<uint32_t> appendLods(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+	{
+		PROFILE_FUNCTION()
+		std::vector<uint32_t> counts{ static_cast<uint32_t>(indices.size()) };
+		MeshSimplifier simplifier{ positions, indices };
+		while (counts.size() < maxLods)
+		{
+			size_t target = static_cast<size_t>(counts.back() / 3 * lodReduction) * 3;
+			std::vector<uint32_t> lod = simplifier.simplify(target, lodMaxError);
+			if (lod.size() > counts.back() * minLodReduction)
+			{
+				break;
+			}
+			MeshOptimizer::optimizeVertexCache(lod, static_cast<uint32_t>(positions.size()));
+			indices.insert(indices.end(), lod.begin(), lod.end());
+			counts.push_back(static_cast<uint32_t>(lod.size()));
+		}
+		return counts;
+	}
+	/**
+		Optimises a freshly loaded mesh and generates its levels of detail.
+		Triangles are reordered for the vertex cache and overdraw, and vertices are reordered in the order of their first use.
+		@param vertices vertices of the mesh, reordered in place.
+		@param indices indices of the mesh. Rewritten to the new order, indices of coarser levels are appended to them.
+		@param stats statistics of the optimisation.
+		@return number of indices of every level, starting with the full one.
+	*/
+	template<typename T>
+	std::vector<uint32_t> processMesh(std::vector<T>& vertices, std::vector<uint32_t>& indices, MeshStats& stats)
+	{
+		PROFILE_FUNCTION()
+		uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		stats = MeshStats{};
+		stats.models = 1;
+		stats.triangles = indices.size() / 3;
+		stats.transformsBefore = MeshOptimizer::countTransforms(indices.data(), indices.size(), vertexCount);
+		std::vector<glm::vec3> positions = getPositions(vertices);
+		std::vector<uint32_t> clusters = MeshOptimizer::optimizeVertexCache(indices, vertexCount);
+		MeshOptimizer::optimizeOverdraw(indices, clusters, positions, overdrawThreshold);
+		std::vector<uint32_t> counts = appendLods(positions, indices);
+		std::vector<uint32_t> remap;
+		uint32_t used = MeshOptimizer::optimizeVertexFetch(indices, vertexCount, remap);
+		std::vector<T> reordered(used);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			if (remap[i] != ~0u)
+			{
+				reordered[remap[i]] = vertices[i];
+			}
+		}
+		vertices.swap(reordered);
+		stats.vertices = used;
+		stats.transformsAfter = MeshOptimizer::countTransforms(indices.data(), counts[0], used);
+		return counts;
+	}
+	/**
+		Reads a processed mesh from the mesh cache.
+		@param path path to the cache file.
+		@param source path to the model file.
+		@param vertices array to which vertices are written.
+		@param indices array to which indices of all levels of detail are written.
+		@param lodCounts array to which number of indices of every level is written.
+		@param stats statistics of the cached optimisation.
+		@return true if mesh was read, false if it's not cached or the cache is out of date.
+	*/
+	template<typename T>
+	bool readCache(const std::string& path, const std::string& source, std::vector<T>& vertices, std::vector<uint32_t>& indices, std::vector<uint32_t>& lodCounts, MeshStats& stats)
+	{
+		PROFILE_FUNCTION()
+		CachedMesh mesh;
+		if (!MeshCache::read(path, source, sizeof(T), mesh))
+		{
+			return false;
+		}
+		vertices.resize(mesh.vertices.size() / sizeof(T));
+		memcpy(vertices.data(), mesh.vertices.data(), mesh.vertices.size());
+		indices = std::move(mesh.indices);
+		lodCounts = std::move(mesh.lodCounts);
+		stats = mesh.stats;
+		return true;
+	}
+	/**
+		Writes a processed mesh to the mesh cache.
+		@param path path to the cache file.
+		@param source path to the model file.
+		@param vertices vertices of the mesh.
+		@param indices indices of all levels of detail.
+		@param lodCounts number of indices of every level.
+		@param stats statistics of the optimisation.
+	*/
+	template<typename T>
+	void writeCache(const std::string& path, const std::string& source, const std::vector<T>& vertices, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& lodCounts, const MeshStats& stats)
+	{
+		CachedMesh mesh;
+		mesh.vertexStride = sizeof(T);
+		mesh.vertices.resize(vertices.size() * sizeof(T));
+		memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+		mesh.indices = indices;
+		mesh.lodCounts = lodCounts;
+		mesh.stats = stats;
+		MeshCache::write(path, source, mesh);
+	}
+	/**
+		Open addressing hash map used to merge corners of OBJ faces into vertices.
+		Corners are identified by their tuple of position, normal and uv indices, so they are merged without hashing or comparing vertex data.
+	*/
+	class CornerMap
+	{
+	public:
+		/**
+			Constructor.
+			@param cornerCount number of corners which will be added, used to size the table so it rarely needs to grow.
+		*/
+		explicit CornerMap(const size_t cornerCount)
+		{
+			size_t capacity = 16;
+			while (capacity < cornerCount)
+			{
+				capacity *= 2;
+			}
+			slots.resize(capacity);
+		}
+		/**
+			Finds the vertex of a corner with a single probe sequence, or assigns it the given vertex if the corner wasn't added before.
+			@param corner OBJ indices of the corner.
+			@param vertex vertex assigned to the corner if it is new.
+			@return vertex of the corner. Equal to the given vertex if the corner is new.
+		*/
+		uint32_t insert(const tinyobj::index_t& corner, const uint32_t vertex)
+		{
+			size_t mask = slots.size() - 1;
+			size_t i = hash(corner) & mask;
+			while (slots[i].vertex != empty)
+			{
+				const Slot& slot = slots[i];
+				if (slot.position == corner.vertex_index && slot.normal == corner.normal_index && slot.uv == corner.texcoord_index)
+				{
+					return slot.vertex;
+				}
+				i = (i + 1) & mask;
+			}
+			slots[i] = Slot{ corner.vertex_index, corner.normal_index, corner.texcoord_index, vertex };
+			//keep the table at most three quarters full so probe sequences stay short.
+			if (++count * 4 > slots.size() * 3)
+			{
+				grow();
+			}
+			return vertex;
+		}
+	private:
+		static const uint32_t empty = ~0u;	//*< Vertex of slots which hold no corner.
+		/**
+			Slot of the table.
+		*/
+		struct Slot
+		{
+			int position{ 0 };				//*< Index of corner's position.
+			int normal{ 0 };				//*< Index of corner's normal.
+			int uv{ 0 };					//*< Index of corner's uv coordinates.
+			uint32_t vertex{ empty };		//*< Vertex assigned to the corner.
+		};
+		/**
+			Hashes the indices of a corner.
+		*/
+		static size_t hash(const tinyobj::index_t& corner)
+		{
+			uint32_t h = static_cast<uint32_t>(corner.vertex_index) * 0x9E3779B1u;
+			h ^= static_cast<uint32_t>(corner.normal_index) * 0x85EBCA77u;
+			h ^= static_cast<uint32_t>(corner.texcoord_index) * 0xC2B2AE3Du;
+			return h ^ (h >> 16);
+		}
+		/**
+			Doubles the size of the table.
+		*/
+		void grow()
+		{
+			std::vector<Slot> old(slots.size() * 2);
+			old.swap(slots);
+			size_t mask = slots.size() - 1;
+			for (const Slot& slot : old)
+			{
+				if (slot.vertex == empty)
+				{
+					continue;
+				}
+				size_t i = hash(tinyobj::index_t{ slot.position, slot.normal, slot.uv }) & mask;
+				while (slots[i].vertex != empty)
+				{
+					i = (i + 1) & mask;
+				}
+				slots[i] = slot;
+			}
+		}
+		std::vector<Slot> slots;	//*< Table of corners, its size is a power of two.
+		size_t count{ 0 };			//*< Number of corners in the table.
+	};
+	/**
+		Parses an OBJ file read through the file system. Material libraries aren't read, as models don't use them.
+		@return true if the file was parsed, false otherwise with the reason in err.
+	*/
+	bool loadObj(const std::string& filename, tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& materials, std::string& err)
+	{
+		FileView file = FileSystem::open(filename);
+		if (!file.isValid())
+		{
+			err = "Cannot open file [" + filename + "]";
+			return false;
+		}
+		ViewStream stream{ file };
+		return tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &stream);
+	}
+	/**
+		Returns the number of face corners of all shapes.
+	*/
+	size_t countCorners(const std::vector<tinyobj::shape_t>& shapes)
+	{
+		size_t count = 0;
+		for (const auto& shape : shapes)
+		{
+			count += shape.mesh.indices.size();
+		}
+		return count;
+	}
+	/**
+		Loads vertices and indices of a 3D model from an OBJ file, merging identical vertices.
+		@param filename name of the file containing a model.
+		@param vertices array to which vertices are written.
+		@param indices array to which indices are written.
+	*/
+	void parse3D(const std::string& filename, std::vector<Vertex3DT>& vertices, std::vector<uint32_t>& indices)
+	{
+		PROFILE_FUNCTION()
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string err;
+
+		// Load the model
+		if (!loadObj(filename, attrib, shapes, materials, err))
+		{
+			throw std::runtime_error(err);
+		}
+		size_t cornerCount = countCorners(shapes);
+		CornerMap corners{ cornerCount };
+		indices.reserve(cornerCount);
+		// Fill vertices, uv coordinates and normals
+		for (const auto& shape : shapes)
+		{
+			for (const auto& index : shape.mesh.indices)
+			{
+				uint32_t next = static_cast<uint32_t>(vertices.size());
+				uint32_t unique = corners.insert(index, next);
+				indices.push_back(unique);
+				if (unique != next)
+				{
+					continue;
+				}
+				Vertex3DT vertex = {};
+
+				vertex.pos = {
+					attrib.vertices[3 * index.vertex_index + 0],
+					attrib.vertices[3 * index.vertex_index + 1],
+					attrib.vertices[3 * index.vertex_index + 2]
+				};
+
+				// Origin of texture coordinates in Vulkan is the top-left corner,
+				// whereas the OBJ format assumes the bottom-left corner
+				// so we need to correct it by subtracting y coordinate from 1.0
+				vertex.uv = {
+					attrib.texcoords[2 * index.texcoord_index + 0],
+					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+				};
+
+				if (attrib.normals.size() > 0)
+				{
+					vertex.normal = { attrib.normals[3 * index.normal_index + 0],
+						attrib.normals[3 * index.normal_index + 1],
+						attrib.normals[3 * index.normal_index + 2] };
+				}
+				else
+				{
+					vertex.normal = { 0,0,1 };
+				}
+				vertices.push_back(vertex);
+			}
+		}
+	}
+	/**
+		Loads vertices and indices of a 3D model from an OBJ file and generates tangents, merging identical vertices.
+		@param filename name of the file containing a model.
+		@param vertices array to which vertices are written.
+		@param indices array to which indices are written.
+	*/
+	void parse3DT(const std::string& filename, std::vector<Vertex3DTT>& vertices, std::vector<uint32_t>& indices)
+	{
+		PROFILE_FUNCTION()
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string err;
+		// Load the model
+		if (!loadObj(filename, attrib, shapes, materials, err))
+		{
+			throw std::runtime_error(err);
+		}
+		size_t cornerCount = countCorners(shapes);
+		CornerMap corners{ cornerCount };
+		indices.reserve(cornerCount);
+		// Fill vertices, uv coordinates and normals
+		for (const auto& shape : shapes)
+		{
+			for (const auto& index : shape.mesh.indices)
+			{
+				uint32_t next = static_cast<uint32_t>(vertices.size());
+				uint32_t unique = corners.insert(index, next);
+				indices.push_back(unique);
+				if (unique != next)
+				{
+					continue;
+				}
+				Vertex3DTT vertex = {};
+				vertex.pos = { attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2] };
+				// Origin of texture coordinates in Vulkan is the top-left corner,
+				// whereas the OBJ format assumes the bottom-left corner
+				// so we need to correct it by subtracting y coordinate from 1.0
+				vertex.uv = { attrib.texcoords[2 * index.texcoord_index + 0], 1.f - attrib.texcoords[2 * index.texcoord_index + 1] };
+				vertex.normal = { attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1], attrib.normals[3 * index.normal_index + 2] };
+				vertices.push_back(vertex);
+			}
+		}
+		// Tangents of corners sharing position, normal and uv are accumulated per vertex
+		std::vector<glm::vec3> normals(vertices.size());
+		std::vector<glm::vec2> uvs(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			normals[i] = vertices[i].normal;
+			uvs[i] = vertices[i].uv;
+		}
+		std::vector<glm::vec4> tangents;
+		TangentGenerator::generate(getPositions(vertices), normals, uvs, indices, tangents);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			vertices[i].tangent = tangents[i];
+		}
+	}
+	/**
+		Splits the range of a model allocated together with its levels of detail into ranges of the levels.
+		@param model model whose range to split.
+		@param counts number of indices of every level, starting with the full one.
+	*/
+	void splitLods(VModel& model, const std::vector<uint32_t>& counts)
+	{
+		uint32_t first = model.range.firstIndex;
+		for (uint32_t count : counts)
+		{
+			model.lods.push_back(MeshRange{ first, count, model.range.vertexOffset, model.range.vertexCount });
+			first += count;
+		}
+		model.range = model.lods[0];
+	}
+}
+
 ModelManager::ModelManager(const GraphicsEngine * engine)
 {
 	this->engine = engine;
 }
 
-std::shared_ptr<VModel> ModelManager::get(const std::string& filename, const ModelType& type)
+std::shared_ptr<VModel> ModelManager::get(const AssetId& model, const ModelType& type)
 {
-	std::string name = extractName(filename);
-	std::shared_ptr<VModel> resource;
-	std::shared_ptr<VModel> (ModelManager::*loader)(const std::string& filename);	// Used to store pointer to a member function used to load the model.
-
-	//Find full name depending on model type
-	//Also determine which function is used to load the model if it is not found
+	PROFILE_FUNCTION()
+	//The same file loaded as a different type is a different resource, so the type is a part of the key
+	//Also determine which function is used to import the model if it is not found
 	// so we don't have to go through switch statement again
+	ResourceKey key{ model.getHash(), static_cast<uint32_t>(type) };
+	Importer importer = getImporter(type);
+	//Find a resource and return it if it is loaded or being loaded, load it otherwise.
+	return getOrLoad(key, [&]()
+	{
+		ImportedModel imported = (this->*importer)(model.getPath(), false);
+		std::unique_lock<std::mutex> lock{ arenaMutex };
+		meshStats.add(imported.stats);
+		lock.unlock();
+		place(imported);
+		return std::make_shared<VModel>(std::move(imported.model));
+	});
+}
+
+ModelManager::Importer ModelManager::getImporter(const ModelType & type)
+{
 	switch (type)
 	{
 	case ModelType::e3D:
-		loader = &ModelManager::load3D;
-		name += "3D";
-		break;
+		return &ModelManager::import3D;
 	case ModelType::e3DTangent:
-		loader = &ModelManager::load3DWithTangent;
-		name += "3DT";
-		break;
+		return &ModelManager::import3DWithTangent;
 	case ModelType::e2D:
-		loader = &ModelManager::load2D;
-		name += "2D";
-		break;
+		return &ModelManager::import2D;
 	default:
 		ASSERT(false) // If this triggers there is case missed;
-			break;
+			return &ModelManager::import3D;
 	}
-	//Find a resource and return it if found.
-	resource = find(name);
-	if (resource != nullptr)
+}
+
+void ModelManager::place(ImportedModel & imported)
+{
+	// Place model's vertices and indices of all levels of detail into the shared arena
+	std::unique_lock<std::mutex> lock{ arenaMutex };
+	allocateMesh(imported.model, imported.type, imported.vertices.data(), imported.vertexCount, imported.vertexStride, imported.indices);
+	lock.unlock();
+	if (!imported.lodCounts.empty())
 	{
-#ifdef _DEBUG
-		hit++;
-#endif
-		return resource;
+		splitLods(imported.model, imported.lodCounts);
 	}
-#ifdef _DEBUG
-	miss++;
-#endif
-	//load and return resource.
-	return (this->*loader)(filename);
 }
 
-ModelManager::~ModelManager()
+std::shared_ptr<MeshArena> ModelManager::getArena(const ModelType & type, uint32_t vertexStride, uint32_t indexSize)
 {
-#ifdef _DEBUG
-	std::cout << "Model hit: " << hit << std::endl;
-	std::cout << "Model miss: " << miss << std::endl;
-#endif
+	std::shared_ptr<MeshArena>& arena = arenas[static_cast<int>(type)][indexSize == sizeof(uint16_t) ? 0 : 1];
+	if (!arena)
+	{
+		arena = std::make_shared<MeshArena>(engine->createMeshArena(vertexStride, initialArenaVertices, initialArenaIndices, indexSize));
+	}
+	ASSERT(arena->getVertexStride() == vertexStride)
+	ASSERT(arena->getIndexSize() == indexSize)
+	return arena;
 }
 
-std::shared_ptr<VModel> ModelManager::load3D(const std::string& filename)
+void ModelManager::allocateMesh(VModel & model, const ModelType & type, const void * vertices, uint32_t vertexCount, uint32_t vertexStride, const std::vector<uint32_t>& indices)
 {
-	std::string name = extractName(filename) + "3D";
-	std::shared_ptr<VModel> model = std::make_shared<VModel>();
-	std::unordered_map<Vertex3DT, int> uniqueVertices = {};
-	std::vector<Vertex3DT> vertices;
-	std::vector<uint32_t> indices;
-
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string err;
-
-	// Load the model
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filename.c_str()))
+	uint32_t indexCount = static_cast<uint32_t>(indices.size());
+	// Indices are relative to the first vertex of the model, so they fit into 16 bits whenever the model itself does
+	if (vertexCount <= maxShortIndexVertices)
 	{
-		throw std::runtime_error(err);
+		std::vector<uint16_t> shortIndices(indexCount);
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			shortIndices[i] = static_cast<uint16_t>(indices[i]);
+		}
+		model.arena = getArena(type, vertexStride, sizeof(uint16_t));
+		model.range = engine->allocateMesh(*model.arena, vertices, vertexCount, shortIndices.data(), indexCount);
 	}
-	// Fill vertices, uv coordinates and normals
-	for (const auto& shape : shapes)
+	else
 	{
-		for (const auto& index : shape.mesh.indices)
-		{
-			Vertex3DT vertex = {};
+		model.arena = getArena(type, vertexStride, sizeof(uint32_t));
+		model.range = engine->allocateMesh(*model.arena, vertices, vertexCount, indices.data(), indexCount);
+	}
+	model.allocation = model.range;
+}
 
-			vertex.pos = {
-				attrib.vertices[3 * index.vertex_index + 0],
-				attrib.vertices[3 * index.vertex_index + 1],
-				attrib.vertices[3 * index.vertex_index + 2]
-			};
+uint64_t ModelManager::getSize(const VModel & resource) const
+{
+	return static_cast<uint64_t>(resource.allocation.vertexCount) * resource.arena->getVertexStride() +
+		static_cast<uint64_t>(resource.allocation.indexCount) * resource.arena->getIndexSize();
+}
 
-			// Origin of texture coordinates in Vulkan is the top-left corner,
-			// whereas the OBJ format assumes the bottom-left corner
-			// so we need to correct it by subtracting y coordinate from 1.0
-			vertex.uv = {
-				attrib.texcoords[2 * index.texcoord_index + 0],
-				1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-			};
+void ModelManager::release(VModel & resource)
+{
+	std::lock_guard<std::mutex> lock{ arenaMutex };
+	resource.arena->free(resource.allocation);
+}
 
-			if (attrib.normals.size() > 0)
-			{
-				vertex.normal = { attrib.normals[3 * index.normal_index + 0],
-					attrib.normals[3 * index.normal_index + 1],
-					attrib.normals[3 * index.normal_index + 2] };
-			}
-			else
-			{
-				vertex.normal = { 0,0,1 };
-			}
+MeshStats ModelManager::getMeshStats() const
+{
+	std::lock_guard<std::mutex> lock{ arenaMutex };
+	return meshStats;
+}
 
-			if (uniqueVertices.count(vertex) == 0)
-			{
-				uniqueVertices[vertex] = vertices.size();
-				vertices.push_back(vertex);
-			}
+ModelManager::~ModelManager()
+{
+#ifdef _DEBUG
+	ResourceStats stats = getStats();
+	std::cout << "Model hit: " << stats.hits << std::endl;
+	std::cout << "Model miss: " << stats.misses << std::endl;
+	std::cout << "Model evictions: " << stats.evictions << std::endl;
+	std::cout << "Mesh ACMR: " << meshStats.getAcmrBefore() << " -> " << meshStats.getAcmrAfter() << std::endl;
+	std::cout << "Mesh ATVR: " << meshStats.getAtvrBefore() << " -> " << meshStats.getAtvrAfter() << std::endl;
+#endif
+}
 
-			indices.push_back(uniqueVertices[vertex]);
-		}
+ModelManager::ImportedModel ModelManager::import3D(const std::string& filename, bool rebuild)
+{
+	PROFILE_FUNCTION()
+	ImportedModel imported;
+	imported.type = ModelType::e3D;
+	std::vector<Vertex3DT> vertices;
+	// Use the processed mesh from the cache, or process the model and cache it
+	std::string cachePath = MeshCache::getPath(filename, "3D");
+	if (rebuild || !readCache(cachePath, filename, vertices, imported.indices, imported.lodCounts, imported.stats))
+	{
+		parse3D(filename, vertices, imported.indices);
+		imported.lodCounts = processMesh(vertices, imported.indices, imported.stats);
+		writeCache(cachePath, filename, vertices, imported.indices, imported.lodCounts, imported.stats);
 	}
-	// Create models vertex and index buffer
-	model->vertices = engine->createVertexBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size());
-	model->indices = engine->createIndexBuffer(indices);
-	// Add model to collection and return it.
-	add(name, model);
-	return model;
+	computeBounds(vertices, imported.model);
+	keepGeometry(vertices, imported.indices, imported.lodCounts[0], imported.model);
+	computeQuantization(imported.model);
+	std::vector<PackedVertex3DT> packed = packVertices(vertices, imported.model.quantization);
+	imported.vertices = toBytes(packed);
+	imported.vertexCount = static_cast<uint32_t>(packed.size());
+	imported.vertexStride = sizeof(packed[0]);
+	return imported;
 }
 
-std::shared_ptr<VModel> ModelManager::load3DWithTangent(const std::string& filename)
+ModelManager::ImportedModel ModelManager::import3DWithTangent(const std::string& filename, bool rebuild)
 {
-	std::string name = extractName(filename) + "3DT";
-	std::shared_ptr<VModel> model = std::make_shared<VModel>();
-	std::unordered_map<Vertex3DTT, int> uniqueVertices = {};
+	PROFILE_FUNCTION()
+	ImportedModel imported;
+	imported.type = ModelType::e3DTangent;
 	std::vector<Vertex3DTT> vertices;
-	std::vector<uint32_t> indices;
-
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string err;
-	// Load the model
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filename.c_str()))
+	// Use the processed mesh from the cache, or process the model and cache it
+	std::string cachePath = MeshCache::getPath(filename, "3DT");
+	if (rebuild || !readCache(cachePath, filename, vertices, imported.indices, imported.lodCounts, imported.stats))
 	{
-		throw std::runtime_error(err);
-	}
-	// Fill vertices, uv coordinates and normals
-	for (const auto& shape : shapes)
-	{
-		for (unsigned int i = 0; i < shape.mesh.indices.size(); i += 3)
-		{
-			tinyobj::index_t i1 = shape.mesh.indices[i], i2 = shape.mesh.indices[i + 1], i3 = shape.mesh.indices[i + 2];
-			Vertex3DTT v1, v2, v3;
-			v1.pos = { attrib.vertices[3 * i1.vertex_index + 0],	attrib.vertices[3 * i1.vertex_index + 1], attrib.vertices[3 * i1.vertex_index + 2] };
-			v2.pos = { attrib.vertices[3 * i2.vertex_index + 0],	attrib.vertices[3 * i2.vertex_index + 1], attrib.vertices[3 * i2.vertex_index + 2] };
-			v3.pos = { attrib.vertices[3 * i3.vertex_index + 0],	attrib.vertices[3 * i3.vertex_index + 1], attrib.vertices[3 * i3.vertex_index + 2] };
-
-			// Origin of texture coordinates in Vulkan is the top-left corner,
-			// whereas the OBJ format assumes the bottom-left corner
-			// so we need to correct it by subtracting y coordinate from 1.0
-			v1.uv = { attrib.texcoords[2 * i1.texcoord_index + 0],	1.f - attrib.texcoords[2 * i1.texcoord_index + 1] };
-			v2.uv = { attrib.texcoords[2 * i2.texcoord_index + 0],	1.f - attrib.texcoords[2 * i2.texcoord_index + 1] };
-			v3.uv = { attrib.texcoords[2 * i3.texcoord_index + 0],	1.f - attrib.texcoords[2 * i3.texcoord_index + 1] };
-
-			v1.normal = { attrib.normals[3 * i1.normal_index + 0],	attrib.normals[3 * i1.normal_index + 1], attrib.normals[3 * i1.normal_index + 2] };
-			v2.normal = { attrib.normals[3 * i2.normal_index + 0],	attrib.normals[3 * i2.normal_index + 1], attrib.normals[3 * i2.normal_index + 2] };
-			v3.normal = { attrib.normals[3 * i3.normal_index + 0],	attrib.normals[3 * i3.normal_index + 1], attrib.normals[3 * i3.normal_index + 2] };
-
-			//calculate tangents and bitangents
-			glm::vec3 dV1 = v2.pos - v1.pos;
-			glm::vec3 dV2 = v3.pos - v1.pos;
-
-			glm::vec2 dUV1 = v2.uv - v1.uv;
-			glm::vec2 dUV2 = v3.uv - v1.uv;
-			float x = 1.f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
-
-			glm::vec3 tangent = (dV1 * dUV2.y - dV2 * dUV1.y) * x;
-			glm::vec3 bitangent = (dV2 * dUV1.x - dV1 * dUV2.x) * x;
-			//gram-schmidt ortogonalization
-			tangent = glm::normalize(tangent - v1.normal * glm::dot(v1.normal, tangent));
-			/*optional if we are using symetric models and textures
-			if (glm::dot(glm::cross(n, t), b) < 0.0f)
-			{
-				t = t * -1.0f;
-			}*/
-
-			v1.tangent = tangent;
-			v2.tangent = tangent;
-			v3.tangent = tangent;
-			v1.bitangent = bitangent;
-			v2.bitangent = bitangent;
-			v3.bitangent = bitangent;
-
-			if (uniqueVertices.count(v1) == 0)
-			{
-				uniqueVertices[v1] = vertices.size();
-				vertices.push_back(v1);
-			}
-			else
-			{
-				vertices[uniqueVertices[v1]].tangent += v1.tangent;
-				vertices[uniqueVertices[v1]].bitangent += v1.bitangent;
-			}
-			indices.push_back(uniqueVertices[v1]);
-
-			if (uniqueVertices.count(v2) == 0)
-			{
-				uniqueVertices[v2] = vertices.size();
-				vertices.push_back(v2);
-			}
-			else
-			{
-				vertices[uniqueVertices[v2]].tangent += v2.tangent;
-				vertices[uniqueVertices[v2]].bitangent += v2.bitangent;
-			}
-			indices.push_back(uniqueVertices[v2]);
-
-			if (uniqueVertices.count(v3) == 0)
-			{
-				uniqueVertices[v3] = vertices.size();
-				vertices.push_back(v3);
-			}
-			else
-			{
-				vertices[uniqueVertices[v3]].tangent += v3.tangent;
-				vertices[uniqueVertices[v3]].bitangent += v3.bitangent;
-			}
-			indices.push_back(uniqueVertices[v3]);
-		}
+		parse3DT(filename, vertices, imported.indices);
+		imported.lodCounts = processMesh(vertices, imported.indices, imported.stats);
+		writeCache(cachePath, filename, vertices, imported.indices, imported.lodCounts, imported.stats);
 	}
-	// Create models vertex and index buffer
-	model->vertices = engine->createVertexBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size());
-	model->indices = engine->createIndexBuffer(indices);
-	// Add model to collection and return it.
-	add(name, model);
-	return model;
+	computeBounds(vertices, imported.model);
+	keepGeometry(vertices, imported.indices, imported.lodCounts[0], imported.model);
+	computeQuantization(imported.model);
+	std::vector<PackedVertex3DTT> packed = packVertices(vertices, imported.model.quantization);
+	imported.vertices = toBytes(packed);
+	imported.vertexCount = static_cast<uint32_t>(packed.size());
+	imported.vertexStride = sizeof(packed[0]);
+	return imported;
 }
 
-std::shared_ptr<VModel> ModelManager::load2D(const std::string& filename)
+ModelManager::ImportedModel ModelManager::import2D(const std::string& filename, bool rebuild)
 {
-	std::string name = extractName(filename) + "2D";
-	std::shared_ptr<VModel> model = std::make_shared<VModel>();
-	std::unordered_map<Vertex2DT, int> uniqueVertices = {};
+	PROFILE_FUNCTION()
+	ImportedModel imported;
+	imported.type = ModelType::e2D;
 	std::vector<Vertex2DT> vertices;
-	std::vector<uint32_t> indices;
+	std::vector<uint32_t>& indices = imported.indices;
 
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
 	std::string err;
 	// Load the model
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filename.c_str()))
+	if (!loadObj(filename, attrib, shapes, materials, err))
 	{
 		throw std::runtime_error(err);
 	}
+	size_t cornerCount = countCorners(shapes);
+	CornerMap corners{ cornerCount };
+	indices.reserve(cornerCount);
 	// Fill vertices and uv coordinates
 	for (const auto& shape : shapes)
 	{
 		for (const auto& index : shape.mesh.indices)
 		{
+			// 2D vertices have no normals, so corners differing only in their normal are merged
+			tinyobj::index_t corner = index;
+			corner.normal_index = -1;
+			uint32_t next = static_cast<uint32_t>(vertices.size());
+			uint32_t unique = corners.insert(corner, next);
+			indices.push_back(unique);
+			if (unique != next)
+			{
+				continue;
+			}
 			Vertex2DT vertex = {};
 
 			vertex.pos = {
@@ -277,20 +785,81 @@ std::shared_ptr<VModel> ModelManager::load2D(const std::string& filename)
 				attrib.texcoords[2 * index.texcoord_index + 0],
 				1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
 			};
+			vertices.push_back(vertex);
+		}
+	}
+	computeBounds(vertices, imported.model);
+	imported.vertices = toBytes(vertices);
+	imported.vertexCount = static_cast<uint32_t>(vertices.size());
+	imported.vertexStride = sizeof(vertices[0]);
+	return imported;
+}
 
-			if (uniqueVertices.count(vertex) == 0)
+void ModelManager::reload(const std::string & filename)
+{
+	PROFILE_FUNCTION()
+	uint64_t asset = AssetId::hash(filename.c_str());
+	// The same file may be loaded as several types of models, each of them is re-imported
+	const ModelType types[] = { ModelType::e3D, ModelType::e2D, ModelType::e3DTangent };
+	for (const ModelType& type : types)
+	{
+		ResourceKey key{ asset, static_cast<uint32_t>(type) };
+		std::shared_ptr<VModel> model = find(key);
+		if (!model)
+		{
+			continue;
+		}
+		// Only importing runs in the background, models are placed into arenas by applyReloads on the thread drawing frames
+		// the source may have changed without changing its size and time, so the cached mesh is always rebuilt
+		Importer importer = getImporter(type);
+		std::future<ImportedModel> imported = std::async(std::launch::async, [this, importer, filename]()
+		{
+			try
 			{
-				uniqueVertices[vertex] = vertices.size();
-				vertices.push_back(vertex);
+				return (this->*importer)(filename, true);
 			}
+			catch (const std::runtime_error&)
+			{
+				return ImportedModel{};
+			}
+		});
+		reloads.push_back(ModelReload{ key, model, std::move(imported) });
+	}
+}
 
-			indices.push_back(uniqueVertices[vertex]);
+void ModelManager::applyReloads()
+{
+	PROFILE_FUNCTION()
+	std::vector<ModelReload> waiting;
+	std::vector<std::pair<ResourceKey, uint64_t>> resized;
+	for (ModelReload& reload : reloads)
+	{
+		// a later reload of the same model waits for the earlier one, so the latest version of the file ends up loaded
+		bool blocked = std::any_of(waiting.begin(), waiting.end(), [&reload](const ModelReload& x) { return x.model == reload.model; });
+		if (blocked || reload.imported.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			waiting.push_back(std::move(reload));
+			continue;
 		}
+		ImportedModel imported = reload.imported.get();
+		// files are often invalid while they are being saved, the current geometry is kept until a valid one is written
+		if (imported.vertexCount == 0)
+		{
+			continue;
+		}
+		// Components hold the model itself, so its contents are swapped and the old geometry is freed
+		// The version tells components that their uploaded dequantization and their bounds are out of date
+		place(imported);
+		VModel old = std::move(*reload.model);
+		*reload.model = std::move(imported.model);
+		reload.model->version = old.version + 1;
+		release(old);
+		resized.push_back(std::make_pair(reload.key, getSize(*reload.model)));
+	}
+	reloads.swap(waiting);
+	// Sizes are updated after all models are replaced, as they may evict models
+	for (const auto& model : resized)
+	{
+		resize(model.first, model.second);
 	}
-	// Create models vertex and index buffer
-	model->vertices = engine->createVertexBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size());
-	model->indices = engine->createIndexBuffer(indices);
-	// Add model to collection and return it.
-	add(name, model);
-	return model;
 }
\ No newline at end of file
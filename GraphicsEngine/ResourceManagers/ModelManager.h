@@ -2,8 +2,11 @@
 #include"ResourceManager.h"
 #include"..\Core\VModel.h"
 #include"..\Graphics\ModelType.h"
+#include"MeshOptimizer.h"
+#include"AssetId.h"
 
 class GraphicsEngine;
+class MeshArena;
 
 /**
 	Resource manager class used for loading and storing models.
@@ -17,31 +20,120 @@ public:
 	*/
 	ModelManager(const GraphicsEngine* engine);
 	/**
-		Gets a model from a colection.
-		@param filename filename of the model to be fetched.
+		Gets a model from a colection. Can be called from several threads at once.
+		@param model id of the model to be fetched.
 		@param type type of a model we want to load.
 	*/
-	std::shared_ptr<VModel> get(const std::string& filename, const ModelType& type);
+	std::shared_ptr<VModel> get(const AssetId& model, const ModelType& type);
+	/**
+		Returns statistics of the optimisation of all loaded 3D models.
+		@return mesh statistics.
+	*/
+	MeshStats getMeshStats() const;
+	/**
+		Starts re-importing all types of a loaded model in the background after its file changed. Other files are ignored.
+		@param filename path of the changed file.
+	*/
+	void reload(const std::string& filename);
+	/**
+		Replaces geometry of models whose re-import finished and increases their versions. Components using the models draw the new geometry, and upload its dequantization once they see the new version.
+		Models whose files couldn't be read keep their current geometry.
+		Needs to be called from the same thread as reload, when the GPU doesn't use any of the models.
+	*/
+	void applyReloads();
 	/**
 		Destructor.
 	*/
 	~ModelManager();
 protected:
 	/**
-		Helper function used for loading a 3D model from disk.
+		Model imported on the CPU, ready to be placed into an arena.
+	*/
+	struct ImportedModel
+	{
+		ModelType type{ ModelType::e3D };	//*< Type of the model.
+		VModel model;						//*< Model with its bounds, quantization and geometry kept on the CPU, not yet placed into an arena.
+		std::vector<char> vertices;			//*< Vertices in the layout of the model type.
+		uint32_t vertexCount{ 0 };			//*< Number of vertices, 0 if the model couldn't be imported.
+		uint32_t vertexStride{ 0 };			//*< Size of a single vertex in bytes.
+		std::vector<uint32_t> indices;		//*< Indices of all levels of detail one after another.
+		std::vector<uint32_t> lodCounts;	//*< Number of indices of every level of detail, starting with the full one. Empty for 2D models.
+		MeshStats stats;					//*< Statistics of the optimisation of a 3D model.
+	};
+	typedef ImportedModel(ModelManager::*Importer)(const std::string& filename, bool rebuild);	//*< Pointer to a member function importing a type of models.
+
+	/**
+		Helper function used for importing a 3D model from disk.
 		@param filename name of the file containing a model.
+		@param rebuild true to process the model even if the cached mesh seems to be up to date.
 	*/
-	std::shared_ptr<VModel> load3D(const std::string& filename);
+	ImportedModel import3D(const std::string& filename, bool rebuild);
 	/**
-		Helper function used for loading a 3D model from disk and calculating its tangents and bitangents.
+		Helper function used for importing a 3D model from disk and calculating its tangents and bitangents.
 		@param filename name of the file containing a model.
+		@param rebuild true to process the model even if the cached mesh seems to be up to date.
 	*/
-	std::shared_ptr<VModel> load3DWithTangent(const std::string& filename);
+	ImportedModel import3DWithTangent(const std::string& filename, bool rebuild);
 	/**
-		Helper function used for loading a 2D model from disk.
+		Helper function used for importing a 2D model from disk.
 		@param filename name of the file containing a model.
+		@param rebuild unused, 2D models aren't cached.
 	*/
-	std::shared_ptr<VModel> load2D(const std::string& filename);
+	ImportedModel import2D(const std::string& filename, bool rebuild);
+	/**
+		Returns the function used to import models of a given type.
+		@param type type of the model.
+		@return pointer to the member function.
+	*/
+	static Importer getImporter(const ModelType& type);
+	/**
+		Places an imported model's vertices and indices into an arena for its type and splits it into levels of detail.
+		@param imported imported model, its model is updated with its location inside of the arena.
+	*/
+	void place(ImportedModel& imported);
+	/**
+		Returns the arena in which models of the given type are stored. Arena is created on first use.
+		@param type type of models stored in the arena.
+		@param vertexStride size of a single vertex of that model type in bytes.
+		@param indexSize size of a single index in bytes, either 2 or 4.
+		@return arena for the given model type and index size.
+	*/
+	std::shared_ptr<MeshArena> getArena(const ModelType& type, uint32_t vertexStride, uint32_t indexSize);
+	/**
+		Places model's vertices and indices into an arena for its type and stores their location in the model.
+		Models with few enough vertices are placed into an arena with 16-bit indices.
+		@param model model which is allocated.
+		@param type type of the model.
+		@param vertices pointer to an array of vertices.
+		@param vertexCount number of vertices in the array.
+		@param vertexStride size of a single vertex in bytes.
+		@param indices indices of the model.
+	*/
+	void allocateMesh(VModel& model, const ModelType& type, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, const std::vector<uint32_t>& indices);
+	/**
+		Returns GPU memory used by a model's vertices and indices.
+		@param resource loaded model.
+		@return size of the model in bytes.
+	*/
+	uint64_t getSize(const VModel& resource) const override;
+	/**
+		Frees the space of an evicted model inside of its arena.
+		@param resource evicted model.
+	*/
+	void release(VModel& resource) override;
 private:
-	const GraphicsEngine* engine;	//*< pointer to a graphics engine used by a manager.
+	const GraphicsEngine* engine;				//*< pointer to a graphics engine used by a manager.
+	std::shared_ptr<MeshArena> arenas[3][2];	//*< Mesh arenas indexed by model type and by index size, 16-bit first. Models of the same type share vertex layout.
+	MeshStats meshStats;						//*< Statistics of the optimisation of loaded 3D models.
+	mutable std::mutex arenaMutex;				//*< Mutex guarding the arenas and the statistics, which threads loading different models update.
+	/**
+		Model being re-imported.
+	*/
+	struct ModelReload
+	{
+		ResourceKey key;						//*< Key of the model in the collection.
+		std::shared_ptr<VModel> model;			//*< Model whose geometry is replaced.
+		std::future<ImportedModel> imported;	//*< Model being imported.
+	};
+	std::vector<ModelReload> reloads;			//*< Models being re-imported, in the order their files changed.
 };
\ No newline at end of file
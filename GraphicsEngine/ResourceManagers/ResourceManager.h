@@ -1,10 +1,66 @@
 #pragma once
-#include<map>
-#include<string>
+#include<unordered_map>
 #include<memory>
+#include<mutex>
+#include<future>
+#include<atomic>
+#include<vector>
+#include<algorithm>
+#include<limits>
+
+/**
+	Statistics of a resource manager.
+*/
+struct ResourceStats
+{
+	uint64_t hits{ 0 };				//*< Number of requests for resources which were already loaded or being loaded.
+	uint64_t misses{ 0 };			//*< Number of requests which needed to load a resource.
+	uint64_t evictions{ 0 };		//*< Number of resources removed to stay within the budget.
+	uint64_t residentBytes{ 0 };	//*< GPU memory used by resources held by the manager.
+	uint64_t budget{ 0 };			//*< GPU memory the manager tries to stay within.
+};
+
+/**
+	Key of a resource: the asset it's loaded from and the parameters it's loaded with, such as the vertex layout of a model.
+*/
+struct ResourceKey
+{
+	uint64_t asset;		//*< Hash of the asset id.
+	uint32_t variant;	//*< Parameters with which the asset is loaded.
+	/**
+		Compares two keys.
+		@param x key to compare with.
+		@return true if both keys refer to the same resource.
+	*/
+	bool operator==(const ResourceKey& x) const
+	{
+		return asset == x.asset && variant == x.variant;
+	}
+};
+
+/**
+	Hash function of resource keys.
+*/
+struct ResourceKeyHash
+{
+	/**
+		Returns the hash of a key.
+		@param key key to hash.
+		@return hash of the key.
+	*/
+	size_t operator()(const ResourceKey& key) const
+	{
+		// asset hashes are already well mixed
+		return static_cast<size_t>(key.asset ^ (key.variant * 0x9e3779b97f4a7c15ull));
+	}
+};
 
 /**
 	Base class used to implement common functions used by resource managers.
+	Resources are keyed by asset ids, so keys are computed once and looking them up doesn't allocate.
+	Resources are stored in shards of hashed containers, each guarded by its own mutex, so they can be requested from several threads.
+	A resource which is being loaded is stored as a future, so later requests for it wait for the first load instead of loading it again.
+	Manager tracks GPU memory of its resources, and when it exceeds the budget it removes least recently used resources nobody else holds.
 */
 template <class T>
 class ResourceManager
@@ -14,81 +70,322 @@ public:
 		Destructor.
 	*/
 	virtual ~ResourceManager(){	}
+	/**
+		Sets the GPU memory the manager tries to stay within. Resources still in use are never removed, so the budget may be exceeded.
+		@param bytes budget in bytes.
+	*/
+	void setBudget(uint64_t bytes);
+	/**
+		Returns statistics of the manager.
+		@return resource statistics.
+	*/
+	ResourceStats getStats() const;
 protected:
+	/**
+		Returns a resource with a given key, loading it if it isn't in the container yet.
+		Only the first of concurrent requests for the same key calls the loader, the rest wait for its result.
+		If the loader throws, the exception is passed to all waiting requests and the resource can be requested again.
+		@param key resource's key.
+		@param loader function returning the loaded resource, called without holding any lock.
+		@return pointer to the resource.
+	*/
+	template<typename F>
+	std::shared_ptr<T> getOrLoad(const ResourceKey& key, const F& loader);
 	/**
 		Adds a resource to the container.
-		@param name resource's name.
+		@param key resource's key.
 		@param resource resource to add to the container.
 	*/
-	void add(const std::string& name, std::shared_ptr<T> resource);
+	void add(const ResourceKey& key, std::shared_ptr<T> resource);
 	/**
-		Finds a resource in the container.
-		@param name name of the resource we want to find.
-		@return pointer to the resource with a given name. Null if not found.
+		Finds a resource in the container. Waits for the resource if it is being loaded.
+		@param key key of the resource we want to find.
+		@return pointer to the resource with a given key. Null if not found.
 	*/
-	std::shared_ptr<T> find(const std::string& name) const;
+	std::shared_ptr<T> find(const ResourceKey& key) const;
 	/**
 		Removes resource from the container.
-		@param name name of the resource we want to remove.
+		@param key key of the resource we want to remove.
+	*/
+	void remove(const ResourceKey& key);
+	/**
+		Changes the GPU memory recorded for a loaded resource, for resources whose size changes after they are loaded.
+		@param key key of the resource.
+		@param size new size of the resource in bytes.
 	*/
-	void remove(const std::string& name);
+	void resize(const ResourceKey& key, uint64_t size);
 	/**
-		Extracts a name from a given filename.
-		@param filename out of which to extract a name.
-		@return extracted name.
+		Returns GPU memory used by a resource.
+		@param resource loaded resource.
+		@return size of the resource in bytes.
 	*/
-	std::string extractName(const std::string& filename) const;
-#ifdef _DEBUG
-	uint64_t hit = 0;									//*< Records the number of resources that did not need to be loaded from disk.
-	uint64_t miss = 0;									//*< Records the number of resources that needed to be loaded from disk.
-#endif
+	virtual uint64_t getSize(const T& resource) const = 0;
+	/**
+		Called when a resource is evicted, before it is destroyed. Nobody else holds the resource at that point.
+		@param resource evicted resource.
+	*/
+	virtual void release(T& resource) {}
 private:
-	std::map<std::string, std::shared_ptr<T>> resources;	//*< Container used for storing resources.
+	static const size_t shardCount = 16;				//*< Number of independently locked parts of the container.
+
+	/**
+		Resource stored in the container.
+	*/
+	struct Entry
+	{
+		std::shared_future<std::shared_ptr<T>> future;	//*< Future holding the resource once it is loaded.
+		bool loaded{ false };							//*< Whether the resource finished loading successfully.
+		uint64_t size{ 0 };								//*< GPU memory used by the resource.
+		uint64_t lastUse{ 0 };							//*< Time of the last request for the resource.
+	};
+
+	/**
+		Part of the container guarded by its own mutex.
+	*/
+	struct Shard
+	{
+		std::mutex mutex;										//*< Mutex guarding the resources of the shard.
+		std::unordered_map<ResourceKey, Entry, ResourceKeyHash> resources;		//*< Loaded resources and resources being loaded.
+	};
+
+	/**
+		Returns the shard in which a resource with a given key is stored.
+		@param key key of the resource.
+		@return shard of the resource.
+	*/
+	Shard& getShard(const ResourceKey& key) const;
+	/**
+		Removes least recently used resources held only by the manager until the resident memory fits into the budget.
+	*/
+	void evict();
+
+	mutable Shard shards[shardCount];										//*< Container used for storing resources.
+	std::atomic<uint64_t> clock{ 0 };										//*< Counter of requests, used as the time of the last use.
+	std::atomic<uint64_t> budget{ std::numeric_limits<uint64_t>::max() };	//*< GPU memory the manager tries to stay within.
+	std::atomic<uint64_t> residentBytes{ 0 };								//*< GPU memory used by loaded resources.
+	std::atomic<uint64_t> hits{ 0 };										//*< Records the number of resources that did not need to be loaded from disk.
+	std::atomic<uint64_t> misses{ 0 };										//*< Records the number of resources that needed to be loaded from disk.
+	std::atomic<uint64_t> evictions{ 0 };									//*< Records the number of resources removed to stay within the budget.
+	std::mutex evictMutex;													//*< Mutex preventing two threads from evicting at once.
 };
 
 template<class T>
-inline void ResourceManager<T>::add(const std::string & name, std::shared_ptr<T> resource)
+inline void ResourceManager<T>::setBudget(uint64_t bytes)
+{
+	budget = bytes;
+	evict();
+}
+
+template<class T>
+inline ResourceStats ResourceManager<T>::getStats() const
+{
+	ResourceStats stats;
+	stats.hits = hits;
+	stats.misses = misses;
+	stats.evictions = evictions;
+	stats.residentBytes = residentBytes;
+	stats.budget = budget;
+	return stats;
+}
+
+template<class T>
+template<typename F>
+inline std::shared_ptr<T> ResourceManager<T>::getOrLoad(const ResourceKey & key, const F & loader)
 {
-	std::pair<std::string, std::shared_ptr<T>> record{name, resource};
-	resources.insert(record);
+	Shard& shard = getShard(key);
+	std::promise<std::shared_ptr<T>> promise;
+	std::shared_future<std::shared_ptr<T>> pending;
+	{
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		typename std::unordered_map<ResourceKey, Entry, ResourceKeyHash>::iterator it = shard.resources.find(key);
+		if (it != shard.resources.end())
+		{
+			hits++;
+			it->second.lastUse = ++clock;
+			//loaded resource is taken under the lock, so it can't be evicted before the caller holds it.
+			if (it->second.loaded)
+			{
+				return it->second.future.get();
+			}
+			pending = it->second.future;
+		}
+		else
+		{
+			Entry entry;
+			entry.future = promise.get_future().share();
+			entry.lastUse = ++clock;
+			shard.resources.emplace(key, entry);
+		}
+	}
+	//wait outside of the lock, so requests for other resources of the shard aren't blocked by the load.
+	if (pending.valid())
+	{
+		return pending.get();
+	}
+	misses++;
+	std::shared_ptr<T> resource;
+	try
+	{
+		resource = loader();
+	}
+	catch (...)
+	{
+		promise.set_exception(std::current_exception());
+		{
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			shard.resources.erase(key);
+		}
+		throw;
+	}
+	promise.set_value(resource);
+	uint64_t size = getSize(*resource);
+	{
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		typename std::unordered_map<ResourceKey, Entry, ResourceKeyHash>::iterator it = shard.resources.find(key);
+		if (it != shard.resources.end() && !it->second.loaded)
+		{
+			it->second.loaded = true;
+			it->second.size = size;
+			residentBytes += size;
+		}
+	}
+	if (residentBytes > budget)
+	{
+		evict();
+	}
+	return resource;
 }
 
 template<class T>
-inline std::shared_ptr<T> ResourceManager<T>::find(const std::string & name) const
+inline void ResourceManager<T>::add(const ResourceKey & key, std::shared_ptr<T> resource)
 {
-	typename std::map<std::string, std::shared_ptr<T>>::const_iterator it;
-	it = resources.find(name);
-	if (it != resources.end())
+	std::promise<std::shared_ptr<T>> promise;
+	promise.set_value(resource);
+	Entry entry;
+	entry.future = promise.get_future().share();
+	entry.loaded = true;
+	entry.size = getSize(*resource);
+	entry.lastUse = ++clock;
+	Shard& shard = getShard(key);
+	{
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		if (!shard.resources.emplace(key, entry).second)
+		{
+			return;
+		}
+		residentBytes += entry.size;
+	}
+	if (residentBytes > budget)
 	{
-		return (*it).second;
+		evict();
 	}
-	return nullptr;
 }
 
 template<class T>
-inline void ResourceManager<T>::remove(const std::string & name)
+inline std::shared_ptr<T> ResourceManager<T>::find(const ResourceKey & key) const
 {
-	typename map<const std::string, T*>::iterator it = resources.find(name);
-	if (it != resources.end())
+	Shard& shard = getShard(key);
+	std::shared_future<std::shared_ptr<T>> pending;
 	{
-		resources.erase(it);
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		typename std::unordered_map<ResourceKey, Entry, ResourceKeyHash>::iterator it = shard.resources.find(key);
+		if (it == shard.resources.end())
+		{
+			return nullptr;
+		}
+		if (it->second.loaded)
+		{
+			return it->second.future.get();
+		}
+		pending = it->second.future;
 	}
+	return pending.get();
 }
 
 template<class T>
-inline std::string ResourceManager<T>::extractName(const std::string & filename) const
+inline void ResourceManager<T>::remove(const ResourceKey & key)
 {
-	size_t offset = filename.find_last_of('/');
-	if (offset == std::string::npos)
+	Shard& shard = getShard(key);
+	std::lock_guard<std::mutex> lock{ shard.mutex };
+	typename std::unordered_map<ResourceKey, Entry, ResourceKeyHash>::iterator it = shard.resources.find(key);
+	if (it != shard.resources.end())
 	{
-		offset = filename.find_last_of('\\');
-		if (offset == std::string::npos)
+		residentBytes -= it->second.size;
+		shard.resources.erase(it);
+	}
+}
+
+template<class T>
+inline void ResourceManager<T>::resize(const ResourceKey & key, uint64_t size)
+{
+	Shard& shard = getShard(key);
+	{
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		typename std::unordered_map<ResourceKey, Entry, ResourceKeyHash>::iterator it = shard.resources.find(key);
+		if (it == shard.resources.end() || !it->second.loaded)
 		{
-			offset = 0;
+			return;
 		}
+		residentBytes += size;
+		residentBytes -= it->second.size;
+		it->second.size = size;
+	}
+	if (residentBytes > budget)
+	{
+		evict();
 	}
-	size_t offsetDot = filename.find_last_of('.');
-	//Take a substring between last '/' and '.', and treat it as a name of a resource;
-	std::string name = filename.substr(offset + 1, offsetDot - offset - 1);
-	return name;
 }
+
+template<class T>
+inline typename ResourceManager<T>::Shard & ResourceManager<T>::getShard(const ResourceKey & key) const
+{
+	// high bits pick the shard, so the low bits used by the buckets of its container still differ between its resources
+	return shards[static_cast<size_t>((key.asset >> 32) + key.variant) % shardCount];
+}
+
+template<class T>
+inline void ResourceManager<T>::evict()
+{
+	std::lock_guard<std::mutex> evictLock{ evictMutex };
+	if (residentBytes <= budget)
+	{
+		return;
+	}
+	//collect loaded resources nobody else holds, least recently used first.
+	std::vector<std::pair<uint64_t, ResourceKey>> candidates;
+	for (Shard& shard : shards)
+	{
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		for (const auto& resource : shard.resources)
+		{
+			if (resource.second.loaded && resource.second.future.get().use_count() == 1)
+			{
+				candidates.push_back(std::make_pair(resource.second.lastUse, resource.first));
+			}
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint64_t, ResourceKey>& a, const std::pair<uint64_t, ResourceKey>& b) { return a.first < b.first; });
+	for (const auto& candidate : candidates)
+	{
+		if (residentBytes <= budget)
+		{
+			break;
+		}
+		Shard& shard = getShard(candidate.second);
+		std::shared_ptr<T> resource;
+		{
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			typename std::unordered_map<ResourceKey, Entry, ResourceKeyHash>::iterator it = shard.resources.find(candidate.second);
+			//skip resources requested since they were collected.
+			if (it == shard.resources.end() || it->second.lastUse != candidate.first || it->second.future.get().use_count() != 1)
+			{
+				continue;
+			}
+			resource = it->second.future.get();
+			residentBytes -= it->second.size;
+			shard.resources.erase(it);
+		}
+		evictions++;
+		release(*resource);
+	}
+}
\ No newline at end of file
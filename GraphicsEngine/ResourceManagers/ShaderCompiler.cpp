@@ -0,0 +1,320 @@
+#include "ShaderCompiler.h"
+#include "FileSystem.h"
+#include<atomic>
+#include<mutex>
+#include<fstream>
+#include<sstream>
+#include<iostream>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<stdexcept>
+#if SHADERC_ENABLED
+#include<shaderc\shaderc.h>
+#pragma comment(lib, "shaderc_combined.lib")
+#endif
+#ifdef _WIN32
+#include<windows.h>
+#else
+#include<sys/stat.h>
+#endif
+
+namespace
+{
+	const uint32_t spirvMagic = 0x07230203;	//*< First word of every SPIR-V module.
+	const char* stageExtensions[] = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };	//*< Extensions of GLSL sources, one for every shader stage.
+
+	std::atomic<bool> compilationEnabled{ false };	//*< Whether shaders are compiled from their sources.
+	std::atomic<bool> compilerAvailable{ true };	//*< Whether the compiler can be run, cleared once it fails to start.
+	std::mutex directoryMutex;				//*< Mutex guarding the cache directory.
+	std::string cacheDirectory{ "ShaderCache" };	//*< Directory in which compiled shaders are cached.
+
+	/**
+		Returns the extension of a path including the dot, empty if it has none.
+	*/
+	std::string getExtension(const std::string& path)
+	{
+		size_t dot = path.find_last_of('.');
+		size_t slash = path.find_last_of("/\\");
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		{
+			return std::string();
+		}
+		return path.substr(dot);
+	}
+
+	/**
+		Hashes bytes with 64-bit FNV-1a, continuing from a previous hash.
+	*/
+	uint64_t hashBytes(const char* data, size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	/**
+		Returns the path of a cached shader, creating the cache directory if needed.
+		@param key hash of the shader.
+		@return path to the cache file without an extension.
+	*/
+	std::string getCachePath(uint64_t key)
+	{
+		char name[17];
+		snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+		std::lock_guard<std::mutex> lock{ directoryMutex };
+#ifdef _WIN32
+		CreateDirectoryA(cacheDirectory.c_str(), nullptr);
+#else
+		mkdir(cacheDirectory.c_str(), 0755);
+#endif
+		return cacheDirectory + "/" + name;
+	}
+
+	/**
+		Reads a whole file from disk, bypassing mounted packs.
+		@return contents of the file, empty if it can't be read.
+	*/
+	std::string readFile(const std::string& path)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+#if SHADERC_ENABLED
+	/**
+		Compiler shared by all threads, shaderc compilers can compile several shaders at once.
+	*/
+	struct Compiler
+	{
+		Compiler() : handle{ shaderc_compiler_initialize() } {}
+		~Compiler() { shaderc_compiler_release(handle); }
+		shaderc_compiler_t handle;
+	};
+#else
+	/**
+		Returns the command running glslangValidator, the one in the Vulkan SDK if it is installed and the one on the path otherwise.
+	*/
+	std::string getValidator()
+	{
+		std::string validator{ "glslangValidator" };
+#ifdef _WIN32
+		char* sdk = nullptr;
+		size_t length = 0;
+		if (_dupenv_s(&sdk, &length, "VULKAN_SDK") == 0 && sdk != nullptr)
+		{
+			validator = "\"" + std::string(sdk) + "\\Bin32\\glslangValidator.exe\"";
+		}
+		free(sdk);
+#else
+		const char* sdk = std::getenv("VULKAN_SDK");
+		if (sdk != nullptr)
+		{
+			validator = "\"" + std::string(sdk) + "/bin/glslangValidator\"";
+		}
+#endif
+		return validator;
+	}
+#endif
+}
+
+void ShaderCompiler::setEnabled(bool enabled)
+{
+	compilationEnabled = enabled;
+}
+
+bool ShaderCompiler::isEnabled()
+{
+	return compilationEnabled;
+}
+
+void ShaderCompiler::setCacheDirectory(const std::string & directory)
+{
+	std::lock_guard<std::mutex> lock{ directoryMutex };
+	cacheDirectory = directory;
+}
+
+FileView ShaderCompiler::load(const std::string & source, const std::string & binary, const std::vector<std::string>& defines)
+{
+	if (!compilationEnabled || !compilerAvailable)
+	{
+		return FileSystem::open(binary);
+	}
+	FileView sourceFile = FileSystem::open(source);
+	if (!sourceFile.isValid())
+	{
+		return FileSystem::open(binary);
+	}
+	std::string text = addDefines(std::string(sourceFile.getData(), sourceFile.getSize()), defines);
+	// the stage isn't a part of the text, so the extension is hashed with it
+	std::string header = std::to_string(version) + getExtension(source);
+	uint64_t key = hashBytes(text.data(), text.size(), hashBytes(header.data(), header.size()));
+	std::string path = getCachePath(key) + ".spv";
+	FileView cached = FileSystem::open(path);
+	if (isSpirv(cached))
+	{
+		return cached;
+	}
+	std::vector<char> code;
+	std::string log;
+	if (!compile(text, source, code, log))
+	{
+		// an error in an edited shader shouldn't stop the application, the code compiled offline is used until it is fixed
+		FileView fallback = FileSystem::open(binary);
+		if (!fallback.isValid())
+		{
+			throw std::runtime_error("failed to compile shader " + source + "!\n" + log);
+		}
+		std::cerr << "failed to compile shader " << source << ", using " << binary << std::endl << log << std::endl;
+		return fallback;
+	}
+	std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+	file.write(code.data(), code.size());
+	// a partially written file fails the magic or size check next time, but don't leave it behind.
+	if (!file)
+	{
+		file.close();
+		std::remove(path.c_str());
+	}
+	return FileView{ std::move(code) };
+}
+
+bool ShaderCompiler::isSource(const std::string & path)
+{
+	std::string extension = getExtension(path);
+	for (const char* stage : stageExtensions)
+	{
+		if (extension == stage)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ShaderCompiler::isSpirv(const FileView & code)
+{
+	uint32_t magic = 0;
+	if (!code.isValid() || code.getSize() < sizeof(magic) || code.getSize() % sizeof(uint32_t) != 0)
+	{
+		return false;
+	}
+	memcpy(&magic, code.getData(), sizeof(magic));
+	return magic == spirvMagic;
+}
+
+std::string ShaderCompiler::addDefines(const std::string & source, const std::vector<std::string>& defines)
+{
+	if (defines.empty())
+	{
+		return source;
+	}
+	// the version directive has to stay first, so macros follow it
+	size_t versionLine = 0;
+	size_t insert = 0;
+	size_t start = 0;
+	uint32_t line = 1;
+	while (start < source.size())
+	{
+		size_t end = source.find('\n', start);
+		end = end == std::string::npos ? source.size() : end + 1;
+		size_t first = source.find_first_not_of(" \t", start);
+		if (first < end && source.compare(first, 8, "#version") == 0)
+		{
+			versionLine = line;
+			insert = end;
+			break;
+		}
+		start = end;
+		line++;
+	}
+	std::string result = source.substr(0, insert);
+	if (insert > 0 && source[insert - 1] != '\n')
+	{
+		result += '\n';
+	}
+	for (const std::string& define : defines)
+	{
+		std::string macro = define;
+		size_t equals = macro.find('=');
+		if (equals != std::string::npos)
+		{
+			macro[equals] = ' ';
+		}
+		result += "#define " + macro + "\n";
+	}
+	result += "#line " + std::to_string(versionLine + 1) + "\n";
+	result += source.substr(insert);
+	return result;
+}
+
+bool ShaderCompiler::compile(const std::string & source, const std::string & name, std::vector<char>& code, std::string & log)
+{
+	std::string extension = getExtension(name);
+#if SHADERC_ENABLED
+	static Compiler compiler;
+	const shaderc_shader_kind kinds[] = { shaderc_glsl_vertex_shader, shaderc_glsl_fragment_shader, shaderc_glsl_compute_shader,
+		shaderc_glsl_geometry_shader, shaderc_glsl_tess_control_shader, shaderc_glsl_tess_evaluation_shader };
+	size_t stage = 0;
+	while (stage < sizeof(kinds) / sizeof(kinds[0]) && extension != stageExtensions[stage])
+	{
+		stage++;
+	}
+	if (stage == sizeof(kinds) / sizeof(kinds[0]))
+	{
+		log = "unknown shader stage";
+		return false;
+	}
+	shaderc_compilation_result_t result = shaderc_compile_into_spv(compiler.handle, source.data(), source.size(), kinds[stage], name.c_str(), "main", nullptr);
+	bool compiled = shaderc_result_get_compilation_status(result) == shaderc_compilation_status_success;
+	if (compiled)
+	{
+		const char* bytes = shaderc_result_get_bytes(result);
+		code.assign(bytes, bytes + shaderc_result_get_length(result));
+	}
+	else
+	{
+		log = shaderc_result_get_error_message(result);
+	}
+	shaderc_result_release(result);
+	return compiled;
+#else
+	// the validator determines the stage from the extension, so the source is written next to the output under a name unique to this call
+	static std::atomic<uint32_t> counter{ 0 };
+	std::string base = getCachePath(hashBytes(source.data(), source.size())) + "." + std::to_string(counter++);
+	std::string input = base + extension;
+	std::string output = base + ".out";
+	std::string logFile = base + ".log";
+	{
+		std::ofstream file{ input, std::ios::binary | std::ios::trunc };
+		file.write(source.data(), source.size());
+	}
+	std::string command = getValidator() + " -V \"" + input + "\" -o \"" + output + "\" > \"" + logFile + "\" 2>&1";
+#ifdef _WIN32
+	// cmd strips the outer quotes of a command which starts with a quote
+	command = "\"" + command + "\"";
+#endif
+	int status = std::system(command.c_str());
+	log = readFile(logFile);
+	std::string compiled = status == 0 ? readFile(output) : std::string();
+	std::remove(input.c_str());
+	std::remove(output.c_str());
+	std::remove(logFile.c_str());
+	if (compiled.empty())
+	{
+		// the validator reports errors in the source, anything else means it couldn't be run, so it isn't tried again
+		if (log.find("ERROR") == std::string::npos)
+		{
+			compilerAvailable = false;
+		}
+		return false;
+	}
+	code.assign(compiled.begin(), compiled.end());
+	return true;
+#endif
+}
\ No newline at end of file
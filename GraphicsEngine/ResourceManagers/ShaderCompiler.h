@@ -0,0 +1,73 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<cstdint>
+#include"FileView.h"
+
+// Compiles shaders with shaderc linked into the engine. Without it glslangValidator of the Vulkan SDK is run instead.
+#define SHADERC_ENABLED 0
+
+/**
+	Shader compiler class.
+	Compiles GLSL shaders to SPIR-V at runtime, so shaders are used without running Shaders/compile.bat after every change.
+	Compiled code is cached on disk under a hash of the source with its defines, so every variant is compiled only once, also across runs.
+	If runtime compilation is disabled, the compiler isn't available or the source doesn't compile, the code compiled offline is used.
+*/
+class ShaderCompiler
+{
+public:
+	static const uint32_t version = 1;	//*< Version of the cache. Shaders cached with a different version are compiled again.
+	/**
+		Sets whether shaders are compiled from their sources. Needs to be set before pipelines using the shaders are created.
+		@param enabled true to compile shaders at runtime, false to use the code compiled offline.
+	*/
+	static void setEnabled(bool enabled);
+	/**
+		Checks if shaders are compiled from their sources.
+		@return true if shaders are compiled at runtime, false otherwise.
+	*/
+	static bool isEnabled();
+	/**
+		Sets the directory in which compiled shaders are cached. It shouldn't be watched for hot reload, as writing the cache would reload shaders again.
+		@param directory path to the directory, created when the first shader is cached.
+	*/
+	static void setCacheDirectory(const std::string& directory);
+	/**
+		Returns SPIR-V code of a shader.
+		@param source path to the GLSL source of the shader, its extension determines the shader stage.
+		@param binary path to the code compiled offline.
+		@param defines macros defined for the variant of the shader, either "NAME" or "NAME=VALUE".
+		@return view of the code, invalid if neither source nor binary is found.
+		@throws std::runtime_error if the source doesn't compile and there is no code compiled offline.
+	*/
+	static FileView load(const std::string& source, const std::string& binary, const std::vector<std::string>& defines = std::vector<std::string>());
+	/**
+		Checks if a file is a GLSL source of a shader.
+		@param path path to the file.
+		@return true if the extension of the file is one of the shader stages, false otherwise.
+	*/
+	static bool isSource(const std::string& path);
+	/**
+		Checks if a file contains complete SPIR-V code.
+		@param code contents of the file.
+		@return true if the code starts with the SPIR-V magic number and consists of whole words, false otherwise.
+	*/
+	static bool isSpirv(const FileView& code);
+	/**
+		Inserts definitions of macros after the version directive of a source, and resets line numbers so errors refer to the original lines.
+		@param source GLSL source.
+		@param defines macros to define, either "NAME" or "NAME=VALUE".
+		@return source with the macros defined.
+	*/
+	static std::string addDefines(const std::string& source, const std::vector<std::string>& defines);
+private:
+	/**
+		Compiles a GLSL source to SPIR-V.
+		@param source GLSL source with all macros defined.
+		@param name path to the source, used to determine the shader stage and in error messages.
+		@param code filled with the compiled code.
+		@param log filled with errors if the compilation fails.
+		@return true if the source was compiled, false otherwise.
+	*/
+	static bool compile(const std::string& source, const std::string& name, std::vector<char>& code, std::string& log);
+};
\ No newline at end of file
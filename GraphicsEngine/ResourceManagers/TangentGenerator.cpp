@@ -0,0 +1,293 @@
+#include "TangentGenerator.h"
+#include<algorithm>
+#include<cmath>
+#include<thread>
+#include<atomic>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TANGENT_SIMD 1
+#include<emmintrin.h>
+#endif
+
+namespace
+{
+	const size_t minTrianglesPerThread = 16384;	//*< Smallest number of triangles worth a thread of its own.
+	const size_t minVerticesPerThread = 16384;	//*< Smallest number of vertices worth a thread of its own during the reduction.
+	const float minUvArea = 1e-12f;				//*< Triangles whose doubled uv area is smaller than this are considered degenerate.
+	const float minLength = 1e-12f;				//*< Vectors shorter than this can't be normalized.
+	const size_t sumStride = 8;					//*< Number of floats accumulated per vertex, tangent and bitangent padded to four floats each.
+
+	std::atomic<unsigned int> busyHelpers{ 0 };	//*< Number of helper threads currently running, shared by concurrent generations.
+
+	/**
+		Reserves helper threads so concurrent generations together don't run more threads than the hardware has.
+		The calling threads count as running already, so at most one less than the number of hardware threads is handed out.
+		@param wanted number of helper threads requested.
+		@return number of helper threads granted, may be 0.
+	*/
+	unsigned int reserveHelpers(const unsigned int wanted)
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		unsigned int limit = hardware > 1 ? hardware - 1 : 0;
+		unsigned int busy = busyHelpers.load();
+		unsigned int granted;
+		do
+		{
+			granted = std::min(wanted, limit > busy ? limit - busy : 0);
+			if (granted == 0)
+			{
+				return 0;
+			}
+		} while (!busyHelpers.compare_exchange_weak(busy, busy + granted));
+		return granted;
+	}
+	/**
+		Runs a function on ranges of items. Items are split into the given number of ranges, which are taken in turn by the calling thread
+		and the helper threads it could reserve, so the split and the results don't depend on how many helpers were available.
+		@param count number of items.
+		@param ranges number of ranges to split the items into.
+		@param function function called with the index of the range and the first and past the last item of the range.
+	*/
+	template<typename F>
+	void parallelFor(const size_t count, const unsigned int ranges, const F& function)
+	{
+		size_t chunk = (count + ranges - 1) / ranges;
+		std::atomic<unsigned int> next{ 0 };
+		auto work = [&]()
+		{
+			for (unsigned int i = next++; i < ranges; i = next++)
+			{
+				size_t first = std::min(count, chunk * i);
+				function(i, first, std::min(count, first + chunk));
+			}
+		};
+		unsigned int helpers = reserveHelpers(ranges - 1);
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < helpers; i++)
+		{
+			workers.emplace_back(work);
+		}
+		work();
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+		busyHelpers -= helpers;
+	}
+	/**
+		Returns the number of ranges to split the given amount of work into, one per thread if enough helpers are available.
+	*/
+	unsigned int threadCount(const size_t count, const size_t minPerThread, const unsigned int maxThreads)
+	{
+		unsigned int available = maxThreads > 0 ? maxThreads : std::max(1u, std::thread::hardware_concurrency());
+		return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(available, count / minPerThread)));
+	}
+	/**
+		Adds the tangent and bitangent of a triangle to the sums of its vertices.
+	*/
+	void addTriangle(float* sums, const uint32_t* triangle, const float* tangent, const float* bitangent)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			float* sum = sums + triangle[i] * sumStride;
+			sum[0] += tangent[0];
+			sum[1] += tangent[1];
+			sum[2] += tangent[2];
+			sum[4] += bitangent[0];
+			sum[5] += bitangent[1];
+			sum[6] += bitangent[2];
+		}
+	}
+	/**
+		Calculates the tangent and bitangent of a single triangle, scaled by its uv area.
+		Instead of dividing by the uv area, which gives infinities for degenerate uvs, only its sign is applied. Vertices are split on uv seams,
+		so triangles around a vertex have similar uv density and the scaling weighs them roughly by their area.
+		@return false if the triangle has degenerate uvs.
+	*/
+	bool triangleFrame(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2,
+						float* tangent, float* bitangent)
+	{
+		glm::vec3 e1 = p1 - p0;
+		glm::vec3 e2 = p2 - p0;
+		glm::vec2 d1 = uv1 - uv0;
+		glm::vec2 d2 = uv2 - uv0;
+		float uvArea = d1.x * d2.y - d2.x * d1.y;
+		if (std::abs(uvArea) < minUvArea)
+		{
+			return false;
+		}
+		float sign = uvArea < 0.0f ? -1.0f : 1.0f;
+		glm::vec3 s = (e1 * d2.y - e2 * d1.y) * sign;
+		glm::vec3 t = (e2 * d1.x - e1 * d2.x) * sign;
+		tangent[0] = s.x;
+		tangent[1] = s.y;
+		tangent[2] = s.z;
+		bitangent[0] = t.x;
+		bitangent[1] = t.y;
+		bitangent[2] = t.z;
+		return true;
+	}
+#ifdef TANGENT_SIMD
+	/**
+		Loads a position into the first three lanes of a register without reading past its end.
+	*/
+	inline __m128 loadPosition(const glm::vec3& position)
+	{
+		return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&position.x)), _mm_load_ss(&position.z));
+	}
+	/**
+		Loads the uvs of four vertices as a register of u and a register of v coordinates.
+	*/
+	inline void loadUvs(const glm::vec2* uv[4], __m128& u, __m128& v)
+	{
+		__m128 a = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(uv[0])), reinterpret_cast<const __m64*>(uv[1]));
+		__m128 b = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(uv[2])), reinterpret_cast<const __m64*>(uv[3]));
+		u = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+	/**
+		Accumulates tangents and bitangents of four consecutive triangles at once, the same way as triangleFrame.
+		Corners are transposed into registers holding one component of four triangles, and the results are transposed back for accumulation.
+		@param positions positions of the vertices.
+		@param uvs texture coordinates of the vertices.
+		@param triangles indices of four consecutive triangles.
+		@param sums array of sumStride floats per vertex to which the frames are added.
+	*/
+	void accumulateBatch(const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs, const uint32_t* triangles, float* sums)
+	{
+		__m128 p[3][4];
+		__m128 u[3], v[3];
+		for (int j = 0; j < 3; j++)
+		{
+			const glm::vec2* uv[4];
+			for (int i = 0; i < 4; i++)
+			{
+				p[j][i] = loadPosition(positions[triangles[i * 3 + j]]);
+				uv[i] = &uvs[triangles[i * 3 + j]];
+			}
+			_MM_TRANSPOSE4_PS(p[j][0], p[j][1], p[j][2], p[j][3]);
+			loadUvs(uv, u[j], v[j]);
+		}
+		__m128 du1 = _mm_sub_ps(u[1], u[0]);
+		__m128 dv1 = _mm_sub_ps(v[1], v[0]);
+		__m128 du2 = _mm_sub_ps(u[2], u[0]);
+		__m128 dv2 = _mm_sub_ps(v[2], v[0]);
+		__m128 uvArea = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+
+		//sign of the uv area is applied with xor and degenerate triangles are masked out.
+		__m128 signBit = _mm_set1_ps(-0.0f);
+		__m128 sign = _mm_and_ps(uvArea, signBit);
+		__m128 valid = _mm_cmpge_ps(_mm_andnot_ps(signBit, uvArea), _mm_set1_ps(minUvArea));
+		__m128 s[4], t[4];
+		for (int c = 0; c < 3; c++)
+		{
+			__m128 e1 = _mm_sub_ps(p[1][c], p[0][c]);
+			__m128 e2 = _mm_sub_ps(p[2][c], p[0][c]);
+			s[c] = _mm_and_ps(_mm_xor_ps(_mm_sub_ps(_mm_mul_ps(e1, dv2), _mm_mul_ps(e2, dv1)), sign), valid);
+			t[c] = _mm_and_ps(_mm_xor_ps(_mm_sub_ps(_mm_mul_ps(e2, du1), _mm_mul_ps(e1, du2)), sign), valid);
+		}
+		s[3] = _mm_setzero_ps();
+		t[3] = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(s[0], s[1], s[2], s[3]);
+		_MM_TRANSPOSE4_PS(t[0], t[1], t[2], t[3]);
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				float* sum = sums + triangles[i * 3 + j] * sumStride;
+				_mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), s[i]));
+				_mm_storeu_ps(sum + 4, _mm_add_ps(_mm_loadu_ps(sum + 4), t[i]));
+			}
+		}
+	}
+#endif
+	/**
+		Accumulates tangents and bitangents of a range of triangles.
+		@param positions positions of the vertices.
+		@param uvs texture coordinates of the vertices.
+		@param indices indices of a triangle list.
+		@param first first triangle of the range.
+		@param last triangle past the last one of the range.
+		@param sums array of sumStride floats per vertex to which the frames are added.
+	*/
+	void accumulate(const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs, const std::vector<uint32_t>& indices,
+					const size_t first, const size_t last, float* sums)
+	{
+		size_t i = first;
+#ifdef TANGENT_SIMD
+		for (; i + 4 <= last; i += 4)
+		{
+			accumulateBatch(positions, uvs, &indices[i * 3], sums);
+		}
+#endif
+		for (; i < last; i++)
+		{
+			const uint32_t* triangle = &indices[i * 3];
+			float tangent[3];
+			float bitangent[3];
+			if (triangleFrame(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]], uvs[triangle[0]], uvs[triangle[1]], uvs[triangle[2]], tangent, bitangent))
+			{
+				addTriangle(sums, triangle, tangent, bitangent);
+			}
+		}
+	}
+	/**
+		Builds the final tangent of a vertex out of its accumulated tangent and bitangent.
+		@param normal normal of the vertex.
+		@param tangent sum of tangents of vertex's triangles.
+		@param bitangent sum of bitangents of vertex's triangles.
+		@return unit tangent orthogonal to the normal in xyz and handedness in w.
+	*/
+	glm::vec4 orthonormalize(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent)
+	{
+		float normalLength = glm::length(normal);
+		glm::vec3 n = normalLength > minLength ? normal / normalLength : glm::vec3{ 0.0f, 0.0f, 1.0f };
+		//Gram-Schmidt, as in MikkTSpace.
+		glm::vec3 t = tangent - n * glm::dot(n, tangent);
+		if (glm::length(t) < minLength)
+		{
+			//tangent is missing or parallel with the normal, so it is rebuilt from the bitangent or made up.
+			t = glm::cross(bitangent, n);
+			if (glm::length(t) < minLength)
+			{
+				t = glm::cross(n, std::abs(n.x) < 0.9f ? glm::vec3{ 1.0f, 0.0f, 0.0f } : glm::vec3{ 0.0f, 1.0f, 0.0f });
+			}
+		}
+		t = glm::normalize(t);
+		float handedness = glm::dot(glm::cross(n, t), bitangent) < 0.0f ? -1.0f : 1.0f;
+		return glm::vec4{ t, handedness };
+	}
+}
+
+void TangentGenerator::generate(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& uvs,
+								const std::vector<uint32_t>& indices, std::vector<glm::vec4>& tangents, unsigned int maxThreads)
+{
+	size_t vertexCount = positions.size();
+	size_t triangleCount = indices.size() / 3;
+	tangents.resize(vertexCount);
+
+	//every range accumulates into its own buffer so no synchronization is needed.
+	unsigned int ranges = threadCount(triangleCount, minTrianglesPerThread, maxThreads);
+	std::vector<std::vector<float>> sums(ranges);
+	parallelFor(triangleCount, ranges, [&](unsigned int range, size_t first, size_t last)
+	{
+		sums[range].assign(vertexCount * sumStride, 0.0f);
+		accumulate(positions, uvs, indices, first, last, sums[range].data());
+	});
+
+	//reduction of the buffers is split between threads by vertices.
+	parallelFor(vertexCount, threadCount(vertexCount, minVerticesPerThread, maxThreads), [&](unsigned int, size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			float sum[sumStride] = {};
+			for (const std::vector<float>& threadSums : sums)
+			{
+				for (size_t j = 0; j < sumStride; j++)
+				{
+					sum[j] += threadSums[i * sumStride + j];
+				}
+			}
+			tangents[i] = orthonormalize(normals[i], glm::vec3{ sum[0], sum[1], sum[2] }, glm::vec3{ sum[4], sum[5], sum[6] });
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+#include<glm\glm.hpp>
+#include<vector>
+
+/**
+	Tangent generator class.
+	Calculates per vertex tangent frames of indexed triangle meshes for normal mapping. Triangles are processed in SIMD batches by several
+	threads, each accumulating into its own buffer, and the buffers are summed up at the end.
+	Helper threads are shared by all generations, so models loaded concurrently don't start more threads than the hardware has.
+	Tangents are orthonormalized against normals the same way as in MikkTSpace, and the bitangent is replaced by a handedness sign,
+	so bitangent = sign * cross(normal, tangent).
+*/
+class TangentGenerator
+{
+public:
+	/**
+		Generates tangents of a mesh. Triangles with degenerate uvs don't contribute, vertices without any valid triangle get an arbitrary
+		tangent perpendicular to their normal.
+		@param positions positions of the vertices.
+		@param normals normals of the vertices.
+		@param uvs texture coordinates of the vertices.
+		@param indices indices of a triangle list.
+		@param tangents filled with the unit tangent of every vertex in xyz and the handedness sign of its tangent frame in w.
+		@param maxThreads largest number of threads used, 0 to use all hardware threads not used by other generations.
+	*/
+	static void generate(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& uvs,
+						const std::vector<uint32_t>& indices, std::vector<glm::vec4>& tangents, unsigned int maxThreads = 0);
+};
\ No newline at end of file
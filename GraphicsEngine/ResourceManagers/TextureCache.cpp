@@ -0,0 +1,150 @@
+#include "TextureCache.h"
+#include<algorithm>
+#include<cstdio>
+#include<cstring>
+#include<fstream>
+#include"FileSystem.h"
+
+namespace
+{
+	const uint32_t magic = 0x5350494d;	//*< Identifier at the start of every cache file, reads "MIPS".
+
+	/**
+		Header of a cache file.
+	*/
+	struct Header
+	{
+		uint32_t magic;				//*< Identifier of the file format.
+		uint32_t version;			//*< Version of the format.
+		uint64_t sourceSize;		//*< Size of the source file.
+		int64_t sourceTime;			//*< Modification time of the source file.
+		MipChain chain;				//*< Description of the stored chain.
+	};
+
+	/**
+		Returns the size of a single level.
+	*/
+	uint64_t getLevelSize(const MipChain& chain, uint32_t level)
+	{
+		return static_cast<uint64_t>(std::max(chain.width >> level, 1u)) * std::max(chain.height >> level, 1u) * 4;
+	}
+}
+
+std::string TextureCache::getPath(const std::string & source)
+{
+	return source + ".mips";
+}
+
+bool TextureCache::readChain(const std::string & path, const std::string & source, MipChain & chain)
+{
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!FileSystem::getInfo(source, sourceSize, sourceTime))
+	{
+		return false;
+	}
+	FileView view = FileSystem::open(path, sizeof(Header));
+	if (!view.isValid())
+	{
+		return false;
+	}
+	ViewStream file{ view };
+	Header header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != magic || header.version != version ||
+		header.sourceSize != sourceSize || header.sourceTime != sourceTime || header.chain.mipLevels == 0)
+	{
+		return false;
+	}
+	chain = header.chain;
+	return true;
+}
+
+bool TextureCache::readLevels(const std::string & path, const MipChain & chain, uint32_t firstLevel, std::vector<unsigned char>& pixels)
+{
+	// only the coarsest levels are read, the finer ones follow them
+	size_t size = static_cast<size_t>(getSize(chain, firstLevel));
+	FileView view = FileSystem::open(path, sizeof(Header) + size);
+	if (!view.isValid() || view.getSize() != sizeof(Header) + size)
+	{
+		return false;
+	}
+	pixels.assign(view.getData() + sizeof(Header), view.getData() + view.getSize());
+	return true;
+}
+
+void TextureCache::write(const std::string & path, const std::string & source, const MipChain & chain, const std::vector<unsigned char>& pixels)
+{
+	Header header{};
+	if (!FileSystem::getInfo(source, header.sourceSize, header.sourceTime))
+	{
+		return;
+	}
+	header.magic = magic;
+	header.version = version;
+	header.chain = chain;
+	std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+	if (!file.is_open())
+	{
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+	//a partially written file would fail to read its levels, but don't leave it behind.
+	if (!file)
+	{
+		file.close();
+		std::remove(path.c_str());
+	}
+}
+
+void TextureCache::generate(const unsigned char * pixels, uint32_t width, uint32_t height, MipChain & chain, std::vector<unsigned char>& levels)
+{
+	chain.width = width;
+	chain.height = height;
+	chain.mipLevels = 1;
+	while ((std::max(width, height) >> chain.mipLevels) > 0)
+	{
+		chain.mipLevels++;
+	}
+	//levels are built from the finest one, but stored from the coarsest one.
+	levels.resize(static_cast<size_t>(getSize(chain, 0)));
+	size_t offset = levels.size() - static_cast<size_t>(getLevelSize(chain, 0));
+	memcpy(&levels[offset], pixels, static_cast<size_t>(getLevelSize(chain, 0)));
+	for (uint32_t level = 1; level < chain.mipLevels; level++)
+	{
+		uint32_t srcWidth = std::max(width >> (level - 1), 1u);
+		uint32_t srcHeight = std::max(height >> (level - 1), 1u);
+		uint32_t dstWidth = std::max(width >> level, 1u);
+		uint32_t dstHeight = std::max(height >> level, 1u);
+		const unsigned char* src = &levels[offset];
+		offset -= static_cast<size_t>(getLevelSize(chain, level));
+		unsigned char* dst = &levels[offset];
+		for (uint32_t y = 0; y < dstHeight; y++)
+		{
+			//odd sizes and sides of a single pixel repeat their last row or column.
+			uint32_t y0 = std::min(y * 2, srcHeight - 1);
+			uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+			for (uint32_t x = 0; x < dstWidth; x++)
+			{
+				uint32_t x0 = std::min(x * 2, srcWidth - 1);
+				uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					uint32_t sum = src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c] +
+						src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c];
+					dst[(y * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+uint64_t TextureCache::getSize(const MipChain & chain, uint32_t firstLevel)
+{
+	uint64_t size = 0;
+	for (uint32_t level = firstLevel; level < chain.mipLevels; level++)
+	{
+		size += getLevelSize(chain, level);
+	}
+	return size;
+}
\ No newline at end of file
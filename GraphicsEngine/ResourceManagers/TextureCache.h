@@ -0,0 +1,73 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<cstdint>
+
+/**
+	Description of a mip chain stored in the texture cache.
+*/
+struct MipChain
+{
+	uint32_t width{ 0 };		//*< Width of the finest level.
+	uint32_t height{ 0 };		//*< Height of the finest level.
+	uint32_t mipLevels{ 0 };	//*< Number of levels down to a single pixel.
+};
+
+/**
+	Texture cache class.
+	Stores full mip chains of 4 channel textures in binary files next to their source images, so images are decoded and downsampled only once.
+	Levels are stored from the coarsest to the finest one, so any number of the coarsest levels is read with a single read from the start of the data.
+	Cached chain is used only if the size and modification time of the source file match the ones recorded when it was written.
+*/
+class TextureCache
+{
+public:
+	static const uint32_t version = 1;	//*< Version of the cache format. Cached textures with a different version are rebuilt.
+	/**
+		Returns the path of a cache file for a source image.
+		@param source path to the source image.
+		@return path to the cache file.
+	*/
+	static std::string getPath(const std::string& source);
+	/**
+		Reads the description of a cached mip chain.
+		@param path path to the cache file.
+		@param source path to the source image the chain was made from.
+		@param chain structure to which the description is read.
+		@return true if a valid cached chain was found, false if it needs to be rebuilt.
+	*/
+	static bool readChain(const std::string& path, const std::string& source, MipChain& chain);
+	/**
+		Reads the coarsest levels of a cached mip chain.
+		@param path path to the cache file.
+		@param chain description of the chain returned by readChain.
+		@param firstLevel finest level to read, all coarser levels are read as well.
+		@param pixels filled with the levels from the coarsest one to firstLevel.
+		@return true if the levels were read, false otherwise.
+	*/
+	static bool readLevels(const std::string& path, const MipChain& chain, uint32_t firstLevel, std::vector<unsigned char>& pixels);
+	/**
+		Writes a mip chain to the cache. Failures are ignored, the chain is then rebuilt next time.
+		@param path path to the cache file.
+		@param source path to the source image the chain was made from.
+		@param chain description of the chain.
+		@param pixels all levels of the chain from the coarsest to the finest one.
+	*/
+	static void write(const std::string& path, const std::string& source, const MipChain& chain, const std::vector<unsigned char>& pixels);
+	/**
+		Builds a full mip chain of an image with a box filter.
+		@param pixels 4 channel pixels of the image.
+		@param width width of the image.
+		@param height height of the image.
+		@param chain filled with the description of the chain.
+		@param levels filled with all levels of the chain from the coarsest to the finest one.
+	*/
+	static void generate(const unsigned char* pixels, uint32_t width, uint32_t height, MipChain& chain, std::vector<unsigned char>& levels);
+	/**
+		Returns the size of the coarsest levels of a chain.
+		@param chain description of the chain.
+		@param firstLevel finest level included.
+		@return size of the levels from the coarsest one to firstLevel in bytes.
+	*/
+	static uint64_t getSize(const MipChain& chain, uint32_t firstLevel);
+};
\ No newline at end of file
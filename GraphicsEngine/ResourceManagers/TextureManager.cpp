@@ -2,41 +2,121 @@
 #include <stb_image.h>
 #include "TextureManager.h"
 #include "..\Core\GraphicsEngine.h"
+#include"..\DebugTools\Profiler.h"
+#include"FileSystem.h"
+#include<algorithm>
+#include<chrono>
 #ifdef _DEBUG
 #include<iostream>
 #endif
 
+namespace
+{
+	const uint32_t initialStreamSize = 64;		//*< Largest side of the finest level a streamed texture is loaded with.
+	const uint32_t maxPendingStreams = 4;		//*< Largest number of background reads of mip levels at once.
+
+	/**
+		Returns the coarsest level of a chain which is at least a given size.
+		@param chain description of the mip chain.
+		@param pixels size the level should have on its larger side.
+		@return mip level.
+	*/
+	uint32_t selectLevel(const MipChain& chain, float pixels)
+	{
+		uint32_t size = std::max(chain.width, chain.height);
+		uint32_t level = 0;
+		while (level + 1 < chain.mipLevels && static_cast<float>(size >> (level + 1)) >= pixels)
+		{
+			level++;
+		}
+		return level;
+	}
+
+	/**
+		Decodes an image read through the file system into 4 channel pixels.
+		@param filename path to the image.
+		@param width set to the width of the image.
+		@param height set to the height of the image.
+		@return pixels to be freed with stbi_image_free, null if the image is missing or can't be decoded.
+	*/
+	stbi_uc* loadPixels(const std::string& filename, int& width, int& height)
+	{
+		FileView file = FileSystem::open(filename);
+		if (!file.isValid())
+		{
+			return nullptr;
+		}
+		int channels;
+		return stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.getData()), static_cast<int>(file.getSize()), &width, &height, &channels, STBI_rgb_alpha);
+	}
+
+	/**
+		Reads the coarsest levels of the mip chain of a streamed texture, down to the level it is loaded with.
+		The chain is built from the image the first time and cached, later only the coarsest levels are read from the cache.
+		@param filename path to the image.
+		@param path path to the cache file.
+		@param rebuild true to build the chain even if the cached one seems to be up to date.
+		@param chain filled with the description of the chain.
+		@param levels filled with the levels from the coarsest one to the returned one.
+		@return finest level read.
+	*/
+	uint32_t readInitialLevels(const std::string& filename, const std::string& path, bool rebuild, MipChain& chain, std::vector<unsigned char>& levels)
+	{
+		uint32_t initialLevel;
+		if (!rebuild && TextureCache::readChain(path, filename, chain))
+		{
+			initialLevel = selectLevel(chain, static_cast<float>(initialStreamSize));
+			if (!TextureCache::readLevels(path, chain, initialLevel, levels))
+			{
+				throw std::runtime_error("failed to read cached texture levels!");
+			}
+			return initialLevel;
+		}
+		int width, height;
+		stbi_uc* pixels = loadPixels(filename, width, height);
+		if (!pixels)
+		{
+			throw std::runtime_error("failed to load texture image!");
+		}
+		TextureCache::generate(pixels, width, height, chain, levels);
+		stbi_image_free(pixels);
+		TextureCache::write(path, filename, chain, levels);
+		initialLevel = selectLevel(chain, static_cast<float>(initialStreamSize));
+		levels.resize(static_cast<size_t>(TextureCache::getSize(chain, initialLevel)));
+		return initialLevel;
+	}
+}
+
 TextureManager::TextureManager(const GraphicsEngine* engine)
 {
 	this->engine = engine;
 }
 
-std::shared_ptr<VTexture> TextureManager::get(const std::string& filename)
+std::shared_ptr<VTexture> TextureManager::get(const AssetId& texture)
 {
-	std::string name = extractName(filename);
-	std::shared_ptr<VTexture> resource;
-	//Find the resource if it is loaded and return it.
-	resource = find(name);
-	if (resource != nullptr)
-	{
-#ifdef _DEBUG
-		hit++;
-#endif
-		return resource;
-	}
-#ifdef _DEBUG
-	miss++;
-#endif
-	//load and return resource.
-	return load(filename);
+	PROFILE_FUNCTION()
+	//Find the resource if it is loaded or being loaded and return it, load it otherwise.
+	ResourceKey key{ texture.getHash(), 0 };
+	return getOrLoad(key, [&]() { return streaming ? loadStreamed(texture.getPath(), key) : load(texture.getPath()); });
+}
+
+void TextureManager::setStreaming(bool streaming)
+{
+	this->streaming = streaming;
+}
+
+bool TextureManager::isStreaming() const
+{
+	return streaming;
 }
 
 std::shared_ptr<VTexture> TextureManager::load(const std::string& filename)
 {
+	PROFILE_FUNCTION()
 	std::shared_ptr<VTexture> texturePtr;
-	int width, height, channels;
+	int width, height;
 	//Load pixels
-	stbi_uc* pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	stbi_uc* pixels = loadPixels(filename, width, height);
 	if (!pixels)
 	{
 		throw std::runtime_error("failed to load texture image!");
@@ -46,15 +126,247 @@ std::shared_ptr<VTexture> TextureManager::load(const std::string& filename)
 	stbi_image_free(pixels);
 
 	texturePtr = std::make_shared<VTexture>(std::move(tex));
-	//Add texture to collection and return it.
-	add(extractName(filename), texturePtr);
 	return texturePtr;
 }
 
+uint64_t TextureManager::getSize(const VTexture & resource) const
+{
+	// textures are stored as 4 channel, 8 bits per channel images
+	MipChain chain{ resource.getWidth(), resource.getHeight(), resource.getMipLevels() };
+	return TextureCache::getSize(chain, 0);
+}
+
+void TextureManager::release(VTexture & resource)
+{
+	std::lock_guard<std::mutex> lock{ streamMutex };
+	streams.erase(&resource);
+}
+
+std::shared_ptr<VTexture> TextureManager::loadStreamed(const std::string & filename, const ResourceKey & key)
+{
+	PROFILE_FUNCTION()
+	TextureStream stream;
+	stream.key = key;
+	stream.path = TextureCache::getPath(filename);
+	std::vector<unsigned char> levels;
+	stream.initialLevel = readInitialLevels(filename, stream.path, false, stream.chain, levels);
+	stream.residentLevel = stream.initialLevel;
+	stream.pendingLevel = stream.initialLevel;
+	stream.lastRequest = 0;
+	//Create a texture
+	VTexture tex = engine->createMipmappedTexture(levels.data(), std::max(stream.chain.width >> stream.initialLevel, 1u),
+		std::max(stream.chain.height >> stream.initialLevel, 1u), stream.chain.mipLevels - stream.initialLevel);
+
+	std::shared_ptr<VTexture> texturePtr = std::make_shared<VTexture>(std::move(tex));
+	std::lock_guard<std::mutex> streamLock{ streamMutex };
+	streams.emplace(texturePtr.get(), std::move(stream));
+	return texturePtr;
+}
+
+void TextureManager::requestLevels(TextureStream & stream, uint32_t level)
+{
+	std::string path = stream.path;
+	MipChain chain = stream.chain;
+	stream.pendingLevel = level;
+	stream.pending = std::async(std::launch::async, [path, chain, level]()
+	{
+		std::vector<unsigned char> levels;
+		if (!TextureCache::readLevels(path, chain, level, levels))
+		{
+			levels.clear();
+		}
+		return levels;
+	});
+}
+
+void TextureManager::stream()
+{
+	PROFILE_FUNCTION()
+	std::vector<std::pair<ResourceKey, uint64_t>> resized;
+	{
+		std::lock_guard<std::mutex> lock{ streamMutex };
+		frame++;
+		uint32_t pendingCount = 0;
+		for (auto& it : streams)
+		{
+			VTexture& texture = *it.first;
+			TextureStream& stream = it.second;
+			float demand = texture.takeDemand();
+			if (demand > 0.0f)
+			{
+				stream.lastRequest = frame;
+			}
+			// Replace the image once its levels are read, a failed read keeps the current levels
+			if (stream.pendingLevel != stream.residentLevel)
+			{
+				if (stream.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					pendingCount++;
+					continue;
+				}
+				std::vector<unsigned char> levels = stream.pending.get();
+				if (!levels.empty())
+				{
+					texture.replace(engine->createMipmappedTexture(levels.data(), std::max(stream.chain.width >> stream.pendingLevel, 1u),
+						std::max(stream.chain.height >> stream.pendingLevel, 1u), stream.chain.mipLevels - stream.pendingLevel));
+					stream.residentLevel = stream.pendingLevel;
+					resized.push_back(std::make_pair(stream.key, getSize(texture)));
+				}
+				stream.pendingLevel = stream.residentLevel;
+			}
+			if (demand > 0.0f && pendingCount < maxPendingStreams)
+			{
+				uint32_t level = selectLevel(stream.chain, demand);
+				if (level < stream.residentLevel)
+				{
+					requestLevels(stream, level);
+					pendingCount++;
+				}
+			}
+		}
+		// Under memory pressure drop textures which weren't requested this frame back to their initial levels, least recently requested first
+		ResourceStats stats = getStats();
+		if (stats.residentBytes > stats.budget)
+		{
+			std::vector<std::pair<uint64_t, TextureStream*>> candidates;
+			for (auto& it : streams)
+			{
+				TextureStream& stream = it.second;
+				if (stream.lastRequest < frame && stream.residentLevel < stream.initialLevel && stream.pendingLevel == stream.residentLevel)
+				{
+					candidates.push_back(std::make_pair(stream.lastRequest, &stream));
+				}
+			}
+			std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint64_t, TextureStream*>& a, const std::pair<uint64_t, TextureStream*>& b) { return a.first < b.first; });
+			uint64_t excess = stats.residentBytes - stats.budget;
+			for (const auto& candidate : candidates)
+			{
+				if (excess == 0 || pendingCount >= maxPendingStreams)
+				{
+					break;
+				}
+				TextureStream& stream = *candidate.second;
+				uint64_t freed = TextureCache::getSize(stream.chain, stream.residentLevel) - TextureCache::getSize(stream.chain, stream.initialLevel);
+				excess -= std::min(excess, freed);
+				requestLevels(stream, stream.initialLevel);
+				pendingCount++;
+			}
+		}
+	}
+	// Sizes are updated outside of the lock, as they may evict textures
+	for (const auto& texture : resized)
+	{
+		resize(texture.first, texture.second);
+	}
+}
+
+void TextureManager::reload(const std::string & filename)
+{
+	PROFILE_FUNCTION()
+	ResourceKey key{ AssetId::hash(filename.c_str()), 0 };
+	std::shared_ptr<VTexture> texture = find(key);
+	if (!texture)
+	{
+		return;
+	}
+	bool streamed;
+	{
+		std::lock_guard<std::mutex> lock{ streamMutex };
+		streamed = streams.find(texture.get()) != streams.end();
+	}
+	// Only decoding runs in the background, images are created by applyReloads on the thread drawing frames
+	std::future<ReloadedImage> image = std::async(std::launch::async, [filename, streamed]()
+	{
+		ReloadedImage image;
+		try
+		{
+			if (streamed)
+			{
+				// the source may have changed without changing its size and time, so the cached chain is always rebuilt
+				image.firstLevel = readInitialLevels(filename, TextureCache::getPath(filename), true, image.chain, image.pixels);
+				return image;
+			}
+			int width, height;
+			stbi_uc* pixels = loadPixels(filename, width, height);
+			if (!pixels)
+			{
+				return image;
+			}
+			image.chain = MipChain{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 };
+			image.pixels.assign(pixels, pixels + static_cast<size_t>(TextureCache::getSize(image.chain, 0)));
+			stbi_image_free(pixels);
+		}
+		catch (const std::runtime_error&)
+		{
+			image.pixels.clear();
+		}
+		return image;
+	});
+	reloads.push_back(TextureReload{ key, texture, streamed, std::move(image) });
+}
+
+void TextureManager::applyReloads()
+{
+	PROFILE_FUNCTION()
+	std::vector<TextureReload> waiting;
+	std::vector<std::pair<ResourceKey, uint64_t>> resized;
+	for (TextureReload& reload : reloads)
+	{
+		// a later reload of the same texture waits for the earlier one, so the latest version of the file ends up loaded
+		bool blocked = std::any_of(waiting.begin(), waiting.end(), [&reload](const TextureReload& x) { return x.texture == reload.texture; });
+		if (blocked || reload.image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			waiting.push_back(std::move(reload));
+			continue;
+		}
+		ReloadedImage image = reload.image.get();
+		// files are often invalid while they are being saved, the current image is kept until a valid one is written
+		if (image.pixels.empty())
+		{
+			continue;
+		}
+		uint32_t width = std::max(image.chain.width >> image.firstLevel, 1u);
+		uint32_t height = std::max(image.chain.height >> image.firstLevel, 1u);
+		if (reload.streamed)
+		{
+			std::lock_guard<std::mutex> lock{ streamMutex };
+			std::unordered_map<VTexture*, TextureStream>::iterator it = streams.find(reload.texture.get());
+			if (it == streams.end())
+			{
+				continue;
+			}
+			// levels being read belong to the old chain, so they are dropped
+			TextureStream& stream = it->second;
+			if (stream.pending.valid())
+			{
+				stream.pending.wait();
+			}
+			stream.chain = image.chain;
+			stream.initialLevel = image.firstLevel;
+			stream.residentLevel = image.firstLevel;
+			stream.pendingLevel = image.firstLevel;
+			reload.texture->replace(engine->createMipmappedTexture(image.pixels.data(), width, height, image.chain.mipLevels - image.firstLevel));
+		}
+		else
+		{
+			reload.texture->replace(engine->createTexture(image.pixels.data(), width, height));
+		}
+		resized.push_back(std::make_pair(reload.key, getSize(*reload.texture)));
+	}
+	reloads.swap(waiting);
+	// Sizes are updated outside of the lock, as they may evict textures
+	for (const auto& texture : resized)
+	{
+		resize(texture.first, texture.second);
+	}
+}
+
 TextureManager::~TextureManager()
 {
 #ifdef _DEBUG
-	std::cout << "Texture hit: " << hit << std::endl;
-	std::cout << "Texture miss: " << miss << std::endl;
+	ResourceStats stats = getStats();
+	std::cout << "Texture hit: " << stats.hits << std::endl;
+	std::cout << "Texture miss: " << stats.misses << std::endl;
+	std::cout << "Texture evictions: " << stats.evictions << std::endl;
 #endif
 }
@@ -1,11 +1,16 @@
 #pragma once
 #include"ResourceManager.h"
 #include"..\Core\VTexture.h"
+#include"TextureCache.h"
+#include"AssetId.h"
 
 class GraphicsEngine;
 
 /**
 	Resource manager class used for loading and storing textures.
+	In streaming mode textures are loaded with only their coarsest mip levels, so they can be used immediately, and finer levels are read
+	in the background once objects using them are large enough on the screen. Levels of textures which weren't requested recently are
+	dropped again when the textures exceed their budget.
 */
 class TextureManager : public ResourceManager<VTexture>
 {
@@ -16,10 +21,36 @@ public:
 	*/
 	TextureManager(const GraphicsEngine* engine);
 	/**
-		Gets a texture from a collection.
-		@param filename filename of the texture to be fetched.
+		Gets a texture from a collection. Can be called from several threads at once.
+		@param texture id of the texture to be fetched.
 	*/
-	std::shared_ptr<VTexture> get(const std::string& filename);
+	std::shared_ptr<VTexture> get(const AssetId& texture);
+	/**
+		Sets whether textures loaded from now on are streamed.
+		@param streaming true to stream textures, false to load them whole.
+	*/
+	void setStreaming(bool streaming);
+	/**
+		Checks if textures are streamed.
+		@return true if textures are streamed, false otherwise.
+	*/
+	bool isStreaming() const;
+	/**
+		Updates residency of streamed textures based on the sizes they were requested for since the last call.
+		Starts background reads of finer levels, replaces images of textures whose reads finished and drops levels under memory pressure.
+		Needs to be called once a frame when the GPU doesn't use any of the textures, and descriptors of replaced textures rewritten afterwards.
+	*/
+	void stream();
+	/**
+		Starts re-importing a loaded texture in the background after its image file changed. Other files are ignored.
+		@param filename path of the changed file.
+	*/
+	void reload(const std::string& filename);
+	/**
+		Replaces images of textures whose re-import finished. Textures whose files couldn't be read keep their current images.
+		Needs to be called from the same thread as reload, when the GPU doesn't use any of the textures, and descriptors of replaced textures rewritten afterwards.
+	*/
+	void applyReloads();
 	/**
 		Destructor.
 	*/
@@ -30,6 +61,70 @@ protected:
 		@param filename name of the file containing a model.
 	*/
 	std::shared_ptr<VTexture> load(const std::string& filename);
+	/**
+		Returns GPU memory used by a texture.
+		@param resource loaded texture.
+		@return size of the texture in bytes.
+	*/
+	uint64_t getSize(const VTexture& resource) const override;
+	/**
+		Stops streaming of an evicted texture.
+		@param resource evicted texture.
+	*/
+	void release(VTexture& resource) override;
 private:
-	const GraphicsEngine* engine;	//*< pointer to a graphics engine used by a manager.
+	/**
+		Streaming state of a texture.
+	*/
+	struct TextureStream
+	{
+		ResourceKey key;									//*< Key of the texture in the collection.
+		std::string path;									//*< Path to the cached mip chain of the texture.
+		MipChain chain;										//*< Description of the full mip chain.
+		uint32_t residentLevel;								//*< Finest mip level in GPU memory.
+		uint32_t initialLevel;								//*< Finest level loaded up front, streaming never drops below it.
+		uint32_t pendingLevel;								//*< Finest level being read, same as residentLevel if no read is in progress.
+		uint64_t lastRequest;								//*< Frame in which the texture was last requested.
+		std::future<std::vector<unsigned char>> pending;	//*< Levels being read in the background.
+	};
+	/**
+		Image of a texture re-imported in the background.
+	*/
+	struct ReloadedImage
+	{
+		std::vector<unsigned char> pixels;	//*< Pixels of the image, or the coarsest levels of the mip chain of a streamed texture. Empty if the file couldn't be read.
+		MipChain chain;						//*< Description of the mip chain, a single level for textures which aren't streamed.
+		uint32_t firstLevel{ 0 };			//*< Finest level in the pixels.
+	};
+	/**
+		Texture being re-imported.
+	*/
+	struct TextureReload
+	{
+		ResourceKey key;					//*< Key of the texture in the collection.
+		std::shared_ptr<VTexture> texture;	//*< Texture whose image is replaced.
+		bool streamed;						//*< Whether the texture is streamed.
+		std::future<ReloadedImage> image;	//*< Image being imported.
+	};
+
+	/**
+		Loads a texture for streaming with only its coarsest levels.
+		@param filename name of the image file.
+		@param key key of the texture in the collection.
+		@return loaded texture.
+	*/
+	std::shared_ptr<VTexture> loadStreamed(const std::string& filename, const ResourceKey& key);
+	/**
+		Starts a background read of the levels of a streamed texture from its coarsest one to a given level.
+		@param stream streaming state of the texture.
+		@param level finest level to read.
+	*/
+	void requestLevels(TextureStream& stream, uint32_t level);
+
+	const GraphicsEngine* engine;								//*< pointer to a graphics engine used by a manager.
+	std::atomic<bool> streaming{ false };						//*< Whether newly loaded textures are streamed.
+	std::mutex streamMutex;										//*< Mutex guarding the streaming states.
+	std::unordered_map<VTexture*, TextureStream> streams;		//*< Streaming states of streamed textures.
+	uint64_t frame{ 0 };										//*< Number of calls to stream so far.
+	std::vector<TextureReload> reloads;							//*< Textures being re-imported, in the order their files changed.
 };
\ No newline at end of file
@@ -1,17 +1,24 @@
 #include "Camera.h"
 #include "glm\gtx\rotate_vector.hpp"
 #include "..\Core\Constants.h"
+#include <algorithm>
 
-Camera::Camera() : position{ 0,0,0 }, orientation{ -cnst::forwardVector }, upVector{ cnst::upVector }, aspectRatio{ 1.f }, FOV{ 45.f }, nearClipPlane{ 0 }, farClipPlane{ 10.f } {}
+Camera::Camera() : position{ 0,0,0 }, orientation{ -cnst::forwardVector }, upVector{ cnst::upVector }, aspectRatio{ 1.f }, FOV{ 45.f }, nearClipPlane{ 0 }, farClipPlane{ 10.f },
+					version{ 1 }, viewDirty{ true }, projectionDirty{ true } {}
 
 Camera::Camera(const glm::vec3 & position, const glm::vec3 & orientation, const float aspectRatio, const float FOV, const float nearClip, const float farClip)
-	: position{ position }, orientation{ glm::normalize(orientation) }, upVector{ cnst::upVector }, aspectRatio{ aspectRatio }, FOV{ FOV }, nearClipPlane{ nearClip }, farClipPlane{ farClip }{}
+	: position{ position }, orientation{ glm::normalize(orientation) }, upVector{ cnst::upVector }, aspectRatio{ aspectRatio }, FOV{ FOV }, nearClipPlane{ nearClip }, farClipPlane{ farClip },
+	version{ 1 }, viewDirty{ true }, projectionDirty{ true } {}
 
 Camera::Camera(Camera & x) : position{ x.position }, orientation{ x.orientation }, upVector{ x.upVector }, 
-					aspectRatio{ x.aspectRatio }, FOV{ x.FOV }, nearClipPlane{ x.nearClipPlane }, farClipPlane{ x.farClipPlane } {}
+					aspectRatio{ x.aspectRatio }, FOV{ x.FOV }, nearClipPlane{ x.nearClipPlane }, farClipPlane{ x.farClipPlane },
+					version{ x.version }, viewMatrix{ x.viewMatrix }, projectionMatrix{ x.projectionMatrix }, viewProjectionMatrix{ x.viewProjectionMatrix },
+					frustum{ x.frustum }, viewDirty{ x.viewDirty }, projectionDirty{ x.projectionDirty } {}
 
 Camera::Camera(Camera && x) : position{ std::move(x.position) }, orientation{ std::move(x.orientation) }, upVector{ std::move(x.upVector) },
-					aspectRatio{ std::move(x.aspectRatio) }, FOV{ std::move(x.FOV) }, nearClipPlane{ std::move(x.nearClipPlane) }, farClipPlane{ std::move(x.farClipPlane) }{}
+					aspectRatio{ std::move(x.aspectRatio) }, FOV{ std::move(x.FOV) }, nearClipPlane{ std::move(x.nearClipPlane) }, farClipPlane{ std::move(x.farClipPlane) },
+					version{ x.version }, viewMatrix{ x.viewMatrix }, projectionMatrix{ x.projectionMatrix }, viewProjectionMatrix{ x.viewProjectionMatrix },
+					frustum{ x.frustum }, viewDirty{ x.viewDirty }, projectionDirty{ x.projectionDirty } {}
 
 Camera & Camera::operator=(Camera & x)
 {
@@ -24,6 +31,14 @@ Camera & Camera::operator=(Camera & x)
 		FOV = x.FOV;
 		nearClipPlane = x.nearClipPlane;
 		farClipPlane = x.farClipPlane;
+		viewMatrix = x.viewMatrix;
+		projectionMatrix = x.projectionMatrix;
+		viewProjectionMatrix = x.viewProjectionMatrix;
+		frustum = x.frustum;
+		viewDirty = x.viewDirty;
+		projectionDirty = x.projectionDirty;
+		//Camera that is assigned to is a different camera from dependents point of view.
+		version = std::max(version, x.version) + 1;
 	}
 	return *this;
 }
@@ -39,6 +54,14 @@ Camera & Camera::operator=(Camera && x)
 		FOV = std::move(x.FOV);
 		nearClipPlane = std::move(x.nearClipPlane);
 		farClipPlane = std::move(x.farClipPlane);
+		viewMatrix = x.viewMatrix;
+		projectionMatrix = x.projectionMatrix;
+		viewProjectionMatrix = x.viewProjectionMatrix;
+		frustum = x.frustum;
+		viewDirty = x.viewDirty;
+		projectionDirty = x.projectionDirty;
+		//Camera that is assigned to is a different camera from dependents point of view.
+		version = std::max(version, x.version) + 1;
 	}
 	return *this;
 }
@@ -51,6 +74,7 @@ void Camera::move(const glm::vec3 & translation)
 	position += translation.x * rightVector;
 	position += translation.y * upVector;
 	position += translation.z * orientation;
+	viewChanged();
 }
 
 void Camera::rotate(const glm::vec3& axis, const float radians)
@@ -64,6 +88,7 @@ void Camera::rotate(const glm::vec3& axis, const float radians)
 	//rotate the camera
 	orientation = glm::rotate(orientation, radians, rotAxis);
 	upVector = glm::rotate(upVector, radians, rotAxis);
+	viewChanged();
 }
 
 void Camera::zoom(const float units)
@@ -78,33 +103,48 @@ void Camera::zoom(const float units)
 	{
 		FOV = 150.f;
 	}
+	projectionChanged();
 }
 
 void Camera::setAspectRatio(const float ratio)
 {
 	aspectRatio = ratio;
+	projectionChanged();
 }
 
 void Camera::setAspectRatio(const uint32_t width, const uint32_t height)
 {
 	aspectRatio = width / static_cast<float>(height);
+	projectionChanged();
 }
 
 glm::mat4 Camera::getViewMatrix() const
 {
-	//calculate and return view matrix
-	return glm::lookAt(position, position + orientation, upVector); //NOTE maybe store viewMatrix if this is called more often than it is updated
+	updateCache();
+	return viewMatrix;
 }
 
 glm::mat4 Camera::getProjectionMatrix() const
 {
-	//calculate and return projection matrix
-	glm::mat4 proj = glm::perspective(glm::radians(FOV), aspectRatio, nearClipPlane, farClipPlane); //NOTE maybe store matrix if this is called more often than it is updated
-	//GLM was originally designed for OpenGL, where the Y coordinate of the clip coordinates is inverted. 
-	//To compensate for that we flip the sign on the scaling factor of the Y axis in the projection matrix.
-	//If we don't do this, the image will be rendered upside down.
-	proj[1][1] *= -1;
-	return proj;
+	updateCache();
+	return projectionMatrix;
+}
+
+glm::mat4 Camera::getViewProjectionMatrix() const
+{
+	updateCache();
+	return viewProjectionMatrix;
+}
+
+const Frustum & Camera::getFrustum() const
+{
+	updateCache();
+	return frustum;
+}
+
+uint64_t Camera::getVersion() const
+{
+	return version;
 }
 
 glm::vec3 Camera::getPosition() const
@@ -116,3 +156,40 @@ Camera::~Camera()
 {
 }
 
+void Camera::updateCache() const
+{
+	if (!viewDirty && !projectionDirty)
+	{
+		return;
+	}
+	if (viewDirty)
+	{
+		//calculate view matrix
+		viewMatrix = glm::lookAt(position, position + orientation, upVector);
+	}
+	if (projectionDirty)
+	{
+		//calculate projection matrix
+		projectionMatrix = glm::perspective(glm::radians(FOV), aspectRatio, nearClipPlane, farClipPlane);
+		//GLM was originally designed for OpenGL, where the Y coordinate of the clip coordinates is inverted. 
+		//To compensate for that we flip the sign on the scaling factor of the Y axis in the projection matrix.
+		//If we don't do this, the image will be rendered upside down.
+		projectionMatrix[1][1] *= -1;
+	}
+	viewProjectionMatrix = projectionMatrix * viewMatrix;
+	frustum = Frustum{ viewProjectionMatrix };
+	viewDirty = false;
+	projectionDirty = false;
+}
+
+void Camera::viewChanged()
+{
+	viewDirty = true;
+	version++;
+}
+
+void Camera::projectionChanged()
+{
+	projectionDirty = true;
+	version++;
+}
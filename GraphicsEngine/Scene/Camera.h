@@ -1,6 +1,7 @@
 #pragma once
 #include"glm\glm.hpp"
 #include"glm\gtc\matrix_transform.hpp"
+#include"Frustum.h"
 
 /** 
 	A camera class.
@@ -76,6 +77,22 @@ public:
 		@return view transformation matrix.
 	*/
 	glm::mat4 getProjectionMatrix() const;
+	/**
+		Returns the matrix which contains the transformation from world-space to projection-space.
+		@return projection-view transformation matrix.
+	*/
+	glm::mat4 getViewProjectionMatrix() const;
+	/**
+		Returns the frustum representing the volume seen by the camera in world-space.
+		@return camera's frustum.
+	*/
+	const Frustum& getFrustum() const;
+	/**
+		Returns camera's version. Version changes every time the camera is moved, rotated, zoomed or its aspect ratio is set.
+		Dependents can store the version and skip their work if the version didn't change.
+		@return camera's version.
+	*/
+	uint64_t getVersion() const;
 	/**
 		Returns the current position of the camera.
 		@return position of the camera.
@@ -86,6 +103,18 @@ public:
 	*/
 	~Camera();
 private:
+	/**
+		Recalculates cached matrices and frustum that are out of date.
+	*/
+	void updateCache() const;
+	/**
+		Marks view dependent data as out of date and changes the version.
+	*/
+	void viewChanged();
+	/**
+		Marks projection dependent data as out of date and changes the version.
+	*/
+	void projectionChanged();
 	glm::vec3 position;		//*< A three dimensional vector variable used to store the position of the camera.
 	glm::vec3 orientation;	//*< A three dimensional vector variable used to store the orientation of the camera. Vector is normalized.
 	glm::vec3 upVector;		//*< A three dimensional vector variable used to store camera's up vector. Vector is normalized.
@@ -93,4 +122,11 @@ private:
 	float FOV;				//*< Float variable used to store camera's field of vision expressed in degrees. Value will always be in interval of [0.1, 150] degrees.
 	float nearClipPlane;	//*< Float variable used to store camera's near clipping plane.
 	float farClipPlane;		//*< Float variable used to store camera's far clipping plane.
+	uint64_t version;		//*< Camera's version. Increased every time camera changes.
+	mutable glm::mat4 viewMatrix;			//*< Cached view matrix.
+	mutable glm::mat4 projectionMatrix;		//*< Cached projection matrix.
+	mutable glm::mat4 viewProjectionMatrix;	//*< Cached projection-view matrix.
+	mutable Frustum frustum;				//*< Cached camera's frustum.
+	mutable bool viewDirty;					//*< Flag determining if the view matrix needs to be recalculated.
+	mutable bool projectionDirty;			//*< Flag determining if the projection matrix needs to be recalculated.
 };
\ No newline at end of file
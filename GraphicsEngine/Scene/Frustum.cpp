@@ -0,0 +1,78 @@
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+	for (int i = 0; i < eCount; i++)
+	{
+		planes[i] = glm::vec4{ 0, 0, 0, 1 };
+	}
+}
+
+Frustum::Frustum(const glm::mat4& projectionView)
+{
+	//glm matrices are column major so we first extract the rows of the matrix.
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4{ projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i] };
+	}
+	//Each plane is a sum or a difference of the last row and one of the other rows.
+	planes[eLeft] = rows[3] + rows[0];
+	planes[eRight] = rows[3] - rows[0];
+	planes[eBottom] = rows[3] + rows[1];
+	planes[eTop] = rows[3] - rows[1];
+	planes[eNear] = rows[3] + rows[2];
+	planes[eFar] = rows[3] - rows[2];
+	//Normalize the planes so distances can be compared with radiuses.
+	for (int i = 0; i < eCount; i++)
+	{
+		planes[i] /= glm::length(glm::vec3{ planes[i] });
+	}
+}
+
+bool Frustum::intersectsSphere(const glm::vec3 & center, const float radius) const
+{
+	for (int i = 0; i < eCount; i++)
+	{
+		if (glm::dot(glm::vec3{ planes[i] }, center) + planes[i].w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::intersectsBox(const glm::vec3 & min, const glm::vec3 & max) const
+{
+	for (int i = 0; i < eCount; i++)
+	{
+		//Take the corner of the box which is the furthest along plane's normal.
+		//If that corner is behind the plane, whole box is.
+		glm::vec3 corner{ planes[i].x >= 0 ? max.x : min.x, planes[i].y >= 0 ? max.y : min.y, planes[i].z >= 0 ? max.z : min.z };
+		if (glm::dot(glm::vec3{ planes[i] }, corner) + planes[i].w < 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::containsBox(const glm::vec3 & min, const glm::vec3 & max) const
+{
+	for (int i = 0; i < eCount; i++)
+	{
+		//Take the corner of the box which is the furthest against plane's normal.
+		//If that corner is behind the plane, part of the box is outside.
+		glm::vec3 corner{ planes[i].x >= 0 ? min.x : max.x, planes[i].y >= 0 ? min.y : max.y, planes[i].z >= 0 ? min.z : max.z };
+		if (glm::dot(glm::vec3{ planes[i] }, corner) + planes[i].w < 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const glm::vec4 & Frustum::getPlane(const Plane plane) const
+{
+	return planes[plane];
+}
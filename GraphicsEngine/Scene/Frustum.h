@@ -0,0 +1,64 @@
+#pragma once
+#include"glm\glm.hpp"
+
+/**
+	Frustum class.
+	Represents the volume visible by a camera as six planes extracted from a projection-view matrix.
+	Plane normals point towards the inside of the volume.
+*/
+class Frustum
+{
+public:
+	/**
+		Enumerator used to index frustum planes.
+	*/
+	enum Plane
+	{
+		eLeft = 0,	//*< Left clipping plane.
+		eRight,		//*< Right clipping plane.
+		eBottom,	//*< Bottom clipping plane.
+		eTop,		//*< Top clipping plane.
+		eNear,		//*< Near clipping plane.
+		eFar,		//*< Far clipping plane.
+		eCount		//*< Number of planes.
+	};
+	/**
+		Constructor.
+		Creates a frustum that contains everything.
+	*/
+	Frustum();
+	/**
+		Constructor.
+		@param projectionView projection-view matrix out of which the planes are extracted.
+	*/
+	Frustum(const glm::mat4& projectionView);
+	/**
+		Checks if a sphere is at least partially inside the frustum.
+		@param center center of the sphere.
+		@param radius radius of the sphere.
+		@return true if sphere intersects the frustum, false otherwise.
+	*/
+	bool intersectsSphere(const glm::vec3& center, const float radius) const;
+	/**
+		Checks if an axis aligned box is at least partially inside the frustum.
+		@param min corner of the box with the smallest coordinates.
+		@param max corner of the box with the largest coordinates.
+		@return true if box intersects the frustum, false otherwise.
+	*/
+	bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+	/**
+		Checks if an axis aligned box is completely inside the frustum.
+		@param min corner of the box with the smallest coordinates.
+		@param max corner of the box with the largest coordinates.
+		@return true if whole box is inside the frustum, false otherwise.
+	*/
+	bool containsBox(const glm::vec3& min, const glm::vec3& max) const;
+	/**
+		Returns a frustum plane.
+		@param plane enumerator of the plane we want to get.
+		@return plane stored as (normal, distance) where normal is normalized.
+	*/
+	const glm::vec4& getPlane(const Plane plane) const;
+private:
+	glm::vec4 planes[eCount];	//*< Array of planes stored as (normal, distance).
+};
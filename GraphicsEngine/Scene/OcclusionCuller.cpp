@@ -0,0 +1,234 @@
+#include "OcclusionCuller.h"
+#include<algorithm>
+#include<cmath>
+#include<limits>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SIMD 1
+#include<emmintrin.h>
+#endif
+
+namespace
+{
+	const float minW = 1e-4f;	//*< Smallest clip space w a vertex may have before it is considered to be behind the near plane.
+}
+
+OcclusionCuller::OcclusionCuller() : viewProjection{ 1.0f }
+{
+	int w = width;
+	int h = height;
+	levels.push_back(std::vector<float>(w * h, 1.0f));
+	while (w > 1 || h > 1)
+	{
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+		levels.push_back(std::vector<float>(w * h, 1.0f));
+	}
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4 & viewProjection)
+{
+	this->viewProjection = viewProjection;
+	std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+	triangles = 0;
+}
+
+void OcclusionCuller::addOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const glm::mat4 & model)
+{
+	glm::mat4 mvp = viewProjection * model;
+	std::vector<glm::vec4> clip(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		clip[i] = mvp * glm::vec4{ positions[i], 1.0f };
+	}
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const glm::vec4& c0 = clip[indices[i]];
+		const glm::vec4& c1 = clip[indices[i + 1]];
+		const glm::vec4& c2 = clip[indices[i + 2]];
+		//skipping a triangle only makes the occluder smaller, so there is no need to clip against the near plane.
+		if (c0.w < minW || c1.w < minW || c2.w < minW)
+		{
+			continue;
+		}
+		glm::vec3 screen[3];
+		const glm::vec4* corners[] = { &c0, &c1, &c2 };
+		for (int j = 0; j < 3; j++)
+		{
+			glm::vec3 ndc = glm::vec3{ *corners[j] } / corners[j]->w;
+			screen[j] = glm::vec3{ (ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z };
+		}
+		rasteriseTriangle(screen[0], screen[1], screen[2]);
+	}
+}
+
+void OcclusionCuller::buildPyramid()
+{
+	int w = width;
+	int h = height;
+	for (size_t level = 1; level < levels.size(); level++)
+	{
+		const std::vector<float>& previous = levels[level - 1];
+		int pw = w;
+		int ph = h;
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+		std::vector<float>& current = levels[level];
+		for (int y = 0; y < h; y++)
+		{
+			int y0 = std::min(2 * y, ph - 1);
+			int y1 = std::min(2 * y + 1, ph - 1);
+			for (int x = 0; x < w; x++)
+			{
+				int x0 = std::min(2 * x, pw - 1);
+				int x1 = std::min(2 * x + 1, pw - 1);
+				current[y * w + x] = std::max(std::max(previous[y0 * pw + x0], previous[y0 * pw + x1]), std::max(previous[y1 * pw + x0], previous[y1 * pw + x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::isVisible(const glm::vec3 & min, const glm::vec3 & max, const glm::mat4 & model) const
+{
+	glm::mat4 mvp = viewProjection * model;
+	glm::vec2 screenMin{ std::numeric_limits<float>::max() };
+	glm::vec2 screenMax{ -std::numeric_limits<float>::max() };
+	float nearest = std::numeric_limits<float>::max();
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner{ i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f };
+		glm::vec4 clip = mvp * corner;
+		//box crossing the near plane surrounds the camera so it can't be hidden.
+		if (clip.w < minW)
+		{
+			return true;
+		}
+		glm::vec3 ndc = glm::vec3{ clip } / clip.w;
+		glm::vec2 screen{ (ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height };
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		nearest = std::min(nearest, ndc.z);
+	}
+	//boxes outside of the screen are handled by frustum culling.
+	if (screenMax.x < 0 || screenMax.y < 0 || screenMin.x >= width || screenMin.y >= height)
+	{
+		return true;
+	}
+	int x0 = std::max(0, static_cast<int>(screenMin.x));
+	int y0 = std::max(0, static_cast<int>(screenMin.y));
+	int x1 = std::min(width - 1, static_cast<int>(screenMax.x));
+	int y1 = std::min(height - 1, static_cast<int>(screenMax.y));
+	//pick the level at which the box covers at most a few texels.
+	size_t level = 0;
+	int size = std::max(x1 - x0, y1 - y0);
+	while (size > 2 && level + 1 < levels.size())
+	{
+		size /= 2;
+		level++;
+	}
+	int w = std::max(1, width >> level);
+	int h = std::max(1, height >> level);
+	const std::vector<float>& depth = levels[level];
+	for (int y = std::min(y0 >> level, h - 1); y <= std::min(y1 >> level, h - 1); y++)
+	{
+		for (int x = std::min(x0 >> level, w - 1); x <= std::min(x1 >> level, w - 1); x++)
+		{
+			if (nearest <= depth[y * w + x])
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+uint32_t OcclusionCuller::getTriangleCount() const
+{
+	return triangles;
+}
+
+void OcclusionCuller::rasteriseTriangle(const glm::vec3 & v0, const glm::vec3 & v1, const glm::vec3 & v2)
+{
+	glm::vec3 a = v0;
+	glm::vec3 b = v1;
+	glm::vec3 c = v2;
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (std::abs(area) < 1e-6f)
+	{
+		return;
+	}
+	//occluders are rasterised regardless of their facing.
+	if (area < 0)
+	{
+		std::swap(b, c);
+	}
+	float depth = std::max(a.z, std::max(b.z, c.z));
+	if (depth >= 1.0f)
+	{
+		return;
+	}
+	int minX = std::max(0, static_cast<int>(std::floor(std::min(a.x, std::min(b.x, c.x)))));
+	int maxX = std::min(width - 1, static_cast<int>(std::ceil(std::max(a.x, std::max(b.x, c.x)))));
+	int minY = std::max(0, static_cast<int>(std::floor(std::min(a.y, std::min(b.y, c.y)))));
+	int maxY = std::min(height - 1, static_cast<int>(std::ceil(std::max(a.y, std::max(b.y, c.y)))));
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+	triangles++;
+	//start at a multiple of 4 so 4 pixels can be processed at once.
+	minX &= ~3;
+
+	//edge functions are linear in x and y: e(x, y) = ex * x + ey * y + e0.
+	const glm::vec3* edges[3][2] = { { &b, &c }, { &c, &a }, { &a, &b } };
+	float ex[3], ey[3], e0[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec3& from = *edges[i][0];
+		const glm::vec3& to = *edges[i][1];
+		ex[i] = from.y - to.y;
+		ey[i] = to.x - from.x;
+		e0[i] = -(ex[i] * from.x + ey[i] * from.y);
+	}
+
+	std::vector<float>& buffer = levels[0];
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = y + 0.5f;
+		float* row = &buffer[y * width];
+#ifdef OCCLUSION_SIMD
+		__m128 depthValue = _mm_set1_ps(depth);
+		__m128 zero = _mm_setzero_ps();
+		__m128 edge[3];
+		__m128 step[3];
+		for (int i = 0; i < 3; i++)
+		{
+			float start = ex[i] * (minX + 0.5f) + ey[i] * py + e0[i];
+			edge[i] = _mm_setr_ps(start, start + ex[i], start + 2 * ex[i], start + 3 * ex[i]);
+			step[i] = _mm_set1_ps(4 * ex[i]);
+		}
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0], zero), _mm_cmpge_ps(edge[1], zero)), _mm_cmpge_ps(edge[2], zero));
+			if (_mm_movemask_ps(inside) != 0)
+			{
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 closer = _mm_min_ps(old, depthValue);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, old)));
+			}
+			for (int i = 0; i < 3; i++)
+			{
+				edge[i] = _mm_add_ps(edge[i], step[i]);
+			}
+		}
+#else
+		for (int x = minX; x <= maxX; x++)
+		{
+			float px = x + 0.5f;
+			if (ex[0] * px + ey[0] * py + e0[0] >= 0 && ex[1] * px + ey[1] * py + e0[1] >= 0 && ex[2] * px + ey[2] * py + e0[2] >= 0)
+			{
+				row[x] = std::min(row[x], depth);
+			}
+		}
+#endif
+	}
+}
\ No newline at end of file
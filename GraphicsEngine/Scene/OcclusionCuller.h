@@ -0,0 +1,59 @@
+#pragma once
+#include<glm\glm.hpp>
+#include<vector>
+
+/**
+	Software occlusion culler.
+	Rasterises designated occluders into a small depth buffer on the CPU, builds a hierarchical depth pyramid out of it
+	and tests object bounding boxes against the pyramid. Depth is stored in normalized device coordinates.
+*/
+class OcclusionCuller
+{
+public:
+	static const int width = 256;	//*< Width of the depth buffer in pixels. Needs to be a multiple of 4 and a power of two.
+	static const int height = 128;	//*< Height of the depth buffer in pixels. Needs to be a power of two.
+	/**
+		Constructor.
+	*/
+	OcclusionCuller();
+	/**
+		Clears the depth buffer and sets the transformation used for the frame.
+		@param viewProjection projection-view matrix of the camera.
+	*/
+	void beginFrame(const glm::mat4& viewProjection);
+	/**
+		Rasterises an occluder into the depth buffer. Triangles crossing the near plane are skipped.
+		@param positions model space positions of occluder's vertices.
+		@param indices indices of occluder's triangles.
+		@param model model transformation of the occluder.
+	*/
+	void addOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const glm::mat4& model);
+	/**
+		Builds the depth pyramid. Needs to be called after all occluders are added and before testing visibility.
+	*/
+	void buildPyramid();
+	/**
+		Checks if a box could be visible, that is if it's not completely behind occluders.
+		@param min corner of the model space box with the smallest coordinates.
+		@param max corner of the model space box with the largest coordinates.
+		@param model model transformation of the box.
+		@return false if box is hidden by occluders, true otherwise.
+	*/
+	bool isVisible(const glm::vec3& min, const glm::vec3& max, const glm::mat4& model) const;
+	/**
+		Returns the number of occluder triangles rasterised this frame.
+		@return number of triangles.
+	*/
+	uint32_t getTriangleCount() const;
+private:
+	/**
+		Rasterises a single triangle given in screen space. Triangle is written with its farthest depth so the result stays conservative.
+		@param v0 first vertex as (x, y, depth).
+		@param v1 second vertex as (x, y, depth).
+		@param v2 third vertex as (x, y, depth).
+	*/
+	void rasteriseTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+	glm::mat4 viewProjection;				//*< Projection-view matrix of the current frame.
+	std::vector<std::vector<float>> levels;	//*< Depth pyramid. First level is the depth buffer, every next one holds the farthest depth of 2x2 texels of the previous one.
+	uint32_t triangles{ 0 };				//*< Number of triangles rasterised this frame.
+};
\ No newline at end of file
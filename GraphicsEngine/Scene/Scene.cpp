@@ -2,13 +2,44 @@
 #include"glm\gtc\matrix_transform.hpp"
 #include"..\Core\GraphicsEngine.h"
 #include<queue>
+#include"..\DebugTools\Profiler.h"
+#include"..\Graphics\GraphicsComponent.h"
+#include"..\Core\VModel.h"
+#include"..\Core\PipelineVariant.h"
+#include<algorithm>
 
 const float cameraSpeed = 1.f;		//*< Camera's movement speed.
 const float cameraRotation = 1.f;	//*< Camera's rotation speed.
 const float cameraZoom = 10.f;		//*< Camera's zoom speed.
 
-Scene::Scene(Scene && x) : id{ std::move(x.id) }, engine{ std::move(x.engine) }, window{ x.window }, camera{ x.camera },
-							buffers{ std::move(x.buffers) }, lights{ std::move(x.lights) }, items{ std::move(x.items) } 
+namespace
+{
+	const float lodScreenSizes[] = { 0.25f, 0.1f, 0.04f };	//*< Projected radius relative to screen height below which the next coarser level of detail is used.
+	const float lodHysteresis = 0.15f;						//*< Relative margin by which projected size needs to cross a threshold to switch the level of detail.
+
+	/**
+		Calculates the world space bounding box of a component out of its model's bounds and its transformation.
+		@param component component whose bounds to calculate.
+		@param min corner of the box with the smallest coordinates.
+		@param max corner of the box with the largest coordinates.
+	*/
+	void worldBounds(const GraphicsComponent& component, glm::vec3& min, glm::vec3& max)
+	{
+		const VModel& model = component.getModel();
+		const glm::mat4& transform = component.getTransform();
+		glm::vec3 center = glm::vec3{ transform * glm::vec4{ (model.boundsMin + model.boundsMax) * 0.5f, 1.0f } };
+		glm::vec3 extent = (model.boundsMax - model.boundsMin) * 0.5f;
+		//each world axis extent is the sum of transformed model axis extents projected onto it.
+		glm::vec3 worldExtent = glm::abs(glm::vec3{ transform[0] }) * extent.x + glm::abs(glm::vec3{ transform[1] }) * extent.y + glm::abs(glm::vec3{ transform[2] }) * extent.z;
+		min = center - worldExtent;
+		max = center + worldExtent;
+	}
+}
+
+Scene::Scene(Scene && x) : id{ std::move(x.id) }, engine{ std::move(x.engine) }, window{ x.window }, camera{ x.camera }, uploadedCameraVersion{ x.uploadedCameraVersion },
+							buffers{ std::move(x.buffers) }, lights{ std::move(x.lights) }, items{ std::move(x.items) },
+							occlusion{ std::move(x.occlusion) }, occlusionCulling{ x.occlusionCulling }, cullingStats{ x.cullingStats },
+							spatialIndex{ std::move(x.spatialIndex) }, indexed{ std::move(x.indexed) }, visibleComponents{ std::move(x.visibleComponents) }
 {
 	x.id = -1;
 	x.engine = nullptr;
@@ -22,9 +53,16 @@ Scene & Scene::operator=(Scene && x)
 		engine = std::move(x.engine);
 		window = x.window;
 		camera = x.camera;
+		uploadedCameraVersion = x.uploadedCameraVersion;
 		buffers = std::move(x.buffers);
 		lights = std::move(x.lights);
 		items = std::move(x.items);
+		occlusion = std::move(x.occlusion);
+		occlusionCulling = x.occlusionCulling;
+		cullingStats = x.cullingStats;
+		spatialIndex = std::move(x.spatialIndex);
+		indexed = std::move(x.indexed);
+		visibleComponents = std::move(x.visibleComponents);
 
 		engine = nullptr;
 		x.id = -1;
@@ -61,6 +99,7 @@ Result Scene::addItem(GameObject * item)
 		if (go->hasGraphics())
 		{
 			engine->attachObject(id, go->getId());
+			index(go);
 		}
 		queue.pop();
 	}
@@ -96,6 +135,7 @@ Result Scene::removeItem(GameObject * item)
 		}
 		if (go->hasGraphics())
 		{
+			unindex(go);
 			engine->detachObject(id, go->getId());
 		}
 		queue.pop();
@@ -113,65 +153,253 @@ void Scene::addLight(const glm::vec3 origin)
 
 void Scene::update(const double time)
 {
-	//handle camera movement and rotation.
-	int state = glfwGetKey(window, GLFW_KEY_W);
-	if (state == GLFW_PRESS)
+	PROFILE_FUNCTION()
+	//handle camera movement and rotation. There is no input when rendering without a window.
+	if (window != nullptr)
 	{
-		camera.move(glm::vec3{ 0,0,(float)time * cameraSpeed });
+		int state = glfwGetKey(window, GLFW_KEY_W);
+		if (state == GLFW_PRESS)
+		{
+			camera.move(glm::vec3{ 0,0,(float)time * cameraSpeed });
+		}
+		state = glfwGetKey(window, GLFW_KEY_S);
+		if (state == GLFW_PRESS)
+		{
+			camera.move(glm::vec3{ 0,0,(float)time * -cameraSpeed });
+		}
+		state = glfwGetKey(window, GLFW_KEY_A);
+		if (state == GLFW_PRESS)
+		{
+			camera.move(glm::vec3{ (float)time * -cameraSpeed, 0, 0 });
+		}
+		state = glfwGetKey(window, GLFW_KEY_D);
+		if (state == GLFW_PRESS)
+		{
+			camera.move(glm::vec3{ (float)time * cameraSpeed, 0, 0 });
+		}
+		state = glfwGetKey(window, GLFW_KEY_E);
+		if (state == GLFW_PRESS)
+		{
+			camera.rotate(glm::vec3{ 0,1,0 }, (float)time * -cameraRotation);
+		}
+		state = glfwGetKey(window, GLFW_KEY_Q);
+		if (state == GLFW_PRESS)
+		{
+			camera.rotate(glm::vec3{ 0,1,0 }, (float)time * cameraRotation);
+		}
+		state = glfwGetKey(window, GLFW_KEY_R);
+		if (state == GLFW_PRESS)
+		{
+			camera.rotate(glm::vec3{ 1,0,0 }, (float)time * cameraRotation);
+		}
+		state = glfwGetKey(window, GLFW_KEY_F);
+		if (state == GLFW_PRESS)
+		{
+			camera.rotate(glm::vec3{ 1,0,0 }, (float)time * -cameraRotation);
+		}
+		state = glfwGetKey(window, GLFW_KEY_KP_SUBTRACT);
+		if (state == GLFW_PRESS)
+		{
+			camera.zoom((float)time * cameraZoom);
+		}
+		state = glfwGetKey(window, GLFW_KEY_KP_ADD);
+		if (state == GLFW_PRESS)
+		{
+			camera.zoom((float)time * -cameraZoom);
+		}
 	}
-	state = glfwGetKey(window, GLFW_KEY_S);
-	if (state == GLFW_PRESS)
+	//upload camera data only if camera changed since the last upload.
+	if (camera.getVersion() != uploadedCameraVersion)
 	{
-		camera.move(glm::vec3{ 0,0,(float)time * -cameraSpeed });
+		buffers.transform.updateBuffer(camera.getViewProjectionMatrix());
+		buffers.camera.updateBuffer(camera.getPosition());
+		uploadedCameraVersion = camera.getVersion();
 	}
-	state = glfwGetKey(window, GLFW_KEY_A);
-	if (state == GLFW_PRESS)
+	for (GameObject* object : items)
 	{
-		camera.move(glm::vec3{ (float)time * -cameraSpeed, 0, 0 });
+		object->update(time);
 	}
-	state = glfwGetKey(window, GLFW_KEY_D);
-	if (state == GLFW_PRESS)
+	cull();
+}
+
+void Scene::cull()
+{
+	PROFILE_FUNCTION()
+	cullingStats = CullingStats{};
+	//refit objects whose transformation changed since the last pass.
+	for (GameObject* object : indexed)
 	{
-		camera.move(glm::vec3{ (float)time * cameraSpeed, 0, 0 });
+		GraphicsComponent& component = *object->getGraphics();
+		if (component.moved)
+		{
+			glm::vec3 min, max;
+			worldBounds(component, min, max);
+			spatialIndex.update(component.proxy, min, max);
+			component.moved = false;
+		}
 	}
-	state = glfwGetKey(window, GLFW_KEY_E);
-	if (state == GLFW_PRESS)
+	//frustum culling. Only components visible in the last pass need to be hidden again.
+	for (GraphicsComponent* component : visibleComponents)
 	{
-		camera.rotate(glm::vec3{ 0,1,0 }, (float)time * -cameraRotation);
+		component->visible = false;
 	}
-	state = glfwGetKey(window, GLFW_KEY_Q);
-	if (state == GLFW_PRESS)
+	visibleComponents.clear();
+	queryResult.clear();
+	spatialIndex.queryFrustum(camera.getFrustum(), queryResult);
+	glm::vec3 cameraPosition = camera.getPosition();
+	//projected size of a sphere is its radius divided by distance, scaled by the projection.
+	float projectionScale = std::abs(camera.getProjectionMatrix()[1][1]);
+	for (GameObject* object : queryResult)
 	{
-		camera.rotate(glm::vec3{ 0,1,0 }, (float)time * cameraRotation);
+		GraphicsComponent* component = object->getGraphics().get();
+		component->visible = true;
+		selectLod(*component, cameraPosition, projectionScale);
+		visibleComponents.push_back(component);
 	}
-	state = glfwGetKey(window, GLFW_KEY_R);
-	if (state == GLFW_PRESS)
+	cullingStats.tested = spatialIndex.getCount();
+	cullingStats.frustumCulled = cullingStats.tested - static_cast<uint32_t>(visibleComponents.size());
+	if (occlusionCulling)
 	{
-		camera.rotate(glm::vec3{ 1,0,0 }, (float)time * cameraRotation);
+		occlude();
 	}
-	state = glfwGetKey(window, GLFW_KEY_F);
-	if (state == GLFW_PRESS)
+	for (GraphicsComponent* component : visibleComponents)
 	{
-		camera.rotate(glm::vec3{ 1,0,0 }, (float)time * -cameraRotation);
+		if (component->visible)
+		{
+			cullingStats.lods[std::min(component->lod, maxLodStats - 1)]++;
+			cullingStats.triangles += component->model->getLod(component->lod).indexCount / 3;
+		}
 	}
-	state = glfwGetKey(window, GLFW_KEY_KP_SUBTRACT);
-	if (state == GLFW_PRESS)
+}
+
+void Scene::occlude()
+{
+	//rasterise occluders and test the remaining components against them.
+	occlusion.beginFrame(camera.getViewProjectionMatrix());
+	for (GraphicsComponent* component : visibleComponents)
 	{
-		camera.zoom((float)time * cameraZoom);
+		if (component->occluder)
+		{
+			occlusion.addOccluder(component->model->positions, component->model->indices, component->transform);
+			cullingStats.occluders++;
+		}
 	}
-	state = glfwGetKey(window, GLFW_KEY_KP_ADD);
-	if (state == GLFW_PRESS)
+	cullingStats.occluderTriangles = occlusion.getTriangleCount();
+	if (cullingStats.occluders == 0)
 	{
-		camera.zoom((float)time * -cameraZoom);
+		return;
 	}
-	buffers.transform.updateBuffer(camera.getProjectionMatrix() * camera.getViewMatrix());
-	buffers.camera.updateBuffer(camera.getPosition());
-	for (GameObject* object : items)
+	occlusion.buildPyramid();
+	for (GraphicsComponent* component : visibleComponents)
 	{
-		object->update(time);
+		//occluders would hide themselves.
+		if (component->occluder)
+		{
+			continue;
+		}
+		if (!occlusion.isVisible(component->model->boundsMin, component->model->boundsMax, component->transform))
+		{
+			component->visible = false;
+			cullingStats.occlusionCulled++;
+		}
 	}
 }
 
+void Scene::selectLod(GraphicsComponent & component, const glm::vec3 & cameraPosition, const float projectionScale) const
+{
+	const VModel& model = *component.model;
+	glm::vec3 min, max;
+	worldBounds(component, min, max);
+	float radius = glm::length(max - min) * 0.5f;
+	float distance = glm::length((min + max) * 0.5f - cameraPosition);
+	//camera inside of the bounds always gets the full model.
+	float size = distance > radius ? radius * projectionScale / distance : 1.0f;
+	//projected radius in normalized device coordinates is also the projected diameter relative to the screen height.
+	component.coverage = size;
+	if (model.lods.size() < 2)
+	{
+		component.lod = 0;
+		return;
+	}
+	uint32_t levels = std::min(static_cast<uint32_t>(model.lods.size()), static_cast<uint32_t>(sizeof(lodScreenSizes) / sizeof(lodScreenSizes[0])) + 1);
+	uint32_t lod = std::min(component.lod, levels - 1);
+	//switching needs the size to cross the threshold by a margin, so objects near a threshold don't flicker between levels.
+	while (lod + 1 < levels && size < lodScreenSizes[lod] * (1.0f - lodHysteresis))
+	{
+		lod++;
+	}
+	while (lod > 0 && size > lodScreenSizes[lod - 1] * (1.0f + lodHysteresis))
+	{
+		lod--;
+	}
+	component.lod = lod;
+}
+
+void Scene::index(GameObject * object)
+{
+	GraphicsComponent& component = *object->getGraphics();
+	//skybox and 2D overlays are always drawn.
+	if (component.drawType == PipelineType::eSkybox || component.drawType == PipelineType::eOrthoTextured)
+	{
+		component.visible = true;
+		return;
+	}
+	glm::vec3 min, max;
+	worldBounds(component, min, max);
+	component.proxy = spatialIndex.insert(object, min, max);
+	component.moved = true;
+	indexed.push_back(object);
+	//component stays visible until the first culling pass decides otherwise.
+	component.visible = true;
+	visibleComponents.push_back(&component);
+}
+
+void Scene::unindex(GameObject * object)
+{
+	GraphicsComponent& component = *object->getGraphics();
+	if (component.proxy == -1)
+	{
+		return;
+	}
+	spatialIndex.remove(component.proxy);
+	component.proxy = -1;
+	component.visible = true;
+	indexed.erase(std::find(indexed.begin(), indexed.end(), object));
+	auto it = std::find(visibleComponents.begin(), visibleComponents.end(), &component);
+	if (it != visibleComponents.end())
+	{
+		visibleComponents.erase(it);
+	}
+}
+
+void Scene::queryBox(const glm::vec3 & min, const glm::vec3 & max, std::vector<GameObject*>& result) const
+{
+	spatialIndex.queryBox(min, max, result);
+}
+
+void Scene::querySphere(const glm::vec3 & center, const float radius, std::vector<GameObject*>& result) const
+{
+	spatialIndex.querySphere(center, radius, result);
+}
+
+GameObject * Scene::raycast(const glm::vec3 & origin, const glm::vec3 & direction, float & distance) const
+{
+	return spatialIndex.raycast(origin, direction, distance);
+}
+
+GameObject * Scene::pick(const float x, const float y) const
+{
+	//unproject points on the near and far plane under the cursor.
+	glm::mat4 inverse = glm::inverse(camera.getViewProjectionMatrix());
+	glm::vec2 ndc{ x * 2.0f - 1.0f, y * 2.0f - 1.0f };
+	glm::vec4 nearPoint = inverse * glm::vec4{ ndc, -1.0f, 1.0f };
+	glm::vec4 farPoint = inverse * glm::vec4{ ndc, 1.0f, 1.0f };
+	glm::vec3 origin = glm::vec3{ nearPoint } / nearPoint.w;
+	glm::vec3 direction = glm::vec3{ farPoint } / farPoint.w - origin;
+	float distance = 1.0f;
+	return spatialIndex.raycast(origin, direction, distance);
+}
+
 uint32_t Scene::getId() const
 {
 	return id;
@@ -187,6 +415,36 @@ glm::vec3 Scene::getCameraPosition() const
 	return camera.getPosition();
 }
 
+uint64_t Scene::getCameraVersion() const
+{
+	return camera.getVersion();
+}
+
+const Frustum & Scene::getCameraFrustum() const
+{
+	return camera.getFrustum();
+}
+
+uint32_t Scene::getSpatialIndexHeight() const
+{
+	return static_cast<uint32_t>(spatialIndex.getHeight());
+}
+
+const CullingStats & Scene::getCullingStats() const
+{
+	return cullingStats;
+}
+
+void Scene::setOcclusionCulling(const bool enabled)
+{
+	occlusionCulling = enabled;
+}
+
+void Scene::setPipelineVariant(const PipelineVariant & variant)
+{
+	engine->setPipelineVariant(id, variant);
+}
+
 Scene::~Scene()
 {
 	if (id != -1)
@@ -195,6 +453,11 @@ Scene::~Scene()
 		{
 			item->setSceneId(-1);
 		}
+		for (GameObject* object : indexed)
+		{
+			object->getGraphics()->proxy = -1;
+			object->getGraphics()->visible = true;
+		}
 		engine->deRegisterScene(id);
 	}
 }
@@ -3,9 +3,29 @@
 #include"..\Graphics\GameObject.h"
 #include<GLFW\glfw3.h>
 #include"Camera.h"
+#include"OcclusionCuller.h"
+#include"SpatialIndex.h"
 #include"..\Graphics\GlobalBuffers.h"
 #include"..\DebugTools\Result.h"
 
+class PipelineVariant;
+
+const uint32_t maxLodStats = 4;	//*< Number of levels of detail counted by culling statistics. Coarser levels are counted with the last one.
+
+/**
+	Results of the last culling pass of a scene.
+*/
+struct CullingStats
+{
+	uint32_t tested{ 0 };				//*< Number of components tested for visibility.
+	uint32_t frustumCulled{ 0 };		//*< Number of components outside of the camera's frustum.
+	uint32_t occlusionCulled{ 0 };		//*< Number of components hidden behind occluders.
+	uint32_t occluders{ 0 };			//*< Number of occluders rasterised.
+	uint32_t occluderTriangles{ 0 };	//*< Number of occluder triangles rasterised.
+	uint32_t lods[maxLodStats]{};		//*< Number of drawn components per level of detail.
+	uint64_t triangles{ 0 };			//*< Number of triangles of drawn components.
+};
+
 /**
 	Class that represents a scene.
 */
@@ -72,17 +92,111 @@ public:
 		@return position of the camera.
 	*/
 	glm::vec3 getCameraPosition() const;
+	/**
+		Returns the version of the scene's camera.
+		Version changes every time camera is moved, rotated or its projection changes.
+		@return version of the camera.
+	*/
+	uint64_t getCameraVersion() const;
+	/**
+		Returns the frustum of the scene's camera.
+		@return frustum of the camera.
+	*/
+	const Frustum& getCameraFrustum() const;
+	/**
+		Returns the results of the last culling pass.
+		@return culling statistics.
+	*/
+	const CullingStats& getCullingStats() const;
+	/**
+		Enables or disables occlusion culling. Frustum culling is always performed.
+		@param enabled true if objects hidden behind occluders should not be drawn, false otherwise.
+	*/
+	void setOcclusionCulling(const bool enabled);
+	/**
+		Sets the variant of a pipeline with which the scene's objects are drawn, so their quality can be traded for speed.
+		The base pipeline is used until the variant is created in the background.
+		@param variant variant of a pipeline type, a variant without constants restores the base pipeline.
+	*/
+	void setPipelineVariant(const PipelineVariant& variant);
+	/**
+		Finds objects whose world space bounding box intersects a box. Bounds are those of the last update.
+		@param min corner of the box with the smallest coordinates.
+		@param max corner of the box with the largest coordinates.
+		@param result array to which found objects are appended.
+	*/
+	void queryBox(const glm::vec3& min, const glm::vec3& max, std::vector<GameObject*>& result) const;
+	/**
+		Finds objects whose world space bounding box intersects a sphere. Bounds are those of the last update.
+		@param center center of the sphere.
+		@param radius radius of the sphere.
+		@param result array to which found objects are appended.
+	*/
+	void querySphere(const glm::vec3& center, const float radius, std::vector<GameObject*>& result) const;
+	/**
+		Finds the first object whose world space bounding box is hit by a ray. Bounds are those of the last update.
+		@param origin origin of the ray.
+		@param direction direction of the ray.
+		@param distance maximum distance along the ray in units of direction. Set to the distance of the hit if an object is found.
+		@return pointer to the hit object, nullptr if no object is hit.
+	*/
+	GameObject* raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+	/**
+		Finds the first object under a point of the window.
+		@param x horizontal position in the window, 0 being the left and 1 the right edge.
+		@param y vertical position in the window, 0 being the top and 1 the bottom edge.
+		@return pointer to the picked object, nullptr if there is no object under the point.
+	*/
+	GameObject* pick(const float x, const float y) const;
+	/**
+		Returns the height of the scene's spatial index.
+		@return height of the spatial index.
+	*/
+	uint32_t getSpatialIndexHeight() const;
 	/**
 		Destructor.
 	*/
 	virtual ~Scene();
 	friend class SceneFactory;
 protected:
+	/**
+		Decides which components are drawn. Components outside of the camera's frustum or hidden behind occluders are hidden.
+	*/
+	void cull();
+	/**
+		Hides components which passed frustum culling but are hidden behind occluders.
+	*/
+	void occlude();
+	/**
+		Chooses component's level of detail out of its projected size, and records the size for texture streaming.
+		@param component component whose level to choose.
+		@param cameraPosition position of the camera.
+		@param projectionScale scale of the projection along the vertical axis.
+	*/
+	void selectLod(GraphicsComponent& component, const glm::vec3& cameraPosition, const float projectionScale) const;
+	/**
+		Adds object's graphics component to the spatial index.
+		@param object object with graphics.
+	*/
+	void index(GameObject* object);
+	/**
+		Removes object's graphics component from the spatial index.
+		@param object object with graphics.
+	*/
+	void unindex(GameObject* object);
 	uint32_t id;							//*< Scene's id assigned by the engine.
 	GraphicsEngine* engine;			//*< Pointer to a graphics engine.
 	GLFWwindow* window;				//*< Window in which the scene is rendered.
 	Camera camera;					//*< Scene's camera.
+	uint64_t uploadedCameraVersion{ 0 };	//*< Version of the camera whose data is currently stored in global buffers.
 	GlobalBuffers buffers;			//*< Buffers which hold global data that are common to all objects.
 	std::vector<glm::vec3> lights;	//*< Array of 3D vector variables. Contains sources of point light in the scene.
 	std::vector<GameObject*> items;	//*< Array of pointers to GameObject objects. Contains all items contained in a scene.
+	OcclusionCuller occlusion;		//*< Software rasteriser used for occlusion culling.
+	bool occlusionCulling{ true };	//*< Flag determining if occlusion culling is performed.
+	CullingStats cullingStats;		//*< Results of the last culling pass.
+	SpatialIndex spatialIndex;		//*< Bounding volume hierarchy over all culled components of the scene.
+	std::vector<GameObject*> indexed;	//*< Objects whose components are in the spatial index.
+	std::vector<GraphicsComponent*> visibleComponents;	//*< Components which passed frustum culling in the last pass.
+	std::vector<GameObject*> queryResult;	//*< Scratch array reused by culling queries.
 };
\ No newline at end of file
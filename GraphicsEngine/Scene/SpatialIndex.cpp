@@ -0,0 +1,463 @@
+#include "SpatialIndex.h"
+#include<algorithm>
+#include"..\DebugTools\Assert.h"
+
+namespace
+{
+	const float relativeMargin = 0.1f;	//*< Part of box's size by which leaf boxes are enlarged on every side.
+	const float absoluteMargin = 0.05f;	//*< Distance by which leaf boxes are enlarged on every side regardless of their size.
+	const float prediction = 4.0f;		//*< Number of updates worth of movement by which reinserted leaf boxes are extended in the direction of movement.
+
+	/**
+		Calculates the surface area of a box.
+	*/
+	float surface(const glm::vec3& min, const glm::vec3& max)
+	{
+		glm::vec3 d = max - min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+	/**
+		Checks if two boxes overlap.
+	*/
+	bool overlaps(const glm::vec3& min1, const glm::vec3& max1, const glm::vec3& min2, const glm::vec3& max2)
+	{
+		return min1.x <= max2.x && min2.x <= max1.x && min1.y <= max2.y && min2.y <= max1.y && min1.z <= max2.z && min2.z <= max1.z;
+	}
+	/**
+		Checks if a box overlaps a sphere.
+	*/
+	bool overlapsSphere(const glm::vec3& min, const glm::vec3& max, const glm::vec3& center, const float radius)
+	{
+		glm::vec3 closest = glm::clamp(center, min, max);
+		glm::vec3 d = closest - center;
+		return glm::dot(d, d) <= radius * radius;
+	}
+	/**
+		Intersects a ray with a box.
+		@return distance at which the ray enters the box, or a negative value if the ray misses it within maxDistance.
+	*/
+	float intersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverse, const float maxDistance)
+	{
+		glm::vec3 t1 = (min - origin) * inverse;
+		glm::vec3 t2 = (max - origin) * inverse;
+		glm::vec3 tMin = glm::min(t1, t2);
+		glm::vec3 tMax = glm::max(t1, t2);
+		float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+		return enter <= exit ? enter : -1.0f;
+	}
+}
+
+int32_t SpatialIndex::insert(GameObject * object, const glm::vec3 & min, const glm::vec3 & max)
+{
+	int32_t leaf = allocateNode();
+	Node& node = nodes[leaf];
+	glm::vec3 margin = (max - min) * relativeMargin + absoluteMargin;
+	node.tightMin = min;
+	node.tightMax = max;
+	node.min = min - margin;
+	node.max = max + margin;
+	node.object = object;
+	node.height = 0;
+	insertLeaf(leaf);
+	count++;
+	return leaf;
+}
+
+bool SpatialIndex::update(const int32_t proxy, const glm::vec3 & min, const glm::vec3 & max)
+{
+	ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(nodes.size()) && nodes[proxy].isLeaf())
+	Node& node = nodes[proxy];
+	glm::vec3 displacement = ((min + max) - (node.tightMin + node.tightMax)) * (0.5f * prediction);
+	node.tightMin = min;
+	node.tightMax = max;
+	if (glm::all(glm::lessThanEqual(node.min, min)) && glm::all(glm::lessThanEqual(max, node.max)))
+	{
+		return false;
+	}
+	removeLeaf(proxy);
+	//objects keep moving in the same direction, so the box is extended ahead of them.
+	glm::vec3 margin = (max - min) * relativeMargin + absoluteMargin;
+	nodes[proxy].min = min - margin + glm::min(displacement, glm::vec3{ 0.0f });
+	nodes[proxy].max = max + margin + glm::max(displacement, glm::vec3{ 0.0f });
+	insertLeaf(proxy);
+	return true;
+}
+
+void SpatialIndex::remove(const int32_t proxy)
+{
+	ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(nodes.size()) && nodes[proxy].isLeaf())
+	removeLeaf(proxy);
+	freeNode(proxy);
+	count--;
+}
+
+void SpatialIndex::queryFrustum(const Frustum & frustum, std::vector<GameObject*>& result) const
+{
+	if (root == nullNode)
+	{
+		return;
+	}
+	std::vector<int32_t> stack{ root };
+	std::vector<int32_t> subtree;
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		int32_t index = stack.back();
+		stack.pop_back();
+		if (!frustum.intersectsBox(node.min, node.max))
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			if (frustum.intersectsBox(node.tightMin, node.tightMax))
+			{
+				result.push_back(node.object);
+			}
+		}
+		//subtrees completely inside the frustum don't need any further tests.
+		else if (frustum.containsBox(node.min, node.max))
+		{
+			collect(index, result, subtree);
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+void SpatialIndex::querySphere(const glm::vec3 & center, const float radius, std::vector<GameObject*>& result) const
+{
+	if (root == nullNode)
+	{
+		return;
+	}
+	std::vector<int32_t> stack{ root };
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		if (!overlapsSphere(node.min, node.max, center, radius))
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			if (overlapsSphere(node.tightMin, node.tightMax, center, radius))
+			{
+				result.push_back(node.object);
+			}
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+void SpatialIndex::queryBox(const glm::vec3 & min, const glm::vec3 & max, std::vector<GameObject*>& result) const
+{
+	if (root == nullNode)
+	{
+		return;
+	}
+	std::vector<int32_t> stack{ root };
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		if (!overlaps(node.min, node.max, min, max))
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			if (overlaps(node.tightMin, node.tightMax, min, max))
+			{
+				result.push_back(node.object);
+			}
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+GameObject * SpatialIndex::raycast(const glm::vec3 & origin, const glm::vec3 & direction, float & distance) const
+{
+	if (root == nullNode)
+	{
+		return nullptr;
+	}
+	glm::vec3 inverse = 1.0f / direction;
+	GameObject* hit = nullptr;
+	std::vector<int32_t> stack{ root };
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		//distance shrinks with every hit so subtrees behind the closest hit are skipped.
+		if (intersectRay(node.min, node.max, origin, inverse, distance) < 0)
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			float t = intersectRay(node.tightMin, node.tightMax, origin, inverse, distance);
+			if (t >= 0)
+			{
+				distance = t;
+				hit = node.object;
+			}
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+	return hit;
+}
+
+uint32_t SpatialIndex::getCount() const
+{
+	return count;
+}
+
+int32_t SpatialIndex::getHeight() const
+{
+	return root == nullNode ? 0 : nodes[root].height;
+}
+
+int32_t SpatialIndex::allocateNode()
+{
+	int32_t index;
+	if (freeList != nullNode)
+	{
+		index = freeList;
+		freeList = nodes[index].parent;
+	}
+	else
+	{
+		index = static_cast<int32_t>(nodes.size());
+		nodes.push_back(Node{});
+	}
+	Node& node = nodes[index];
+	node.parent = nullNode;
+	node.child1 = nullNode;
+	node.child2 = nullNode;
+	node.height = 0;
+	node.object = nullptr;
+	return index;
+}
+
+void SpatialIndex::freeNode(const int32_t node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	nodes[node].object = nullptr;
+	freeList = node;
+}
+
+void SpatialIndex::insertLeaf(const int32_t leaf)
+{
+	if (root == nullNode)
+	{
+		root = leaf;
+		nodes[root].parent = nullNode;
+		return;
+	}
+	glm::vec3 leafMin = nodes[leaf].min;
+	glm::vec3 leafMax = nodes[leaf].max;
+	//descend towards the sibling whose box grows the least, measured by surface area.
+	int32_t index = root;
+	while (!nodes[index].isLeaf())
+	{
+		const Node& node = nodes[index];
+		float area = surface(node.min, node.max);
+		float combined = surface(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+		//cost of creating a new parent for this node and the leaf.
+		float cost = 2.0f * combined;
+		//cost of pushing the leaf further down the tree.
+		float inheritance = 2.0f * (combined - area);
+		float childCost[2];
+		int32_t children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = nodes[children[i]];
+			float enlarged = surface(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+			childCost[i] = (child.isLeaf() ? enlarged : enlarged - surface(child.min, child.max)) + inheritance;
+		}
+		if (cost < childCost[0] && cost < childCost[1])
+		{
+			break;
+		}
+		index = childCost[0] < childCost[1] ? children[0] : children[1];
+	}
+	int32_t sibling = index;
+	int32_t oldParent = nodes[sibling].parent;
+	int32_t newParent = allocateNode();
+	Node& parent = nodes[newParent];
+	parent.parent = oldParent;
+	parent.min = glm::min(nodes[sibling].min, leafMin);
+	parent.max = glm::max(nodes[sibling].max, leafMax);
+	parent.height = nodes[sibling].height + 1;
+	parent.child1 = sibling;
+	parent.child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+	if (oldParent != nullNode)
+	{
+		if (nodes[oldParent].child1 == sibling)
+		{
+			nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			nodes[oldParent].child2 = newParent;
+		}
+	}
+	else
+	{
+		root = newParent;
+	}
+	refit(nodes[leaf].parent);
+}
+
+void SpatialIndex::removeLeaf(const int32_t leaf)
+{
+	if (leaf == root)
+	{
+		root = nullNode;
+		return;
+	}
+	int32_t parent = nodes[leaf].parent;
+	int32_t grandParent = nodes[parent].parent;
+	int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+	//sibling takes the place of the parent.
+	if (grandParent != nullNode)
+	{
+		if (nodes[grandParent].child1 == parent)
+		{
+			nodes[grandParent].child1 = sibling;
+		}
+		else
+		{
+			nodes[grandParent].child2 = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		freeNode(parent);
+		refit(grandParent);
+	}
+	else
+	{
+		root = sibling;
+		nodes[sibling].parent = nullNode;
+		freeNode(parent);
+	}
+	nodes[leaf].parent = nullNode;
+}
+
+void SpatialIndex::refit(int32_t node)
+{
+	while (node != nullNode)
+	{
+		node = balance(node);
+		Node& current = nodes[node];
+		const Node& child1 = nodes[current.child1];
+		const Node& child2 = nodes[current.child2];
+		current.height = 1 + std::max(child1.height, child2.height);
+		current.min = glm::min(child1.min, child2.min);
+		current.max = glm::max(child1.max, child2.max);
+		node = current.parent;
+	}
+}
+
+int32_t SpatialIndex::balance(const int32_t a)
+{
+	if (nodes[a].isLeaf() || nodes[a].height < 2)
+	{
+		return a;
+	}
+	int32_t b = nodes[a].child1;
+	int32_t c = nodes[a].child2;
+	int32_t difference = nodes[c].height - nodes[b].height;
+	if (difference >= -1 && difference <= 1)
+	{
+		return a;
+	}
+	//promote the higher child, its higher child stays under it and the other one takes its place under a.
+	int32_t up = difference > 1 ? c : b;
+	int32_t down = difference > 1 ? b : c;
+	int32_t f = nodes[up].child1;
+	int32_t g = nodes[up].child2;
+
+	nodes[up].child1 = a;
+	nodes[up].parent = nodes[a].parent;
+	nodes[a].parent = up;
+	if (nodes[up].parent != nullNode)
+	{
+		Node& parent = nodes[nodes[up].parent];
+		if (parent.child1 == a)
+		{
+			parent.child1 = up;
+		}
+		else
+		{
+			parent.child2 = up;
+		}
+	}
+	else
+	{
+		root = up;
+	}
+
+	int32_t keep = nodes[f].height > nodes[g].height ? f : g;
+	int32_t move = keep == f ? g : f;
+	nodes[up].child2 = keep;
+	if (up == c)
+	{
+		nodes[a].child2 = move;
+	}
+	else
+	{
+		nodes[a].child1 = move;
+	}
+	nodes[move].parent = a;
+
+	Node& lower = nodes[a];
+	lower.min = glm::min(nodes[down].min, nodes[move].min);
+	lower.max = glm::max(nodes[down].max, nodes[move].max);
+	lower.height = 1 + std::max(nodes[down].height, nodes[move].height);
+	Node& upper = nodes[up];
+	upper.min = glm::min(lower.min, nodes[keep].min);
+	upper.max = glm::max(lower.max, nodes[keep].max);
+	upper.height = 1 + std::max(lower.height, nodes[keep].height);
+	return up;
+}
+
+void SpatialIndex::collect(const int32_t node, std::vector<GameObject*>& result, std::vector<int32_t>& stack) const
+{
+	stack.clear();
+	stack.push_back(node);
+	while (!stack.empty())
+	{
+		const Node& current = nodes[stack.back()];
+		stack.pop_back();
+		if (current.isLeaf())
+		{
+			result.push_back(current.object);
+		}
+		else
+		{
+			stack.push_back(current.child1);
+			stack.push_back(current.child2);
+		}
+	}
+}
\ No newline at end of file
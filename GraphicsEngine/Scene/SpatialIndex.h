@@ -0,0 +1,143 @@
+#pragma once
+#include<glm\glm.hpp>
+#include<vector>
+#include"Frustum.h"
+
+class GameObject;
+
+/**
+	Spatial index over scene objects.
+	Dynamic bounding volume hierarchy whose leaves hold enlarged boxes of objects, so objects moving within their enlarged box
+	only update their tight box and the tree is restructured only when an object leaves it. Tree is kept balanced with rotations.
+*/
+class SpatialIndex
+{
+public:
+	static const int32_t nullNode = -1;	//*< Index used for missing nodes.
+	/**
+		Constructor.
+	*/
+	SpatialIndex() {}
+	/**
+		Inserts an object into the index.
+		@param object object to insert.
+		@param min corner of object's world space bounding box with the smallest coordinates.
+		@param max corner of object's world space bounding box with the largest coordinates.
+		@return proxy identifying the object in the index.
+	*/
+	int32_t insert(GameObject* object, const glm::vec3& min, const glm::vec3& max);
+	/**
+		Updates bounds of an object. Object is reinserted only if its new bounds leave the enlarged box.
+		@param proxy proxy of the object returned by insert.
+		@param min corner of object's world space bounding box with the smallest coordinates.
+		@param max corner of object's world space bounding box with the largest coordinates.
+		@return true if object was reinserted, false if only its box was refitted.
+	*/
+	bool update(const int32_t proxy, const glm::vec3& min, const glm::vec3& max);
+	/**
+		Removes an object from the index.
+		@param proxy proxy of the object returned by insert.
+	*/
+	void remove(const int32_t proxy);
+	/**
+		Finds objects whose bounding box intersects the frustum.
+		@param frustum frustum to test against.
+		@param result array to which found objects are appended.
+	*/
+	void queryFrustum(const Frustum& frustum, std::vector<GameObject*>& result) const;
+	/**
+		Finds objects whose bounding box intersects a sphere.
+		@param center center of the sphere.
+		@param radius radius of the sphere.
+		@param result array to which found objects are appended.
+	*/
+	void querySphere(const glm::vec3& center, const float radius, std::vector<GameObject*>& result) const;
+	/**
+		Finds objects whose bounding box intersects a box.
+		@param min corner of the box with the smallest coordinates.
+		@param max corner of the box with the largest coordinates.
+		@param result array to which found objects are appended.
+	*/
+	void queryBox(const glm::vec3& min, const glm::vec3& max, std::vector<GameObject*>& result) const;
+	/**
+		Finds the first object whose bounding box is hit by a ray.
+		@param origin origin of the ray.
+		@param direction direction of the ray, doesn't need to be normalized.
+		@param distance maximum distance along the ray in units of direction. Set to the distance of the hit if an object is found.
+		@return pointer to the hit object, nullptr if no object is hit.
+	*/
+	GameObject* raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+	/**
+		Returns the number of objects in the index.
+		@return number of objects.
+	*/
+	uint32_t getCount() const;
+	/**
+		Returns the height of the tree.
+		@return height of the tree, 0 if tree is empty or holds a single object.
+	*/
+	int32_t getHeight() const;
+private:
+	/**
+		Tree node. Leaf nodes hold an object, inner nodes always have two children.
+	*/
+	struct Node
+	{
+		glm::vec3 min;				//*< Corner of the node's box with the smallest coordinates. Enlarged for leaves.
+		glm::vec3 max;				//*< Corner of the node's box with the largest coordinates. Enlarged for leaves.
+		glm::vec3 tightMin;			//*< Corner of the object's box with the smallest coordinates. Used only by leaves.
+		glm::vec3 tightMax;			//*< Corner of the object's box with the largest coordinates. Used only by leaves.
+		int32_t parent;				//*< Index of the parent node or of the next free node if node is not used.
+		int32_t child1;				//*< Index of the first child, nullNode for leaves.
+		int32_t child2;				//*< Index of the second child, nullNode for leaves.
+		int32_t height;				//*< Height of the node's subtree. 0 for leaves, -1 for unused nodes.
+		GameObject* object;			//*< Object held by a leaf.
+		/**
+			Checks if node is a leaf.
+			@return true if node is a leaf, false otherwise.
+		*/
+		bool isLeaf() const { return child1 == nullNode; }
+	};
+	/**
+		Takes a node from the free list or creates a new one.
+		@return index of the node.
+	*/
+	int32_t allocateNode();
+	/**
+		Returns a node to the free list.
+		@param node index of the node.
+	*/
+	void freeNode(const int32_t node);
+	/**
+		Inserts a leaf into the tree next to the sibling whose enlargement costs the least.
+		@param leaf index of the leaf.
+	*/
+	void insertLeaf(const int32_t leaf);
+	/**
+		Removes a leaf from the tree. Leaf node itself stays allocated.
+		@param leaf index of the leaf.
+	*/
+	void removeLeaf(const int32_t leaf);
+	/**
+		Recomputes boxes and heights from a node up to the root, balancing the tree on the way.
+		@param node index of the first node to fix.
+	*/
+	void refit(int32_t node);
+	/**
+		Rotates a node's subtree if its children heights differ by more than one.
+		@param node index of the node.
+		@return index of the node which took node's place.
+	*/
+	int32_t balance(const int32_t node);
+	/**
+		Appends all objects from a subtree.
+		@param node index of the subtree's root.
+		@param result array to which objects are appended.
+		@param stack scratch stack used for traversal.
+	*/
+	void collect(const int32_t node, std::vector<GameObject*>& result, std::vector<int32_t>& stack) const;
+	std::vector<Node> nodes;		//*< Array of all nodes, including unused ones.
+	int32_t root{ nullNode };		//*< Index of the root node.
+	int32_t freeList{ nullNode };	//*< Index of the first unused node.
+	uint32_t count{ 0 };			//*< Number of objects in the index.
+};
\ No newline at end of file
@@ -11,6 +11,8 @@ layout(location = 3) in vec3 halfVector_tangentSpace;
 
 layout(location = 0) out vec4 outColor;
 
+layout(constant_id = 4) const float shininess = 5.0;
+
 void main() {
 	vec3 LightColor = vec3(1.0,1.0,1.0);
 	float LightPower = 40.0;
@@ -32,7 +34,7 @@ void main() {
 	vec3 color = 
 		MaterialAmbientColor +
 		MaterialDiffuseColor * LightColor * cosNL +
-		MaterialSpecularColor * LightColor * pow(cosHN,5);
+		MaterialSpecularColor * LightColor * pow(cosHN, shininess);
 
 	outColor = vec4(color, 1.0);
 }
\ No newline at end of file
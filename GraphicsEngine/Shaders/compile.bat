@@ -9,4 +9,8 @@ C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V simpleColored.frag -o simple
 C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V simpleTextured.frag -o simpleTexturedF.spv
 C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V bumpMapPhong.frag -o bumpMapPhongF.spv
 C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V parallaxPhong.frag -o parallaxPhongF.spv
+C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V simpleIndirect.vert -o simpleIndirectV.spv
+C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V lightIndirect.vert -o lightIndirectV.spv
+C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V tangentSpaceIndirect.vert -o tangentSpaceIndirectV.spv
+C:/VulkanSDK/1.0.26.0/Bin32/glslangValidator.exe -V cull.comp -o cullC.spv
 pause
\ No newline at end of file
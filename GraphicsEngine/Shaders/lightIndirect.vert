@@ -0,0 +1,46 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+	mat4 pv;
+} ubo;
+
+layout(set = 0, binding = 1) uniform UniformLightObject {
+	vec3 position;
+} light;
+
+layout(set = 2, binding = 0) readonly buffer ObjectTransforms {
+	mat4 transforms[];
+};
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inUv;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec2 outUv;
+layout(location = 2) out vec3 outViewVec;
+layout(location = 3) out vec3 outLightVec;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+//decodes a direction stored with octahedral mapping.
+vec3 decodeOctahedral(vec2 encoded) {
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += direction.x >= 0.0 ? -fold : fold;
+	direction.y += direction.y >= 0.0 ? -fold : fold;
+	return normalize(direction);
+}
+
+void main() {
+	mat4 model = transforms[gl_InstanceIndex];
+	outUv = inUv;
+	vec4 position_worldSpace = model * vec4(inPosition.xyz, 1.0);
+	gl_Position = ubo.pv * position_worldSpace;
+	outNormal = mat3(model) * decodeOctahedral(inNormal);
+	outLightVec = light.position - position_worldSpace.xyz;
+	outViewVec = - position_worldSpace.xyz;
+}
\ No newline at end of file
@@ -13,8 +13,8 @@ layout(set = 1, binding = 0) uniform modelUniform{
 	mat4 m;
 } model;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
 layout(location = 2) in vec2 inUv;
 
 layout(location = 0) out vec3 outNormal;
@@ -26,11 +26,20 @@ out gl_PerVertex {
     vec4 gl_Position;
 };
 
+//decodes a direction stored with octahedral mapping.
+vec3 decodeOctahedral(vec2 encoded) {
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += direction.x >= 0.0 ? -fold : fold;
+	direction.y += direction.y >= 0.0 ? -fold : fold;
+	return normalize(direction);
+}
+
 void main() {
 	outUv = inUv;
-	vec4 position_worldSpace = model.m * vec4(inPosition, 1.0);
+	vec4 position_worldSpace = model.m * vec4(inPosition.xyz, 1.0);
 	gl_Position = ubo.pv * position_worldSpace;
-	outNormal = mat3(model.m) * inNormal;
+	outNormal = mat3(model.m) * decodeOctahedral(inNormal);
 	outLightVec = light.position - position_worldSpace.xyz;
 	outViewVec = - position_worldSpace.xyz;
 }
\ No newline at end of file
@@ -12,15 +12,14 @@ layout(location = 3) in vec3 halfVector_tangentSpace;
 
 layout(location = 0) out vec4 outColor;
 
-float heightScale = 0.1;
-const float minLayers = 8;
-const float maxLayers = 32;
+layout(constant_id = 0) const int minLayers = 10;
+layout(constant_id = 1) const int maxLayers = 20;
+layout(constant_id = 2) const float heightScale = 0.1;
+layout(constant_id = 4) const float shininess = 16.0;
 
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir)
 { 
-	const float minLayers = 10;
-    const float maxLayers = 20;
-    float numLayers = mix(maxLayers, minLayers, abs(dot(vec3(0.0, 0.0, 1.0), viewDir)));  
+    float numLayers = mix(float(maxLayers), float(minLayers), abs(dot(vec3(0.0, 0.0, 1.0), viewDir)));  
     // calculate the size of each layer
     float layerDepth = 1.0 / numLayers;
     // depth of current layer
@@ -90,7 +89,7 @@ void main() {
 	vec3 color = 
 		MaterialAmbientColor +
 		MaterialDiffuseColor * LightColor * cosNL +
-		MaterialSpecularColor * LightColor * pow(cosHN,16);
+		MaterialSpecularColor * LightColor * pow(cosHN, shininess);
 
 	outColor = vec4(color, 1.0);
 }
\ No newline at end of file
@@ -10,6 +10,8 @@ layout(location = 3) in vec3 lightVec;
 
 layout(location = 0) out vec4 outColor;
 
+layout(constant_id = 4) const float shininess = 16.0;
+
 void main() {
 	vec3 N = normalize(normal);
 	vec3 L = normalize(lightVec);
@@ -21,6 +23,6 @@ void main() {
 	vec3 color = texture(texSampler, uv).rgb;
 	vec3 ambient = color * vec3(0.1);
 	vec3 diffuse = cosNL * color;
-	vec3 specular = pow(cosER, 16.0) * vec3(0.75);
+	vec3 specular = pow(cosER, shininess) * vec3(0.75);
 	outColor = vec4(ambient + diffuse + specular, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+	mat4 pv;
+} ubo;
+
+layout(set = 2, binding = 0) readonly buffer ObjectTransforms {
+	mat4 transforms[];
+};
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inUv;
+
+layout(location = 0) out vec2 outUv;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+	mat4 model = transforms[gl_InstanceIndex];
+	outUv = inUv;
+	gl_Position = ubo.pv * model * vec4(inPosition.xyz, 1.0);
+}
\ No newline at end of file
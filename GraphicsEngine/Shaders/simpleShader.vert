@@ -9,8 +9,8 @@ layout(set = 1, binding = 0) uniform modelUniform{
 mat4 m;
 } model;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
 layout(location = 2) in vec2 inUv;
 
 layout(location = 0) out vec2 outUv;
@@ -21,5 +21,5 @@ out gl_PerVertex {
 
 void main() {
 	outUv = inUv;
-	gl_Position = ubo.pv * model.m * vec4(inPosition, 1.0);
+	gl_Position = ubo.pv * model.m * vec4(inPosition.xyz, 1.0);
 }
\ No newline at end of file
@@ -17,19 +17,27 @@ layout(set = 1, binding = 0) uniform modelUniform{
 	mat4 m;
 } model;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
 layout(location = 2) in vec2 inUv;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
+layout(location = 3) in vec2 inTangent;
 
 layout(location = 0) out vec2 outUv;
 layout(location = 1) out vec3 outViewDirection_tangentSpace;
 layout(location = 2) out vec3 outLightVec_tangentSpace;
 layout(location = 3) out vec3 outHalfVec_tangentSpace;
 
+//decodes a direction stored with octahedral mapping.
+vec3 decodeOctahedral(vec2 encoded) {
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += direction.x >= 0.0 ? -fold : fold;
+	direction.y += direction.y >= 0.0 ? -fold : fold;
+	return normalize(direction);
+}
+
 void main(){
-	vec4 vertex_worldSpace = model.m * vec4(inPosition, 1.0);
+	vec4 vertex_worldSpace = model.m * vec4(inPosition.xyz, 1.0);
 	gl_Position = ubo.pv * vertex_worldSpace;
 	outUv = inUv;
 
@@ -41,9 +49,14 @@ void main(){
 
 	mat3 m = mat3(model.m);
 
-	vec3 tangent_worldSpace = normalize(m * inTangent);
-	vec3 bitangent_worldSpace = normalize(m * inBitangent);
-	vec3 normal_worldSpace = normalize(m * inNormal);
+	//bitangent is rebuilt from the normal and tangent, handedness is stored in the last position component
+	vec3 normal = decodeOctahedral(inNormal);
+	vec3 tangent = decodeOctahedral(inTangent);
+	vec3 bitangent = cross(normal, tangent) * inPosition.w;
+
+	vec3 tangent_worldSpace = normalize(m * tangent);
+	vec3 bitangent_worldSpace = normalize(m * bitangent);
+	vec3 normal_worldSpace = normalize(m * normal);
 
 	//mat3 TBN = transpose(mat3(tangent_worldSpace, bitangent_worldSpace, normal_worldSpace));
 
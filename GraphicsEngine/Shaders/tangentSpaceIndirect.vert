@@ -0,0 +1,79 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+	mat4 pv;
+} ubo;
+
+layout(set = 0, binding = 1) uniform UniformLightObject {
+	vec3 position;
+} light;
+
+layout(set = 0, binding = 2) uniform View {
+	vec3 position;
+} view;
+
+layout(set = 2, binding = 0) readonly buffer ObjectTransforms {
+	mat4 transforms[];
+};
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inUv;
+layout(location = 3) in vec2 inTangent;
+
+layout(location = 0) out vec2 outUv;
+layout(location = 1) out vec3 outViewDirection_tangentSpace;
+layout(location = 2) out vec3 outLightVec_tangentSpace;
+layout(location = 3) out vec3 outHalfVec_tangentSpace;
+
+//decodes a direction stored with octahedral mapping.
+vec3 decodeOctahedral(vec2 encoded) {
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += direction.x >= 0.0 ? -fold : fold;
+	direction.y += direction.y >= 0.0 ? -fold : fold;
+	return normalize(direction);
+}
+
+void main(){
+	mat4 model = transforms[gl_InstanceIndex];
+	vec4 vertex_worldSpace = model * vec4(inPosition.xyz, 1.0);
+	gl_Position = ubo.pv * vertex_worldSpace;
+	outUv = inUv;
+
+	vec3 lightPos_worldSpace = light.position;
+
+	vec3 lightDir_worldSpace = lightPos_worldSpace - vertex_worldSpace.xyz;
+	vec3 halfVec_worldSpace = normalize(lightDir_worldSpace + vertex_worldSpace.xyz);
+	vec3 viewDirection_worldSpace = view.position - vertex_worldSpace.xyz;
+
+	mat3 m = mat3(model);
+
+	//bitangent is rebuilt from the normal and tangent, handedness is stored in the last position component
+	vec3 normal = decodeOctahedral(inNormal);
+	vec3 tangent = decodeOctahedral(inTangent);
+	vec3 bitangent = cross(normal, tangent) * inPosition.w;
+
+	vec3 tangent_worldSpace = normalize(m * tangent);
+	vec3 bitangent_worldSpace = normalize(m * bitangent);
+	vec3 normal_worldSpace = normalize(m * normal);
+
+	//mat3 TBN = transpose(mat3(tangent_worldSpace, bitangent_worldSpace, normal_worldSpace));
+
+	outLightVec_tangentSpace.x = dot(tangent_worldSpace, lightDir_worldSpace);
+	outLightVec_tangentSpace.y = dot(bitangent_worldSpace, lightDir_worldSpace);
+	outLightVec_tangentSpace.z = dot(normal_worldSpace, lightDir_worldSpace);
+
+	outHalfVec_tangentSpace.x = dot(tangent_worldSpace, halfVec_worldSpace);
+	outHalfVec_tangentSpace.y = dot(bitangent_worldSpace, halfVec_worldSpace);
+	outHalfVec_tangentSpace.z = dot(normal_worldSpace, halfVec_worldSpace);
+
+	outViewDirection_tangentSpace.x = dot(tangent_worldSpace, viewDirection_worldSpace);
+	outViewDirection_tangentSpace.y = dot(bitangent_worldSpace, viewDirection_worldSpace);
+	outViewDirection_tangentSpace.z = dot(normal_worldSpace, viewDirection_worldSpace);
+
+	/*outLightVec_tangentSpace = TBN * lightDir_worldSpace;
+	outHalfVec_tangentSpace =  TBN * halfVec_worldSpace;
+	outViewDirection_tangentSpace = TBN * viewDirection_worldSpace;*/
+}
\ No newline at end of file
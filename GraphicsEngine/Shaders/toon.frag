@@ -10,6 +10,8 @@ layout(location = 3) in vec3 lightVec;
 
 layout(location = 0) out vec4 outColor;
 
+layout(constant_id = 3) const int bands = 4;
+
 void main() {
 	vec3 N = normalize(normal);
 	vec3 L = normalize(lightVec);
@@ -24,11 +26,8 @@ void main() {
 	vec3 specular = pow(cosER, 16.0) * vec3(0.75);
 	outColor = vec4(ambient + diffuse * 1.75 + specular, 1.0);
 
-	float shade = 1.0;
-	shade = cosNL < 0.5 ? 0.75 : shade;
-	shade = cosNL < 0.35 ? 0.6 : shade;
-	shade = cosNL < 0.25 ? 0.5 : shade;
-	shade = cosNL < 0.1 ? 0.25 : shade;
+	//light is quantised into bands, the darkest band is as bright as the first lit one so unlit sides don't turn black.
+	float shade = max(ceil(cosNL * float(bands)) / float(bands), 1.0 / float(bands));
 
 	outColor.rgb = texture(texSampler, uv).rgb * 3.0 * shade;
 	outColor.a = texture(texSampler, uv).a;
@@ -2,11 +2,26 @@
 #include"Factories\ObjectFactory.h"
 #include"Factories\SceneFactory.h"
 #include"Djinn.h"
+#include<cstring>
+#include<string>
 
-int main()
+int main(int argc, char** argv)
 {
+	//--headless [frames] [output.png] renders given number of frames offscreen and optionally saves the last one.
+	bool headless = argc > 1 && strcmp(argv[1], "--headless") == 0;
+	uint32_t maxFrames = 0;
+	const char* output = nullptr;
+	if (headless)
+	{
+		maxFrames = argc > 2 ? std::stoul(argv[2]) : 1;
+		output = argc > 3 ? argv[3] : nullptr;
+	}
 	Djinn djinn;
-	djinn.initialize("Djinn", 800, 600);
+	//shaders are compiled from their sources, so edited shaders don't need compile.bat.
+	djinn.setShaderCompilation(!headless);
+	djinn.initialize("Djinn", 800, 600, headless);
+	//assets edited while the window is open are reloaded.
+	djinn.setHotReload(!headless);
 	GameObject* slider = ObjectFactory::createSlider(SliderCreate{ glm::vec4{ 0.1f, 0.1f, 0.15f, 0.15f}, "Textures/slider.png", "Textures/littleSlider.png", "" });
 	GameObject* binder = ObjectFactory::createBinder(BinderCreate{ glm::vec4{ 0.4f, 0.4f, 0.3f, 0.1f }, glm::vec4{ 0.f, 0.5f, 0.4f, 1.f }, glm::vec4{ 0.6f, 0.5f, 0.4f, 1.f }, "Textures/name.png", "Textures/box.png", "" });
 	GameObject* selector = ObjectFactory::createSelector(SelectorCreate{ glm::vec4{ 0.15f, 0.8f, 0.3f, 0.3f }, glm::vec4{ 0.5f, 0.75f, 0.4f, 0.5f }, glm::vec4{ 0.25f, 0.25f, 0.4f, 0.5f },
@@ -43,7 +58,11 @@ int main()
 	djinn.setScene(&s);
 	try
 	{
-		djinn.run();
+		djinn.run(maxFrames);
+		if (output != nullptr)
+		{
+			djinn.saveFrame(output);
+		}
 	}
 	catch (const std::runtime_error& e)
 	{
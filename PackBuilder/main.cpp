@@ -0,0 +1,150 @@
+#include<iostream>
+#include<string>
+#include<cstring>
+#include<algorithm>
+#include<vector>
+#include<experimental\filesystem>
+#include<stb_image.h>
+#include"ResourceManagers\AssetId.h"
+#include"ResourceManagers\AssetPack.h"
+#include"ResourceManagers\FileSystem.h"
+#include"ResourceManagers\TextureCache.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+	/**
+		PackOptions structure.
+		Contains options parsed from the command line.
+	*/
+	struct PackOptions
+	{
+		const char* output{ nullptr };			//*< Pack file to write.
+		std::vector<std::string> directories;	//*< Directories whose files are packed.
+		bool compress{ false };					//*< Flag determining if files which compress well are stored compressed.
+	};
+
+	/**
+		Parses command line arguments.
+		@param argc number of arguments.
+		@param argv array of arguments.
+		@return parsed options.
+	*/
+	PackOptions parseOptions(int argc, char** argv)
+	{
+		PackOptions options;
+		for (int i = 1; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--compress") == 0)
+			{
+				options.compress = true;
+			}
+			else if (options.output == nullptr)
+			{
+				options.output = argv[i];
+			}
+			else
+			{
+				options.directories.push_back(argv[i]);
+			}
+		}
+		if (options.output == nullptr || options.directories.empty())
+		{
+			throw std::runtime_error("usage: PackBuilder [--compress] <pack> <directory>...");
+		}
+		return options;
+	}
+
+	/**
+		Checks if a file is an image loaded as a texture.
+		@param path path to the file.
+		@return true if the file is an image, false otherwise.
+	*/
+	bool isImage(const std::string& path)
+	{
+		std::string normalized = AssetId::normalize(path);
+		const char* extensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga" };
+		for (const char* extension : extensions)
+		{
+			size_t length = strlen(extension);
+			if (normalized.size() > length && normalized.compare(normalized.size() - length, length, extension) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+		Builds the cached mip chain of an image if it's missing or out of date, so streamed textures don't need the image at runtime.
+		@param path path to the image.
+		@return path to the cached mip chain, empty if the image can't be decoded.
+	*/
+	std::string cookTexture(const std::string& path)
+	{
+		std::string cachePath = TextureCache::getPath(path);
+		MipChain chain;
+		if (TextureCache::readChain(cachePath, path, chain))
+		{
+			return cachePath;
+		}
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels)
+		{
+			return std::string();
+		}
+		std::vector<unsigned char> levels;
+		TextureCache::generate(pixels, width, height, chain, levels);
+		stbi_image_free(pixels);
+		TextureCache::write(cachePath, path, chain, levels);
+		return TextureCache::readChain(cachePath, path, chain) ? cachePath : std::string();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		PackOptions options = parseOptions(argc, argv);
+		std::vector<std::string> paths;
+		for (const std::string& directory : options.directories)
+		{
+			for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory))
+			{
+				if (fs::is_regular_file(entry.status()))
+				{
+					paths.push_back(entry.path().generic_string());
+				}
+			}
+		}
+		size_t fileCount = paths.size();
+		for (size_t i = 0; i < fileCount; i++)
+		{
+			if (isImage(paths[i]))
+			{
+				std::string cachePath = cookTexture(paths[i]);
+				if (!cachePath.empty())
+				{
+					paths.push_back(cachePath);
+				}
+			}
+		}
+		// sorting keeps files of a directory together and caches right after their sources, cooked mip chains may already be in the list
+		std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) { return AssetId::normalize(a) < AssetId::normalize(b); });
+		paths.erase(std::unique(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) { return AssetId::normalize(a) == AssetId::normalize(b); }), paths.end());
+
+		PackStats stats = AssetPack::build(options.output, paths, options.compress);
+		std::cout << "files: " << stats.files << std::endl;
+		std::cout << "size: " << stats.size << std::endl;
+		std::cout << "stored size: " << stats.storedSize << std::endl;
+		std::cout << "pack size: " << stats.packSize << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file